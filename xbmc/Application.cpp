@@ -173,11 +173,7 @@
 #include "music/tags/MusicInfoTagLoaderFactory.h"
 #include "CompileInfo.h"
 
-#ifdef HAS_PERFORMANCE_SAMPLE
-#include "utils/PerformanceSample.h"
-#else
-#define MEASURE_FUNCTION
-#endif
+#include "utils/Trace.h"
 
 #ifdef TARGET_WINDOWS
 #include "win32util.h"
@@ -1846,7 +1842,7 @@ bool CApplication::LoadUserWindows()
 
 bool CApplication::RenderNoPresent()
 {
-  MEASURE_FUNCTION;
+  TRACE_FUNCTION("app");
 
 // DXMERGE: This may have been important?
 //  g_graphicsContext.AcquireCurrentContext();
@@ -1890,7 +1886,7 @@ void CApplication::Render()
   if (m_bStop)
     return;
 
-  MEASURE_FUNCTION;
+  TRACE_FUNCTION("app");
 
   int vsync_mode = CSettings::Get().GetInt("videoscreen.vsync");
 
@@ -1996,7 +1992,7 @@ void CApplication::Render()
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
   // isn't called)
-  g_infoManager.ResetCache();
+  g_infoManager.ResetChangedCache();
 
 
   unsigned int now = XbmcThreads::SystemClockMillis();
@@ -2457,7 +2453,7 @@ bool CApplication::OnAction(const CAction &action)
 
 void CApplication::FrameMove(bool processEvents, bool processGUI)
 {
-  MEASURE_FUNCTION;
+  TRACE_FUNCTION("app");
 
   if (processEvents)
   {
@@ -2532,10 +2528,11 @@ bool CApplication::Cleanup()
 
     CLog::Log(LOGNOTICE, "unload sections");
 
-#ifdef HAS_PERFORMANCE_SAMPLE
-    CLog::Log(LOGNOTICE, "performance statistics");
-    m_perfStats.DumpStats();
-#endif
+    if (CTracer::IsEnabled())
+    {
+      CTracer::Get().Stop();
+      CTracer::Get().Save(CTracer::GetTraceFile());
+    }
 
     //  Shutdown as much as possible of the
     //  application, to reduce the leaks dumped
@@ -2710,6 +2707,9 @@ void CApplication::Stop(int exitCode)
     CLog::Log(LOGERROR, "Exception in CApplication::Stop()");
   }
 
+  // write out what is still queued and log from this thread from now on
+  CLog::SetAsync(false);
+
   // we may not get to finish the run cycle but exit immediately after a call to g_application.Stop()
   // so we may never get to Destroy() in CXBApplicationEx::Run(), we call it here.
   Destroy();
@@ -4198,7 +4198,7 @@ void CApplication::ShowAppMigrationMessage()
 
 void CApplication::Process()
 {
-  MEASURE_FUNCTION;
+  TRACE_FUNCTION("app");
 
   // dispatch the messages generated by python or other threads to the current window
   g_windowManager.DispatchThreadMessages();
@@ -4921,12 +4921,6 @@ CNetwork& CApplication::getNetwork()
 {
   return *m_network;
 }
-#ifdef HAS_PERFORMANCE_SAMPLE
-CPerformanceStats &CApplication::GetPerformanceStats()
-{
-  return m_perfStats;
-}
-#endif
 
 bool CApplication::SetLanguage(const std::string &strLanguage)
 {
@@ -234,10 +234,6 @@ CFileItem::CFileItem(const CGenre& genre)
 }
 
 CFileItem::CFileItem(const CFileItem& item)
-: m_musicInfoTag(NULL),
-  m_videoInfoTag(NULL),
-  m_pictureInfoTag(NULL),
-  m_gameInfoTag(NULL)
 {
   *this = item;
 }
@@ -315,15 +311,6 @@ CFileItem::CFileItem(const CMediaSource& share)
 
 CFileItem::~CFileItem(void)
 {
-  delete m_musicInfoTag;
-  delete m_videoInfoTag;
-  delete m_pictureInfoTag;
-  delete m_gameInfoTag;
-
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
-  m_gameInfoTag = NULL;
 }
 
 const CFileItem& CFileItem::operator=(const CFileItem& item)
@@ -341,57 +328,11 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
   m_dateTime = item.m_dateTime;
   m_dwSize = item.m_dwSize;
 
-  if (item.m_musicInfoTag)
-  {
-    if (m_musicInfoTag)
-      *m_musicInfoTag = *item.m_musicInfoTag;
-    else
-      m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag(*item.m_musicInfoTag);
-  }
-  else
-  {
-    delete m_musicInfoTag;
-    m_musicInfoTag = NULL;
-  }
-
-  if (item.m_videoInfoTag)
-  {
-    if (m_videoInfoTag)
-      *m_videoInfoTag = *item.m_videoInfoTag;
-    else
-      m_videoInfoTag = new CVideoInfoTag(*item.m_videoInfoTag);
-  }
-  else
-  {
-    delete m_videoInfoTag;
-    m_videoInfoTag = NULL;
-  }
-
-  if (item.m_pictureInfoTag)
-  {
-    if (m_pictureInfoTag)
-      *m_pictureInfoTag = *item.m_pictureInfoTag;
-    else
-      m_pictureInfoTag = new CPictureInfoTag(*item.m_pictureInfoTag);
-  }
-  else
-  {
-    delete m_pictureInfoTag;
-    m_pictureInfoTag = NULL;
-  }
-
-  if (item.m_gameInfoTag)
-  {
-    if (m_gameInfoTag)
-      *m_gameInfoTag = *item.m_gameInfoTag;
-    else
-      m_gameInfoTag = new CGameInfoTag(*item.m_gameInfoTag);
-  }
-  else
-  {
-    delete m_gameInfoTag;
-    m_gameInfoTag = NULL;
-  }
+  // the tags are copied once either item asks for a tag it can modify
+  m_musicInfoTag = item.m_musicInfoTag;
+  m_videoInfoTag = item.m_videoInfoTag;
+  m_pictureInfoTag = item.m_pictureInfoTag;
+  m_gameInfoTag = item.m_gameInfoTag;
 
   m_epgInfoTag = item.m_epgInfoTag;
   m_pvrChannelInfoTag = item.m_pvrChannelInfoTag;
@@ -419,10 +360,6 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
 
 void CFileItem::Initialize()
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
-  m_gameInfoTag = NULL;
   m_bLabelPreformated = false;
   m_bIsAlbum = false;
   m_dwSize = 0;
@@ -457,18 +394,14 @@ void CFileItem::Reset()
   m_dateTime.Reset();
   m_strLockCode.clear();
   m_mimetype.clear();
-  delete m_musicInfoTag;
-  m_musicInfoTag=NULL;
-  delete m_videoInfoTag;
-  m_videoInfoTag=NULL;
+  m_musicInfoTag.reset();
+  m_videoInfoTag.reset();
   m_epgInfoTag.reset();
   m_pvrChannelInfoTag.reset();
   m_pvrRecordingInfoTag.reset();
   m_pvrTimerInfoTag.reset();
-  delete m_pictureInfoTag;
-  m_pictureInfoTag=NULL;
-  delete m_gameInfoTag;
-  m_gameInfoTag = NULL;
+  m_pictureInfoTag.reset();
+  m_gameInfoTag.reset();
   m_extrainfo.clear();
   ClearProperties();
 
@@ -501,7 +434,7 @@ void CFileItem::Archive(CArchive& ar)
     ar << m_iBadPwdCount;
 
     ar << m_bCanQueue;
-    ar << m_mimetype;
+    ar << m_mimetype.str();
     ar << m_extrainfo;
     ar << m_specialSort;
 
@@ -557,7 +490,9 @@ void CFileItem::Archive(CArchive& ar)
     ar >> m_iBadPwdCount;
 
     ar >> m_bCanQueue;
-    ar >> m_mimetype;
+    std::string mimetype;
+    ar >> mimetype;
+    m_mimetype = mimetype;
     ar >> m_extrainfo;
     ar >> temp;
     m_specialSort = (SortSpecial)temp;
@@ -590,7 +525,7 @@ void CFileItem::Serialize(CVariant& value) const
   value["size"] = m_dwSize;
   value["DVDLabel"] = m_strDVDLabel;
   value["title"] = m_strTitle;
-  value["mimetype"] = m_mimetype;
+  value["mimetype"] = m_mimetype.str();
   value["extrainfo"] = m_extrainfo;
 
   if (m_musicInfoTag)
@@ -733,7 +668,7 @@ bool CFileItem::IsVideo() const
   std::string extension;
   if(StringUtils::StartsWithNoCase(m_mimetype, "application/"))
   { /* check for some standard types */
-    extension = m_mimetype.substr(12);
+    extension = m_mimetype.str().substr(12);
     if( StringUtils::EqualsNoCase(extension, "ogg")
      || StringUtils::EqualsNoCase(extension, "mp4")
      || StringUtils::EqualsNoCase(extension, "mxf") )
@@ -812,7 +747,7 @@ bool CFileItem::IsAudio() const
 
   if(StringUtils::StartsWithNoCase(m_mimetype, "application/"))
   { /* check for some standard types */
-    std::string extension = m_mimetype.substr(12);
+    std::string extension = m_mimetype.str().substr(12);
     if( StringUtils::EqualsNoCase(extension, "ogg")
      || StringUtils::EqualsNoCase(extension, "mp4")
      || StringUtils::EqualsNoCase(extension, "mxf") )
@@ -1361,20 +1296,22 @@ void CFileItem::FillInMimeType(bool lookup /*= true*/)
       if (!lookup)
         return;
 
-      CCurlFile::GetMimeType(GetURL(), m_mimetype);
+      std::string mimetype;
+      CCurlFile::GetMimeType(GetURL(), mimetype);
 
       // try to get mime-type again but with an NSPlayer User-Agent
       // in order for server to provide correct mime-type.  Allows us
       // to properly detect an MMS stream
-      if (StringUtils::StartsWithNoCase(m_mimetype, "video/x-ms-"))
-        CCurlFile::GetMimeType(GetURL(), m_mimetype, "NSPlayer/11.00.6001.7000");
+      if (StringUtils::StartsWithNoCase(mimetype, "video/x-ms-"))
+        CCurlFile::GetMimeType(GetURL(), mimetype, "NSPlayer/11.00.6001.7000");
 
       // make sure there are no options set in mime-type
       // mime-type can look like "video/x-ms-asf ; charset=utf8"
-      size_t i = m_mimetype.find(';');
+      size_t i = mimetype.find(';');
       if(i != std::string::npos)
-        m_mimetype.erase(i, m_mimetype.length() - i);
-      StringUtils::Trim(m_mimetype);
+        mimetype.erase(i, mimetype.length() - i);
+      StringUtils::Trim(mimetype);
+      m_mimetype = mimetype;
     }
     else
       m_mimetype = CMime::GetMimeType(*this);
@@ -2036,26 +1973,22 @@ void CFileItemList::Sort(SortDescription sortDescription)
   if (m_sortIgnoreFolders)
     sortDescription.sortAttributes = (SortAttribute)((int)sortDescription.sortAttributes | SortAttributeIgnoreFolders);
 
-  const Fields fields = SortUtils::GetFieldsForSorting(sortDescription.sortBy);
-  SortItems sortItems((size_t)Size());
-  for (int index = 0; index < Size(); index++)
-  {
-    sortItems[index] = std::shared_ptr<SortItem>(new SortItem);
-    m_items[index]->ToSortable(*sortItems[index], fields);
-    (*sortItems[index])[FieldId] = index;
-  }
-
   // do the sorting
-  SortUtils::Sort(sortDescription, sortItems);
+  std::vector<size_t> order;
+  std::vector<std::wstring> labels;
+  SortUtils::Sort(sortDescription, m_items.size(), [this](size_t index, const Fields &fields, SortItem &sortable)
+  {
+    m_items[index]->ToSortable(sortable, fields);
+  }, order, &labels);
 
   // apply the new order to the existing CFileItems
   VECFILEITEMS sortedFileItems;
-  sortedFileItems.reserve(Size());
-  for (SortItems::const_iterator it = sortItems.begin(); it != sortItems.end(); it++)
+  sortedFileItems.reserve(order.size());
+  for (std::vector<size_t>::const_iterator it = order.begin(); it != order.end(); ++it)
   {
-    CFileItemPtr item = m_items[(int)(*it)->at(FieldId).asInteger()];
+    CFileItemPtr item = m_items[*it];
     // Set the sort label in the CFileItem
-    item->SetSortLabel((*it)->at(FieldSort).asWideString());
+    item->SetSortLabel(labels[*it]);
 
     sortedFileItems.push_back(item);
   }
@@ -3218,34 +3151,22 @@ void CFileItemList::ClearSortState()
 
 CVideoInfoTag* CFileItem::GetVideoInfoTag()
 {
-  if (!m_videoInfoTag)
-    m_videoInfoTag = new CVideoInfoTag;
-
-  return m_videoInfoTag;
+  return m_videoInfoTag.GetUnique();
 }
 
 CPictureInfoTag* CFileItem::GetPictureInfoTag()
 {
-  if (!m_pictureInfoTag)
-    m_pictureInfoTag = new CPictureInfoTag;
-
-  return m_pictureInfoTag;
+  return m_pictureInfoTag.GetUnique();
 }
 
 MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag()
 {
-  if (!m_musicInfoTag)
-    m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
-
-  return m_musicInfoTag;
+  return m_musicInfoTag.GetUnique();
 }
 
 CGameInfoTag* CFileItem::GetGameInfoTag()
 {
-  if (!m_gameInfoTag)
-    m_gameInfoTag = new CGameInfoTag;
-
-  return m_gameInfoTag;
+  return m_gameInfoTag.GetUnique();
 }
 
 std::string CFileItem::FindTrailer() const
@@ -30,9 +30,11 @@
 #include "utils/ISortable.h"
 #include "XBDateTime.h"
 #include "utils/SortUtils.h"
+#include "utils/StringPool.h"
 #include "GUIPassword.h"
 #include "threads/CriticalSection.h"
 
+#include <atomic>
 #include <vector>
 #include <memory>
 
@@ -245,26 +247,32 @@ public:
 
   inline bool HasMusicInfoTag() const
   {
-    return m_musicInfoTag != NULL;
+    return m_musicInfoTag.get() != NULL;
   }
 
+  /*! \brief Get the music tag for modifying, creating it if there's none.
+   Copies of an item share their tags, a shared tag is copied here before it
+   may be modified. The same goes for the other info tags, so a pointer from
+   before the item was copied must not be used to modify it. Other threads may
+   go on reading the item meanwhile, see CSharedTag.
+   */
   MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag();
 
   inline const MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag() const
   {
-    return m_musicInfoTag;
+    return m_musicInfoTag.get();
   }
 
   inline bool HasVideoInfoTag() const
   {
-    return m_videoInfoTag != NULL;
+    return m_videoInfoTag.get() != NULL;
   }
 
   CVideoInfoTag* GetVideoInfoTag();
 
   inline const CVideoInfoTag* GetVideoInfoTag() const
   {
-    return m_videoInfoTag;
+    return m_videoInfoTag.get();
   }
 
   inline bool HasEPGInfoTag() const
@@ -326,24 +334,24 @@ public:
 
   inline bool HasPictureInfoTag() const
   {
-    return m_pictureInfoTag != NULL;
+    return m_pictureInfoTag.get() != NULL;
   }
 
   inline const CPictureInfoTag* GetPictureInfoTag() const
   {
-    return m_pictureInfoTag;
+    return m_pictureInfoTag.get();
   }
 
   inline bool HasGameInfoTag() const
   {
-    return m_gameInfoTag != NULL;
+    return m_gameInfoTag.get() != NULL;
   }
 
   GAME::CGameInfoTag* GetGameInfoTag();
 
   inline const GAME::CGameInfoTag* GetGameInfoTag() const
   {
-    return m_gameInfoTag;
+    return m_gameInfoTag.get();
   }
 
   CPictureInfoTag* GetPictureInfoTag();
@@ -494,22 +502,110 @@ private:
    */
   void Initialize();
 
+  /*!
+   \brief An info tag that copies of the item share until one of them asks for a tag it can modify.
+
+   Kodi reads tags through the non-const getters too, and from other threads than the one that
+   modifies the item (the thumb loaders), so the tag is swapped atomically. The tag that was
+   replaced is kept until the next swap or until the item is reset, assigned or destroyed, so
+   a pointer another thread got from the item just before stays valid.
+   */
+  template<typename T>
+  class CSharedTag
+  {
+  public:
+    CSharedTag() : m_holder(NULL), m_replaced(NULL) {}
+    CSharedTag(const CSharedTag &other) : m_holder(other.Share()), m_replaced(NULL) {}
+    ~CSharedTag() { reset(); }
+
+    CSharedTag& operator=(const CSharedTag &other)
+    {
+      if (this != &other)
+      {
+        Release(m_holder.exchange(other.Share()));
+        Release(m_replaced.exchange(NULL));
+      }
+      return *this;
+    }
+
+    T* get() const
+    {
+      Holder *holder = m_holder.load();
+      return holder ? holder->tag : NULL;
+    }
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+    explicit operator bool() const { return get() != NULL; }
+
+    /*! \brief Get the tag for modifying, creating it if there's none and copying it if it's shared */
+    T* GetUnique()
+    {
+      Holder *holder = m_holder.load();
+      while (!holder || holder->refs > 1)
+      {
+        Holder *unique = new Holder(holder ? new T(*holder->tag) : new T);
+        if (m_holder.compare_exchange_strong(holder, unique))
+        {
+          Release(m_replaced.exchange(holder));
+          return unique->tag;
+        }
+        // another thread swapped it first, holder is the tag it swapped in
+        Release(unique);
+      }
+      return holder->tag;
+    }
+
+    void reset()
+    {
+      Release(m_holder.exchange(NULL));
+      Release(m_replaced.exchange(NULL));
+    }
+
+  private:
+    struct Holder
+    {
+      explicit Holder(T *t) : refs(1), tag(t) {}
+      std::atomic<int> refs;
+      T *tag;
+    };
+
+    Holder* Share() const
+    {
+      Holder *holder = m_holder.load();
+      if (holder)
+        ++holder->refs;
+      return holder;
+    }
+
+    static void Release(Holder *holder)
+    {
+      if (holder && --holder->refs == 0)
+      {
+        delete holder->tag;
+        delete holder;
+      }
+    }
+
+    std::atomic<Holder*> m_holder;
+    std::atomic<Holder*> m_replaced;
+  };
+
   std::string m_strPath;            ///< complete path to item
 
   SortSpecial m_specialSort;
   bool m_bIsParentFolder;
   bool m_bCanQueue;
   bool m_bLabelPreformated;
-  std::string m_mimetype;
+  CPooledString m_mimetype;
   std::string m_extrainfo;
-  MUSIC_INFO::CMusicInfoTag* m_musicInfoTag;
-  CVideoInfoTag* m_videoInfoTag;
+  CSharedTag<MUSIC_INFO::CMusicInfoTag> m_musicInfoTag;
+  CSharedTag<CVideoInfoTag> m_videoInfoTag;
   EPG::CEpgInfoTagPtr m_epgInfoTag;
   PVR::CPVRChannelPtr m_pvrChannelInfoTag;
   PVR::CPVRRecordingPtr m_pvrRecordingInfoTag;
   PVR::CPVRTimerInfoTagPtr m_pvrTimerInfoTag;
-  CPictureInfoTag* m_pictureInfoTag;
-  GAME::CGameInfoTag* m_gameInfoTag;
+  CSharedTag<CPictureInfoTag> m_pictureInfoTag;
+  CSharedTag<GAME::CGameInfoTag> m_gameInfoTag;
   bool m_bIsAlbum;
 
   CCueDocumentPtr m_cueDocument;
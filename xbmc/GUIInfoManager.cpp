@@ -59,6 +59,7 @@
 #include "utils/SeekHandler.h"
 #include "URL.h"
 #include "addons/Skin.h"
+#include <algorithm>
 #include <memory>
 #include <functional>
 #include "cores/DataCacheCore.h"
@@ -124,6 +125,9 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowCodec = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
+  m_changedSources = 0;
+  m_playerState = 0;
+  m_playerSpeed = 1;
   ResetLibraryBools();
 }
 
@@ -5548,6 +5552,107 @@ void CGUIInfoManager::ResetCache()
     (*i)->SetDirty();
 }
 
+void CGUIInfoManager::ResetChangedCache()
+{
+  // reset any animation triggers as well
+  m_containerMoves.clear();
+
+  unsigned int changed = m_changedSources.exchange(0) | INFO_SOURCE_FRAME;
+
+  // the player doesn't tell us about state changes, so compare against the last frame
+  enum { PLAYING = 1 << 0, AUDIO = 1 << 1, VIDEO = 1 << 2, GAME = 1 << 3, PAUSED = 1 << 4, CACHING = 1 << 5, MUTED = 1 << 6 };
+  unsigned int state = 0;
+  int speed = 1;
+  if (g_application.m_pPlayer->IsPlaying())
+  {
+    state |= PLAYING;
+    if (g_application.m_pPlayer->IsPlayingAudio())
+      state |= AUDIO;
+    if (g_application.m_pPlayer->IsPlayingVideo())
+      state |= VIDEO;
+    if (g_application.m_pPlayer->IsPlayingGame())
+      state |= GAME;
+    if (g_application.m_pPlayer->IsPausedPlayback())
+      state |= PAUSED;
+    if (g_application.m_pPlayer->IsCaching())
+      state |= CACHING;
+    speed = g_application.m_pPlayer->GetPlaySpeed();
+  }
+  if (g_application.IsMuted())
+    state |= MUTED;
+  if (state != m_playerState || speed != m_playerSpeed)
+  {
+    m_playerState = state;
+    m_playerSpeed = speed;
+    changed |= INFO_SOURCE_PLAYER;
+  }
+
+  // mark the infobools depending on what changed as dirty
+  CSingleLock lock(m_critInfo);
+  for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+  {
+    if ((*i)->GetSources() & changed)
+      (*i)->SetDirty();
+  }
+}
+
+unsigned int CGUIInfoManager::GetInfoSources(int condition) const
+{
+  condition = abs(condition);
+
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  {
+    size_t index = condition - MULTI_INFO_START;
+    if (index < m_multiInfo.size())
+    {
+      int info = m_multiInfo[index].m_info;
+      if (info == SKIN_BOOL || info == SKIN_STRING)
+        return INFO_SOURCE_SKIN;
+    }
+    return INFO_SOURCE_FRAME;
+  }
+
+  if ((condition >= PLAYER_HAS_MEDIA && condition <= PLAYER_FORWARDING_32x) ||
+      condition == PLAYER_HAS_GAME || condition == PLAYER_CACHING ||
+      condition == PLAYER_MUTED || condition == PLAYER_SHOWCODEC || condition == PLAYER_SHOWINFO)
+    return INFO_SOURCE_PLAYER;
+
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_COMPILATIONS)
+    return INFO_SOURCE_LIBRARY;
+
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE ||
+      condition == SYSTEM_ETHERNET_LINK_ACTIVE ||
+      (condition >= SYSTEM_PLATFORM_LINUX && condition <= SYSTEM_PLATFORM_LINUX_RASPBERRY_PI))
+    return INFO_SOURCE_NONE;
+
+  return INFO_SOURCE_FRAME;
+}
+
+vector<InfoPtr> CGUIInfoManager::GetInfoBoolProfile()
+{
+  vector<InfoPtr> profile;
+  {
+    CSingleLock lock(m_critInfo);
+    for (vector<InfoPtr>::const_iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+    {
+      if ((*i)->GetEvaluations() > 0)
+        profile.push_back(*i);
+    }
+  }
+  sort(profile.begin(), profile.end(), [](const InfoPtr &a, const InfoPtr &b)
+  {
+    return a->GetEvaluationTime() > b->GetEvaluationTime();
+  });
+  return profile;
+}
+
+void CGUIInfoManager::ResetInfoBoolProfile()
+{
+  CSingleLock lock(m_critInfo);
+  for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+    (*i)->ResetProfile();
+}
+
 std::string CGUIInfoManager::GetPictureLabel(int info)
 {
   if (info == SLIDE_FILE_NAME)
@@ -5704,8 +5809,9 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
       m_libraryHasCompilations = value ? 1 : 0;
       break;
     default:
-      break;
+      return;
   }
+  SetInfoSourceChanged(INFO_SOURCE_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5717,6 +5823,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasMovieSets = -1;
   m_libraryHasSingles = -1;
   m_libraryHasCompilations = -1;
+  SetInfoSourceChanged(INFO_SOURCE_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
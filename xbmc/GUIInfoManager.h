@@ -36,6 +36,7 @@
 #include "interfaces/info/SkinVariable.h"
 #include "cores/IPlayer.h"
 
+#include <atomic>
 #include <list>
 #include <map>
 
@@ -815,10 +816,10 @@ public:
   bool GetDisplayAfterSeek();
   void SetDisplayAfterSeek(unsigned int timeOut = 2500, int seekOffset = 0);
   void SetShowTime(bool showtime) { m_playerShowTime = showtime; };
-  void SetShowCodec(bool showcodec) { m_playerShowCodec = showcodec; };
-  void SetShowInfo(bool showinfo) { m_playerShowInfo = showinfo; };
-  void ToggleShowCodec() { m_playerShowCodec = !m_playerShowCodec; };
-  bool ToggleShowInfo() { m_playerShowInfo = !m_playerShowInfo; return m_playerShowInfo; };
+  void SetShowCodec(bool showcodec) { m_playerShowCodec = showcodec; SetInfoSourceChanged(INFO::INFO_SOURCE_PLAYER); };
+  void SetShowInfo(bool showinfo) { m_playerShowInfo = showinfo; SetInfoSourceChanged(INFO::INFO_SOURCE_PLAYER); };
+  void ToggleShowCodec() { m_playerShowCodec = !m_playerShowCodec; SetInfoSourceChanged(INFO::INFO_SOURCE_PLAYER); };
+  bool ToggleShowInfo() { m_playerShowInfo = !m_playerShowInfo; SetInfoSourceChanged(INFO::INFO_SOURCE_PLAYER); return m_playerShowInfo; };
 
   std::string GetSystemHeatInfo(int info);
   CTemperature GetGPUTemperature();
@@ -830,7 +831,24 @@ public:
   void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
   void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
 
+  /*! \brief Mark all info bools as dirty */
   void ResetCache();
+  /*! \brief Mark only the info bools as dirty whose sources changed since the last call
+   Info bools depending on INFO::INFO_SOURCE_FRAME are always marked as dirty.
+   */
+  void ResetChangedCache();
+  /*! \brief Called by the info sources when their state changes
+   \param sources the INFO::InfoSource values that changed
+   \sa ResetChangedCache
+   */
+  void SetInfoSourceChanged(unsigned int sources) { m_changedSources |= sources; }
+  /*! \brief The INFO::InfoSource values a condition depends on */
+  unsigned int GetInfoSources(int condition) const;
+
+  /*! \brief Info bools that were evaluated while profiling, most expensive first */
+  std::vector<INFO::InfoPtr> GetInfoBoolProfile();
+  void ResetInfoBoolProfile();
+
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   std::string GetItemLabel(const CFileItem *item, int info, std::string *fallback = NULL);
   std::string GetItemImage(const CFileItem *item, int info, std::string *fallback = NULL);
@@ -953,6 +971,9 @@ protected:
   int m_prevWindowID;
 
   std::vector<INFO::InfoPtr> m_bools;
+  std::atomic<unsigned int> m_changedSources;
+  unsigned int m_playerState;           // flags of the player state at the last ResetChangedCache()
+  int m_playerSpeed;
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
 
   int m_libraryHasMusic;
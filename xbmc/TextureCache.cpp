@@ -23,22 +23,32 @@
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/Crc32.h"
+#include "utils/CPUInfo.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
 #include "URL.h"
 
+#include <algorithm>
+
 using namespace XFILE;
 
+#define MAX_CACHE_JOBS 4 // images decoded and cached at once
+#define USE_COUNT_FLUSH_INTERVAL 60000 // ms between writes of the use counts
+
 CTextureCache &CTextureCache::Get()
 {
   static CTextureCache s_cache;
   return s_cache;
 }
 
-CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
+// decoding images is cpu bound, so cache a few in parallel but leave a core for the GUI
+CTextureCache::CTextureCache()
+  : CJobQueue(false, std::max(1, std::min(g_cpuInfo.getCPUCount() - 1, MAX_CACHE_JOBS)), CJob::PRIORITY_LOW_PAUSABLE),
+    m_useCountFlushed(0)
 {
 }
 
@@ -51,13 +61,33 @@ void CTextureCache::Initialize()
   CSingleLock lock(m_databaseSection);
   if (!m_database.IsOpen())
     m_database.Open();
+  lock.Leave();
+
+  {
+    CSingleLock useCountLock(m_useCountSection);
+    m_useCountFlushed = XbmcThreads::SystemClockMillis();
+  }
+
+  // lookups go to the database until the index is loaded
+  if (!m_index.IsLoaded())
+    AddJob(new CTextureIndexJob());
 }
 
 void CTextureCache::Deinitialize()
 {
   CancelJobs();
+
+  std::vector<CTextureDetails> useCounts;
+  {
+    CSingleLock lock(m_useCountSection);
+    useCounts.swap(m_useCounts);
+  }
+  if (!useCounts.empty())
+    CTextureUseCountJob(useCounts).DoWork();
+
   CSingleLock lock(m_databaseSection);
   m_database.Close();
+  m_index.Clear();
 }
 
 bool CTextureCache::IsCachedImage(const std::string &url) const
@@ -207,14 +237,34 @@ bool CTextureCache::ClearCachedImage(int id)
 
 bool CTextureCache::GetCachedTexture(const std::string &url, CTextureDetails &details)
 {
+  if (m_index.Get(url, details))
+    return true;
+  if (m_index.IsLoaded())
+    return false;
+
   CSingleLock lock(m_databaseSection);
   return m_database.GetCachedTexture(url, details);
 }
 
 bool CTextureCache::AddCachedTexture(const std::string &url, const CTextureDetails &details)
 {
+  CTextureDetails added(details);
+  CSingleLock lock(m_databaseSection);
+  if (!m_database.AddCachedTexture(url, added))
+    return false;
+  m_index.Add(url, added);
+  return true;
+}
+
+bool CTextureCache::InvalidateCachedTexture(const std::string &url, CTextureDatabase *database /* = NULL */)
+{
+  // same as CTextureDatabase::InvalidateCachedTexture, last checked long enough ago to check again
+  m_index.SetHashCheck(url, CDateTime::GetCurrentDateTime() - CDateTimeSpan(2, 0, 0, 0));
+  if (database)
+    return database->InvalidateCachedTexture(url);
+
   CSingleLock lock(m_databaseSection);
-  return m_database.AddCachedTexture(url, details);
+  return m_database.InvalidateCachedTexture(url);
 }
 
 void CTextureCache::IncrementUseCount(const CTextureDetails &details)
@@ -223,27 +273,32 @@ void CTextureCache::IncrementUseCount(const CTextureDetails &details)
   CSingleLock lock(m_useCountSection);
   m_useCounts.reserve(count_before_update);
   m_useCounts.push_back(details);
-  if (m_useCounts.size() >= count_before_update)
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (m_useCounts.size() >= count_before_update || now - m_useCountFlushed >= USE_COUNT_FLUSH_INTERVAL)
   {
     AddJob(new CTextureUseCountJob(m_useCounts));
     m_useCounts.clear();
+    m_useCountFlushed = now;
   }
 }
 
 bool CTextureCache::SetCachedTextureValid(const std::string &url, bool updateable)
 {
+  m_index.SetHashCheck(url, updateable ? CDateTime::GetCurrentDateTime() : CDateTime());
   CSingleLock lock(m_databaseSection);
   return m_database.SetCachedTextureValid(url, updateable);
 }
 
 bool CTextureCache::ClearCachedTexture(const std::string &url, std::string &cachedURL)
 {
+  m_index.Remove(url);
   CSingleLock lock(m_databaseSection);
   return m_database.ClearCachedTexture(url, cachedURL);
 }
 
 bool CTextureCache::ClearCachedTexture(int id, std::string &cachedURL)
 {
+  m_index.Remove(id);
   CSingleLock lock(m_databaseSection);
   return m_database.ClearCachedTexture(id, cachedURL);
 }
@@ -290,6 +345,8 @@ void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   if (strcmp(job->GetType(), kJobTypeCacheImage) == 0)
     OnCachingComplete(success, (CTextureCacheJob *)job);
+  else if (success && strcmp(job->GetType(), "textureindex") == 0)
+    m_index.Load(((CTextureIndexJob *)job)->m_textures);
   return CJobQueue::OnJobComplete(jobID, success, job);
 }
 
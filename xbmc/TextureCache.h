@@ -25,6 +25,7 @@
 #include <vector>
 #include "utils/JobManager.h"
 #include "TextureDatabase.h"
+#include "TextureIndex.h"
 #include "threads/Event.h"
 
 class CURL;
@@ -149,6 +150,14 @@ public:
    */
   bool AddCachedTexture(const std::string &image, const CTextureDetails &details);
 
+  /*! \brief Invalidate a previously cached image so that it is checked for updates on next load
+   Wrapper of CTextureDatabase::InvalidateCachedTexture that keeps the texture index in sync.
+   \param image url of the original image
+   \param database an open texture database to use, e.g. one in the middle of a batch of updates (defaults to NULL)
+   \return true if successful, false otherwise.
+   */
+  bool InvalidateCachedTexture(const std::string &image, CTextureDatabase *database = NULL);
+
   /*! \brief Export a (possibly) cached image to a file
    \param image url of the original image
    \param destination url of the destination image, excluding extension.
@@ -197,7 +206,8 @@ private:
   bool ClearCachedTexture(int textureID, std::string &cacheFile);
 
   /*! \brief Increment the use count of a texture
-   Stores locally before calling CTextureDatabase::IncrementUseCount via a CUseCountJob
+   Stores locally before calling CTextureDatabase::IncrementUseCount via a CUseCountJob,
+   either once enough have been stored or periodically.
    \sa CUseCountJob, CTextureDatabase::IncrementUseCount
    */
   void IncrementUseCount(const CTextureDetails &details);
@@ -223,10 +233,12 @@ private:
 
   CCriticalSection m_databaseSection;
   CTextureDatabase m_database;
+  CTextureIndex    m_index;     ///< in memory copy of the database, for lookups without a query
   std::set<std::string> m_processinglist; ///< currently processing list to avoid 2 jobs being processed at once
   CCriticalSection     m_processingSection;
   CEvent               m_completeEvent; ///< Set whenever a job has finished
   std::vector<CTextureDetails> m_useCounts; ///< Use count tracking
+  unsigned int                 m_useCountFlushed; ///< time the use counts were last written
   CCriticalSection             m_useCountSection;
 };
 
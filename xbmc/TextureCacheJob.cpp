@@ -25,6 +25,7 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
+#include "threads/SystemClock.h"
 #include "filesystem/File.h"
 #include "pictures/Picture.h"
 #include "utils/URIUtils.h"
@@ -102,7 +103,13 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     return true;
   }
 #endif
-  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true);
+  // no need to decode larger than the cached version, which lets jpegs be scaled while decoding
+  unsigned int decodeWidth = width, decodeHeight = height;
+  if (!decodeWidth && !decodeHeight)
+    CPicture::GetMaxCacheSize(decodeWidth, decodeHeight);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  CBaseTexture *texture = LoadImage(image, decodeWidth, decodeHeight, additional_info, true);
   if (texture)
   {
     if (texture->HasAlpha())
@@ -112,8 +119,12 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
 
     CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", image.c_str(), m_details.file.c_str());
 
+    unsigned int decoded = XbmcThreads::SystemClockMillis();
     if (CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(m_details.file)))
     {
+      CLog::Log(LOGDEBUG, "%s: decoded %ux%u (of %ux%u) in %u ms, scaled to %ux%u and saved in %u ms", __FUNCTION__,
+                texture->GetWidth(), texture->GetHeight(), texture->GetOriginalWidth(), texture->GetOriginalHeight(),
+                decoded - start, width, height, XbmcThreads::SystemClockMillis() - decoded);
       m_details.width = width;
       m_details.height = height;
       if (out_texture) // caller wants the texture
@@ -302,3 +313,16 @@ bool CTextureUseCountJob::DoWork()
   }
   return true;
 }
+
+bool CTextureIndexJob::DoWork()
+{
+  CTextureDatabase db;
+  if (!db.Open())
+    return false;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  if (!db.GetCachedTextures(m_textures))
+    return false;
+  CLog::Log(LOGDEBUG, "%s loaded %u textures in %u ms", __FUNCTION__, (unsigned int)m_textures.size(), XbmcThreads::SystemClockMillis() - start);
+  return true;
+}
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
+#include "TextureIndex.h"
 #include "utils/Job.h"
 
 class CBaseTexture;
@@ -152,3 +153,14 @@ public:
 private:
   std::vector<CTextureDetails> m_textures;
 };
+
+/* \brief Job class for loading the texture index from the database
+ */
+class CTextureIndexJob : public CJob
+{
+public:
+  virtual const char* GetType() const { return "textureindex"; };
+  virtual bool DoWork();
+
+  CTextureIndex::Entries m_textures;
+};
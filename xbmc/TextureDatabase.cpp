@@ -282,6 +282,38 @@ bool CTextureDatabase::GetCachedTexture(const std::string &url, CTextureDetails
   return false;
 }
 
+bool CTextureDatabase::GetCachedTextures(CTextureIndex::Entries &textures)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    std::string sql = "SELECT url, id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1)";
+    if (!m_pDS->query(sql.c_str()))
+      return false;
+
+    while (!m_pDS->eof())
+    {
+      CTextureIndex::Entry &texture = textures[m_pDS->fv(0).get_asString()];
+      texture.id = m_pDS->fv(1).get_asInt();
+      texture.file = m_pDS->fv(2).get_asString();
+      texture.lastHashCheck.SetFromDBDateTime(m_pDS->fv(3).get_asString());
+      texture.imageHash = m_pDS->fv(4).get_asString();
+      texture.width = m_pDS->fv(5).get_asInt();
+      texture.height = m_pDS->fv(6).get_asInt();
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s, failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CTextureDatabase::GetTextures(CVariant &items, const Filter &filter)
 {
   try
@@ -335,7 +367,7 @@ bool CTextureDatabase::SetCachedTextureValid(const std::string &url, bool update
   return ExecuteQuery(sql);
 }
 
-bool CTextureDatabase::AddCachedTexture(const std::string &url, const CTextureDetails &details)
+bool CTextureDatabase::AddCachedTexture(const std::string &url, CTextureDetails &details)
 {
   try
   {
@@ -353,12 +385,14 @@ bool CTextureDatabase::AddCachedTexture(const std::string &url, const CTextureDe
     // set the size information
     sql = PrepareSQL("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(%u, 1, 1, CURRENT_TIMESTAMP, %u, %u)", textureID, details.width, details.height);
     m_pDS->exec(sql.c_str());
+    details.id = textureID;
+    return true;
   }
   catch (...)
   {
     CLog::Log(LOGERROR, "%s failed on url '%s'", __FUNCTION__, url.c_str());
   }
-  return true;
+  return false;
 }
 
 bool CTextureDatabase::ClearCachedTexture(const std::string &url, std::string &cacheFile)
@@ -22,6 +22,7 @@
 
 #include "dbwrappers/Database.h"
 #include "TextureCacheJob.h"
+#include "TextureIndex.h"
 #include "dbwrappers/DatabaseQuery.h"
 
 class CVariant;
@@ -72,7 +73,20 @@ public:
   virtual bool Open();
 
   bool GetCachedTexture(const std::string &originalURL, CTextureDetails &details);
-  bool AddCachedTexture(const std::string &originalURL, const CTextureDetails &details);
+
+  /*! \brief Retrieve all cached textures, keyed on the original url
+   \param textures [out] the cached textures
+   \return true if the textures were retrieved, false otherwise.
+   \sa CTextureIndex
+   */
+  bool GetCachedTextures(CTextureIndex::Entries &textures);
+
+  /*! \brief Add a cached texture, replacing any previous one for the url
+   \param originalURL url of the original image
+   \param details [in/out] details of the cached texture, the id is set to the id of the new texture
+   \return true if the texture was added, false otherwise.
+   */
+  bool AddCachedTexture(const std::string &originalURL, CTextureDetails &details);
   bool SetCachedTextureValid(const std::string &originalURL, bool updateable);
   bool ClearCachedTexture(const std::string &originalURL, std::string &cacheFile);
   bool ClearCachedTexture(int textureID, std::string &cacheFile);
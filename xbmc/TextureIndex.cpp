@@ -0,0 +1,161 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextureIndex.h"
+#include "TextureCacheJob.h"
+
+CTextureIndex::CTextureIndex() : m_loaded(false)
+{
+}
+
+bool CTextureIndex::Get(const std::string &url, CTextureDetails &details) const
+{
+  CSharedLock lock(m_section);
+  Entries::const_iterator it = m_entries.find(url);
+  if (it == m_entries.end())
+    return false;
+
+  const Entry &entry = it->second;
+  details.id = entry.id;
+  details.file = entry.file;
+  // same rule as CTextureDatabase::GetCachedTexture, updateable images are checked daily
+  if (entry.lastHashCheck.IsValid() && entry.lastHashCheck + CDateTimeSpan(1,0,0,0) < CDateTime::GetCurrentDateTime())
+    details.hash = entry.imageHash;
+  details.width = entry.width;
+  details.height = entry.height;
+  return true;
+}
+
+void CTextureIndex::Add(const std::string &url, const CTextureDetails &details)
+{
+  Entry entry;
+  entry.id = details.id;
+  entry.file = details.file;
+  entry.imageHash = details.hash;
+  if (details.updateable)
+    entry.lastHashCheck = CDateTime::GetCurrentDateTime();
+  entry.width = details.width;
+  entry.height = details.height;
+
+  CExclusiveLock lock(m_section);
+  m_entries[url] = entry;
+  Touch(url);
+}
+
+void CTextureIndex::SetHashCheck(const std::string &url, const CDateTime &lastHashCheck)
+{
+  CExclusiveLock lock(m_section);
+  Entries::iterator it = m_entries.find(url);
+  if (it != m_entries.end())
+  {
+    it->second.lastHashCheck = lastHashCheck;
+    Touch(url);
+  }
+  else if (!m_loaded)
+    m_hashChecks[url] = lastHashCheck; // applied to the row once loaded
+}
+
+void CTextureIndex::Remove(const std::string &url)
+{
+  CExclusiveLock lock(m_section);
+  m_entries.erase(url);
+  Touch(url);
+}
+
+void CTextureIndex::Remove(int textureID)
+{
+  CExclusiveLock lock(m_section);
+  for (Entries::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->second.id == textureID)
+    {
+      m_entries.erase(it);
+      break;
+    }
+  }
+  if (!m_loaded)
+    m_removedIDs.insert(textureID);
+}
+
+void CTextureIndex::Load(Entries &entries)
+{
+  CExclusiveLock lock(m_section);
+
+  if (!m_removedIDs.empty())
+  {
+    for (Entries::iterator it = entries.begin(); it != entries.end();)
+    {
+      if (m_removedIDs.find(it->second.id) != m_removedIDs.end())
+        it = entries.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  for (std::map<std::string, CDateTime>::const_iterator check = m_hashChecks.begin(); check != m_hashChecks.end(); ++check)
+  {
+    Entries::iterator it = entries.find(check->first);
+    if (it != entries.end())
+      it->second.lastHashCheck = check->second;
+  }
+
+  for (std::set<std::string>::const_iterator url = m_touched.begin(); url != m_touched.end(); ++url)
+  {
+    Entries::iterator it = m_entries.find(*url);
+    if (it != m_entries.end())
+      entries[*url] = it->second;
+    else
+      entries.erase(*url);
+  }
+
+  m_entries.swap(entries);
+  m_touched.clear();
+  m_removedIDs.clear();
+  m_hashChecks.clear();
+  m_loaded = true;
+}
+
+void CTextureIndex::Clear()
+{
+  CExclusiveLock lock(m_section);
+  m_entries.clear();
+  m_touched.clear();
+  m_removedIDs.clear();
+  m_hashChecks.clear();
+  m_loaded = false;
+}
+
+bool CTextureIndex::IsLoaded() const
+{
+  CSharedLock lock(m_section);
+  return m_loaded;
+}
+
+size_t CTextureIndex::Size() const
+{
+  CSharedLock lock(m_section);
+  return m_entries.size();
+}
+
+void CTextureIndex::Touch(const std::string &url)
+{
+  if (!m_loaded)
+    m_touched.insert(url);
+}
@@ -0,0 +1,108 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "XBDateTime.h"
+#include "threads/SharedSection.h"
+
+class CTextureDetails;
+
+/*!
+ \ingroup textures
+ \brief In memory copy of the cached textures in the texture database.
+
+ Looking up the cached version of an image is done for every image shown, so
+ the texture cache answers it from here rather than querying the database.
+ The index is filled from the database in the background, changes made while
+ it is loading take precedence over the loaded rows.
+ */
+class CTextureIndex
+{
+public:
+  struct Entry
+  {
+    Entry() : id(-1), width(0), height(0) {}
+
+    int          id;
+    std::string  file;
+    std::string  imageHash;
+    CDateTime    lastHashCheck;
+    unsigned int width;
+    unsigned int height;
+  };
+  typedef std::unordered_map<std::string, Entry> Entries;
+
+  CTextureIndex();
+
+  /*! \brief Look up the cached version of an image
+   Fills in the details as CTextureDatabase::GetCachedTexture does, including
+   the image hash if the image is due for a check for updates.
+   \param url url of the original image
+   \param details [out] details of the cached texture
+   \return true if the image is in the index
+   */
+  bool Get(const std::string &url, CTextureDetails &details) const;
+
+  /*! \brief Add or replace a cached texture
+   \param url url of the original image
+   \param details details of the cached texture, as added to the database
+   */
+  void Add(const std::string &url, const CTextureDetails &details);
+
+  /*! \brief Set when a cached texture was last checked for updates
+   \param url url of the original image
+   \param lastHashCheck time of the check, invalid if the image is never checked
+   */
+  void SetHashCheck(const std::string &url, const CDateTime &lastHashCheck);
+
+  void Remove(const std::string &url);
+  void Remove(int textureID);
+
+  /*! \brief Take over the rows loaded from the database
+   \param entries [in/out] the cached textures in the database, swapped with the index
+   */
+  void Load(Entries &entries);
+
+  /*! \brief Empty the index, e.g. when the database is closed */
+  void Clear();
+
+  bool IsLoaded() const;
+  size_t Size() const;
+
+private:
+  CTextureIndex(const CTextureIndex&);
+  CTextureIndex &operator=(const CTextureIndex&);
+
+  void Touch(const std::string &url);
+
+  mutable CSharedSection m_section;
+  Entries m_entries;
+  bool m_loaded;
+
+  // changed while loading, these override the loaded rows
+  std::set<std::string> m_touched;
+  std::set<int> m_removedIDs;
+  std::map<std::string, CDateTime> m_hashChecks;
+};
@@ -22,11 +22,8 @@
 #include "XBApplicationEx.h"
 #include "utils/log.h"
 #include "threads/SystemClock.h"
-#ifdef HAS_PERFORMANCE_SAMPLE
-#include "utils/PerformanceSample.h"
-#else
-#define MEASURE_FUNCTION
-#endif
+#include "utils/Trace.h"
+#include "utils/LatencyHistogram.h"
 #include "commons/Exception.h"
 
 // Put this here for easy enable and disable
@@ -34,6 +31,9 @@
 #define XBMC_TRACK_EXCEPTIONS
 #endif
 
+// time of a pass of the main loop, a stall is a visible hitch
+static CLatencyHistogram &s_frameLatency = CLatencyHistograms::Get().GetHistogram("gui.frame", 50000);
+
 CXBApplicationEx::CXBApplicationEx()
 {
   // Variables to perform app timing
@@ -92,9 +92,8 @@ INT CXBApplicationEx::Run()
   // Run xbmc
   while (!m_bStop)
   {
-#ifdef HAS_PERFORMANCE_SAMPLE
-    CPerformanceSample sampleLoop("XBApplicationEx-loop");
-#endif
+    TRACE_SCOPE("app", "Frame");
+    CLatencyTimer frameTimer(s_frameLatency);
     //-----------------------------------------
     // Animate and render a frame
     //-----------------------------------------
@@ -34,10 +34,14 @@ CPluginSource::CPluginSource(const AddonProps &props)
   if (i != Props().extrainfo.end())
     provides = i->second;
   SetProvides(provides);
+
+  i = Props().extrainfo.find("reuselanguageinvoker");
+  m_reuseLanguageInvoker = i != Props().extrainfo.end() && StringUtils::EqualsNoCase(i->second, "true");
 }
 
 CPluginSource::CPluginSource(const cp_extension_t *ext)
-  : CAddon(ext)
+  : CAddon(ext),
+    m_reuseLanguageInvoker(false)
 {
   std::string provides;
   if (ext)
@@ -45,6 +49,11 @@ CPluginSource::CPluginSource(const cp_extension_t *ext)
     provides = CAddonMgr::Get().GetExtValue(ext->configuration, "provides");
     if (!provides.empty())
       Props().extrainfo.insert(make_pair("provides", provides));
+
+    std::string reuse = CAddonMgr::Get().GetExtValue(ext->configuration, "reuselanguageinvoker");
+    if (!reuse.empty())
+      Props().extrainfo.insert(make_pair("reuselanguageinvoker", reuse));
+    m_reuseLanguageInvoker = StringUtils::EqualsNoCase(reuse, "true");
   }
   SetProvides(provides);
 }
@@ -46,6 +46,12 @@ public:
     return m_providedContent.size() > 1;
   }
 
+  /*! \brief Whether the plugin can be executed by an interpreter kept from its previous invocation
+   Set with <reuselanguageinvoker>true</reuselanguageinvoker> in the extension of the plugin. Modules
+   stay imported between invocations, so the plugin must not rely on module level state being fresh.
+   */
+  bool ReuseLanguageInvoker() const { return m_reuseLanguageInvoker; }
+
   static Content Translate(const std::string &content);
 private:
   /*! \brief Set the provided content for this plugin
@@ -54,6 +60,7 @@ private:
    */
   void SetProvides(const std::string &content);
   std::set<Content> m_providedContent;
+  bool m_reuseLanguageInvoker;
 };
 
 } /*namespace ADDON*/
@@ -34,6 +34,7 @@
 #include "utils/URIUtils.h"
 #include "utils/XBMCTinyXML.h"
 #include "FileItem.h"
+#include "TextureCache.h"
 #include "TextureDatabase.h"
 #include "URL.h"
 
@@ -265,9 +266,9 @@ bool CRepositoryUpdateJob::DoWork()
 
     // invalidate the art associated with this item
     if (!newAddon->Props().fanart.empty())
-      textureDB.InvalidateCachedTexture(newAddon->Props().fanart);
+      CTextureCache::Get().InvalidateCachedTexture(newAddon->Props().fanart, &textureDB);
     if (!newAddon->Props().icon.empty())
-      textureDB.InvalidateCachedTexture(newAddon->Props().icon);
+      CTextureCache::Get().InvalidateCachedTexture(newAddon->Props().icon, &textureDB);
 
     AddonPtr addon;
     CAddonMgr::Get().GetAddon(newAddon->ID(),addon);
@@ -28,6 +28,7 @@
 
 #include "settings/Settings.h"
 #include "utils/log.h"
+#include "utils/Trace.h"
 
 #include <new> // for std::bad_alloc
 #include <algorithm>
@@ -792,6 +793,7 @@ void CActiveAESink::ReturnBuffers()
 
 unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
 {
+  TRACE_FUNCTION("audio");
   uint8_t **buffer = samples->pkt->data;
   unsigned int frames = samples->pkt->nb_samples;
   unsigned int maxFrames;
@@ -0,0 +1,605 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEMixKernels.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+// the AVX2 kernels are compiled for their own target, the rest of the file
+// (and the engine) keeps working on CPUs without AVX2
+#if defined(__SSE2__) && defined(__GNUC__) && !defined(__clang__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define HAS_AE_AVX2
+#include <immintrin.h>
+#define AVX2_KERNEL __attribute__((target("avx2")))
+#endif
+
+// matrices with more inputs or outputs than this use the plain C kernel
+#define MATRIX_MAX_IN  16
+#define MATRIX_MAX_OUT 8
+
+namespace
+{
+
+/*
+ Plain C
+ */
+
+inline float SoftClamp(float x)
+{
+  // see CAEUtil::SoftClamp
+  if (x < -3.0f)
+    return -1.0f;
+  else if (x > 3.0f)
+    return 1.0f;
+  float y = x * x;
+  return x * (27.0f + y) / (27.0f + 9.0f * y);
+}
+
+void MulArrayC(float *data, float mul, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    data[i] *= mul;
+}
+
+float MulAddArrayC(float *data, const float *add, float mul, uint32_t count)
+{
+  float peak = 0.0f;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    data[i] += add[i] * mul;
+    peak = std::max(peak, fabsf(data[i]));
+  }
+  return peak;
+}
+
+void ClampArrayC(float *data, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    data[i] = SoftClamp(data[i]);
+}
+
+void InterleaveC(float *dst, const float * const *src, unsigned int channels, uint32_t frames)
+{
+  for (unsigned int ch = 0; ch < channels; ++ch)
+  {
+    const float *in = src[ch];
+    float *out = dst + ch;
+    for (uint32_t i = 0; i < frames; ++i, out += channels)
+      *out = in[i];
+  }
+}
+
+void DeinterleaveC(float * const *dst, const float *src, unsigned int channels, uint32_t frames)
+{
+  for (unsigned int ch = 0; ch < channels; ++ch)
+  {
+    const float *in = src + ch;
+    float *out = dst[ch];
+    for (uint32_t i = 0; i < frames; ++i, in += channels)
+      out[i] = *in;
+  }
+}
+
+void MatrixMixC(float *dst, unsigned int outChannels, const float *src, unsigned int inChannels,
+                const float *matrix, uint32_t frames)
+{
+  for (uint32_t f = 0; f < frames; ++f, src += inChannels, dst += outChannels)
+  {
+    for (unsigned int o = 0; o < outChannels; ++o)
+    {
+      const float *coeffs = matrix + o * inChannels;
+      float sum = 0.0f;
+      for (unsigned int i = 0; i < inChannels; ++i)
+        sum += coeffs[i] * src[i];
+      dst[o] = sum;
+    }
+  }
+}
+
+const CAEMixKernels kernelsC =
+{
+  "C", MulArrayC, MulAddArrayC, ClampArrayC, InterleaveC, DeinterleaveC, MatrixMixC
+};
+
+/*
+ SSE2
+ */
+
+#if defined(__SSE2__)
+inline float HorizontalMax(__m128 v)
+{
+  v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_max_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(v);
+}
+
+inline __m128 Abs(__m128 v)
+{
+  return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+
+void MulArraySSE2(float *data, float mul, uint32_t count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    _mm_storeu_ps(data + i,     _mm_mul_ps(_mm_loadu_ps(data + i),     m));
+    _mm_storeu_ps(data + i + 4, _mm_mul_ps(_mm_loadu_ps(data + i + 4), m));
+  }
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), m));
+  MulArrayC(data + i, mul, count - i);
+}
+
+float MulAddArraySSE2(float *data, const float *add, float mul, uint32_t count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  __m128 peak = _mm_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 out = _mm_add_ps(_mm_loadu_ps(data + i), _mm_mul_ps(_mm_loadu_ps(add + i), m));
+    _mm_storeu_ps(data + i, out);
+    peak = _mm_max_ps(peak, Abs(out));
+  }
+  return std::max(HorizontalMax(peak), MulAddArrayC(data + i, add + i, mul, count - i));
+}
+
+void ClampArraySSE2(float *data, uint32_t count)
+{
+  const __m128 limit = _mm_set1_ps(3.0f);
+  const __m128 nlimit = _mm_set1_ps(-3.0f);
+  const __m128 c1 = _mm_set1_ps(27.0f);
+  const __m128 c2 = _mm_set1_ps(9.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), nlimit), limit);
+    __m128 y = _mm_mul_ps(x, x);
+    __m128 out = _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(c1, y)), _mm_add_ps(c1, _mm_mul_ps(c2, y)));
+    _mm_storeu_ps(data + i, out);
+  }
+  ClampArrayC(data + i, count - i);
+}
+
+void InterleaveSSE2(float *dst, const float * const *src, unsigned int channels, uint32_t frames)
+{
+  if (channels != 2)
+  {
+    InterleaveC(dst, src, channels, frames);
+    return;
+  }
+
+  const float *l = src[0];
+  const float *r = src[1];
+  uint32_t i = 0;
+  for (; i + 4 <= frames; i += 4)
+  {
+    __m128 a = _mm_loadu_ps(l + i);
+    __m128 b = _mm_loadu_ps(r + i);
+    _mm_storeu_ps(dst + 2 * i,     _mm_unpacklo_ps(a, b));
+    _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(a, b));
+  }
+  for (; i < frames; ++i)
+  {
+    dst[2 * i]     = l[i];
+    dst[2 * i + 1] = r[i];
+  }
+}
+
+void DeinterleaveSSE2(float * const *dst, const float *src, unsigned int channels, uint32_t frames)
+{
+  if (channels != 2)
+  {
+    DeinterleaveC(dst, src, channels, frames);
+    return;
+  }
+
+  float *l = dst[0];
+  float *r = dst[1];
+  uint32_t i = 0;
+  for (; i + 4 <= frames; i += 4)
+  {
+    __m128 a = _mm_loadu_ps(src + 2 * i);
+    __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+    _mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  for (; i < frames; ++i)
+  {
+    l[i] = src[2 * i];
+    r[i] = src[2 * i + 1];
+  }
+}
+
+void MatrixMixSSE2(float *dst, unsigned int outChannels, const float *src, unsigned int inChannels,
+                   const float *matrix, uint32_t frames)
+{
+  if (inChannels > MATRIX_MAX_IN || outChannels > MATRIX_MAX_OUT)
+  {
+    MatrixMixC(dst, outChannels, src, inChannels, matrix, frames);
+    return;
+  }
+
+  // one column of the matrix per input channel, outputs 0-3 and 4-7
+  __m128 cols[MATRIX_MAX_IN][2];
+  for (unsigned int i = 0; i < inChannels; ++i)
+  {
+    float col[MATRIX_MAX_OUT] = {0};
+    for (unsigned int o = 0; o < outChannels; ++o)
+      col[o] = matrix[o * inChannels + i];
+    cols[i][0] = _mm_loadu_ps(col);
+    cols[i][1] = _mm_loadu_ps(col + 4);
+  }
+
+  for (uint32_t f = 0; f < frames; ++f, src += inChannels, dst += outChannels)
+  {
+    __m128 lo = _mm_setzero_ps();
+    __m128 hi = _mm_setzero_ps();
+    for (unsigned int i = 0; i < inChannels; ++i)
+    {
+      __m128 s = _mm_set1_ps(src[i]);
+      lo = _mm_add_ps(lo, _mm_mul_ps(s, cols[i][0]));
+      hi = _mm_add_ps(hi, _mm_mul_ps(s, cols[i][1]));
+    }
+
+    if (outChannels == 2)
+      _mm_storel_pi((__m64*)dst, lo);
+    else if (outChannels == 4)
+      _mm_storeu_ps(dst, lo);
+    else if (outChannels == 8)
+    {
+      _mm_storeu_ps(dst,     lo);
+      _mm_storeu_ps(dst + 4, hi);
+    }
+    else
+    {
+      float out[MATRIX_MAX_OUT];
+      _mm_storeu_ps(out,     lo);
+      _mm_storeu_ps(out + 4, hi);
+      memcpy(dst, out, outChannels * sizeof(float));
+    }
+  }
+}
+
+const CAEMixKernels kernelsSSE2 =
+{
+  "SSE2", MulArraySSE2, MulAddArraySSE2, ClampArraySSE2, InterleaveSSE2, DeinterleaveSSE2, MatrixMixSSE2
+};
+#endif
+
+/*
+ AVX2
+ */
+
+#if defined(HAS_AE_AVX2)
+AVX2_KERNEL void MulArrayAVX2(float *data, float mul, uint32_t count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  uint32_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    _mm256_storeu_ps(data + i,     _mm256_mul_ps(_mm256_loadu_ps(data + i),     m));
+    _mm256_storeu_ps(data + i + 8, _mm256_mul_ps(_mm256_loadu_ps(data + i + 8), m));
+  }
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), m));
+  MulArrayC(data + i, mul, count - i);
+}
+
+AVX2_KERNEL float MulAddArrayAVX2(float *data, const float *add, float mul, uint32_t count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 peak = _mm256_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 out = _mm256_add_ps(_mm256_loadu_ps(data + i), _mm256_mul_ps(_mm256_loadu_ps(add + i), m));
+    _mm256_storeu_ps(data + i, out);
+    peak = _mm256_max_ps(peak, _mm256_and_ps(out, absMask));
+  }
+
+  __m128 peak4 = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+  peak4 = _mm_max_ps(peak4, _mm_movehl_ps(peak4, peak4));
+  peak4 = _mm_max_ss(peak4, _mm_shuffle_ps(peak4, peak4, _MM_SHUFFLE(1, 1, 1, 1)));
+  return std::max(_mm_cvtss_f32(peak4), MulAddArrayC(data + i, add + i, mul, count - i));
+}
+
+AVX2_KERNEL void ClampArrayAVX2(float *data, uint32_t count)
+{
+  const __m256 limit = _mm256_set1_ps(3.0f);
+  const __m256 nlimit = _mm256_set1_ps(-3.0f);
+  const __m256 c1 = _mm256_set1_ps(27.0f);
+  const __m256 c2 = _mm256_set1_ps(9.0f);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(data + i), nlimit), limit);
+    __m256 y = _mm256_mul_ps(x, x);
+    __m256 out = _mm256_div_ps(_mm256_mul_ps(x, _mm256_add_ps(c1, y)), _mm256_add_ps(c1, _mm256_mul_ps(c2, y)));
+    _mm256_storeu_ps(data + i, out);
+  }
+  ClampArrayC(data + i, count - i);
+}
+
+AVX2_KERNEL void MatrixMixAVX2(float *dst, unsigned int outChannels, const float *src, unsigned int inChannels,
+                               const float *matrix, uint32_t frames)
+{
+  if (inChannels > MATRIX_MAX_IN || outChannels > MATRIX_MAX_OUT)
+  {
+    MatrixMixC(dst, outChannels, src, inChannels, matrix, frames);
+    return;
+  }
+
+  // one column of the matrix per input channel
+  __m256 cols[MATRIX_MAX_IN];
+  for (unsigned int i = 0; i < inChannels; ++i)
+  {
+    float col[MATRIX_MAX_OUT] = {0};
+    for (unsigned int o = 0; o < outChannels; ++o)
+      col[o] = matrix[o * inChannels + i];
+    cols[i] = _mm256_loadu_ps(col);
+  }
+
+  for (uint32_t f = 0; f < frames; ++f, src += inChannels, dst += outChannels)
+  {
+    __m256 acc = _mm256_setzero_ps();
+    for (unsigned int i = 0; i < inChannels; ++i)
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_broadcast_ss(src + i), cols[i]));
+
+    if (outChannels == 2)
+      _mm_storel_pi((__m64*)dst, _mm256_castps256_ps128(acc));
+    else if (outChannels == 8)
+      _mm256_storeu_ps(dst, acc);
+    else
+    {
+      float out[MATRIX_MAX_OUT];
+      _mm256_storeu_ps(out, acc);
+      memcpy(dst, out, outChannels * sizeof(float));
+    }
+  }
+}
+
+// interleaving is bound by memory, the SSE2 versions do as well
+const CAEMixKernels kernelsAVX2 =
+{
+  "AVX2", MulArrayAVX2, MulAddArrayAVX2, ClampArrayAVX2, InterleaveSSE2, DeinterleaveSSE2, MatrixMixAVX2
+};
+#endif
+
+/*
+ NEON
+ */
+
+#if defined(__ARM_NEON__)
+void MulArrayNEON(float *data, float mul, uint32_t count)
+{
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), mul));
+  MulArrayC(data + i, mul, count - i);
+}
+
+float MulAddArrayNEON(float *data, const float *add, float mul, uint32_t count)
+{
+  float32x4_t peak = vdupq_n_f32(0.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t out = vmlaq_n_f32(vld1q_f32(data + i), vld1q_f32(add + i), mul);
+    vst1q_f32(data + i, out);
+    peak = vmaxq_f32(peak, vabsq_f32(out));
+  }
+
+  float32x2_t peak2 = vpmax_f32(vget_low_f32(peak), vget_high_f32(peak));
+  peak2 = vpmax_f32(peak2, peak2);
+  return std::max(vget_lane_f32(peak2, 0), MulAddArrayC(data + i, add + i, mul, count - i));
+}
+
+void ClampArrayNEON(float *data, uint32_t count)
+{
+  const float32x4_t limit = vdupq_n_f32(3.0f);
+  const float32x4_t nlimit = vdupq_n_f32(-3.0f);
+  const float32x4_t c1 = vdupq_n_f32(27.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(data + i), nlimit), limit);
+    float32x4_t y = vmulq_f32(x, x);
+    float32x4_t num = vmulq_f32(x, vaddq_f32(c1, y));
+    float32x4_t den = vmlaq_n_f32(c1, y, 9.0f);
+
+    // no vector divide, refine the reciprocal estimate twice
+    float32x4_t rcp = vrecpeq_f32(den);
+    rcp = vmulq_f32(rcp, vrecpsq_f32(den, rcp));
+    rcp = vmulq_f32(rcp, vrecpsq_f32(den, rcp));
+    vst1q_f32(data + i, vmulq_f32(num, rcp));
+  }
+  ClampArrayC(data + i, count - i);
+}
+
+void InterleaveNEON(float *dst, const float * const *src, unsigned int channels, uint32_t frames)
+{
+  if (channels != 2)
+  {
+    InterleaveC(dst, src, channels, frames);
+    return;
+  }
+
+  const float *l = src[0];
+  const float *r = src[1];
+  uint32_t i = 0;
+  for (; i + 4 <= frames; i += 4)
+  {
+    float32x4x2_t v;
+    v.val[0] = vld1q_f32(l + i);
+    v.val[1] = vld1q_f32(r + i);
+    vst2q_f32(dst + 2 * i, v);
+  }
+  for (; i < frames; ++i)
+  {
+    dst[2 * i]     = l[i];
+    dst[2 * i + 1] = r[i];
+  }
+}
+
+void DeinterleaveNEON(float * const *dst, const float *src, unsigned int channels, uint32_t frames)
+{
+  if (channels != 2)
+  {
+    DeinterleaveC(dst, src, channels, frames);
+    return;
+  }
+
+  float *l = dst[0];
+  float *r = dst[1];
+  uint32_t i = 0;
+  for (; i + 4 <= frames; i += 4)
+  {
+    float32x4x2_t v = vld2q_f32(src + 2 * i);
+    vst1q_f32(l + i, v.val[0]);
+    vst1q_f32(r + i, v.val[1]);
+  }
+  for (; i < frames; ++i)
+  {
+    l[i] = src[2 * i];
+    r[i] = src[2 * i + 1];
+  }
+}
+
+void MatrixMixNEON(float *dst, unsigned int outChannels, const float *src, unsigned int inChannels,
+                   const float *matrix, uint32_t frames)
+{
+  if (inChannels > MATRIX_MAX_IN || outChannels > MATRIX_MAX_OUT)
+  {
+    MatrixMixC(dst, outChannels, src, inChannels, matrix, frames);
+    return;
+  }
+
+  // one column of the matrix per input channel, outputs 0-3 and 4-7
+  float32x4_t cols[MATRIX_MAX_IN][2];
+  for (unsigned int i = 0; i < inChannels; ++i)
+  {
+    float col[MATRIX_MAX_OUT] = {0};
+    for (unsigned int o = 0; o < outChannels; ++o)
+      col[o] = matrix[o * inChannels + i];
+    cols[i][0] = vld1q_f32(col);
+    cols[i][1] = vld1q_f32(col + 4);
+  }
+
+  for (uint32_t f = 0; f < frames; ++f, src += inChannels, dst += outChannels)
+  {
+    float32x4_t lo = vdupq_n_f32(0.0f);
+    float32x4_t hi = vdupq_n_f32(0.0f);
+    for (unsigned int i = 0; i < inChannels; ++i)
+    {
+      lo = vmlaq_n_f32(lo, cols[i][0], src[i]);
+      hi = vmlaq_n_f32(hi, cols[i][1], src[i]);
+    }
+
+    if (outChannels == 2)
+      vst1_f32(dst, vget_low_f32(lo));
+    else if (outChannels == 4)
+      vst1q_f32(dst, lo);
+    else if (outChannels == 8)
+    {
+      vst1q_f32(dst,     lo);
+      vst1q_f32(dst + 4, hi);
+    }
+    else
+    {
+      float out[MATRIX_MAX_OUT];
+      vst1q_f32(out,     lo);
+      vst1q_f32(out + 4, hi);
+      memcpy(dst, out, outChannels * sizeof(float));
+    }
+  }
+}
+
+const CAEMixKernels kernelsNEON =
+{
+  "NEON", MulArrayNEON, MulAddArrayNEON, ClampArrayNEON, InterleaveNEON, DeinterleaveNEON, MatrixMixNEON
+};
+#endif
+
+const CAEMixKernels* SelectKernels()
+{
+  const CAEMixKernels *kernels = &kernelsC;
+#if defined(__SSE2__)
+  kernels = &kernelsSSE2;
+#endif
+#if defined(HAS_AE_AVX2)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_AVX2)
+    kernels = &kernelsAVX2;
+#endif
+#if defined(__ARM_NEON__)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_NEON)
+    kernels = &kernelsNEON;
+#endif
+
+  CLog::Log(LOGDEBUG, "CAEMixKernels - using %s kernels", kernels->name);
+  return kernels;
+}
+
+} // anonymous namespace
+
+const CAEMixKernels& CAEMixKernels::Get()
+{
+  static const CAEMixKernels *kernels = SelectKernels();
+  return *kernels;
+}
+
+const CAEMixKernels& CAEMixKernels::GetScalar()
+{
+  return kernelsC;
+}
+
+std::vector<const CAEMixKernels*> CAEMixKernels::GetAvailable()
+{
+  std::vector<const CAEMixKernels*> available;
+  available.push_back(&kernelsC);
+#if defined(__SSE2__)
+  available.push_back(&kernelsSSE2);
+#endif
+#if defined(HAS_AE_AVX2)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_AVX2)
+    available.push_back(&kernelsAVX2);
+#endif
+#if defined(__ARM_NEON__)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_NEON)
+    available.push_back(&kernelsNEON);
+#endif
+  return available;
+}
@@ -0,0 +1,68 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <vector>
+
+/*!
+ \brief Float sample kernels used by the audio engine's mix path.
+
+ One set of kernels exists per instruction set (plain C, SSE2, AVX2, NEON).
+ Get() returns the fastest set the CPU supports, selected once at runtime, so
+ the engine doesn't need any instruction set specific code itself.
+
+ All kernels work on unaligned buffers.
+ */
+struct CAEMixKernels
+{
+  /*! \brief data[i] *= mul */
+  typedef void  (*MulArrayFunc)   (float *data, float mul, uint32_t count);
+  /*! \brief data[i] += add[i] * mul
+   \return the largest absolute value of the result, > 1.0 means it needs to be clamped
+   */
+  typedef float (*MulAddArrayFunc)(float *data, const float *add, float mul, uint32_t count);
+  /*! \brief Soft clamp samples to [-1.0, 1.0], the same curve as CAEUtil::ClampArray */
+  typedef void  (*ClampArrayFunc) (float *data, uint32_t count);
+  /*! \brief Interleave channels planes of frames samples each into dst */
+  typedef void  (*InterleaveFunc)  (float *dst, const float * const *src, unsigned int channels, uint32_t frames);
+  /*! \brief Split interleaved src into channels planes of frames samples each */
+  typedef void  (*DeinterleaveFunc)(float * const *dst, const float *src, unsigned int channels, uint32_t frames);
+  /*! \brief Remix interleaved frames, dst[o] = sum(matrix[o * inChannels + i] * src[i]) */
+  typedef void  (*MatrixMixFunc)   (float *dst, unsigned int outChannels, const float *src, unsigned int inChannels,
+                                    const float *matrix, uint32_t frames);
+
+  const char      *name;
+  MulArrayFunc     MulArray;
+  MulAddArrayFunc  MulAddArray;
+  ClampArrayFunc   ClampArray;
+  InterleaveFunc   Interleave;
+  DeinterleaveFunc Deinterleave;
+  MatrixMixFunc    MatrixMix;
+
+  /*! \brief The fastest kernels supported by this CPU */
+  static const CAEMixKernels& Get();
+
+  /*! \brief The plain C kernels, for reference */
+  static const CAEMixKernels& GetScalar();
+
+  /*! \brief All kernel sets supported by this CPU, plain C first */
+  static std::vector<const CAEMixKernels*> GetAvailable();
+};
@@ -0,0 +1,202 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEMixKernels.h"
+#include "utils/TimeUtils.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+// 7.1 float, one period of a typical sink buffer
+const unsigned int CHANNELS = 8;
+const uint32_t FRAMES = 1024;
+const int ITERATIONS = 2000;
+
+std::vector<float> RandomSamples(size_t count, float range = 1.0f)
+{
+  std::vector<float> samples(count);
+  for (size_t i = 0; i < count; ++i)
+    samples[i] = range * (2.0f * rand() / RAND_MAX - 1.0f);
+  return samples;
+}
+
+void ExpectNear(const std::vector<float> &expected, const std::vector<float> &actual, const char *kernel)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+    ASSERT_NEAR(expected[i], actual[i], 1e-5f) << kernel << " differs at sample " << i;
+}
+
+// ITU downmix of 7.1 to stereo, rows are outputs
+const float DOWNMIX_71[2 * CHANNELS] =
+{
+  1.0f, 0.0f, 0.707f, 0.0f, 0.707f, 0.0f, 0.707f, 0.0f,
+  0.0f, 1.0f, 0.707f, 0.0f, 0.0f, 0.707f, 0.0f, 0.707f
+};
+
+class Timer
+{
+public:
+  Timer() : m_start(CurrentHostCounter()) {}
+  double NsPerSample(uint64_t samples) const
+  {
+    double seconds = (double)(CurrentHostCounter() - m_start) / CurrentHostFrequency();
+    return seconds * 1e9 / samples;
+  }
+private:
+  int64_t m_start;
+};
+}
+
+TEST(TestAEMixKernels, MatchScalar)
+{
+  const CAEMixKernels &ref = CAEMixKernels::GetScalar();
+  std::vector<const CAEMixKernels*> available = CAEMixKernels::GetAvailable();
+
+  // odd sizes and offsets so the tails and unaligned loads are covered
+  const uint32_t count = CHANNELS * FRAMES + 3;
+  std::vector<float> input = RandomSamples(count + 1, 2.0f);
+  std::vector<float> add = RandomSamples(count + 1);
+
+  for (size_t k = 0; k < available.size(); ++k)
+  {
+    const CAEMixKernels &kernels = *available[k];
+
+    std::vector<float> expected(input.begin() + 1, input.end());
+    std::vector<float> actual(expected);
+    ref.MulArray(&expected[0], 0.5f, count);
+    kernels.MulArray(&actual[0], 0.5f, count);
+    ExpectNear(expected, actual, kernels.name);
+
+    expected.assign(input.begin() + 1, input.end());
+    actual = expected;
+    float expectedPeak = ref.MulAddArray(&expected[0], &add[1], 0.8f, count);
+    float actualPeak = kernels.MulAddArray(&actual[0], &add[1], 0.8f, count);
+    ExpectNear(expected, actual, kernels.name);
+    EXPECT_NEAR(expectedPeak, actualPeak, 1e-5f) << kernels.name;
+
+    expected.assign(input.begin() + 1, input.end());
+    actual = expected;
+    ref.ClampArray(&expected[0], count);
+    kernels.ClampArray(&actual[0], count);
+    ExpectNear(expected, actual, kernels.name);
+
+    for (unsigned int channels = 1; channels <= CHANNELS; ++channels)
+    {
+      const uint32_t frames = FRAMES + 3;
+      std::vector<float> planes = RandomSamples(channels * frames);
+      std::vector<const float*> src(channels);
+      for (unsigned int ch = 0; ch < channels; ++ch)
+        src[ch] = &planes[ch * frames];
+
+      std::vector<float> interleaved(channels * frames);
+      kernels.Interleave(&interleaved[0], &src[0], channels, frames);
+      for (uint32_t i = 0; i < frames; ++i)
+      {
+        for (unsigned int ch = 0; ch < channels; ++ch)
+          ASSERT_EQ(src[ch][i], interleaved[i * channels + ch]) << kernels.name;
+      }
+
+      std::vector<float> split(channels * frames);
+      std::vector<float*> dst(channels);
+      for (unsigned int ch = 0; ch < channels; ++ch)
+        dst[ch] = &split[ch * frames];
+      kernels.Deinterleave(&dst[0], &interleaved[0], channels, frames);
+      EXPECT_EQ(planes, split) << kernels.name;
+    }
+
+    for (unsigned int outChannels = 1; outChannels <= CHANNELS; ++outChannels)
+    {
+      std::vector<float> matrix = RandomSamples(outChannels * CHANNELS);
+      std::vector<float> mixInput = RandomSamples(CHANNELS * FRAMES);
+      expected.assign(outChannels * FRAMES, 0.0f);
+      actual = expected;
+      ref.MatrixMix(&expected[0], outChannels, &mixInput[0], CHANNELS, &matrix[0], FRAMES);
+      kernels.MatrixMix(&actual[0], outChannels, &mixInput[0], CHANNELS, &matrix[0], FRAMES);
+      ExpectNear(expected, actual, kernels.name);
+    }
+  }
+}
+
+// The throughput of each kernel, run it with --gtest_also_run_disabled_tests
+TEST(TestAEMixKernels, DISABLED_Benchmark)
+{
+  std::vector<const CAEMixKernels*> available = CAEMixKernels::GetAvailable();
+  const uint32_t count = CHANNELS * FRAMES;
+  const uint64_t samples = (uint64_t)count * ITERATIONS;
+
+  std::vector<float> data = RandomSamples(count);
+  std::vector<float> add = RandomSamples(count);
+  std::vector<float> stereo(2 * FRAMES);
+  std::vector<float> planes(count);
+  std::vector<float*> dst(CHANNELS);
+  std::vector<const float*> src(CHANNELS);
+  for (unsigned int ch = 0; ch < CHANNELS; ++ch)
+  {
+    dst[ch] = &planes[ch * FRAMES];
+    src[ch] = dst[ch];
+  }
+
+  std::cout << "7.1 float, " << FRAMES << " frames, ns per sample" << std::endl;
+  for (size_t k = 0; k < available.size(); ++k)
+  {
+    const CAEMixKernels &kernels = *available[k];
+    double mul, muladd, clamp, deinterleave, interleave, downmix;
+
+    Timer t1;
+    for (int i = 0; i < ITERATIONS; ++i)
+      kernels.MulArray(&data[0], (i & 1) ? 0.5f : 2.0f, count);
+    mul = t1.NsPerSample(samples);
+
+    Timer t2;
+    for (int i = 0; i < ITERATIONS; ++i)
+      kernels.MulAddArray(&data[0], &add[0], (i & 1) ? 0.5f : -0.5f, count);
+    muladd = t2.NsPerSample(samples);
+
+    Timer t3;
+    for (int i = 0; i < ITERATIONS; ++i)
+      kernels.ClampArray(&data[0], count);
+    clamp = t3.NsPerSample(samples);
+
+    Timer t4;
+    for (int i = 0; i < ITERATIONS; ++i)
+      kernels.Deinterleave(&dst[0], &data[0], CHANNELS, FRAMES);
+    deinterleave = t4.NsPerSample(samples);
+
+    Timer t5;
+    for (int i = 0; i < ITERATIONS; ++i)
+      kernels.Interleave(&data[0], &src[0], CHANNELS, FRAMES);
+    interleave = t5.NsPerSample(samples);
+
+    Timer t6;
+    for (int i = 0; i < ITERATIONS; ++i)
+      kernels.MatrixMix(&stereo[0], 2, &data[0], CHANNELS, DOWNMIX_71, FRAMES);
+    downmix = t6.NsPerSample(samples);
+
+    std::cout << kernels.name << ": mul " << mul << ", mul-add " << muladd << ", clamp " << clamp
+              << ", deinterleave " << deinterleave << ", interleave " << interleave
+              << ", downmix to stereo " << downmix << std::endl;
+  }
+}
@@ -0,0 +1,328 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if (defined HAVE_CONFIG_H) && (!defined TARGET_WINDOWS)
+  #include "config.h"
+#endif
+#include "system.h"
+#include "DVDDemuxPacketPool.h"
+#include "DVDClock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+// memory each size class may keep parked in its free list, and all of them together
+#define POOL_BYTES_PER_CLASS (16 * 1024 * 1024)
+#define POOL_MAX_BYTES       (32 * 1024 * 1024)
+#define POOL_MIN_SLOTS       4
+#define POOL_MAX_SLOTS       256
+#define POOL_HEADER_SLOTS    1024
+
+struct CDVDDemuxPacketPool::PooledPacket
+{
+  DemuxPacket  packet; // must stay the first member
+  int          sizeClass;
+  void*        block;
+  AVBufferRef* avBuffer;
+};
+
+CDVDDemuxPacketPool::CFreeList::CFreeList()
+  : m_slots(NULL)
+  , m_mask(0)
+  , m_head(0)
+  , m_tail(0)
+{
+}
+
+CDVDDemuxPacketPool::CFreeList::~CFreeList()
+{
+  delete[] m_slots;
+}
+
+void CDVDDemuxPacketPool::CFreeList::Init(size_t capacity)
+{
+  size_t size = 1;
+  while (size < capacity)
+    size <<= 1;
+
+  m_slots = new Slot[size];
+  for (size_t i = 0; i < size; i++)
+  {
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    m_slots[i].data = NULL;
+  }
+  m_mask = size - 1;
+}
+
+bool CDVDDemuxPacketPool::CFreeList::Push(void* p)
+{
+  size_t pos = m_tail.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    Slot& slot = m_slots[pos & m_mask];
+    size_t seq = slot.sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if (diff == 0)
+    {
+      if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        slot.data = p;
+        slot.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+      return false; // full
+    else
+      pos = m_tail.load(std::memory_order_relaxed);
+  }
+}
+
+void* CDVDDemuxPacketPool::CFreeList::Pop()
+{
+  size_t pos = m_head.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    Slot& slot = m_slots[pos & m_mask];
+    size_t seq = slot.sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+    if (diff == 0)
+    {
+      if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        void* p = slot.data;
+        slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return p;
+      }
+    }
+    else if (diff < 0)
+      return NULL; // empty
+    else
+      pos = m_head.load(std::memory_order_relaxed);
+  }
+}
+
+CDVDDemuxPacketPool& CDVDDemuxPacketPool::GetInstance()
+{
+  static CDVDDemuxPacketPool pool;
+  return pool;
+}
+
+CDVDDemuxPacketPool::CDVDDemuxPacketPool()
+  : m_allocations(0)
+  , m_poolHits(0)
+  , m_poolMisses(0)
+  , m_bytesCopied(0)
+  , m_bytesWrapped(0)
+  , m_pooledBytes(0)
+  , m_statsStart(XbmcThreads::SystemClockMillis())
+{
+  m_headers.Init(POOL_HEADER_SLOTS);
+  for (int i = 0; i < NUM_CLASSES; i++)
+  {
+    size_t slots = POOL_BYTES_PER_CLASS >> (MIN_CLASS_SHIFT + i);
+    if (slots < POOL_MIN_SLOTS)
+      slots = POOL_MIN_SLOTS;
+    if (slots > POOL_MAX_SLOTS)
+      slots = POOL_MAX_SLOTS;
+    m_payloads[i].Init(slots);
+  }
+}
+
+CDVDDemuxPacketPool::~CDVDDemuxPacketPool()
+{
+  Trim();
+}
+
+void CDVDDemuxPacketPool::Trim()
+{
+  void* p;
+  for (int i = 0; i < NUM_CLASSES; i++)
+  {
+    while ((p = m_payloads[i].Pop()) != NULL)
+    {
+      m_pooledBytes -= GetClassSize(i);
+      _aligned_free(p);
+    }
+  }
+  while ((p = m_headers.Pop()) != NULL)
+    delete (PooledPacket*)p;
+}
+
+int CDVDDemuxPacketPool::GetSizeClass(size_t size)
+{
+  int shift = MIN_CLASS_SHIFT;
+  while (shift <= MAX_CLASS_SHIFT && ((size_t)1 << shift) < size)
+    shift++;
+  return shift <= MAX_CLASS_SHIFT ? shift - MIN_CLASS_SHIFT : -1;
+}
+
+size_t CDVDDemuxPacketPool::GetClassSize(int sizeClass)
+{
+  return (size_t)1 << (sizeClass + MIN_CLASS_SHIFT);
+}
+
+bool CDVDDemuxPacketPool::PushPayload(int sizeClass, void* block)
+{
+  // a payload only goes back to its free list while all of them together stay within budget
+  size_t size = GetClassSize(sizeClass);
+  if (m_pooledBytes.fetch_add(size) + size > POOL_MAX_BYTES || !m_payloads[sizeClass].Push(block))
+  {
+    m_pooledBytes -= size;
+    return false;
+  }
+  return true;
+}
+
+CDVDDemuxPacketPool::PooledPacket* CDVDDemuxPacketPool::AllocateHeader()
+{
+  PooledPacket* pHeader = (PooledPacket*)m_headers.Pop();
+  if (!pHeader)
+    pHeader = new PooledPacket;
+
+  memset(pHeader, 0, sizeof(PooledPacket));
+  pHeader->sizeClass = -1;
+  pHeader->packet.dts       = DVD_NOPTS_VALUE;
+  pHeader->packet.pts       = DVD_NOPTS_VALUE;
+  pHeader->packet.iStreamId = -1;
+
+  m_allocations++;
+  return pHeader;
+}
+
+void CDVDDemuxPacketPool::FreeHeader(PooledPacket* pHeader)
+{
+  if (!m_headers.Push(pHeader))
+    delete pHeader;
+}
+
+DemuxPacket* CDVDDemuxPacketPool::Allocate(int iDataSize)
+{
+  PooledPacket* pHeader = AllocateHeader();
+  if (iDataSize <= 0)
+    return &pHeader->packet;
+
+  // ffmpeg's optimised bitstream readers may read past the end of the data,
+  // the padding has to be allocated and zeroed (see FF_INPUT_BUFFER_PADDING_SIZE)
+  size_t size = iDataSize + FF_INPUT_BUFFER_PADDING_SIZE;
+  int sizeClass = GetSizeClass(size);
+
+  void* block = NULL;
+  if (sizeClass >= 0)
+  {
+    block = m_payloads[sizeClass].Pop();
+    if (block)
+    {
+      m_pooledBytes -= GetClassSize(sizeClass);
+      m_poolHits++;
+    }
+    else
+    {
+      m_poolMisses++;
+      block = _aligned_malloc(GetClassSize(sizeClass), 16);
+    }
+  }
+  else
+  {
+    m_poolMisses++;
+    block = _aligned_malloc(size, 16);
+  }
+
+  if (!block)
+  {
+    CLog::Log(LOGERROR, "%s - unable to allocate %d bytes", __FUNCTION__, iDataSize);
+    FreeHeader(pHeader);
+    return NULL;
+  }
+
+  pHeader->sizeClass = sizeClass;
+  pHeader->block = block;
+  pHeader->packet.pData = (uint8_t*)block;
+  memset(pHeader->packet.pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+
+  return &pHeader->packet;
+}
+
+DemuxPacket* CDVDDemuxPacketPool::Wrap(AVBufferRef* buffer, uint8_t* data, int iDataSize)
+{
+  PooledPacket* pHeader = AllocateHeader();
+  pHeader->avBuffer = buffer;
+  pHeader->packet.pData = data;
+  pHeader->packet.iSize = iDataSize;
+
+  m_bytesWrapped += iDataSize;
+  return &pHeader->packet;
+}
+
+void CDVDDemuxPacketPool::Free(DemuxPacket* pPacket)
+{
+  if (!pPacket)
+    return;
+
+  PooledPacket* pHeader = (PooledPacket*)pPacket;
+  if (pHeader->avBuffer)
+    av_buffer_unref(&pHeader->avBuffer);
+  else if (pHeader->block)
+  {
+    if (pHeader->sizeClass < 0 || !PushPayload(pHeader->sizeClass, pHeader->block))
+      _aligned_free(pHeader->block);
+  }
+
+  FreeHeader(pHeader);
+}
+
+void CDVDDemuxPacketPool::GetStats(Stats& stats) const
+{
+  stats.allocations  = m_allocations;
+  stats.poolHits     = m_poolHits;
+  stats.poolMisses   = m_poolMisses;
+  stats.bytesCopied  = m_bytesCopied;
+  stats.bytesWrapped = m_bytesWrapped;
+  stats.pooledBytes  = m_pooledBytes;
+
+  uint64_t requests = stats.poolHits + stats.poolMisses;
+  stats.hitRate = requests ? (double)stats.poolHits / requests : 0.0;
+
+  stats.elapsedSeconds = (XbmcThreads::SystemClockMillis() - m_statsStart) / 1000.0;
+  stats.bytesCopiedPerSecond = stats.elapsedSeconds > 0.0 ? stats.bytesCopied / stats.elapsedSeconds : 0.0;
+}
+
+void CDVDDemuxPacketPool::ResetStats()
+{
+  m_allocations  = 0;
+  m_poolHits     = 0;
+  m_poolMisses   = 0;
+  m_bytesCopied  = 0;
+  m_bytesWrapped = 0;
+  m_statsStart   = XbmcThreads::SystemClockMillis();
+}
+
+void CDVDDemuxPacketPool::LogStats() const
+{
+  Stats stats;
+  GetStats(stats);
+  CLog::Log(LOGDEBUG, "CDVDDemuxPacketPool - packets: %" PRIu64 ", pool hit rate: %.1f%% (%" PRIu64 "/%" PRIu64 "), "
+                      "copied: %" PRIu64 " bytes (%.0f bytes/s), wrapped: %" PRIu64 " bytes, pooled: %" PRIu64 " bytes",
+            stats.allocations, stats.hitRate * 100.0, stats.poolHits, stats.poolHits + stats.poolMisses,
+            stats.bytesCopied, stats.bytesCopiedPerSecond, stats.bytesWrapped, stats.pooledBytes);
+}
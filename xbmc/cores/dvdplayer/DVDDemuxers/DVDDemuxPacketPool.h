@@ -0,0 +1,146 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "DVDDemuxPacket.h"
+
+struct AVBufferRef;
+
+/*!
+ \brief Recycles DemuxPacket headers and payload buffers between the demux,
+ audio and video threads.
+
+ Payloads are handed out from power-of-two size classes. Each class keeps a
+ bounded lock-free free list, so allocating and freeing a packet in steady
+ state does not touch the heap or take a lock. The free lists share a global
+ byte budget and are emptied by Trim() when playback ends. Payloads may alternatively
+ reference an ffmpeg AVBufferRef, in which case no copy is done at all and
+ the buffer is released through ffmpeg's own reference counting.
+
+ The layout of DemuxPacket is shared with PVR add-ons and is not changed;
+ the pool keeps its bookkeeping in a private header around it.
+ */
+class CDVDDemuxPacketPool
+{
+public:
+  struct Stats
+  {
+    uint64_t allocations;   //!< packets handed out
+    uint64_t poolHits;      //!< payloads served from a free list
+    uint64_t poolMisses;    //!< payloads that needed a heap allocation
+    uint64_t bytesCopied;   //!< payload bytes copied into pooled buffers
+    uint64_t bytesWrapped;  //!< payload bytes referenced without a copy
+    uint64_t pooledBytes;   //!< payload bytes parked in the free lists
+    double   hitRate;       //!< poolHits / (poolHits + poolMisses)
+    double   bytesCopiedPerSecond;
+    double   elapsedSeconds;
+  };
+
+  static CDVDDemuxPacketPool& GetInstance();
+
+  /*!
+   \brief Allocate a packet with room for iDataSize bytes plus ffmpeg padding.
+   The padding is zeroed, the payload itself is left uninitialised.
+   */
+  DemuxPacket* Allocate(int iDataSize);
+
+  /*!
+   \brief Allocate a packet whose payload references an ffmpeg buffer.
+   The pool takes over the caller's reference to buffer.
+   */
+  DemuxPacket* Wrap(AVBufferRef* buffer, uint8_t* data, int iDataSize);
+
+  void Free(DemuxPacket* pPacket);
+
+  /*!
+   \brief Release all parked payloads and headers, e.g. once playback ended.
+   Packets still in use are not affected and go back to the pool when freed.
+   */
+  void Trim();
+
+  /*!
+   \brief Account for bytes the caller copied into a pooled payload.
+   */
+  void AddBytesCopied(size_t bytes) { m_bytesCopied += bytes; }
+
+  void GetStats(Stats& stats) const;
+  void ResetStats();
+  void LogStats() const;
+
+private:
+  CDVDDemuxPacketPool();
+  ~CDVDDemuxPacketPool();
+  CDVDDemuxPacketPool(const CDVDDemuxPacketPool&);
+  CDVDDemuxPacketPool& operator=(const CDVDDemuxPacketPool&);
+
+  /*!
+   \brief Bounded multi-producer/multi-consumer free list.
+   Each slot carries a sequence number, which avoids the ABA problem of a
+   plain linked stack without needing a double-width compare and swap.
+   */
+  class CFreeList
+  {
+  public:
+    CFreeList();
+    ~CFreeList();
+    void Init(size_t capacity);
+    bool Push(void* p);
+    void* Pop();
+    size_t Capacity() const { return m_mask + 1; }
+  private:
+    struct Slot
+    {
+      std::atomic<size_t> sequence;
+      void* data;
+    };
+    Slot* m_slots;
+    size_t m_mask;
+    std::atomic<size_t> m_head;
+    std::atomic<size_t> m_tail;
+  };
+
+  struct PooledPacket;
+
+  static int GetSizeClass(size_t size);
+  static size_t GetClassSize(int sizeClass);
+  bool PushPayload(int sizeClass, void* block);
+  PooledPacket* AllocateHeader();
+  void FreeHeader(PooledPacket* pHeader);
+
+  static const int    MIN_CLASS_SHIFT = 10; // 1 KiB
+  static const int    MAX_CLASS_SHIFT = 22; // 4 MiB
+  static const int    NUM_CLASSES     = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+
+  CFreeList m_headers;
+  CFreeList m_payloads[NUM_CLASSES];
+
+  std::atomic<uint64_t> m_allocations;
+  std::atomic<uint64_t> m_poolHits;
+  std::atomic<uint64_t> m_poolMisses;
+  std::atomic<uint64_t> m_bytesCopied;
+  std::atomic<uint64_t> m_bytesWrapped;
+  std::atomic<size_t>   m_pooledBytes;
+  std::atomic<unsigned int> m_statsStart;
+};
@@ -22,7 +22,7 @@
   #include "config.h"
 #endif
 #include "DVDDemuxUtils.h"
-#include "DVDClock.h"
+#include "DVDDemuxPacketPool.h"
 #include "utils/log.h"
 
 extern "C" {
@@ -34,8 +34,7 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      CDVDDemuxPacketPool::GetInstance().Free(pPacket);
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -45,45 +44,52 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
-
+  DemuxPacket* pPacket = NULL;
   try
   {
-    memset(pPacket, 0, sizeof(DemuxPacket));
-
-    if (iDataSize > 0)
-    {
-      // need to allocate a few bytes more.
-      // From avcodec.h (ffmpeg)
-      /**
-        * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
-        * this is mainly needed because some optimized bitstream readers read
-        * 32 or 64 bit at once and could read over the end<br>
-        * Note, if the first 23 bits of the additional bytes are not 0 then damaged
-        * MPEG bitstreams could cause overread and segfault
-        */
-      pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
-      if (!pPacket->pData)
-      {
-        FreeDemuxPacket(pPacket);
-        return NULL;
-      }
-
-      // reset the last 8 bytes to 0;
-      memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
-    }
-
-    // setup defaults
-    pPacket->dts       = DVD_NOPTS_VALUE;
-    pPacket->pts       = DVD_NOPTS_VALUE;
-    pPacket->iStreamId = -1;
+    pPacket = CDVDDemuxPacketPool::GetInstance().Allocate(iDataSize);
   }
   catch(...)
   {
     CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
-    FreeDemuxPacket(pPacket);
     pPacket = NULL;
   }
   return pPacket;
 }
+
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(AVPacket* pkt)
+{
+  // take over the buffer if nobody else references it, it is aligned like
+  // our own allocations and carries the padding ffmpeg's decoders require
+  AVBufferRef* buf = pkt->buf;
+  if (buf && pkt->data && pkt->size > 0 &&
+      av_buffer_is_writable(buf) &&
+      ((uintptr_t)pkt->data & 15) == 0 &&
+      pkt->data >= buf->data &&
+      pkt->data + pkt->size + FF_INPUT_BUFFER_PADDING_SIZE <= buf->data + buf->size)
+  {
+    DemuxPacket* pPacket = NULL;
+    try
+    {
+      pPacket = CDVDDemuxPacketPool::GetInstance().Wrap(buf, pkt->data, pkt->size);
+    }
+    catch(...)
+    {
+      CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
+      return NULL;
+    }
+    // padding from lavf is normally zeroed already, but make sure
+    memset(pkt->data + pkt->size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+    pkt->buf = NULL;
+    return pPacket;
+  }
+
+  DemuxPacket* pPacket = AllocateDemuxPacket(pkt->size);
+  if (pPacket && pkt->data && pkt->size > 0)
+  {
+    pPacket->iSize = pkt->size;
+    memcpy(pPacket->pData, pkt->data, pkt->size);
+    CDVDDemuxPacketPool::GetInstance().AddBytesCopied(pkt->size);
+  }
+  return pPacket;
+}
@@ -22,10 +22,19 @@
 
 #include "DVDDemuxPacket.h"
 
+struct AVPacket;
+
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+  /*!
+   \brief Allocate a packet holding the payload of an ffmpeg packet.
+   If the payload is exclusively owned by pkt and suitably padded, the buffer
+   is moved into the returned packet and pkt no longer references it.
+   Otherwise the payload is copied. Timestamps and stream id are not set.
+   */
+  static DemuxPacket* AllocateDemuxPacket(AVPacket* pkt);
 };
 
@@ -23,10 +23,12 @@
 #include "threads/SingleLock.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
+#include "utils/LatencyHistogram.h"
 
 using namespace std;
 
-CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owner(owner)
+CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owner(owner),
+  m_waitLatency(CLatencyHistograms::Get().GetHistogram("messagequeue." + owner, 0))
 {
   m_iDataSize     = 0;
   m_bAbortRequest = false;
@@ -207,7 +209,10 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
+      int64_t waitStart = CurrentHostCounter();
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+      m_waitLatency.RecordSince(waitStart);
+      if (!signaled)
         return MSGQ_TIMEOUT;
 
       lock.Enter();
@@ -27,6 +27,8 @@
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
+class CLatencyHistogram;
+
 struct DVDMessageListItem
 {
   DVDMessageListItem(CDVDMsg* msg, int prio)
@@ -140,6 +142,7 @@ private:
   int m_iMaxDataSize;
   bool m_bEmptied;
   std::string m_owner;
+  CLatencyHistogram &m_waitLatency; ///< time spent waiting for messages
 
   typedef std::list<DVDMessageListItem> SList;
   SList m_list;
@@ -28,6 +28,7 @@
 
 #include "DVDDemuxers/DVDDemux.h"
 #include "DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDDemuxers/DVDDemuxPacketPool.h"
 #include "DVDDemuxers/DVDDemuxVobsub.h"
 #include "DVDDemuxers/DVDFactoryDemuxer.h"
 #include "DVDDemuxers/DVDDemuxFFmpeg.h"
@@ -50,11 +51,7 @@
 #ifdef HAS_VIDEO_PLAYBACK
 #include "cores/VideoRenderers/RenderManager.h"
 #endif
-#ifdef HAS_PERFORMANCE_SAMPLE
-#include "xbmc/utils/PerformanceSample.h"
-#else
-#define MEASURE_FUNCTION
-#endif
+#include "utils/Trace.h"
 #include "settings/AdvancedSettings.h"
 #include "FileItem.h"
 #include "GUIUserMessages.h"
@@ -901,6 +898,7 @@ void CDVDPlayer::OpenDefaultStreams(bool reset)
 
 bool CDVDPlayer::ReadPacket(DemuxPacket*& packet, CDemuxStream*& stream)
 {
+  TRACE_FUNCTION("dvdplayer");
 
   // check if we should read from subtitle demuxer
   if( m_pSubtitleDemuxer && m_dvdPlayerSubtitle->AcceptsData() )
@@ -1500,6 +1498,7 @@ bool CDVDPlayer::CheckIsCurrent(CCurrentStream& current, CDemuxStream* stream, D
 
 void CDVDPlayer::ProcessPacket(CDemuxStream* pStream, DemuxPacket* pPacket)
 {
+  TRACE_FUNCTION("dvdplayer");
   // process packet if it belongs to selected stream.
   // for dvd's don't allow automatic opening of streams*/
 
@@ -2278,6 +2277,11 @@ void CDVDPlayer::OnExit()
     // clean up all selection streams
     m_SelectionStreams.Clear(STREAM_NONE, STREAM_SOURCE_NONE);
 
+    // don't keep the payloads of this file around until the next one
+    CDVDDemuxPacketPool::GetInstance().LogStats();
+    CDVDDemuxPacketPool::GetInstance().Trim();
+    CDVDDemuxPacketPool::GetInstance().ResetStats();
+
     m_messenger.End();
 
     if (m_omxplayer_mode)
@@ -2303,6 +2307,7 @@ void CDVDPlayer::OnExit()
 
 void CDVDPlayer::HandleMessages()
 {
+  TRACE_FUNCTION("dvdplayer");
   CDVDMsg* pMsg;
 
   while (m_messenger.Get(&pMsg, 0) == MSGQ_OK)
@@ -30,6 +30,7 @@
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/DataCacheCore.h"
+#include "utils/Trace.h"
 
 #include <sstream>
 #include <iomanip>
@@ -244,6 +245,7 @@ void CDVDPlayerAudio::CloseStream(bool bWaitForBuffers)
 // decode one audio frame and returns its uncompressed size
 int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe)
 {
+  TRACE_FUNCTION("dvdplayer");
   int result = 0;
 
   // make sure the sent frame is clean
@@ -40,10 +40,15 @@
 #include <numeric>
 #include <iterator>
 #include "utils/log.h"
+#include "utils/Trace.h"
+#include "utils/LatencyHistogram.h"
 
 using namespace std;
 using namespace RenderManager;
 
+static CLatencyHistogram &s_decodeLatency = CLatencyHistograms::Get().GetHistogram("video.decode", 40000);
+static CLatencyHistogram &s_outputLatency = CLatencyHistograms::Get().GetHistogram("video.output", 200000);
+
 class CPulldownCorrection
 {
 public:
@@ -568,7 +573,12 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
-      int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      int iDecoderState;
+      {
+        TRACE_SCOPE("dvdplayer", "VideoDecode");
+        CLatencyTimer decodeTimer(s_decodeLatency);
+        iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      }
 
       // buffer packets so we can recover should decoder flush for some reason
       if(m_pVideoCodec->GetConvergeCount() > 0)
@@ -954,6 +964,8 @@ std::string CDVDPlayerVideo::GetStereoMode()
 
 int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
 {
+  TRACE_FUNCTION("dvdplayer");
+  CLatencyTimer outputTimer(s_outputLatency);
   /* picture buffer is not allowed to be modified in this call */
   DVDVideoPicture picture(*src);
   DVDVideoPicture* pPicture = &picture;
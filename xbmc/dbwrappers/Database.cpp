@@ -27,6 +27,7 @@
 #include "utils/log.h"
 #include "utils/SortUtils.h"
 #include "utils/StringUtils.h"
+#include "utils/Trace.h"
 #include "sqlitedataset.h"
 #include "DatabaseManager.h"
 #include "DbUrl.h"
@@ -105,6 +106,8 @@ CDatabase::CDatabase(void)
   m_sqlite = true;
   m_bMultiWrite = false;
   m_multipleExecute = false;
+  m_batch = false;
+  m_batchDepth = 0;
 }
 
 CDatabase::~CDatabase(void)
@@ -144,6 +147,7 @@ std::string CDatabase::PrepareSQL(std::string strStmt, ...) const
 
 std::string CDatabase::GetSingleValue(const std::string &query, std::unique_ptr<Dataset> &ds)
 {
+  TRACE_FUNCTION("database");
   std::string ret;
   try
   {
@@ -193,6 +197,7 @@ bool CDatabase::BeginMultipleExecute()
 
 bool CDatabase::CommitMultipleExecute()
 {
+  TRACE_FUNCTION("database");
   m_multipleExecute = false;
   BeginTransaction();
   for (std::vector<std::string>::const_iterator i = m_multipleQueries.begin(); i != m_multipleQueries.end(); ++i)
@@ -209,6 +214,7 @@ bool CDatabase::CommitMultipleExecute()
 
 bool CDatabase::ExecuteQuery(const std::string &strQuery)
 {
+  TRACE_FUNCTION("database");
   if (m_multipleExecute)
   {
     m_multipleQueries.push_back(strQuery);
@@ -233,8 +239,30 @@ bool CDatabase::ExecuteQuery(const std::string &strQuery)
   return bReturn;
 }
 
+bool CDatabase::ExecuteQuery(const std::string &strQuery, const std::vector<dbiplus::field_value> &values)
+{
+  TRACE_FUNCTION("database");
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+    m_pDS->exec_params(strQuery, values);
+    bReturn = true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+
 bool CDatabase::ResultQuery(const std::string &strQuery)
 {
+  TRACE_FUNCTION("database");
   bool bReturn = false;
 
   try
@@ -276,6 +304,7 @@ bool CDatabase::QueueInsertQuery(const std::string &strQuery)
 
 bool CDatabase::CommitInsertQueries()
 {
+  TRACE_FUNCTION("database");
   bool bReturn = true;
 
   if (m_bMultiWrite)
@@ -578,6 +607,9 @@ void CDatabase::Close()
     return;
   }
 
+  if (m_batch)
+    CommitBatch();
+
   m_openCount = 0;
   m_multipleExecute = false;
 
@@ -632,6 +664,12 @@ void CDatabase::Interupt()
 
 void CDatabase::BeginTransaction()
 {
+  if (m_batch)
+  {
+    m_batchDepth++;
+    return;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -645,6 +683,14 @@ void CDatabase::BeginTransaction()
 
 bool CDatabase::CommitTransaction()
 {
+  TRACE_FUNCTION("database");
+  if (m_batch)
+  {
+    if (m_batchDepth > 0)
+      m_batchDepth--;
+    return true;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -660,6 +706,13 @@ bool CDatabase::CommitTransaction()
 
 void CDatabase::RollbackTransaction()
 {
+  if (m_batch)
+  {
+    CLog::Log(LOGWARNING, "database:rollbacktransaction rolls back the whole batch");
+    m_batch = false;
+    m_batchDepth = 0;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -671,6 +724,30 @@ void CDatabase::RollbackTransaction()
   }
 }
 
+void CDatabase::BeginBatch()
+{
+  if (m_batch)
+    return;
+
+  BeginTransaction();
+  m_batch = true;
+  m_batchDepth = 0;
+}
+
+bool CDatabase::CommitBatch()
+{
+  if (!m_batch)
+    return false;
+
+  if (m_batchDepth > 0)
+    CLog::Log(LOGWARNING, "database:commitbatch %u transactions were not committed", m_batchDepth);
+
+  m_batch = false;
+  m_batchDepth = 0;
+  // virtual, so derived databases see the commit as usual
+  return CommitTransaction();
+}
+
 bool CDatabase::InTransaction()
 {
   if (NULL != m_pDB.get()) return false;
@@ -23,6 +23,7 @@
 namespace dbiplus {
   class Database;
   class Dataset;
+  class field_value;
 }
 
 #include <memory>
@@ -71,6 +72,25 @@ public:
   void RollbackTransaction();
   bool InTransaction();
 
+  /*!
+   * @brief Start a batch of writes that are committed as one transaction.
+   *        Until CommitBatch() is called, BeginTransaction() and
+   *        CommitTransaction() only nest within the batch, so bulk updates
+   *        made of many small transactions don't pay for a commit each.
+   *        RollbackTransaction() rolls back and ends the whole batch.
+   * @sa CommitBatch
+   */
+  void BeginBatch();
+
+  /*!
+   * @brief Commit the writes since BeginBatch() and end the batch.
+   * @return True if the batch was committed, false otherwise.
+   * @sa BeginBatch
+   */
+  bool CommitBatch();
+
+  bool InBatch() const { return m_batch; }
+
   std::string PrepareSQL(std::string strStmt, ...) const;
 
   /*!
@@ -110,6 +130,16 @@ public:
    */
   bool ExecuteQuery(const std::string &strQuery);
 
+  /*!
+   * @brief Execute a query that does not return any result, with its '?' placeholders bound to values.
+   *        The statement is prepared once and reused while the database is open, which makes
+   *        repeating a write with different values cheap. It's never queued by BeginMultipleExecute().
+   * @param strQuery The query to execute.
+   * @param values The values of the placeholders, in order.
+   * @return True if the query was executed successfully, false otherwise.
+   */
+  bool ExecuteQuery(const std::string &strQuery, const std::vector<dbiplus::field_value> &values);
+
   /*!
    * @brief Execute a query that returns a result.
    * @remarks Call m_pDS->close(); to clean up the dataset when done.
@@ -220,4 +250,7 @@ private:
 
   bool m_multipleExecute;
   std::vector<std::string> m_multipleQueries;
+
+  bool m_batch;                   ///< a batch of transactions is open
+  unsigned int m_batchDepth;      ///< transactions nested in the open batch
 };
@@ -397,6 +397,40 @@ int Dataset::str_compare(const char * s1, const char * s2) {
  }
 
 
+bool Dataset::query_stream(const std::string &sql, const sql_record &params) {
+  // no native support, substitute the placeholders and materialise the result
+  return query(format_params(sql, params));
+}
+
+int Dataset::exec_params(const std::string &sql, const sql_record &params) {
+  return exec(format_params(sql, params));
+}
+
+std::string Dataset::format_params(const std::string &sql, const sql_record &params) {
+  std::string qry;
+  unsigned int param = 0;
+  bool quoted = false;
+  for (std::string::const_iterator c = sql.begin(); c != sql.end(); ++c) {
+    if (*c == '\'')
+      quoted = !quoted;
+    if (*c != '?' || quoted) {
+      qry += *c;
+      continue;
+    }
+    if (param >= params.size())
+      throw DbErrors("Missing parameter %u for query", param + 1);
+
+    const field_value &v = params[param++];
+    if (v.get_isNull())
+      qry += "NULL";
+    else if (v.get_fType() == ft_String)
+      qry += db->prepare("'%s'", v.get_asString().c_str());
+    else
+      qry += v.get_asString();
+  }
+  return qry;
+}
+
 void Dataset::setParamList(const ParamList &params){
   plist = params;
 }
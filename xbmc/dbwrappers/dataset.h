@@ -264,6 +264,9 @@ protected:
 /* Returns old field value (for :OLD) */
   virtual const field_value f_old(const char *f);
 
+/* Returns sql with its '?' placeholders replaced by the formatted params */
+  std::string format_params(const std::string &sql, const sql_record &params);
+
 public:
 
  virtual int str_compare(const char * s1, const char * s2);
@@ -309,6 +312,19 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &sql) = 0;
+/* Streaming cursor: as query, but '?' placeholders in sql are bound to params
+   and rows are fetched one at a time by next() rather than materialised up
+   front. Only forward navigation (eof/next) is possible, get_sql_record()
+   returns the current row only and num_rows() counts the rows read so far.
+   Backends without native support fall back to query() with the parameters
+   formatted into the statement. */
+  virtual bool query_stream(const std::string &sql, const sql_record &params = sql_record());
+/* as exec, but '?' placeholders in sql are bound to params. Backends with
+   prepared statements keep the statement for the next call, so a write
+   repeated with different values is only parsed once. */
+  virtual int exec_params(const std::string &sql, const sql_record &params);
+/* true if the current result is read through a streaming cursor */
+  virtual bool is_streaming() { return false; }
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
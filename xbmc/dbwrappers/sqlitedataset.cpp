@@ -258,6 +258,7 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clear_statement_cache();
   sqlite3_close(conn);
   active = false;
 }
@@ -364,6 +365,67 @@ int SqliteDatabase::drop() {
 }
 
 
+sqlite3_stmt *SqliteDatabase::acquire_statement(const std::string &sql) {
+  if (active == false) throw DbErrors("No Database Connection");
+
+  std::map<std::string, cached_stmt>::iterator it = stmt_cache.find(sql);
+  if (it != stmt_cache.end() && !it->second.in_use)
+  {
+    it->second.in_use = true;
+    return it->second.stmt;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(getErrorMsg());
+
+  // the same statement is already being stepped, hand out a private copy
+  if (it != stmt_cache.end())
+    return stmt;
+
+  // keep the cache bounded, dropping whatever is idle
+  if (stmt_cache.size() >= MAX_CACHED_STATEMENTS)
+  {
+    for (it = stmt_cache.begin(); it != stmt_cache.end(); )
+    {
+      if (!it->second.in_use)
+      {
+        sqlite3_finalize(it->second.stmt);
+        stmt_cache.erase(it++);
+      }
+      else
+        ++it;
+    }
+  }
+
+  cached_stmt &entry = stmt_cache[sql];
+  entry.stmt = stmt;
+  entry.in_use = true;
+  return stmt;
+}
+
+void SqliteDatabase::release_statement(sqlite3_stmt *stmt) {
+  if (stmt == NULL) return;
+
+  for (std::map<std::string, cached_stmt>::iterator it = stmt_cache.begin(); it != stmt_cache.end(); ++it)
+  {
+    if (it->second.stmt == stmt)
+    {
+      sqlite3_reset(stmt);
+      sqlite3_clear_bindings(stmt);
+      it->second.in_use = false;
+      return;
+    }
+  }
+  sqlite3_finalize(stmt);
+}
+
+void SqliteDatabase::clear_statement_cache() {
+  for (std::map<std::string, cached_stmt>::iterator it = stmt_cache.begin(); it != stmt_cache.end(); ++it)
+    sqlite3_finalize(it->second.stmt);
+  stmt_cache.clear();
+}
+
 long SqliteDatabase::nextid(const char* sname) {
   if (!active) return DB_UNEXPECTED_RESULT;
   int id;/*,nrow,ncol;*/
@@ -447,11 +509,78 @@ string SqliteDatabase::vprepare(const char *format, va_list args)
 
 //************* SqliteDataset implementation ***************
 
+static int bind_params(sqlite3_stmt *stmt, const sql_record &params)
+{
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &v = params[i];
+    int rc;
+    if (v.get_isNull())
+      rc = sqlite3_bind_null(stmt, i + 1);
+    else
+    {
+      switch (v.get_fType())
+      {
+      case ft_Boolean:
+      case ft_Char:
+      case ft_Short:
+      case ft_UShort:
+      case ft_Int:
+      case ft_UInt:
+      case ft_Int64:
+        rc = sqlite3_bind_int64(stmt, i + 1, v.get_asInt64());
+        break;
+      case ft_Float:
+      case ft_Double:
+        rc = sqlite3_bind_double(stmt, i + 1, v.get_asDouble());
+        break;
+      default:
+        rc = sqlite3_bind_text(stmt, i + 1, v.get_asString().c_str(), -1, SQLITE_TRANSIENT);
+        break;
+      }
+    }
+    if (rc != SQLITE_OK)
+      return rc;
+  }
+  return SQLITE_OK;
+}
+
+static void read_row(sqlite3_stmt *stmt, sql_record &row)
+{
+  const unsigned int numColumns = row.size();
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    field_value &v = row[i];
+    switch (sqlite3_column_type(stmt, i))
+    {
+    case SQLITE_INTEGER:
+      v.set_asInt64(sqlite3_column_int64(stmt, i));
+      break;
+    case SQLITE_FLOAT:
+      v.set_asDouble(sqlite3_column_double(stmt, i));
+      break;
+    case SQLITE_TEXT:
+      v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      break;
+    case SQLITE_BLOB:
+      v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      break;
+    case SQLITE_NULL:
+    default:
+      v.set_asString("");
+      v.set_isNull();
+      break;
+    }
+  }
+}
+
 SqliteDataset::SqliteDataset():Dataset() {
   haveError = false;
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
+  stream_stmt = NULL;
+  stream_rows = -1;
 }
 
 
@@ -460,9 +589,12 @@ SqliteDataset::SqliteDataset(SqliteDatabase *newDb):Dataset(newDb) {
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
+  stream_stmt = NULL;
+  stream_rows = -1;
 }
 
  SqliteDataset::~SqliteDataset(){
+   close_stream();
    if (errmsg) sqlite3_free(errmsg);
  }
 
@@ -662,30 +794,7 @@ bool SqliteDataset::query(const std::string &query) {
   { // have a row of data
     sql_record *res = new sql_record;
     res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
-      {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
-        break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_NULL:
-      default:
-        v.set_asString("");
-        v.set_isNull();
-        break;
-      }
-    }
+    read_row(stmt, *res);
     result.records.push_back(res);
   }
   if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
@@ -701,6 +810,86 @@ bool SqliteDataset::query(const std::string &query) {
   }  
 }
 
+bool SqliteDataset::query_stream(const std::string &query, const sql_record &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  SqliteDatabase *sqlite = static_cast<SqliteDatabase*>(db);
+  stream_stmt = sqlite->acquire_statement(query);
+  stream_rows = 0;
+
+  if (db->setErr(bind_params(stream_stmt, params), query.c_str()) != SQLITE_OK)
+  {
+    close_stream();
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  // column headers
+  const unsigned int numColumns = sqlite3_column_count(stream_stmt);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+    result.record_header[i].name = sqlite3_column_name(stream_stmt, i);
+
+  // a single row buffer is reused for every row stepped
+  result.records.push_back(new sql_record(numColumns));
+
+  active = true;
+  ds_state = dsSelect;
+  frecno = 0;
+  fbof = false;
+  feof = !step_stream();
+  if (!feof)
+    fill_fields();
+  else
+    close_stream();
+  return true;
+}
+
+int SqliteDataset::exec_params(const std::string &sql, const sql_record &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  SqliteDatabase *sqlite = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = sqlite->acquire_statement(sql);
+
+  int rc = bind_params(stmt, params);
+  if (rc == SQLITE_OK)
+  {
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE || rc == SQLITE_ROW)
+      rc = SQLITE_OK;
+  }
+
+  sqlite->release_statement(stmt);
+  if (db->setErr(rc, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return rc;
+}
+
+bool SqliteDataset::step_stream() {
+  int rc = sqlite3_step(stream_stmt);
+  if (rc == SQLITE_ROW)
+  {
+    read_row(stream_stmt, *result.records[0]);
+    stream_rows++;
+    return true;
+  }
+  if (rc != SQLITE_DONE)
+  {
+    std::string err = sqlite3_errmsg(handle());
+    close_stream();
+    throw DbErrors("Error stepping query: %s", err.c_str());
+  }
+  return false;
+}
+
+void SqliteDataset::close_stream() {
+  if (stream_stmt == NULL) return;
+  static_cast<SqliteDatabase*>(db)->release_statement(stream_stmt);
+  stream_stmt = NULL;
+}
+
 void SqliteDataset::open(const string &sql) {
   set_select_sql(sql);
   open();
@@ -717,6 +906,8 @@ void SqliteDataset::open() {
 
 
 void SqliteDataset::close() {
+  close_stream();
+  stream_rows = -1;
   Dataset::close();
   result.clear();
   edit_object->clear();
@@ -737,6 +928,8 @@ void SqliteDataset::cancel() {
 
 
 int SqliteDataset::num_rows() {
+  if (stream_rows >= 0)
+    return stream_rows;
   return result.records.size();
 }
 
@@ -752,21 +945,36 @@ bool SqliteDataset::bof() {
 
 
 void SqliteDataset::first() {
+  if (stream_rows >= 0) return; // a stream can't be rewound
   Dataset::first();
   this->fill_fields();
 }
 
 void SqliteDataset::last() {
+  if (stream_rows >= 0) return;
   Dataset::last();
   fill_fields();
 }
 
 void SqliteDataset::prev(void) {
+  if (stream_rows >= 0) return;
   Dataset::prev();
   fill_fields();
 }
 
 void SqliteDataset::next(void) {
+  if (stream_rows >= 0)
+  {
+    if (ds_state != dsSelect || feof || stream_stmt == NULL) return;
+    if (step_stream())
+      fill_fields();
+    else
+    {
+      feof = true;
+      close_stream();
+    }
+    return;
+  }
   Dataset::next();
   if (!eof()) 
       fill_fields();
@@ -774,6 +982,7 @@ void SqliteDataset::next(void) {
 
 void SqliteDataset::free_row(void)
 {
+  if (stream_rows >= 0) return; // the row buffer is reused
   if (frecno < 0 || (unsigned int)frecno >= result.records.size())
     return;
 
@@ -786,7 +995,7 @@ void SqliteDataset::free_row(void)
 }
 
 bool SqliteDataset::seek(int pos) {
-  if (ds_state == dsSelect) {
+  if (ds_state == dsSelect && stream_rows < 0) {
     Dataset::seek(pos);
     fill_fields();
     return true;  
@@ -30,6 +30,7 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -46,6 +47,14 @@ protected:
   bool _in_transaction;
   int last_err;
 
+/* prepared statements kept for reuse by streaming datasets */
+  struct cached_stmt {
+    sqlite3_stmt *stmt;
+    bool in_use;
+  };
+  std::map<std::string, cached_stmt> stmt_cache;
+  static const unsigned int MAX_CACHED_STATEMENTS = 32;
+
 public:
 /* default constructor */
   SqliteDatabase();
@@ -97,6 +106,14 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* returns a prepared statement for sql, reusing a cached one if it is idle.
+   The statement must be handed back with release_statement(). */
+  sqlite3_stmt *acquire_statement(const std::string &sql);
+/* resets a statement from acquire_statement() and returns it to the cache */
+  void release_statement(sqlite3_stmt *stmt);
+/* finalizes all cached statements */
+  void clear_statement_cache();
+
 };
 
 
@@ -128,6 +145,13 @@ protected:
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
 
+/* streaming cursor state, see query_stream() */
+  sqlite3_stmt *stream_stmt;
+  int stream_rows; // rows read so far, -1 if the result isn't streamed
+/* steps the streaming cursor, returns false once all rows have been read */
+  bool step_stream();
+  void close_stream();
+
 public:
 /* constructor */
   SqliteDataset();
@@ -149,6 +173,11 @@ or insert() operations default = false) */
   virtual const void* getExecRes();
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &query);
+/* as query, but with a cached statement and lazily stepped rows */
+  virtual bool query_stream(const std::string &query, const sql_record &params = sql_record());
+  virtual bool is_streaming() { return stream_rows >= 0; }
+/* as exec, but with a cached statement and bound parameters */
+  virtual int exec_params(const std::string &sql, const sql_record &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
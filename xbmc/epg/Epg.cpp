@@ -88,7 +88,11 @@ CEpg &CEpg::operator =(const CEpg &right)
   m_pvrChannel        = right.m_pvrChannel;
 
   for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = right.m_tags.begin(); it != right.m_tags.end(); ++it)
-    m_tags.insert(make_pair(it->first, it->second));
+  {
+    // keep the index in line with the tags, an existing tag isn't replaced
+    if (m_tags.insert(make_pair(it->first, it->second)).second)
+      m_searchIndex.Add(it->second);
+  }
 
   return *this;
 }
@@ -147,6 +151,7 @@ void CEpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  m_searchIndex.Clear();
 }
 
 void CEpg::Cleanup(void)
@@ -167,6 +172,7 @@ void CEpg::Cleanup(const CDateTime &Time)
         m_nowActiveStart.SetValid(false);
 
       it->second->ClearTimer();
+      m_searchIndex.Remove(it->second);
       it = m_tags.erase(it);
     }
     else
@@ -314,6 +320,7 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
     newTag->Update(tag);
     newTag->SetPVRChannel(m_pvrChannel);
     newTag->SetEpg(this);
+    m_searchIndex.Add(newTag);
   }
 }
 
@@ -336,11 +343,15 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
     bNewTag = true;
   }
 
-  infoTag->Update(tag, bNewTag);
+  bool bChanged = infoTag->Update(tag, bNewTag);
   infoTag->SetEpg(this);
   infoTag->SetPVRChannel(m_pvrChannel);
 
-  if (bUpdateDatabase)
+  if (bChanged || bNewTag)
+    m_searchIndex.Add(infoTag);
+
+  /* only write the tags that differ from what's in the database already */
+  if (bUpdateDatabase && (bChanged || bNewTag))
     m_changedTags.insert(make_pair(infoTag->UniqueBroadcastID(), infoTag));
 
   return true;
@@ -506,7 +517,28 @@ int CEpg::Get(CFileItemList &results, const EpgSearchFilter &filter) const
 
   CSingleLock lock(m_critSection);
 
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  /* look the search term and genre up in the index, only its candidates have to be matched */
+  std::vector<CEpgInfoTagPtr> candidates;
+  if (m_searchIndex.GetCandidates(filter, candidates))
+  {
+    for (std::vector<CEpgInfoTagPtr>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+    {
+      if (filter.FilterEntry(**it))
+        results.Add(CFileItemPtr(new CFileItem(*it)));
+    }
+    return results.Size() - iInitialSize;
+  }
+
+  /* tags are ordered by start time, so only those starting in the time range have to be matched.
+     the filter compares local times, allow for a day of time zone and DST offset here */
+  map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin();
+  CDateTime end;
+  if (filter.m_startDateTime.IsValid())
+    it = m_tags.lower_bound(filter.m_startDateTime.GetAsUTCDateTime() - CDateTimeSpan(1, 0, 0, 0));
+  if (filter.m_endDateTime.IsValid())
+    end = filter.m_endDateTime.GetAsUTCDateTime() + CDateTimeSpan(1, 0, 0, 0);
+
+  for (; it != m_tags.end() && (!end.IsValid() || it->first <= end); ++it)
   {
     if (filter.FilterEntry(*it->second))
       results.Add(CFileItemPtr(new CFileItem(it->second)));
@@ -517,6 +549,13 @@ int CEpg::Get(CFileItemList &results, const EpgSearchFilter &filter) const
 
 bool CEpg::Persist(void)
 {
+  unsigned int iTagsWritten(0);
+  return Persist(0, iTagsWritten);
+}
+
+bool CEpg::Persist(unsigned int iMaxTags, unsigned int &iTagsWritten)
+{
+  iTagsWritten = 0;
   if (CSettings::Get().GetBool("epg.ignoredbforclient") || !NeedsSave())
     return true;
 
@@ -531,6 +570,7 @@ bool CEpg::Persist(void)
     return false;
   }
 
+  bool bReturn(true);
   {
     CSingleLock lock(m_critSection);
     if (m_iEpgID <= 0 || m_bChanged)
@@ -538,25 +578,38 @@ bool CEpg::Persist(void)
       int iId = database->Persist(*this, m_iEpgID > 0);
       if (iId > 0)
         m_iEpgID = iId;
+      m_bChanged = false;
     }
 
-    for (std::map<int, CEpgInfoTagPtr>::iterator it = m_deletedTags.begin(); it != m_deletedTags.end(); ++it)
+    /* tags that don't fit in this call stay queued for the next one */
+    while (!m_deletedTags.empty() && (iMaxTags == 0 || iTagsWritten < iMaxTags))
+    {
+      std::map<int, CEpgInfoTagPtr>::iterator it = m_deletedTags.begin();
       database->Delete(*it->second);
+      m_deletedTags.erase(it);
+      iTagsWritten++;
+    }
 
-    for (std::map<int, CEpgInfoTagPtr>::iterator it = m_changedTags.begin(); it != m_changedTags.end(); ++it)
-      it->second->Persist(false);
+    while (!m_changedTags.empty() && (iMaxTags == 0 || iTagsWritten < iMaxTags))
+    {
+      std::map<int, CEpgInfoTagPtr>::iterator it = m_changedTags.begin();
+      if (!it->second->Persist(false))
+        bReturn = false;
+      m_changedTags.erase(it);
+      iTagsWritten++;
+    }
 
-    if (m_bUpdateLastScanTime)
-      database->PersistLastEpgScanTime(m_iEpgID, true);
+    if (m_deletedTags.empty() && m_changedTags.empty())
+    {
+      if (m_bUpdateLastScanTime)
+        database->PersistLastEpgScanTime(m_iEpgID, true);
 
-    m_deletedTags.clear();
-    m_changedTags.clear();
-    m_bChanged            = false;
-    m_bTagsChanged        = false;
-    m_bUpdateLastScanTime = false;
+      m_bTagsChanged        = false;
+      m_bUpdateLastScanTime = false;
+    }
   }
 
-  return database->CommitInsertQueries();
+  return database->CommitInsertQueries() && bReturn;
 }
 
 CDateTime CEpg::GetFirstDate(void) const
@@ -604,12 +657,16 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
     {
       // delete the current tag. it's completely overlapped
       if (bUpdateDb)
+      {
+        m_changedTags.erase(currentTag->UniqueBroadcastID());
         m_deletedTags.insert(make_pair(currentTag->UniqueBroadcastID(), currentTag));
+      }
 
       if (m_nowActiveStart == it->first)
         m_nowActiveStart.SetValid(false);
 
       it->second->ClearTimer();
+      m_searchIndex.Remove(it->second);
       m_tags.erase(it++);
     }
     else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
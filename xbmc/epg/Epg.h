@@ -26,6 +26,7 @@
 
 #include "EpgInfoTag.h"
 #include "EpgSearchFilter.h"
+#include "EpgSearchIndex.h"
 
 namespace PVR
 {
@@ -249,6 +250,14 @@ namespace EPG
      */
     bool Persist(void);
 
+    /*!
+     * @brief Persist this table in the database, writing at most the given amount of tags.
+     * @param iMaxTags The maximum amount of tags to write or delete, 0 for no limit.
+     * @param iTagsWritten The amount of tags that were written or deleted.
+     * @return True if the table was persisted, false otherwise. NeedsSave() is still true if tags were left over.
+     */
+    bool Persist(unsigned int iMaxTags, unsigned int &iTagsWritten);
+
     /*!
      * @brief Get the start time of the first entry in this table.
      * @return The first date in UTC.
@@ -347,6 +356,7 @@ namespace EPG
     bool IsRemovableTag(const EPG::CEpgInfoTag &tag) const;
 
     std::map<CDateTime, CEpgInfoTagPtr> m_tags;
+    CEpgSearchIndex                     m_searchIndex;     /*!< the words and genres of m_tags, for searches */
     std::map<int, CEpgInfoTagPtr>       m_changedTags;
     std::map<int, CEpgInfoTagPtr>       m_deletedTags;
     bool                                m_bChanged;        /*!< true if anything changed that needs to be persisted, false otherwise */
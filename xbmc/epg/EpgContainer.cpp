@@ -29,6 +29,7 @@
 #include "settings/lib/Setting.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
+#include "utils/LatencyHistogram.h"
 #include "utils/log.h"
 
 #include "Epg.h"
@@ -57,6 +58,10 @@ CEpgContainer::CEpgContainer(void) :
   m_iNextEpgUpdate = 0;
   m_iDisplayTime = 24 * 60 * 60;
   m_bIgnoreDbForClient = false;
+  m_bPersistPending = false;
+  m_iPersistedTags = 0;
+  m_iPersistedTables = 0;
+  m_iPersistBatches = 0;
 }
 
 CEpgContainer::~CEpgContainer(void)
@@ -241,22 +246,60 @@ bool CEpgContainer::PersistTables(void)
   return m_database.Persist(copy);
 }
 
-bool CEpgContainer::PersistAll(void)
+bool CEpgContainer::PersistAll(unsigned int iMaxTags /* = 0 */)
 {
+  static CLatencyHistogram &histogram = CLatencyHistograms::Get().GetHistogram("epg.persist", 100000);
+  CLatencyTimer timer(histogram);
+
   bool bReturn(true);
   m_critSection.lock();
   std::map<unsigned int, CEpg*> copy = m_epgs;
   m_critSection.unlock();
 
+  /* write everything in a single transaction instead of one per table */
+  m_database.BeginBatch();
+
+  unsigned int iTagsWritten(0);
+  m_bPersistPending = false;
   for (EPGMAP_CITR it = copy.begin(); it != copy.end() && !m_bStop; it++)
   {
     CEpg *epg = it->second;
     if (epg && epg->NeedsSave())
     {
-      bReturn &= epg->Persist();
+      if (iMaxTags > 0 && iTagsWritten >= iMaxTags)
+      {
+        m_bPersistPending = true;
+        break;
+      }
+
+      unsigned int iTags(0);
+      bReturn &= epg->Persist(iMaxTags > 0 ? iMaxTags - iTagsWritten : 0, iTags);
+      iTagsWritten += iTags;
+      m_iPersistedTags += iTags;
+
+      // the budget ran out inside the table, write the rest soon
+      if (iMaxTags > 0 && iTagsWritten >= iMaxTags && epg->NeedsSave())
+        m_bPersistPending = true;
+      else
+        m_iPersistedTables++;
     }
   }
 
+  if (m_database.InBatch())
+    bReturn &= m_database.CommitBatch();
+
+  if (iTagsWritten > 0 || m_bPersistPending)
+    m_iPersistBatches++;
+
+  if (!m_bPersistPending && m_iPersistBatches > 0)
+  {
+    CLog::Log(LOGDEBUG, "EPG - %s - wrote %u changed tags of %u tables in %u transactions",
+        __FUNCTION__, m_iPersistedTags, m_iPersistedTables, m_iPersistBatches);
+    m_iPersistedTags   = 0;
+    m_iPersistedTables = 0;
+    m_iPersistBatches  = 0;
+  }
+
   return bReturn;
 }
 
@@ -323,10 +366,13 @@ void CEpgContainer::Process(void)
     if (!m_bStop)
       CheckPlayingEvents();
 
-    /* check for changes that need to be saved every 60 seconds */
-    if (iNow - iLastSave > 60)
+    /* check for changes that need to be saved every 60 seconds, or right away
+       while a previous pass left tags behind. playback gets smaller transactions */
+    if (m_bPersistPending || iNow - iLastSave > 60)
     {
-      PersistAll();
+      PersistAll(g_application.m_pPlayer->IsPlaying() ?
+          g_advancedSettings.m_iEpgPersistBatchSizePlaying :
+          g_advancedSettings.m_iEpgPersistBatchSize);
       iLastSave = iNow;
     }
 
@@ -232,10 +232,11 @@ namespace EPG
     bool IsInitialising(void) const;
 
     /*!
-     * @brief Call Persist() on each table
+     * @brief Call Persist() on each table that has changes, in a single transaction.
+     * @param iMaxTags The maximum amount of tags to write, 0 for no limit. Tags that don't fit are written by the next call.
      * @return True when they all were persisted, false otherwise.
      */
-    bool PersistAll(void);
+    bool PersistAll(unsigned int iMaxTags = 0);
 
     bool PersistTables(void);
 
@@ -307,6 +308,10 @@ namespace EPG
     time_t       m_iNextEpgActiveTagCheck; /*!< the time the EPG will be checked for active tag updates */
     unsigned int m_iNextEpgId;             /*!< the next epg ID that will be given to a new table when the db isn't being used */
     EPGMAP       m_epgs;                   /*!< the EPGs in this container */
+    bool         m_bPersistPending;        /*!< true if the last PersistAll() call left changes behind */
+    unsigned int m_iPersistedTags;         /*!< tags written since all changes were last persisted */
+    unsigned int m_iPersistedTables;       /*!< tables written since all changes were last persisted */
+    unsigned int m_iPersistBatches;        /*!< transactions since all changes were last persisted */
     //@}
 
     CGUIDialogProgressBarHandle *  m_progressHandle; /*!< the progress dialog that is visible when updating the first time */
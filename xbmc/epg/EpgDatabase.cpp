@@ -162,10 +162,10 @@ bool CEpgDatabase::Delete(const CEpgInfoTag &tag)
   if (tag.BroadcastId() <= 0)
     return false;
 
-  Filter filter;
-  filter.AppendWhere(PrepareSQL("idBroadcast = %u", tag.BroadcastId()));
+  std::vector<dbiplus::field_value> values;
+  values.push_back(dbiplus::field_value(tag.BroadcastId()));
 
-  return DeleteValues("epgtags", filter);
+  return ExecuteQuery("DELETE FROM epgtags WHERE idBroadcast = ?;", values);
 }
 
 int CEpgDatabase::Get(CEpgContainer &container)
@@ -346,52 +346,60 @@ int CEpgDatabase::Persist(const CEpgInfoTag &tag, bool bSingleUpdate /* = true *
   tag.FirstAiredAsUTC().GetAsTime(iFirstAired);
 
   int iBroadcastId = tag.BroadcastId();
-  std::string strQuery;
 
   /* Only store the genre string when needed */
   std::string strGenre = (tag.GenreType() == EPG_GENRE_USE_STRING) ? StringUtils::Join(tag.Genre(), g_advancedSettings.m_videoItemSeparator) : "";
 
+  /* the values are bound to one of two statements, so each is only prepared once for all tags */
+  std::vector<dbiplus::field_value> values;
+  values.reserve(26);
+  values.push_back(dbiplus::field_value(tag.EpgID()));
+  values.push_back(dbiplus::field_value((int64_t)iStartTime));
+  values.push_back(dbiplus::field_value((int64_t)iEndTime));
+  values.push_back(dbiplus::field_value(tag.Title(true).c_str()));
+  values.push_back(dbiplus::field_value(tag.PlotOutline(true).c_str()));
+  values.push_back(dbiplus::field_value(tag.Plot(true).c_str()));
+  values.push_back(dbiplus::field_value(tag.OriginalTitle(true).c_str()));
+  values.push_back(dbiplus::field_value(tag.Cast().c_str()));
+  values.push_back(dbiplus::field_value(tag.Director().c_str()));
+  values.push_back(dbiplus::field_value(tag.Writer().c_str()));
+  values.push_back(dbiplus::field_value(tag.Year()));
+  values.push_back(dbiplus::field_value(tag.IMDBNumber().c_str()));
+  values.push_back(dbiplus::field_value(tag.Icon().c_str()));
+  values.push_back(dbiplus::field_value(tag.GenreType()));
+  values.push_back(dbiplus::field_value(tag.GenreSubType()));
+  values.push_back(dbiplus::field_value(strGenre.c_str()));
+  values.push_back(dbiplus::field_value((int64_t)iFirstAired));
+  values.push_back(dbiplus::field_value(tag.ParentalRating()));
+  values.push_back(dbiplus::field_value(tag.StarRating()));
+  values.push_back(dbiplus::field_value((int)tag.Notify()));
+  values.push_back(dbiplus::field_value(tag.SeriesNumber()));
+  values.push_back(dbiplus::field_value(tag.EpisodeNumber()));
+  values.push_back(dbiplus::field_value(tag.EpisodePart()));
+  values.push_back(dbiplus::field_value(tag.EpisodeName().c_str()));
+  values.push_back(dbiplus::field_value(tag.UniqueBroadcastID()));
+
+  std::string strQuery;
   if (iBroadcastId < 0)
   {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
+    strQuery = "REPLACE INTO epgtags (idEpg, iStartTime, "
         "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
         "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
         "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i);",
-        tag.EpgID(), iStartTime, iEndTime,
-        tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(),
-        tag.OriginalTitle(true).c_str(), tag.Cast().c_str(), tag.Director().c_str(), tag.Writer().c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        iFirstAired, tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(),
-        tag.UniqueBroadcastID());
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
   }
   else
   {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
+    strQuery = "REPLACE INTO epgtags (idEpg, iStartTime, "
         "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
         "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
         "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid, idBroadcast) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, %i);",
-        tag.EpgID(), iStartTime, iEndTime,
-        tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(),
-        tag.OriginalTitle(true).c_str(), tag.Cast().c_str(), tag.Director().c_str(), tag.Writer().c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        iFirstAired, tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(),
-        tag.UniqueBroadcastID(), iBroadcastId);
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+    values.push_back(dbiplus::field_value(iBroadcastId));
   }
 
-  if (bSingleUpdate)
-  {
-    if (ExecuteQuery(strQuery))
-      iReturn = (int) m_pDS->lastinsertid();
-  }
-  else
-  {
-    QueueInsertQuery(strQuery);
-    iReturn = 0;
-  }
+  if (ExecuteQuery(strQuery, values))
+    iReturn = (int) m_pDS->lastinsertid();
 
   return iReturn;
 }
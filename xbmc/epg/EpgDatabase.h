@@ -135,8 +135,9 @@ namespace EPG
     /*!
      * @brief Persist an infotag.
      * @param tag The tag to persist.
-     * @param bSingleUpdate If true, this is a single update and the query will be executed immediately.
-     * @return The database ID of this entry or 0 if bSingleUpdate is false and the query was queued.
+     * @param bSingleUpdate False if more updates will follow. The query is executed immediately either way,
+     *                      callers writing many tags group them in a transaction with BeginBatch().
+     * @return The database ID of this entry or -1 if it couldn't be written.
      */
     virtual int Persist(const CEpgInfoTag &tag, bool bSingleUpdate = true);
 
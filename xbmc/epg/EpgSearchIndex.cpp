@@ -0,0 +1,253 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+#include "EpgInfoTag.h"
+#include "EpgSearchFilter.h"
+#include "EpgSearchIndex.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <iterator>
+
+/* removed ids are only dropped from the postings once there are more of them than live ones */
+#define EPG_SEARCH_INDEX_MIN_REMOVED 1024
+
+using namespace EPG;
+
+static void Intersect(std::vector<unsigned int> &left, const std::vector<unsigned int> &right)
+{
+  std::vector<unsigned int> result;
+  std::set_intersection(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(result));
+  left.swap(result);
+}
+
+static void Unite(std::vector<unsigned int> &left, const std::vector<unsigned int> &right)
+{
+  std::vector<unsigned int> result;
+  std::set_union(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(result));
+  left.swap(result);
+}
+
+CEpgSearchIndex::CEpgSearchIndex(void) :
+    m_iRemoved(0)
+{
+}
+
+void CEpgSearchIndex::Add(const CEpgInfoTagPtr &tag)
+{
+  if (!tag)
+    return;
+
+  if (m_ids.find(tag.get()) != m_ids.end())
+    Remove(tag);
+
+  unsigned int id = m_tags.size();
+  m_tags.push_back(tag);
+  m_ids.insert(std::make_pair(tag.get(), id));
+
+  std::vector<std::string> words;
+  Tokenize(tag->Title(true), words);
+  Tokenize(tag->PlotOutline(true), words);
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  /* ids only grow, so appending keeps the postings sorted */
+  for (std::vector<std::string>::const_iterator it = words.begin(); it != words.end(); ++it)
+    m_words[*it].push_back(id);
+  m_genres[tag->GenreType()].push_back(id);
+}
+
+void CEpgSearchIndex::Remove(const CEpgInfoTagPtr &tag)
+{
+  if (!tag)
+    return;
+
+  std::map<const CEpgInfoTag*, unsigned int>::iterator it = m_ids.find(tag.get());
+  if (it == m_ids.end())
+    return;
+
+  /* the id stays in the postings until the next compaction, lookups skip it */
+  m_tags[it->second].reset();
+  m_ids.erase(it);
+  m_iRemoved++;
+
+  if (m_iRemoved > EPG_SEARCH_INDEX_MIN_REMOVED && m_iRemoved > m_ids.size())
+    Compact();
+}
+
+void CEpgSearchIndex::Clear(void)
+{
+  m_tags.clear();
+  m_ids.clear();
+  m_words.clear();
+  m_genres.clear();
+  m_iRemoved = 0;
+}
+
+void CEpgSearchIndex::Compact(void)
+{
+  std::vector<CEpgInfoTagPtr> tags;
+  tags.reserve(m_ids.size());
+  for (std::vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  {
+    if (*it)
+      tags.push_back(*it);
+  }
+
+  Clear();
+  for (std::vector<CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
+    Add(*it);
+}
+
+bool CEpgSearchIndex::GetCandidates(const EpgSearchFilter &filter, std::vector<CEpgInfoTagPtr> &candidates) const
+{
+  Postings result;
+  bool bNarrowed(false);
+
+  if (!filter.m_strSearchTerm.empty())
+  {
+    /* use the same terms as EpgSearchFilter::MatchSearchTerm(). NOT terms can't narrow anything down */
+    CTextSearch search(filter.m_strSearchTerm, filter.m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
+
+    const std::vector<std::string> &orTerms = search.GetOrTerms();
+    Postings orResult;
+    bool bOrNarrowed(!orTerms.empty());
+    for (std::vector<std::string>::const_iterator it = orTerms.begin(); bOrNarrowed && it != orTerms.end(); ++it)
+    {
+      Postings term;
+      if (FindTerm(*it, term))
+        Unite(orResult, term);
+      else
+        bOrNarrowed = false;
+    }
+    if (bOrNarrowed)
+    {
+      result.swap(orResult);
+      bNarrowed = true;
+    }
+
+    const std::vector<std::string> &andTerms = search.GetAndTerms();
+    for (std::vector<std::string>::const_iterator it = andTerms.begin(); it != andTerms.end(); ++it)
+    {
+      Postings term;
+      if (!FindTerm(*it, term))
+        continue;
+
+      if (bNarrowed)
+        Intersect(result, term);
+      else
+        result.swap(term);
+      bNarrowed = true;
+    }
+  }
+
+  if (filter.m_iGenreType != EPG_SEARCH_UNSET && !filter.m_bIncludeUnknownGenres)
+  {
+    std::map<int, Postings>::const_iterator it = m_genres.find(filter.m_iGenreType);
+    if (it == m_genres.end())
+      result.clear();
+    else if (bNarrowed)
+      Intersect(result, it->second);
+    else
+      result = it->second;
+    bNarrowed = true;
+  }
+
+  if (!bNarrowed)
+    return false;
+
+  size_t iFirst = candidates.size();
+  for (Postings::const_iterator it = result.begin(); it != result.end(); ++it)
+  {
+    if (m_tags[*it])
+      candidates.push_back(m_tags[*it]);
+  }
+
+  std::sort(candidates.begin() + iFirst, candidates.end(), [](const CEpgInfoTagPtr &left, const CEpgInfoTagPtr &right)
+  {
+    return left->StartAsUTC() < right->StartAsUTC();
+  });
+
+  return true;
+}
+
+bool CEpgSearchIndex::FindTerm(const std::string &term, Postings &result) const
+{
+  std::vector<std::string> words;
+  Tokenize(term, words);
+  if (words.empty())
+    return false;
+
+  /* a term can be a quoted phrase, every one of its words has to start a word of the tag */
+  FindPrefix(words[0], result);
+  for (size_t i = 1; i < words.size() && !result.empty(); i++)
+  {
+    Postings word;
+    FindPrefix(words[i], word);
+    Intersect(result, word);
+  }
+
+  return true;
+}
+
+void CEpgSearchIndex::FindPrefix(const std::string &prefix, Postings &result) const
+{
+  result.clear();
+
+  unsigned int iWords(0);
+  std::map<std::string, Postings>::const_iterator it = m_words.lower_bound(prefix);
+  for (; it != m_words.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it, ++iWords)
+    result.insert(result.end(), it->second.begin(), it->second.end());
+
+  /* postings of a single word are sorted already */
+  if (iWords > 1)
+  {
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+  }
+}
+
+void CEpgSearchIndex::Tokenize(const std::string &text, std::vector<std::string> &words)
+{
+  std::string strLower(text);
+  StringUtils::ToLower(strLower);
+
+  /* bytes of multi-byte UTF-8 characters are part of words, so non-latin words stay intact */
+  std::string strWord;
+  for (std::string::const_iterator it = strLower.begin(); it != strLower.end(); ++it)
+  {
+    unsigned char c = (unsigned char)*it;
+    if (c >= 0x80 || isalnum(c))
+    {
+      strWord += *it;
+    }
+    else if (!strWord.empty())
+    {
+      words.push_back(strWord);
+      strWord.clear();
+    }
+  }
+
+  if (!strWord.empty())
+    words.push_back(strWord);
+}
@@ -0,0 +1,96 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EPG
+{
+  class CEpgInfoTag;
+  typedef std::shared_ptr<EPG::CEpgInfoTag> CEpgInfoTagPtr;
+
+  struct EpgSearchFilter;
+
+  /*!
+   * @brief Inverted index of the words in the titles and plot outlines of the tags of an EPG table.
+   *
+   * A search term matches the tags containing words that start with each of its words, so the
+   * index only narrows a search down to candidates which still have to pass
+   * EpgSearchFilter::FilterEntry(). The index isn't thread safe, CEpg guards it with its lock.
+   */
+  class CEpgSearchIndex
+  {
+  public:
+    CEpgSearchIndex(void);
+
+    /*!
+     * @brief Add a tag or re-index it after its title, plot outline or genre changed.
+     * @param tag The tag.
+     */
+    void Add(const CEpgInfoTagPtr &tag);
+
+    /*!
+     * @brief Remove a tag from the index.
+     * @param tag The tag.
+     */
+    void Remove(const CEpgInfoTagPtr &tag);
+
+    /*!
+     * @brief Remove all tags from the index.
+     */
+    void Clear(void);
+
+    /*!
+     * @return The amount of tags in the index.
+     */
+    size_t Size(void) const { return m_ids.size(); }
+
+    /*!
+     * @brief Get the tags that may match the search term and genre of a filter.
+     * @param filter The filter.
+     * @param candidates The candidates, ordered by start time.
+     * @return False if the index can't narrow down the filter, e.g. when it has no search term or genre.
+     */
+    bool GetCandidates(const EpgSearchFilter &filter, std::vector<CEpgInfoTagPtr> &candidates) const;
+
+    /*!
+     * @brief Split a text into lower case words.
+     * @param text The text.
+     * @param words The words, in order and including duplicates.
+     */
+    static void Tokenize(const std::string &text, std::vector<std::string> &words);
+
+  private:
+    typedef std::vector<unsigned int> Postings; ///< sorted ids of the tags containing a word
+
+    bool FindTerm(const std::string &term, Postings &result) const;
+    void FindPrefix(const std::string &prefix, Postings &result) const;
+    void Compact(void);
+
+    std::vector<CEpgInfoTagPtr>            m_tags;    /*!< the tags by id, empty when removed */
+    std::map<const CEpgInfoTag*, unsigned int> m_ids; /*!< the id of each indexed tag */
+    std::map<std::string, Postings>        m_words;   /*!< the tags by word, sorted for prefix lookups */
+    std::map<int, Postings>                m_genres;  /*!< the tags by genre type */
+    size_t                                 m_iRemoved; /*!< ids that are no longer used, but still in postings */
+  };
+}
@@ -413,6 +413,7 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
   posB += DrawOffsetB;
 
   int channel = chanOffset;
+  GridItemsPtr *focusedItem = GetGridItem(m_channelOffset + m_channelCursor, m_blockOffset + m_blockCursor);
 
   while (posB < endB && !m_channelItems.empty())
   {
@@ -422,29 +423,23 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
     // Free memory not used on screen
     FreeProgrammeMemory(channel, blockOffset - cacheBeforeProgramme, blockOffset + m_programmesPerPage + 1 + cacheAfterProgramme);
 
-    int block = blockOffset;
     float posA2 = posA;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
+    GridItemsPtr *gridItem = GetGridItem(channel, blockOffset);
+    if (gridItem)
     {
-      /* first program starts before current view */
-      int startBlock = blockOffset - 1;
-      while (startBlock >= 0 && m_gridIndex[channel][startBlock].item == item)
-        startBlock--;
-
-      block = startBlock + 1;
-      int missingSection = blockOffset - block;
+      /* first program may start before current view */
+      int missingSection = blockOffset - gridItem->startBlock;
       posA2 -= missingSection * m_blockSize;
     }
 
-    while (posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
+    while (gridItem && posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
+      CGUIListItemPtr item = gridItem->item;
       if (!item || !item.get()->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      bool focused = (channel == m_channelOffset + m_channelCursor) && (gridItem == focusedItem);
 
       // calculate the size to truncate if item is out of grid view
       float truncateSize = 0;
@@ -457,20 +452,25 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
       {
         CSingleLock lock(m_critSection);
         // truncate item's width
-        m_gridIndex[channel][block].width = m_gridIndex[channel][block].originWidth - truncateSize;
+        gridItem->width = gridItem->originWidth - truncateSize;
       }
 
-      ProcessItem(posA2, posB, item.get(), m_lastChannel, focused, m_programmeLayout, m_focusedProgrammeLayout, currentTime, dirtyregions, m_gridIndex[channel][block].width);
+      ProcessItem(posA2, posB, item.get(), m_lastChannel, focused, m_programmeLayout, m_focusedProgrammeLayout, currentTime, dirtyregions, gridItem->width);
 
       // increment our X position
-      posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-      block += (int)(m_gridIndex[channel][block].originWidth / m_blockSize);
+      posA2 += gridItem->width; // assumes focused & unfocused layouts have equal length
+      gridItem = GetGridItem(channel, gridItem->endBlock);
     }
 
     // increment our Y position
     channel++;
     posB += m_channelHeight;
   }
+
+  // Free rows of channels far from view
+  int cacheBeforeChannel, cacheAfterChannel;
+  GetChannelCacheOffsets(cacheBeforeChannel, cacheAfterChannel);
+  FreeGridIndexMemory(chanOffset - cacheBeforeChannel - m_channelsPerPage, channel + cacheAfterChannel + m_channelsPerPage);
 }
 
 void CGUIEPGGridContainer::RenderProgrammeGrid()
@@ -503,34 +503,29 @@ void CGUIEPGGridContainer::RenderProgrammeGrid()
   float focusedPosX = 0;
   float focusedPosY = 0;
   CGUIListItemPtr focusedItem;
+  GridItemsPtr *focusedGridItem = GetGridItem(m_channelOffset + m_channelCursor, m_blockOffset + m_blockCursor);
   while (posB < endB && !m_channelItems.empty())
   {
     if (channel >= (int)m_channelItems.size())
       break;
 
-    int block = blockOffset;
     float posA2 = posA;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
+    GridItemsPtr *gridItem = GetGridItem(channel, blockOffset);
+    if (gridItem)
     {
-      /* first program starts before current view */
-      int startBlock = blockOffset - 1;
-      while (startBlock >= 0 && m_gridIndex[channel][startBlock].item == item)
-        startBlock--;
-
-      block = startBlock + 1;
-      int missingSection = blockOffset - block;
+      /* first program may start before current view */
+      int missingSection = blockOffset - gridItem->startBlock;
       posA2 -= missingSection * m_blockSize;
     }
 
-    while (posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
+    while (gridItem && posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
+      CGUIListItemPtr item = gridItem->item;
       if (!item || !item.get()->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      bool focused = (channel == m_channelOffset + m_channelCursor) && (gridItem == focusedGridItem);
 
       // reset to grid start position if first item is out of grid view
       if (posA2 < posA)
@@ -549,8 +544,8 @@ void CGUIEPGGridContainer::RenderProgrammeGrid()
       }
 
       // increment our X position
-      posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-      block += (int)(m_gridIndex[channel][block].originWidth / m_blockSize);
+      posA2 += gridItem->width; // assumes focused & unfocused layouts have equal length
+      gridItem = GetGridItem(channel, gridItem->endBlock);
     }
 
     // increment our Y position
@@ -854,12 +849,8 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
             m_epgItemsPtr.push_back(itemsPointer);
           }
 
-          m_gridIndex.reserve(m_channelItems.size());
-          for (unsigned int i = 0; i < m_channelItems.size(); i++)
-          {
-            std::vector<GridItemsPtr> blocks(MAXBLOCKS);
-            m_gridIndex.push_back(blocks);
-          }
+          /* Rows of the grid are built when shown */
+          m_gridIndex.resize(m_channelItems.size());
 
           FreeItemsMemory();
           UpdateLayout();
@@ -882,6 +873,7 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
           UpdateItems();
 
           m_channels = m_epgItemsPtr.size();
+          m_item = GetItem(m_channelCursor);
 
           if (prevSelectedEpgTag)
           {
@@ -968,93 +960,133 @@ void CGUIEPGGridContainer::UpdateItems()
     return;
   }
 
-  CDateTimeSpan blockDuration;
-  blockDuration.SetDateTimeSpan(0, 0, MINSPERBLOCK, 0);
+  CLog::Log(LOGDEBUG, "CGUIEPGGridContainer - %s - %u channels, %d blocks", __FUNCTION__, (unsigned int)m_epgItemsPtr.size(), m_blocks);
+}
+
+std::vector<GridItemsPtr> &CGUIEPGGridContainer::GetGridRow(int channel) const
+{
+  std::vector<GridItemsPtr> &row = m_gridIndex[channel];
+  if (row.empty())
+  {
+    CSingleLock lock(m_critSection);
+    BuildGridRow(channel, row);
+  }
+  return row;
+}
+
+void CGUIEPGGridContainer::BuildGridRow(int channel, std::vector<GridItemsPtr> &row) const
+{
+  if (m_blocks <= 0 || channel >= (int)m_epgItemsPtr.size())
+    return;
+
+  unsigned long progIdx     = m_epgItemsPtr[channel].start;
+  unsigned long lastIdx     = m_epgItemsPtr[channel].stop;
+  const CEpgInfoTagPtr info = ((CFileItem *)m_programmeItems[progIdx].get())->GetEPGInfoTag();
+  int iEpgId                = info ? info->EpgID() : -1;
+  int blockSeconds          = MINSPERBLOCK * 60;
 
-  long tick(XbmcThreads::SystemClockMillis());
+  GridItemsPtr gridItem;
+  gridItem.originHeight = gridItem.height = m_channelHeight;
 
-  for (unsigned int row = 0; row < m_epgItemsPtr.size(); ++row)
+  /* programmes cover the blocks starting within their time, an earlier programme keeps the blocks it overlaps */
+  int nextBlock = 0;
+  for (; progIdx <= lastIdx && nextBlock < m_blocks; progIdx++)
   {
-    CDateTime gridCursor      = m_gridStart; //reset cursor for new channel
-    unsigned long progIdx     = m_epgItemsPtr[row].start;
-    unsigned long lastIdx     = m_epgItemsPtr[row].stop;
-    const CEpgInfoTagPtr info = ((CFileItem *)m_programmeItems[progIdx].get())->GetEPGInfoTag();
-    int iEpgId                = info ? info->EpgID() : -1;
+    CGUIListItemPtr item = m_programmeItems[progIdx];
+    const CEpgInfoTagPtr tag(((CFileItem *)item.get())->GetEPGInfoTag());
+    if (!tag)
+      continue;
+    if (tag->EpgID() != iEpgId || m_gridEnd <= tag->StartAsUTC())
+      break;
 
-    /** FOR EACH BLOCK **********************************************************************/
+    int startSeconds = (tag->StartAsUTC() - m_gridStart).GetSecondsTotal();
+    int endSeconds   = (tag->EndAsUTC() - m_gridStart).GetSecondsTotal();
+    int startBlock   = std::max(nextBlock, startSeconds > 0 ? (startSeconds + blockSeconds - 1) / blockSeconds : 0);
+    int endBlock     = std::min(m_blocks, endSeconds > 0 ? (endSeconds + blockSeconds - 1) / blockSeconds : 0);
+    if (endBlock <= startBlock)
+      continue;
 
-    for (int block = 0; block < m_blocks; block++)
+    if (startBlock > nextBlock)
     {
-      while (progIdx <= lastIdx)
-      {
-        CGUIListItemPtr item = m_programmeItems[progIdx];
-        const CEpgInfoTagPtr tag(((CFileItem *)item.get())->GetEPGInfoTag());
-        if (!tag)
-        {
-          progIdx++;
-          continue;
-        }
+      gridItem.item.reset(new CFileItem(CEpgInfoTag::CreateDefaultTag()));
+      gridItem.startBlock = nextBlock;
+      gridItem.endBlock = startBlock;
+      gridItem.originWidth = gridItem.width = (startBlock - nextBlock) * m_blockSize;
+      row.push_back(gridItem);
+    }
 
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break;
+    item->SetProperty("GenreType", tag->GenreType());
+    gridItem.item = item;
+    gridItem.startBlock = startBlock;
+    gridItem.endBlock = endBlock;
+    gridItem.originWidth = gridItem.width = (endBlock - startBlock) * m_blockSize;
+    row.push_back(gridItem);
 
-        if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[row][block].item = item;
-          break;
-        }
+    nextBlock = endBlock;
+  }
 
-        progIdx++;
-      }
+  if (nextBlock < m_blocks)
+  {
+    gridItem.item.reset(new CFileItem(CEpgInfoTag::CreateDefaultTag()));
+    gridItem.startBlock = nextBlock;
+    gridItem.endBlock = m_blocks;
+    gridItem.originWidth = gridItem.width = (m_blocks - nextBlock) * m_blockSize;
+    row.push_back(gridItem);
+  }
+}
 
-      gridCursor += blockDuration;
-    }
+GridItemsPtr *CGUIEPGGridContainer::GetGridItem(int channel, int block) const
+{
+  if (channel < 0 || channel >= (int)m_gridIndex.size() || block < 0 || block >= m_blocks)
+    return NULL;
 
-    /** FOR EACH BLOCK **********************************************************************/
-    int itemSize = 1; // size of the programme in blocks
-    int savedBlock = 0;
+  std::vector<GridItemsPtr> &row = GetGridRow(channel);
 
-    for (int block = 0; block < m_blocks; block++)
+  // the last item starting at or before the block
+  int first = 0;
+  int count = (int)row.size();
+  while (count > 0)
+  {
+    int step = count / 2;
+    if (row[first + step].startBlock <= block)
     {
-      CGUIListItemPtr item = m_gridIndex[row][block].item;
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
 
-      if (item != m_gridIndex[row][block+1].item)
-      {
-        if (!item)
-        {
-          CEpgInfoTagPtr gapTag(CEpgInfoTag::CreateDefaultTag());
-          CFileItemPtr gapItem(new CFileItem(gapTag));
-          for (int i = block ; i > block - itemSize; i--)
-          {
-            m_gridIndex[row][i].item = gapItem;
-          }
-        }
-        else
-        {
-          const CEpgInfoTagPtr tag(((CFileItem *)item.get())->GetEPGInfoTag());
-          if (tag)
-            m_gridIndex[row][savedBlock].item->SetProperty("GenreType", tag->GenreType());
-        }
+  if (first == 0)
+    return NULL;
+  return &row[first - 1];
+}
+
+void CGUIEPGGridContainer::FreeGridIndexMemory(int keepStart, int keepEnd)
+{
+  CSingleLock lock(m_critSection);
 
-        m_gridIndex[row][savedBlock].originWidth = itemSize*m_blockSize;
-        m_gridIndex[row][savedBlock].originHeight = m_channelHeight;
+  for (int channel = 0; channel < (int)m_gridIndex.size(); ++channel)
+  {
+    if (channel >= keepStart && channel <= keepEnd)
+      continue;
 
-        m_gridIndex[row][savedBlock].width = m_gridIndex[row][savedBlock].originWidth;
-        m_gridIndex[row][savedBlock].height = m_gridIndex[row][savedBlock].originHeight;
+    std::vector<GridItemsPtr> &row = m_gridIndex[channel];
+    if (row.empty() || (m_item >= &row.front() && m_item <= &row.back()))
+      continue; // the selected item stays valid
 
-        itemSize = 1;
-        savedBlock = block+1;
-      }
-      else
-      {
-        itemSize++;
-      }
-    }
+    std::vector<GridItemsPtr>().swap(row);
   }
+}
+
+void CGUIEPGGridContainer::ResetGridIndex()
+{
+  CSingleLock lock(m_critSection);
 
-  /******************************************* END ******************************************/
+  for (unsigned int i = 0; i < m_gridIndex.size(); i++)
+    std::vector<GridItemsPtr>().swap(m_gridIndex[i]);
 
-  CLog::Log(LOGDEBUG, "CGUIEPGGridContainer - %s completed successfully in %u ms", __FUNCTION__, (unsigned int)(XbmcThreads::SystemClockMillis()-tick));
+  m_item = GetItem(m_channelCursor);
 }
 
 void CGUIEPGGridContainer::ChannelScroll(int amount)
@@ -1133,7 +1165,7 @@ void CGUIEPGGridContainer::OnLeft()
   if (!m_gridIndex.empty() && m_item)
   {
     if (m_channelCursor + m_channelOffset >= 0 && m_blockOffset >= 0 &&
-        m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blockOffset].item)
+        m_item != GetGridItem(m_channelCursor + m_channelOffset, m_blockOffset))
     {
       // this is not first item on page
       m_item = GetPrevItem(m_channelCursor);
@@ -1158,7 +1190,7 @@ void CGUIEPGGridContainer::OnRight()
 {
   if (!m_gridIndex.empty() && m_item)
   {
-    if (m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blocksPerPage + m_blockOffset - 1].item)
+    if (m_item != GetGridItem(m_channelCursor + m_channelOffset, m_blocksPerPage + m_blockOffset - 1))
     {
       // this is not last item on page
       m_item = GetNextItem(m_channelCursor);
@@ -1281,7 +1313,8 @@ bool CGUIEPGGridContainer::SelectItemFromPoint(const CPoint &point, bool justGri
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return false;
   // bail if block isn't occupied
-  if (!m_gridIndex[channelIndex][blockIndex].item)
+  GridItemsPtr *gridItem = GetGridItem(channelIndex, blockIndex);
+  if (!gridItem || !gridItem->item)
     return false;
 
   SetChannel(channel);
@@ -1469,10 +1502,12 @@ int CGUIEPGGridContainer::GetSelectedItem() const
       m_blockCursor + m_blockOffset >= m_blocks)
     return -1;
 
-  CGUIListItemPtr currentItem = m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item;
-  if (!currentItem)
+  GridItemsPtr *gridItem = GetGridItem(m_channelCursor + m_channelOffset, m_blockCursor + m_blockOffset);
+  if (!gridItem || !gridItem->item)
     return -1;
 
+  CGUIListItemPtr currentItem = gridItem->item;
+
   for (int i = 0; i < (int)m_programmeItems.size(); i++)
   {
     if (currentItem == m_programmeItems[i])
@@ -1495,9 +1530,9 @@ CEpgInfoTagPtr CGUIEPGGridContainer::GetSelectedEpgInfoTag() const
       m_channelCursor + m_channelOffset < m_channels &&
       m_blockCursor + m_blockOffset < m_blocks)
   {
-    CGUIListItemPtr currentItem(m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item);
-    if (currentItem)
-      tag = static_cast<CFileItem *>(currentItem.get())->GetEPGInfoTag();
+    GridItemsPtr *gridItem = GetGridItem(m_channelCursor + m_channelOffset, m_blockCursor + m_blockOffset);
+    if (gridItem && gridItem->item)
+      tag = static_cast<CFileItem *>(gridItem->item.get())->GetEPGInfoTag();
   }
 
   return tag;
@@ -1505,15 +1540,16 @@ CEpgInfoTagPtr CGUIEPGGridContainer::GetSelectedEpgInfoTag() const
 
 int CGUIEPGGridContainer::GetBlock(const CEpgInfoTagPtr &tag, int channel) const
 {
-  for (int block = 0; block < m_blocks; ++block)
+  int channelIndex = channel + m_channelOffset;
+  if (channelIndex < 0 || channelIndex >= (int)m_gridIndex.size())
+    return -1;
+
+  const std::vector<GridItemsPtr> &row = GetGridRow(channelIndex);
+  for (std::vector<GridItemsPtr>::const_iterator it = row.begin(); it != row.end(); ++it)
   {
-    CGUIListItemPtr item = m_gridIndex[channel + m_channelOffset][block].item;
-    if (item)
-    {
-      CEpgInfoTagPtr currentTag(static_cast<CFileItem *>(item.get())->GetEPGInfoTag());
-      if (currentTag == tag)
-        return (block - m_blockOffset >= 0) ? block - m_blockOffset : 0;
-    }
+    CEpgInfoTagPtr currentTag(static_cast<CFileItem *>(it->item.get())->GetEPGInfoTag());
+    if (currentTag == tag)
+      return (it->startBlock - m_blockOffset >= 0) ? it->startBlock - m_blockOffset : 0;
   }
 
   return -1;
@@ -1524,23 +1560,11 @@ int CGUIEPGGridContainer::GetChannel(const CEpgInfoTagPtr &tag) const
   if (tag->HasPVRChannel())
   {
     int channelId = tag->ChannelTag()->ChannelID();
-    for (int row = 0; row < m_channels; ++row)
+    for (int row = 0; row < m_channels && row < (int)m_channelItems.size(); ++row)
     {
-      for (int block = 0; block < m_blocks; ++block)
-      {
-        CGUIListItemPtr item = m_gridIndex[row][block].item;
-        if (item)
-        {
-          CEpgInfoTagPtr currentTag(static_cast<CFileItem *>(item.get())->GetEPGInfoTag());
-          if (currentTag->HasPVRChannel()) // Take care. Gap tags have no channel.
-          {
-            if (currentTag->ChannelTag()->ChannelID() == channelId)
-              return (row - m_channelOffset >= 0) ? row - m_channelOffset : 0;
-            else
-              break;
-          }
-        }
-      }
+      const CFileItem *channelItem = static_cast<const CFileItem *>(m_channelItems[row].get());
+      if (channelItem->HasPVRChannelInfoTag() && channelItem->GetPVRChannelInfoTag()->ChannelID() == channelId)
+        return (row - m_channelOffset >= 0) ? row - m_channelOffset : 0;
     }
   }
 
@@ -1622,9 +1646,9 @@ GridItemsPtr *CGUIEPGGridContainer::GetClosestItem(const int &channel)
   }
 
   if (right <= SHORTGAP && right <= left && m_blockCursor + right < m_blocksPerPage)
-    return &m_gridIndex[channel + m_channelOffset][m_blockCursor + right + m_blockOffset];
+    return GetGridItem(channel + m_channelOffset, m_blockCursor + right + m_blockOffset);
 
-  return &m_gridIndex[channel + m_channelOffset][m_blockCursor - left  + m_blockOffset];
+  return GetGridItem(channel + m_channelOffset, m_blockCursor - left  + m_blockOffset);
 }
 
 int CGUIEPGGridContainer::GetItemSize(GridItemsPtr *item)
@@ -1646,42 +1670,45 @@ int CGUIEPGGridContainer::GetBlock(const CGUIListItemPtr &item, const int &chann
 int CGUIEPGGridContainer::GetRealBlock(const CGUIListItemPtr &item, const int &channel)
 {
   int channelIndex = channel + m_channelOffset;
-  int block = 0;
+  if (channelIndex < 0 || channelIndex >= (int)m_gridIndex.size())
+    return m_blocks;
 
-  while (m_gridIndex[channelIndex][block].item != item && block < m_blocks)
-    block++;
+  const std::vector<GridItemsPtr> &row = GetGridRow(channelIndex);
+  for (std::vector<GridItemsPtr>::const_iterator it = row.begin(); it != row.end(); ++it)
+  {
+    if (it->item == item)
+      return it->startBlock;
+  }
 
-  return block;
+  return m_blocks;
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetNextItem(const int &channel)
 {
   int channelIndex = channel + m_channelOffset;
   int blockIndex = m_blockCursor + m_blockOffset;
-  if (channelIndex >= m_channels || blockIndex >= m_blocks)
+  GridItemsPtr *current = GetGridItem(channelIndex, blockIndex);
+  if (!current)
     return NULL;
 
-  int i = m_blockCursor;
-
-  while (i < m_blocksPerPage && m_gridIndex[channelIndex][i + m_blockOffset].item == m_gridIndex[channelIndex][blockIndex].item)
-    i++;
-
-  return &m_gridIndex[channelIndex][i + m_blockOffset];
+  // the next item if it starts on this page, else the block at the end of the page
+  int block = std::min(current->endBlock, m_blocksPerPage + m_blockOffset);
+  GridItemsPtr *next = GetGridItem(channelIndex, block);
+  return next ? next : current;
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetPrevItem(const int &channel)
 {
   int channelIndex = channel + m_channelOffset;
   int blockIndex = m_blockCursor + m_blockOffset;
-  if (channelIndex >= m_channels || blockIndex >= m_blocks)
+  GridItemsPtr *current = GetGridItem(channelIndex, blockIndex);
+  if (!current)
     return NULL;
 
-  int i = m_blockCursor;
-
-  while (i > 0 && m_gridIndex[channelIndex][i + m_blockOffset].item == m_gridIndex[channelIndex][blockIndex].item)
-    i--;
-
-  return &m_gridIndex[channelIndex][i + m_blockOffset];
+  // the previous item if it ends on this page, else the first block of the page
+  int block = std::max(current->startBlock - 1, m_blockOffset);
+  GridItemsPtr *prev = GetGridItem(channelIndex, block);
+  return prev ? prev : current;
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
@@ -1691,7 +1718,7 @@ GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return NULL;
 
-  return &m_gridIndex[channelIndex][blockIndex];
+  return GetGridItem(channelIndex, blockIndex);
 }
 
 void CGUIEPGGridContainer::SetFocus(bool focus)
@@ -1857,14 +1884,14 @@ void CGUIEPGGridContainer::ClearGridIndex(void)
 {
   for (unsigned int i = 0; i < m_gridIndex.size(); i++)
   {
-    for (int block = 0; block < m_blocks; block++)
+    for (std::vector<GridItemsPtr>::iterator it = m_gridIndex[i].begin(); it != m_gridIndex[i].end(); ++it)
     {
-      if (m_gridIndex[i][block].item)
-        m_gridIndex[i][block].item.get()->ClearProperties();
+      if (it->item)
+        it->item.get()->ClearProperties();
     }
-    m_gridIndex[i].clear();
   }
   m_gridIndex.clear();
+  m_item = NULL;
 }
 
 void CGUIEPGGridContainer::Reset()
@@ -1892,13 +1919,11 @@ void CGUIEPGGridContainer::GoToEnd()
   int blocksEnd = 0;   // the end block of the last epg element for the selected channel
   int blocksStart = 0; // the start block of the last epg element for the selected channel
   int blockOffset = 0; // the block offset to scroll to
-  for (int blockIndex = m_blocks; blockIndex >= 0 && (!blocksEnd || !blocksStart); blockIndex--)
+  GridItemsPtr *last = GetGridItem(m_channelCursor + m_channelOffset, m_blocks - 1);
+  if (last)
   {
-    if (!blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item != NULL)
-      blocksEnd = blockIndex;
-    if (blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blocksEnd].item !=
-                     m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item)
-      blocksStart = blockIndex + 1;
+    blocksEnd = last->endBlock - 1;
+    blocksStart = last->startBlock;
   }
   if (blocksEnd - blocksStart > m_blocksPerPage)
     blockOffset = blocksStart;
@@ -1958,6 +1983,9 @@ void CGUIEPGGridContainer::UpdateLayout()
   m_channelsPerPage   = (int)(m_gridHeight / m_channelHeight);
   m_programmesPerPage = (int)(m_gridWidth / m_blockSize) + 1;
 
+  // rows are sized for the layout they were built with
+  ResetGridIndex();
+
   // ensure that the scroll offsets are a multiple of our sizes
   m_channelScrollOffset   = m_channelOffset * m_programmeLayout->Size(VERTICAL);
   m_programmeScrollOffset = m_blockOffset * m_blockSize;
@@ -2085,42 +2113,15 @@ void CGUIEPGGridContainer::FreeProgrammeMemory(int channel, int keepStart, int k
 {
   if (keepStart < keepEnd)
   { // remove before keepStart and after keepEnd
-    if (keepStart > 0 && keepStart < m_blocks)
-    {
-      // if item exist and block is not part of visible item
-      CGUIListItemPtr last = m_gridIndex[channel][keepStart].item;
-      for (int i = keepStart - 1 ; i > 0 ; i--)
-      {
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          CSingleLock lock(m_critSection);
-
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that ocupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
-    }
+    CSingleLock lock(m_critSection);
 
-    if (keepEnd > 0 && keepEnd < m_blocks)
+    // items that are partially visible are kept
+    std::vector<GridItemsPtr> &row = GetGridRow(channel);
+    for (std::vector<GridItemsPtr>::iterator it = row.begin(); it != row.end(); ++it)
     {
-      CGUIListItemPtr last = m_gridIndex[channel][keepEnd].item;
-      for (int i = keepEnd + 1 ; i < m_blocks ; i++)
-      {
-        // if item exist and block is not part of visible item
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          CSingleLock lock(m_critSection);
-
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that ocupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
+      if ((keepStart > 0 && keepStart < m_blocks && it->endBlock <= keepStart) ||
+          (keepEnd > 0 && keepEnd < m_blocks && it->startBlock > keepEnd))
+        it->item->FreeMemory();
     }
   }
 }
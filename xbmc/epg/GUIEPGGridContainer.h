@@ -30,9 +30,14 @@ namespace EPG
   #define MAXCHANNELS 20
   #define MAXBLOCKS   (33 * 24 * 60 / 5) //! 33 days of 5 minute blocks (31 days for upcoming data + 1 day for past data + 1 day for fillers)
 
+  /*!
+   \brief A programme or a gap in a channel row of the grid, spanning one or more blocks
+   */
   struct GridItemsPtr
   {
     CGUIListItemPtr item;
+    int startBlock; //! first block of the item
+    int endBlock;   //! block after the last block of the item
     float originWidth;
     float originHeight;
     float width;
@@ -107,6 +112,16 @@ namespace EPG
     void Reset();
     void ClearGridIndex(void);
 
+    /*!
+     \brief Get the item of a channel row at a block, building the row if needed
+     \return the item or NULL if the channel or block is out of range
+     */
+    GridItemsPtr *GetGridItem(int channel, int block) const;
+    std::vector<GridItemsPtr> &GetGridRow(int channel) const;
+    void BuildGridRow(int channel, std::vector<GridItemsPtr> &row) const;
+    void FreeGridIndexMemory(int keepStart, int keepEnd);
+    void ResetGridIndex();
+
     GridItemsPtr *GetItem(const int &channel);
     GridItemsPtr *GetNextItem(const int &channel);
     GridItemsPtr *GetPrevItem(const int &channel);
@@ -212,7 +227,12 @@ namespace EPG
 
     CGUITexture m_guiProgressIndicatorTexture;
 
-    std::vector<std::vector<GridItemsPtr> > m_gridIndex;
+    /*!
+     Rows of the grid by channel, sorted by start block and covering all blocks, gaps included.
+     Rows are built when first shown and freed when scrolled far out of view, so the memory
+     used and the time to bind new items only depend on the channels shown.
+     */
+    mutable std::vector<std::vector<GridItemsPtr> > m_gridIndex;
     GridItemsPtr *m_item;
     CGUIListItem *m_lastItem;
     CGUIListItem *m_lastChannel;
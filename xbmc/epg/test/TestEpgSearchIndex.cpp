@@ -0,0 +1,272 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "XBDateTime.h"
+#include "addons/include/xbmc_epg_types.h"
+#include "epg/Epg.h"
+#include "epg/EpgSearchIndex.h"
+#include "utils/TimeUtils.h"
+
+#include <iostream>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+using namespace EPG;
+
+namespace
+{
+// tags are created by their table, which adds or updates the tag with the same start time
+CEpgInfoTagPtr CreateTag(CEpg &epg, time_t start, const char *title, const char *plotOutline = "", int genreType = 0)
+{
+  EPG_TAG data;
+  memset(&data, 0, sizeof(data));
+  data.strTitle = title;
+  data.strPlotOutline = plotOutline;
+  data.startTime = start;
+  data.endTime = start + 600;
+  data.iGenreType = genreType;
+  epg.UpdateEntry(&data);
+  return epg.GetTag(CDateTime(start));
+}
+
+EpgSearchFilter CreateFilter(const std::string &term, int genreType = EPG_SEARCH_UNSET)
+{
+  // not Reset(), that needs the EPG container
+  EpgSearchFilter filter;
+  filter.m_strSearchTerm = term;
+  filter.m_bIsCaseSensitive = false;
+  filter.m_bSearchInDescription = false;
+  filter.m_iGenreType = genreType;
+  filter.m_iGenreSubType = EPG_SEARCH_UNSET;
+  filter.m_iMinimumDuration = EPG_SEARCH_UNSET;
+  filter.m_iMaximumDuration = EPG_SEARCH_UNSET;
+  filter.m_startDateTime.SetDateTime(1970, 1, 1, 0, 0, 0);
+  filter.m_endDateTime.SetDateTime(2100, 1, 1, 0, 0, 0);
+  filter.m_bIncludeUnknownGenres = false;
+  filter.m_bPreventRepeats = false;
+  filter.m_bIsRadio = false;
+  filter.m_iChannelNumber = EPG_SEARCH_UNSET;
+  filter.m_bFTAOnly = false;
+  filter.m_iChannelGroup = EPG_SEARCH_UNSET;
+  filter.m_bIgnorePresentTimers = false;
+  filter.m_bIgnorePresentRecordings = false;
+  filter.m_iUniqueBroadcastId = EPG_SEARCH_UNSET;
+  return filter;
+}
+
+size_t CountCandidates(const CEpgSearchIndex &index, const std::string &term, int genreType = EPG_SEARCH_UNSET)
+{
+  std::vector<CEpgInfoTagPtr> candidates;
+  EXPECT_TRUE(index.GetCandidates(CreateFilter(term, genreType), candidates)) << term;
+  return candidates.size();
+}
+
+class TestEpgSearchIndex : public ::testing::Test
+{
+protected:
+  TestEpgSearchIndex() : m_epg(1, "test")
+  {
+    m_tags.push_back(CreateTag(m_epg, 3000, "Football Live", "", EPG_EVENT_CONTENTMASK_SPORTS));
+    m_tags.push_back(CreateTag(m_epg, 1000, "Star Trek", "A space adventure", EPG_EVENT_CONTENTMASK_MOVIEDRAMA));
+    m_tags.push_back(CreateTag(m_epg, 2000, "The Football Show", "Highlights of the week", EPG_EVENT_CONTENTMASK_SPORTS));
+    m_tags.push_back(CreateTag(m_epg, 4000, "News", "World news", EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS));
+    for (std::vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+      m_index.Add(*it);
+  }
+
+  CEpg m_epg;
+  std::vector<CEpgInfoTagPtr> m_tags;
+  CEpgSearchIndex m_index;
+};
+}
+
+TEST(TestEpgSearchIndexTokenize, Words)
+{
+  std::vector<std::string> words;
+  CEpgSearchIndex::Tokenize("Star Trek: The Next-Generation (1987)", words);
+  ASSERT_EQ(6U, words.size());
+  EXPECT_EQ("star", words[0]);
+  EXPECT_EQ("trek", words[1]);
+  EXPECT_EQ("generation", words[4]);
+  EXPECT_EQ("1987", words[5]);
+
+  words.clear();
+  CEpgSearchIndex::Tokenize("  O'Brien & Co.  ", words);
+  ASSERT_EQ(3U, words.size());
+  EXPECT_EQ("o", words[0]);
+  EXPECT_EQ("brien", words[1]);
+  EXPECT_EQ("co", words[2]);
+
+  // multi-byte characters stay part of the word
+  words.clear();
+  CEpgSearchIndex::Tokenize("Tatort M\xc3\xbcnster", words);
+  ASSERT_EQ(2U, words.size());
+  EXPECT_EQ("m\xc3\xbcnster", words[1]);
+}
+
+TEST_F(TestEpgSearchIndex, Prefixes)
+{
+  EXPECT_EQ(2U, CountCandidates(m_index, "foot"));
+  EXPECT_EQ(2U, CountCandidates(m_index, "FOOTBALL"));
+  EXPECT_EQ(0U, CountCandidates(m_index, "ball"));
+  EXPECT_EQ(1U, CountCandidates(m_index, "advent"));
+  EXPECT_EQ(1U, CountCandidates(m_index, "\"football sh\""));
+}
+
+TEST_F(TestEpgSearchIndex, Terms)
+{
+  EXPECT_EQ(3U, CountCandidates(m_index, "star football"));
+  EXPECT_EQ(1U, CountCandidates(m_index, "star + space"));
+  EXPECT_EQ(0U, CountCandidates(m_index, "star + week"));
+  EXPECT_EQ(2U, CountCandidates(m_index, "football !live"));
+
+  // without words to look up the index can't narrow anything down
+  std::vector<CEpgInfoTagPtr> candidates;
+  EXPECT_FALSE(m_index.GetCandidates(CreateFilter("!football"), candidates));
+  EXPECT_FALSE(m_index.GetCandidates(CreateFilter("star | &"), candidates));
+  EXPECT_FALSE(m_index.GetCandidates(CreateFilter(""), candidates));
+  EXPECT_TRUE(candidates.empty());
+}
+
+TEST_F(TestEpgSearchIndex, Genres)
+{
+  EXPECT_EQ(2U, CountCandidates(m_index, "", EPG_EVENT_CONTENTMASK_SPORTS));
+  EXPECT_EQ(1U, CountCandidates(m_index, "show", EPG_EVENT_CONTENTMASK_SPORTS));
+  EXPECT_EQ(0U, CountCandidates(m_index, "star", EPG_EVENT_CONTENTMASK_SPORTS));
+  EXPECT_EQ(0U, CountCandidates(m_index, "", EPG_EVENT_CONTENTMASK_MUSICBALLETDANCE));
+
+  // unknown genres may match as well, which the index doesn't know about
+  EpgSearchFilter filter = CreateFilter("", EPG_EVENT_CONTENTMASK_SPORTS);
+  filter.m_bIncludeUnknownGenres = true;
+  std::vector<CEpgInfoTagPtr> candidates;
+  EXPECT_FALSE(m_index.GetCandidates(filter, candidates));
+}
+
+TEST_F(TestEpgSearchIndex, StartTimeOrder)
+{
+  std::vector<CEpgInfoTagPtr> candidates;
+  ASSERT_TRUE(m_index.GetCandidates(CreateFilter("football star"), candidates));
+  ASSERT_EQ(3U, candidates.size());
+  EXPECT_EQ(m_tags[1], candidates[0]);
+  EXPECT_EQ(m_tags[2], candidates[1]);
+  EXPECT_EQ(m_tags[0], candidates[2]);
+}
+
+TEST_F(TestEpgSearchIndex, Updates)
+{
+  EXPECT_EQ(4U, m_index.Size());
+
+  m_index.Remove(m_tags[0]);
+  EXPECT_EQ(3U, m_index.Size());
+  EXPECT_EQ(1U, CountCandidates(m_index, "football"));
+  m_index.Remove(m_tags[0]);
+  EXPECT_EQ(3U, m_index.Size());
+
+  // adding a tag again re-indexes it
+  EXPECT_EQ(m_tags[3], CreateTag(m_epg, 4000, "Football Extra"));
+  m_index.Add(m_tags[3]);
+  EXPECT_EQ(3U, m_index.Size());
+  EXPECT_EQ(2U, CountCandidates(m_index, "football"));
+  EXPECT_EQ(0U, CountCandidates(m_index, "news"));
+
+  m_index.Clear();
+  EXPECT_EQ(0U, m_index.Size());
+  EXPECT_EQ(0U, CountCandidates(m_index, "football"));
+}
+
+TEST_F(TestEpgSearchIndex, Compaction)
+{
+  std::vector<CEpgInfoTagPtr> tags;
+  for (int i = 0; i < 3000; i++)
+  {
+    tags.push_back(CreateTag(m_epg, 10000 + i * 600, i % 2 ? "Odd" : "Even"));
+    m_index.Add(tags.back());
+  }
+  for (int i = 0; i < 2500; i++)
+    m_index.Remove(tags[i]);
+
+  EXPECT_EQ(504U, m_index.Size());
+  EXPECT_EQ(250U, CountCandidates(m_index, "odd"));
+  EXPECT_EQ(2U, CountCandidates(m_index, "football"));
+}
+
+// A guide of 1,000 channels with two weeks of 10 minute events, 2 million events in total. It needs
+// a few GB of memory, run it with --gtest_also_run_disabled_tests
+TEST(TestEpgSearchIndexBenchmark, DISABLED_Guide)
+{
+  const int channels = 1000;
+  const int events = 14 * 24 * 6;
+  const char *words[] = { "news", "weather", "football", "tennis", "documentary", "nature", "cooking",
+                          "quiz", "drama", "comedy", "crime", "history", "science", "travel", "music",
+                          "concert", "cartoon", "kids", "movie", "western", "thriller", "romance" };
+  const unsigned int wordCount = sizeof(words) / sizeof(words[0]);
+
+  std::vector<CEpg*> guide;
+  std::vector<CEpgInfoTagPtr> tags;
+  tags.reserve(channels * events);
+  time_t now = time(NULL);
+  unsigned int random = 1;
+  int64_t start = CurrentHostCounter();
+  for (int channel = 0; channel < channels; channel++)
+  {
+    guide.push_back(new CEpg(channel + 1, "benchmark"));
+    for (int event = 0; event < events; event++)
+    {
+      std::string title, plotOutline;
+      for (int i = 0; i < 8; i++)
+      {
+        random = random * 1103515245 + 12345;
+        std::string &text = i < 2 ? title : plotOutline;
+        text += std::string(words[(random >> 16) % wordCount]) + " ";
+      }
+      tags.push_back(CreateTag(*guide.back(), now + event * 600, title.c_str(), plotOutline.c_str(), (random >> 8) % 11 * 16));
+    }
+  }
+  double build = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  EpgSearchFilter filter = CreateFilter("\"documentary nature\"");
+
+  // the way searches were done before, matching the term against every tag
+  start = CurrentHostCounter();
+  int scanned = 0;
+  for (std::vector<CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
+  {
+    if (filter.MatchSearchTerm(**it))
+      scanned++;
+  }
+  double scan = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  start = CurrentHostCounter();
+  CFileItemList results;
+  for (std::vector<CEpg*>::const_iterator it = guide.begin(); it != guide.end(); ++it)
+    (*it)->Get(results, filter);
+  double indexed = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  EXPECT_EQ(scanned, results.Size());
+  std::cout << tags.size() << " events added and indexed in " << build << " ms. Search for " << filter.m_strSearchTerm
+            << ": " << results.Size() << " results in " << indexed << " ms, matching every tag " << scan << " ms" << std::endl;
+
+  results.Clear();
+  tags.clear();
+  for (std::vector<CEpg*>::const_iterator it = guide.begin(); it != guide.end(); ++it)
+    delete *it;
+}
@@ -0,0 +1,398 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string.h>
+#include "threads/SystemClock.h"
+#include "system.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "BlockCache.h"
+
+#define BLOCK_SIZE (128 * 1024)
+
+using namespace XFILE;
+
+CBlockCache::CBlockCache(size_t front, size_t back)
+ : CCacheStrategy()
+ , m_lruHead(NULL)
+ , m_lruTail(NULL)
+ , m_front(front)
+ , m_back(back)
+ , m_cur(0)
+ , m_end(0)
+ , m_seekHits(0)
+ , m_seekMisses(0)
+{
+  // the forward buffer, plus the partial blocks at either end of it, must always fit
+  m_maxBlocks = std::max((front + back) / BLOCK_SIZE, front / BLOCK_SIZE + 2);
+}
+
+CBlockCache::~CBlockCache()
+{
+  Close();
+}
+
+int CBlockCache::Open()
+{
+  CSingleLock lock(m_sync);
+  Clear();
+  m_cur = 0;
+  m_end = 0;
+  m_seekHits = 0;
+  m_seekMisses = 0;
+  return CACHE_RC_OK;
+}
+
+void CBlockCache::Close()
+{
+  CSingleLock lock(m_sync);
+  if (m_seekHits + m_seekMisses > 0)
+    CLog::Log(LOGDEBUG, "CBlockCache::Close - %u of %u seeks served from cache", m_seekHits, m_seekHits + m_seekMisses);
+  Clear();
+
+  for (std::vector<uint8_t*>::iterator it = m_freeData.begin(); it != m_freeData.end(); ++it)
+    delete[] *it;
+  m_freeData.clear();
+}
+
+void CBlockCache::Clear()
+{
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    m_freeData.push_back(it->second->data);
+    delete it->second;
+  }
+  m_blocks.clear();
+  m_lruHead = m_lruTail = NULL;
+}
+
+CBlockCache::Block* CBlockCache::FindBlock(int64_t index) const
+{
+  BlockMap::const_iterator it = m_blocks.find(index);
+  if (it == m_blocks.end())
+    return NULL;
+  return it->second;
+}
+
+void CBlockCache::Unlink(Block *block)
+{
+  if (block->prev)
+    block->prev->next = block->next;
+  else
+    m_lruHead = block->next;
+  if (block->next)
+    block->next->prev = block->prev;
+  else
+    m_lruTail = block->prev;
+  block->prev = block->next = NULL;
+}
+
+void CBlockCache::Touch(Block *block)
+{
+  if (block == m_lruHead)
+    return;
+  Unlink(block);
+  PushFront(block);
+}
+
+void CBlockCache::PushFront(Block *block)
+{
+  block->prev = NULL;
+  block->next = m_lruHead;
+  if (m_lruHead)
+    m_lruHead->prev = block;
+  m_lruHead = block;
+  if (!m_lruTail)
+    m_lruTail = block;
+}
+
+CBlockCache::Block* CBlockCache::AllocateBlock(int64_t index)
+{
+  Block *block = NULL;
+  if (m_blocks.size() >= m_maxBlocks)
+  {
+    // evict the least recently used block that isn't between the read and write position
+    int64_t first = std::min(m_cur, m_end) / BLOCK_SIZE;
+    int64_t last  = std::max(m_cur, m_end) / BLOCK_SIZE;
+    for (block = m_lruTail; block; block = block->prev)
+    {
+      if (block->index < first || block->index > last)
+        break;
+    }
+    if (!block)
+      return NULL;
+
+    Unlink(block);
+    m_blocks.erase(block->index);
+  }
+  else
+  {
+    block = new Block;
+    block->prev = block->next = NULL;
+    if (!m_freeData.empty())
+    {
+      block->data = m_freeData.back();
+      m_freeData.pop_back();
+    }
+    else
+      block->data = new uint8_t[BLOCK_SIZE];
+  }
+
+  block->index = index;
+  block->filled = 0;
+  m_blocks.insert(std::make_pair(index, block));
+  PushFront(block);
+  return block;
+}
+
+int64_t CBlockCache::ContiguousEnd(int64_t pos) const
+{
+  Block *block = FindBlock(pos / BLOCK_SIZE);
+  if (!block || (size_t)(pos % BLOCK_SIZE) >= block->filled)
+    return pos;
+
+  // follow the chain of full blocks
+  while (block->filled == BLOCK_SIZE)
+  {
+    Block *next = FindBlock(block->index + 1);
+    if (!next || next->filled == 0)
+      break;
+    block = next;
+  }
+  return block->index * BLOCK_SIZE + block->filled;
+}
+
+int64_t CBlockCache::WritePositionFor(int64_t pos) const
+{
+  if (IsCachedPositionLocked(pos))
+    return ContiguousEnd(pos);
+
+  // blocks are only ever filled from their start, so continue after what this block already has
+  Block *block = FindBlock(pos / BLOCK_SIZE);
+  return (pos / BLOCK_SIZE) * BLOCK_SIZE + (block ? block->filled : 0);
+}
+
+bool CBlockCache::IsWritingForReader() const
+{
+  // the writer either fills the block being read up to the read position,
+  // or extends the data cached contiguously from it
+  return m_end >= (m_cur / BLOCK_SIZE) * BLOCK_SIZE && m_end <= ContiguousEnd(m_cur);
+}
+
+size_t CBlockCache::GetMaxWriteSize(const size_t& iRequestSize)
+{
+  CSingleLock lock(m_sync);
+
+  // after a seek into another cached range, the writer waits until it is
+  // moved on to where that range ends
+  if (!IsWritingForReader())
+    return 0;
+
+  int64_t front = std::max<int64_t>(m_end - m_cur, 0);
+  if (front >= (int64_t)m_front)
+    return 0;
+
+  // Never return more than limit and size requested by caller
+  return std::min(iRequestSize, (size_t)(m_front - front));
+}
+
+/**
+ * Writes data at m_end. A call never writes across a block boundary,
+ * so multiple calls may be needed to store a buffer completely.
+ *
+ * Data for a part of a block that is already cached is skipped.
+ */
+int CBlockCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  if (!IsWritingForReader())
+    return 0;
+
+  int64_t front = std::max<int64_t>(m_end - m_cur, 0);
+  if (front >= (int64_t)m_front)
+    return 0;
+
+  size_t offset = (size_t)(m_end % BLOCK_SIZE);
+  len = std::min(len, std::min((size_t)(m_front - front), BLOCK_SIZE - offset));
+  if (len == 0)
+    return 0;
+
+  Block *block = FindBlock(m_end / BLOCK_SIZE);
+  if (!block)
+  {
+    block = AllocateBlock(m_end / BLOCK_SIZE);
+    if (!block)
+      return 0;
+  }
+
+  if (offset < block->filled)
+  {
+    // already have this part
+    len = std::min(len, block->filled - offset);
+  }
+  else if (offset == block->filled)
+  {
+    memcpy(block->data + offset, buf, len);
+    block->filled += len;
+  }
+  else
+  {
+    CLog::Log(LOGERROR, "CBlockCache::WriteToCache - write at %" PRId64" leaves a gap in block %" PRId64, m_end, block->index);
+    return CACHE_RC_ERROR;
+  }
+
+  Touch(block);
+  m_end += len;
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Reads data from cache. Will only read up till the end of
+ * the block, so multiple calls may be needed.
+ */
+int CBlockCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  size_t offset = (size_t)(m_cur % BLOCK_SIZE);
+  Block *block = FindBlock(m_cur / BLOCK_SIZE);
+  size_t avail = (block && block->filled > offset) ? block->filled - offset : 0;
+
+  if (avail == 0)
+  {
+    // end of input only means end of file if the writer got there from here
+    if (IsEndOfInput() && m_cur == m_end)
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  if (len > avail)
+    len = avail;
+
+  if (len == 0)
+    return 0;
+
+  memcpy(buf, block->data + offset, len);
+  m_cur += len;
+  Touch(block);
+
+  m_space.Set();
+
+  return len;
+}
+
+/* Wait "millis" milliseconds for "minimum" amount of data to come in.
+ * Note that caller needs to make sure there's sufficient space in the forward
+ * buffer for "minimum" bytes else we may block the full timeout time
+ */
+int64_t CBlockCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = ContiguousEnd(m_cur) - m_cur;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > m_front)
+    minimum = m_front;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = ContiguousEnd(m_cur) - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CBlockCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what we are writing, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000 && !IsCachedPositionLocked(pos))
+  {
+    // give up the forward buffer, so there's space to read up to pos
+    m_cur = m_end;
+    lock.Leave();
+    WaitForData((unsigned int)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  if (pos == m_end || IsCachedPositionLocked(pos))
+  {
+    m_seekHits++;
+    m_cur = pos;
+    return pos;
+  }
+
+  m_seekMisses++;
+  return CACHE_RC_ERROR;
+}
+
+bool CBlockCache::Reset(int64_t pos, bool clearAnyway)
+{
+  CSingleLock lock(m_sync);
+
+  // cached blocks stay valid regardless, so there is nothing to throw away
+  bool cached = IsCachedPositionLocked(pos);
+  m_end = WritePositionFor(pos);
+  m_cur = pos;
+
+  return !cached;
+}
+
+int64_t CBlockCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return WritePositionFor(iFilePosition);
+}
+
+int64_t CBlockCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_sync);
+  return m_end;
+}
+
+bool CBlockCache::IsCachedPosition(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return IsCachedPositionLocked(iFilePosition);
+}
+
+bool CBlockCache::IsCachedPositionLocked(int64_t iFilePosition) const
+{
+  Block *block = FindBlock(iFilePosition / BLOCK_SIZE);
+  return block && (size_t)(iFilePosition % BLOCK_SIZE) < block->filled;
+}
+
+CCacheStrategy *CBlockCache::CreateNew()
+{
+  return new CBlockCache(m_front, m_back);
+}
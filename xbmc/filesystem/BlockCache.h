@@ -0,0 +1,109 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <unordered_map>
+#include <vector>
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+namespace XFILE {
+
+/*!
+ \brief Cache strategy keeping any number of independently cached ranges of a file.
+
+ The file is split into fixed size blocks. Each cached block holds a contiguous
+ prefix of its data, so after a seek the source is always read from the start of
+ a block. Blocks are kept in a least recently used list and are only evicted once
+ the memory budget is used up, so seeking back and forth (index reads at the end
+ of a file, chapter skips) finds the data that was read before rather than
+ fetching it again.
+
+ The forward buffer (data ahead of the read position) is limited to front bytes,
+ the total memory used to front + back bytes, the same way as CCircularCache.
+ */
+class CBlockCache : public CCacheStrategy
+{
+public:
+  CBlockCache(size_t front, size_t back);
+  virtual ~CBlockCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual size_t GetMaxWriteSize(const size_t& iRequestSize);
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual bool Reset(int64_t pos, bool clearAnyway=true);
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+
+  virtual CCacheStrategy *CreateNew();
+
+protected:
+  struct Block
+  {
+    int64_t  index;   /**< position in file / block size */
+    size_t   filled;  /**< number of valid bytes from the start of the block */
+    uint8_t *data;
+    Block   *prev;    /**< more recently used */
+    Block   *next;    /**< less recently used */
+  };
+  typedef std::unordered_map<int64_t, Block*> BlockMap;
+
+  Block* FindBlock(int64_t index) const;
+  Block* AllocateBlock(int64_t index);
+  void Touch(Block *block);
+  void Unlink(Block *block);
+  void PushFront(Block *block);
+  void Clear();
+
+  /*! \brief End of the data cached contiguously from pos, pos itself if pos isn't cached */
+  int64_t ContiguousEnd(int64_t pos) const;
+  /*! \brief Position the source has to be read from to have pos cached */
+  int64_t WritePositionFor(int64_t pos) const;
+  /*! \brief Whether the data being written is the data the reader will need next */
+  bool IsWritingForReader() const;
+  bool IsCachedPositionLocked(int64_t iFilePosition) const;
+
+  BlockMap              m_blocks;
+  Block                *m_lruHead;
+  Block                *m_lruTail;
+  std::vector<uint8_t*> m_freeData;  /**< data buffers of released blocks */
+  size_t                m_front;     /**< maximum size of the forward buffer */
+  size_t                m_back;
+  size_t                m_maxBlocks;
+  int64_t               m_cur;       /**< current reading index in file */
+  int64_t               m_end;       /**< index in file the next write goes to */
+  unsigned int          m_seekHits;
+  unsigned int          m_seekMisses;
+  CCriticalSection      m_sync;
+  CEvent                m_written;
+};
+
+} // namespace XFILE
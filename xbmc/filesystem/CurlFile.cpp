@@ -28,6 +28,8 @@
 #include "threads/SystemClock.h"
 
 #include <vector>
+#include <deque>
+#include <algorithm>
 #include <climits>
 #include <cassert>
 
@@ -150,6 +152,56 @@ static inline void* realloc_simple(void *ptr, size_t size)
     return ptr2;
 }
 
+/* wait until any transfer of a multi handle can make progress or a timeout occurs */
+static bool WaitForMultiHandle(CURLM* multi)
+{
+  fd_set fdread;
+  fd_set fdwrite;
+  fd_set fdexcep;
+  int maxfd = -1;
+  FD_ZERO(&fdread);
+  FD_ZERO(&fdwrite);
+  FD_ZERO(&fdexcep);
+
+  // get file descriptors from the transfers
+  g_curlInterface.multi_fdset(multi, &fdread, &fdwrite, &fdexcep, &maxfd);
+
+  long timeout = 0;
+  if (CURLM_OK != g_curlInterface.multi_timeout(multi, &timeout) || timeout == -1 || timeout < 200)
+    timeout = 200;
+
+  XbmcThreads::EndTime endTime(timeout);
+  int rc;
+
+  do
+  {
+    unsigned int time_left = endTime.MillisLeft();
+    struct timeval t = { (int)time_left / 1000, ((int)time_left % 1000) * 1000 };
+
+    // Wait until data is available or a timeout occurs.
+    rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &t);
+#ifdef TARGET_WINDOWS
+  } while(rc == SOCKET_ERROR && WSAGetLastError() == WSAEINTR);
+#else
+  } while(rc == SOCKET_ERROR && errno == EINTR);
+#endif
+
+  if(rc == SOCKET_ERROR)
+  {
+#ifdef TARGET_WINDOWS
+    char buf[256];
+    strerror_s(buf, 256, WSAGetLastError());
+    CLog::Log(LOGERROR, "%s - Failed with socket error:%s", __FUNCTION__, buf);
+#else
+    char const * str = strerror(errno);
+    CLog::Log(LOGERROR, "%s - Failed with socket error:%s", __FUNCTION__, str);
+#endif
+
+    return false;
+  }
+  return true;
+}
+
 size_t CCurlFile::CReadState::HeaderCallback(void *ptr, size_t size, size_t nmemb)
 {
   std::string inString;
@@ -396,9 +448,293 @@ void CCurlFile::CReadState::Disconnect()
 }
 
 
+/*
+ * Reads a file with several concurrent range requests on the handles of one
+ * multi handle. Every request fetches a chunk into the ring buffer of its own
+ * read state and chunks are handed out in file order. The handle of a chunk
+ * that has been read is reused for the next chunk past the window, the
+ * connections stay alive in the connection cache of the multi handle.
+ */
+class CCurlFile::CRangeReader
+{
+public:
+  CRangeReader(CCurlFile& file, unsigned int connections, unsigned int chunkSize);
+  ~CRangeReader();
+
+  ssize_t Read(void* lpBuf, size_t uiBufSize);
+  bool    Seek(int64_t pos);
+  void    Restart(int64_t pos);
+  int64_t GetPosition() const { return m_pos; }
+
+private:
+  struct Chunk
+  {
+    CReadState* state;
+    int64_t     start;
+    int64_t     end;
+    int64_t     read;       // bytes handed to the caller
+    int         retries;
+    bool        active;     // handle is added to the multi handle
+    bool        verified;   // server answered with partial content
+    bool        failed;
+  };
+
+  void    AddChunk(CReadState* state);
+  void    NextChunk();
+  void    Request(Chunk& chunk);
+  void    Abort(Chunk& chunk);
+  bool    Perform();
+  int64_t Received(const Chunk& chunk) const;
+
+  CCurlFile&                m_file;
+  CURLM*                    m_multi;
+  std::vector<CReadState*>  m_states;
+  std::deque<Chunk>         m_chunks;
+  int64_t                   m_fileSize;
+  int64_t                   m_pos;       // position of the caller
+  int64_t                   m_next;      // start of the next chunk to request
+  unsigned int              m_chunkSize;
+  unsigned int              m_requests;
+  unsigned int              m_retries;
+};
+
+CCurlFile::CRangeReader::CRangeReader(CCurlFile& file, unsigned int connections, unsigned int chunkSize)
+  : m_file(file)
+  , m_multi(file.m_state->m_multiHandle)
+  , m_fileSize(file.m_state->m_fileSize)
+  , m_pos(0)
+  , m_next(0)
+  , m_chunkSize(chunkSize)
+  , m_requests(0)
+  , m_retries(0)
+{
+  CURL url(m_file.m_url);
+  for (unsigned int i = 0; i < connections; i++)
+  {
+    CReadState* state = new CReadState();
+    g_curlInterface.easy_aquire(url.GetProtocol().c_str(),
+                                url.GetHostName().c_str(),
+                                &state->m_easyHandle,
+                                NULL);
+    m_file.SetCommonOptions(state);
+    m_file.SetRequestHeaders(state);
+    state->m_buffer.Create(chunkSize);
+    m_states.push_back(state);
+  }
+}
+
+CCurlFile::CRangeReader::~CRangeReader()
+{
+  for (std::deque<Chunk>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    Abort(*it);
+
+  for (std::vector<CReadState*>::iterator it = m_states.begin(); it != m_states.end(); ++it)
+    delete *it;
+
+  CLog::Log(LOGDEBUG, "CCurlFile::CRangeReader - %u range requests on %u connections, %u retried",
+            m_requests, (unsigned int)m_states.size(), m_retries);
+}
+
+int64_t CCurlFile::CRangeReader::Received(const Chunk& chunk) const
+{
+  return chunk.read + chunk.state->m_buffer.getMaxReadSize();
+}
+
+void CCurlFile::CRangeReader::AddChunk(CReadState* state)
+{
+  Chunk chunk = {};
+  chunk.state = state;
+  chunk.start = m_next;
+  chunk.end = std::min(m_next + (int64_t)m_chunkSize, m_fileSize);
+  m_next = chunk.end;
+
+  state->m_buffer.Clear();
+  free(state->m_overflowBuffer);
+  state->m_overflowBuffer = NULL;
+  state->m_overflowSize = 0;
+
+  m_chunks.push_back(chunk);
+  Request(m_chunks.back());
+}
+
+void CCurlFile::CRangeReader::NextChunk()
+{
+  Chunk chunk = m_chunks.front();
+  Abort(chunk);
+  m_chunks.pop_front();
+
+  if (m_next < m_fileSize)
+    AddChunk(chunk.state);
+
+  m_pos = m_chunks.empty() ? m_fileSize : m_chunks.front().start + m_chunks.front().read;
+}
+
+void CCurlFile::CRangeReader::Request(Chunk& chunk)
+{
+  // a retry continues after what has been received already
+  int64_t from = chunk.start + Received(chunk);
+  std::string range = StringUtils::Format("%" PRId64 "-%" PRId64, from, chunk.end - 1);
+
+  chunk.state->m_httpheader.Clear();
+  g_curlInterface.easy_setopt(chunk.state->m_easyHandle, CURLOPT_RANGE, range.c_str());
+  g_curlInterface.multi_add_handle(m_multi, chunk.state->m_easyHandle);
+  chunk.active = true;
+  chunk.verified = false;
+  m_requests++;
+}
+
+void CCurlFile::CRangeReader::Abort(Chunk& chunk)
+{
+  if (chunk.active)
+    g_curlInterface.multi_remove_handle(m_multi, chunk.state->m_easyHandle);
+  chunk.active = false;
+}
+
+void CCurlFile::CRangeReader::Restart(int64_t pos)
+{
+  for (std::deque<Chunk>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    Abort(*it);
+  m_chunks.clear();
+
+  m_pos = m_next = pos;
+  for (size_t i = 0; i < m_states.size() && m_next < m_fileSize; i++)
+    AddChunk(m_states[i]);
+}
+
+bool CCurlFile::CRangeReader::Seek(int64_t pos)
+{
+  if (pos == m_pos)
+    return true;
+
+  if (pos > m_pos)
+  {
+    // skip whole chunks, their handles move on to the end of the window
+    while (!m_chunks.empty() && pos >= m_chunks.front().end)
+      NextChunk();
+
+    if (!m_chunks.empty())
+    {
+      Chunk& chunk = m_chunks.front();
+      int64_t skip = pos - m_pos;
+      if (skip >= 0 && skip <= chunk.state->m_buffer.getMaxReadSize() &&
+          chunk.state->m_buffer.SkipBytes((int)skip))
+      {
+        chunk.read += skip;
+        m_pos = pos;
+        return true;
+      }
+    }
+  }
+
+  Restart(pos);
+  return true;
+}
+
+bool CCurlFile::CRangeReader::Perform()
+{
+  int running;
+  CURLMcode result;
+  do
+  {
+    result = g_curlInterface.multi_perform(m_multi, &running);
+  } while (result == CURLM_CALL_MULTI_PERFORM);
+
+  if (result != CURLM_OK)
+  {
+    CLog::Log(LOGERROR, "CCurlFile::CRangeReader - Multi perform failed with code %d", result);
+    return false;
+  }
+
+  for (std::deque<Chunk>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+  {
+    // a server that ignores the range would send the whole file into the buffer
+    if (it->state->m_overflowSize)
+    {
+      CLog::Log(LOGERROR, "CCurlFile::CRangeReader - Server sent more than the requested range");
+      return false;
+    }
+
+    if (it->active && !it->verified && it->state->IsHeaderDone())
+    {
+      long response = 0;
+      g_curlInterface.easy_getinfo(it->state->m_easyHandle, CURLINFO_RESPONSE_CODE, &response);
+      if (response != 206)
+      {
+        CLog::Log(LOGERROR, "CCurlFile::CRangeReader - Range request answered with code %ld", response);
+        return false;
+      }
+      it->verified = true;
+    }
+  }
+
+  int msgs;
+  CURLMsg* msg;
+  while ((msg = g_curlInterface.multi_info_read(m_multi, &msgs)))
+  {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    std::deque<Chunk>::iterator it;
+    for (it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    {
+      if (it->active && it->state->m_easyHandle == msg->easy_handle)
+        break;
+    }
+    if (it == m_chunks.end())
+      continue;
+
+    CURLcode code = msg->data.result;
+    Abort(*it);
+    if (code == CURLE_OK && Received(*it) == it->end - it->start)
+      continue;
+
+    if (++it->retries > g_advancedSettings.m_curlretries)
+    {
+      CLog::Log(LOGERROR, "CCurlFile::CRangeReader - Range at %" PRId64 " failed: %s(%d)", it->start, g_curlInterface.easy_strerror(code), code);
+      it->failed = true;
+      continue;
+    }
+
+    CLog::Log(LOGNOTICE, "CCurlFile::CRangeReader - Range at %" PRId64 " ended early, (re)try %i", it->start, it->retries);
+    m_retries++;
+    Request(*it);
+  }
+
+  return true;
+}
+
+ssize_t CCurlFile::CRangeReader::Read(void* lpBuf, size_t uiBufSize)
+{
+  while (!m_chunks.empty())
+  {
+    if (m_file.m_state->m_cancelled)
+      return 0;
+
+    Chunk& chunk = m_chunks.front();
+    unsigned int want = XMIN((unsigned int)chunk.state->m_buffer.getMaxReadSize(), uiBufSize);
+    if (want)
+    {
+      chunk.state->m_buffer.ReadData((char *)lpBuf, want);
+      chunk.read += want;
+      m_pos += want;
+      if (chunk.start + chunk.read == chunk.end)
+        NextChunk();
+      return want;
+    }
+
+    if (chunk.failed || !Perform())
+      return -1;
+
+    if (chunk.active && chunk.state->m_buffer.getMaxReadSize() == 0 && !WaitForMultiHandle(m_multi))
+      return -1;
+  }
+  return 0;
+}
+
 CCurlFile::~CCurlFile()
 {
   Close();
+  delete m_ranges;
   delete m_state;
   delete m_oldState;
   g_curlInterface.Unload();
@@ -431,6 +767,7 @@ CCurlFile::CCurlFile()
   m_proxytype = PROXY_HTTP;
   m_state = new CReadState();
   m_oldState = NULL;
+  m_ranges = NULL;
   m_skipshout = false;
   m_httpresponse = -1;
   m_acceptCharset = "UTF-8,*;q=0.8"; /* prefer UTF-8 if available */
@@ -447,6 +784,8 @@ void CCurlFile::Close()
   if (m_opened && m_forWrite && !m_inError)
       Write(NULL, 0);
 
+  delete m_ranges;
+  m_ranges = NULL;
   m_state->Disconnect();
   delete m_oldState;
   m_oldState = NULL;
@@ -518,6 +857,9 @@ void CCurlFile::SetCommonOptions(CReadState* state)
   // resolves. Unfortunately, c-ares does not yet support IPv6.
   g_curlInterface.easy_setopt(h, CURLOPT_NOSIGNAL, TRUE);
 
+  // reuse name lookups and ssl sessions of other handles
+  g_curlInterface.easy_setopt(h, CURLOPT_SHARE, g_curlInterface.GetShare());
+
   // not interested in failed requests
   g_curlInterface.easy_setopt(h, CURLOPT_FAILONERROR, 1);
 
@@ -532,8 +874,8 @@ void CCurlFile::SetCommonOptions(CReadState* state)
   g_curlInterface.easy_setopt(h, CURLOPT_SSL_VERIFYPEER, 0);
   g_curlInterface.easy_setopt(h, CURLOPT_SSL_VERIFYHOST, 0);
 
-  g_curlInterface.easy_setopt(m_state->m_easyHandle, CURLOPT_URL, m_url.c_str());
-  g_curlInterface.easy_setopt(m_state->m_easyHandle, CURLOPT_TRANSFERTEXT, FALSE);
+  g_curlInterface.easy_setopt(h, CURLOPT_URL, m_url.c_str());
+  g_curlInterface.easy_setopt(h, CURLOPT_TRANSFERTEXT, FALSE);
 
   // setup POST data if it is set (and it may be empty)
   if (m_postdataset)
@@ -1024,9 +1366,85 @@ bool CCurlFile::Open(const CURL& url)
     m_url = efurl;
   }
 
+  if (CanReadRanges())
+    StartRangeReads();
+
+  return true;
+}
+
+bool CCurlFile::CanReadRanges()
+{
+  if (g_advancedSettings.m_curlRangeConnections < 2 || !m_seekable || !m_multisession)
+    return false;
+
+  // only worth it for files spanning a few chunks
+  if (m_state->m_fileSize < 4 * (int64_t)g_advancedSettings.m_curlRangeChunkSize)
+    return false;
+
+  if (m_postdataset || !m_customrequest.empty())
+    return false;
+
+  return StringUtils::EqualsNoCase(m_state->m_httpheader.GetValue("Accept-Ranges"), "bytes");
+}
+
+void CCurlFile::StartRangeReads()
+{
+  CLog::Log(LOGDEBUG, "CCurlFile::StartRangeReads - Reading %s with %u connections", CURL::GetRedacted(m_url).c_str(), g_advancedSettings.m_curlRangeConnections);
+
+  // the range requests take over from the first connection, which stays
+  // aquired so its multi handle keeps the connections alive
+  int64_t fileSize = m_state->m_fileSize;
+  m_state->Disconnect();
+  m_state->m_fileSize = fileSize;
+
+  m_ranges = new CRangeReader(*this, g_advancedSettings.m_curlRangeConnections, g_advancedSettings.m_curlRangeChunkSize);
+  m_ranges->Restart(0);
+}
+
+bool CCurlFile::StopRangeReads()
+{
+  int64_t pos = m_ranges->GetPosition();
+  delete m_ranges;
+  m_ranges = NULL;
+
+  CLog::Log(LOGWARNING, "CCurlFile::StopRangeReads - Continuing %s on a single connection at %" PRId64, CURL::GetRedacted(m_url).c_str(), pos);
+
+  SetCommonOptions(m_state);
+  SetRequestHeaders(m_state);
+  m_state->m_filePos = pos;
+  m_state->m_sendRange = true;
+
+  long response = m_state->Connect(m_bufferSize);
+  if (response <= 0 || response >= 400)
+  {
+    CLog::Log(LOGERROR, "CCurlFile::StopRangeReads - Reconnect failed with code %li", response);
+    return false;
+  }
   return true;
 }
 
+ssize_t CCurlFile::Read(void* lpBuf, size_t uiBufSize)
+{
+  if (m_ranges)
+  {
+    ssize_t read = m_ranges->Read(lpBuf, uiBufSize);
+    if (read >= 0)
+      return read;
+
+    if (!StopRangeReads())
+      return -1;
+  }
+  return m_state->Read(lpBuf, uiBufSize);
+}
+
+bool CCurlFile::ReadString(char *szLine, int iLineLength)
+{
+  if (m_ranges && !StopRangeReads())
+    return false;
+
+  return m_state->ReadString(szLine, iLineLength);
+}
+
 bool CCurlFile::OpenForWrite(const CURL& url, bool bOverWrite)
 {
   if(m_opened)
@@ -1194,7 +1612,7 @@ bool CCurlFile::Exists(const CURL& url)
 
 int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
 {
-  int64_t nextPos = m_state->m_filePos;
+  int64_t nextPos = m_ranges ? m_ranges->GetPosition() : m_state->m_filePos;
   
   if(!m_seekable)
     return -1;
@@ -1220,6 +1638,9 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   // We can't seek beyond EOF
   if (m_state->m_fileSize && nextPos > m_state->m_fileSize) return -1;
 
+  if (m_ranges)
+    return m_ranges->Seek(nextPos) ? nextPos : -1;
+
   if(m_state->Seek(nextPos))
     return nextPos;
 
@@ -1298,6 +1719,7 @@ int64_t CCurlFile::GetLength()
 int64_t CCurlFile::GetPosition()
 {
   if (!m_opened) return 0;
+  if (m_ranges) return m_ranges->GetPosition();
   return m_state->m_filePos;
 }
 
@@ -1461,9 +1883,6 @@ unsigned int CCurlFile::CReadState::Read(void* lpBuf, size_t uiBufSize)
 bool CCurlFile::CReadState::FillBuffer(unsigned int want)
 {
   int retry = 0;
-  fd_set fdread;
-  fd_set fdwrite;
-  fd_set fdexcep;
 
   // only attempt to fill buffer if transactions still running and buffer
   // doesnt exceed required size already
@@ -1590,47 +2009,8 @@ bool CCurlFile::CReadState::FillBuffer(unsigned int want)
     {
       case CURLM_OK:
       {
-        int maxfd = -1;
-        FD_ZERO(&fdread);
-        FD_ZERO(&fdwrite);
-        FD_ZERO(&fdexcep);
-
-        // get file descriptors from the transfers
-        g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
-
-        long timeout = 0;
-        if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1 || timeout < 200)
-          timeout = 200;
-
-        XbmcThreads::EndTime endTime(timeout);
-        int rc;
-
-        do
-        {
-          unsigned int time_left = endTime.MillisLeft();
-          struct timeval t = { (int)time_left / 1000, ((int)time_left % 1000) * 1000 };
-
-          // Wait until data is available or a timeout occurs.
-          rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &t);
-#ifdef TARGET_WINDOWS
-        } while(rc == SOCKET_ERROR && WSAGetLastError() == WSAEINTR);
-#else
-        } while(rc == SOCKET_ERROR && errno == EINTR);
-#endif
-
-        if(rc == SOCKET_ERROR)
-        {
-#ifdef TARGET_WINDOWS
-          char buf[256];
-          strerror_s(buf, 256, WSAGetLastError());
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", buf);
-#else
-          char const * str = strerror(errno);
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", str);
-#endif
-
+        if (!WaitForMultiHandle(m_multiHandle))
           return false;
-        }
       }
       break;
       case CURLM_CALL_MULTI_PERFORM:
@@ -56,8 +56,8 @@ namespace XFILE
       virtual int64_t  GetLength();
       virtual int  Stat(const CURL& url, struct __stat64* buffer);
       virtual void Close();
-      virtual bool ReadString(char *szLine, int iLineLength)     { return m_state->ReadString(szLine, iLineLength); }
-      virtual ssize_t Read(void* lpBuf, size_t uiBufSize)        { return m_state->Read(lpBuf, uiBufSize); }
+      virtual bool ReadString(char *szLine, int iLineLength);
+      virtual ssize_t Read(void* lpBuf, size_t uiBufSize);
       virtual ssize_t Write(const void* lpBuf, size_t uiBufSize);
       virtual std::string GetMimeType()                          { return m_state->m_httpheader.GetMimeType(); }
       virtual std::string GetContent()                           { return m_state->m_httpheader.GetValue("content-type"); }
@@ -149,16 +149,23 @@ namespace XFILE
           void         Disconnect();
       };
 
+      /* reads a file with several concurrent range requests, see advancedsettings curlrangeconnections */
+      class CRangeReader;
+
     protected:
       void ParseAndCorrectUrl(CURL &url);
       void SetCommonOptions(CReadState* state);
       void SetRequestHeaders(CReadState* state);
       void SetCorrectHeaders(CReadState* state);
       bool Service(const std::string& strURL, std::string& strHTML);
+      bool CanReadRanges();
+      void StartRangeReads();
+      bool StopRangeReads();
 
     protected:
       CReadState*     m_state;
       CReadState*     m_oldState;
+      CRangeReader*   m_ranges;
       unsigned int    m_bufferSize;
       int64_t         m_writeOffset;
 
@@ -20,6 +20,7 @@
 
 #include "DirectoryCache.h"
 #include "FileItem.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
@@ -34,57 +35,67 @@ using namespace XFILE;
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
-  m_lastAccess = 0;
-  m_Items = new CFileItemList;
+  m_size = 0;
+  m_prev = m_next = NULL;
+  m_Items.reset(new CFileItemList);
   m_Items->SetFastLookup(true);
 }
 
 CDirectoryCache::CDir::~CDir()
 {
-  delete m_Items;
-}
-
-void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
-{
-  m_lastAccess = accessCounter++;
 }
 
 CDirectoryCache::CDirectoryCache(void)
 {
-  m_accessCounter = 0;
-#ifdef _DEBUG
+  m_lruHead = m_lruTail = NULL;
+  m_lruCount = 0;
+  m_totalSize = 0;
   m_cacheHits = 0;
   m_cacheMisses = 0;
-#endif
+  m_evictions = 0;
 }
 
 CDirectoryCache::~CDirectoryCache(void)
 {
+  Clear();
 }
 
 bool CDirectoryCache::GetDirectory(const std::string& strPath, CFileItemList &items, bool retrieveAll)
 {
-  CSingleLock lock (m_cs);
+  std::shared_ptr<CFileItemList> cached;
+  {
+    CSingleLock lock (m_cs);
 
-  std::string storedPath = strPath;
-  URIUtils::RemoveSlashAtEnd(storedPath);
+    std::string storedPath = strPath;
+    URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ciCache i = m_cache.find(storedPath);
-  if (i != m_cache.end())
-  {
-    CDir* dir = i->second;
-    if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
-       (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+    ciCache i = m_cache.find(storedPath);
+    if (i != m_cache.end())
     {
-      items.Copy(*dir->m_Items);
-      dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
-      m_cacheHits+=items.Size();
-#endif
-      return true;
+      CDir* dir = i->second;
+      if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
+         (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+      {
+        cached = dir->m_Items;
+        Touch(dir);
+      }
     }
+
+    if (!cached)
+    {
+      m_cacheMisses++;
+      return false;
+    }
+    m_cacheHits++;
   }
-  return false;
+
+  // the caller gets a copy rather than the cached items themselves, as
+  // callers go on to alter them (stacking, filtering, archives), see
+  // SetDirectory(). Cached listings are never altered, so the copy can be
+  // done without holding up other users of the cache. Copies of the items
+  // share their info tags until they are modified, which keeps it cheap.
+  items.Copy(*cached);
+  return true;
 }
 
 void CDirectoryCache::SetDirectory(const std::string& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
@@ -103,6 +114,10 @@ void CDirectoryCache::SetDirectory(const std::string& strPath, const CFileItemLi
   // IDEALLY, any further processing on the item would actually create a new item
   // instead of altering it, but we can't really enforce that in an easy way, so
   // this is the best solution for now.
+  CDir* dir = new CDir(cacheType);
+  dir->m_Items->Copy(items);
+  dir->m_size = EstimateSize(*dir->m_Items);
+
   CSingleLock lock (m_cs);
 
   std::string storedPath = strPath;
@@ -110,12 +125,14 @@ void CDirectoryCache::SetDirectory(const std::string& strPath, const CFileItemLi
 
   ClearDirectory(storedPath);
 
-  CheckIfFull();
+  if (cacheType != DIR_CACHE_ALWAYS)
+    CheckIfFull(dir->m_size);
 
-  CDir* dir = new CDir(cacheType);
-  dir->m_Items->Copy(items);
-  dir->SetLastAccess(m_accessCounter);
-  m_cache.insert(pair<std::string, CDir*>(storedPath, dir));
+  dir->m_path = storedPath;
+  m_cache.insert(make_pair(storedPath, dir));
+  m_totalSize += dir->m_size;
+  if (cacheType != DIR_CACHE_ALWAYS)
+    Link(dir);
 }
 
 void CDirectoryCache::ClearFile(const std::string& strFile)
@@ -163,9 +180,21 @@ void CDirectoryCache::AddFile(const std::string& strFile)
   if (i != m_cache.end())
   {
     CDir *dir = i->second;
+
+    // the listing may be in use by a reader, so replace it rather than
+    // modifying it in place
+    std::shared_ptr<CFileItemList> newItems(new CFileItemList);
+    newItems->SetFastLookup(true);
+    newItems->Copy(*dir->m_Items, false);
+    newItems->Append(*dir->m_Items);
     CFileItemPtr item(new CFileItem(strFile, false));
-    dir->m_Items->Add(item);
-    dir->SetLastAccess(m_accessCounter);
+    newItems->Add(item);
+    dir->m_Items = newItems;
+
+    size_t size = EstimateSize(*newItems);
+    m_totalSize += size - dir->m_size;
+    dir->m_size = size;
+    Touch(dir);
   }
 }
 
@@ -184,15 +213,11 @@ bool CDirectoryCache::FileExists(const std::string& strFile, bool& bInCache)
   {
     bInCache = true;
     CDir *dir = i->second;
-    dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
+    Touch(dir);
     m_cacheHits++;
-#endif
     return (URIUtils::PathEquals(strPath, storedPath) || dir->m_Items->Contains(strFile));
   }
-#ifdef _DEBUG
   m_cacheMisses++;
-#endif
   return false;
 }
 
@@ -230,51 +255,102 @@ void CDirectoryCache::ClearCache(set<std::string>& dirs)
   }
 }
 
-void CDirectoryCache::CheckIfFull()
+void CDirectoryCache::CheckIfFull(size_t newSize)
 {
   CSingleLock lock (m_cs);
-  static const unsigned int max_cached_dirs = 10;
 
-  // find the last accessed folder, and remove if the number of cached folders is too many
-  iCache lastAccessed = m_cache.end();
-  unsigned int numCached = 0;
-  for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+  // dirs that are always cached aren't in the lru list and are never evicted
+  const unsigned int maxDirs = g_advancedSettings.m_dirCacheMaxDirs;
+  const size_t maxBytes = g_advancedSettings.m_dirCacheMemSize;
+  while (m_lruTail &&
+        (m_lruCount >= maxDirs || (maxBytes > 0 && m_totalSize + newSize > maxBytes)))
   {
-    // ensure dirs that are always cached aren't cleared
-    if (i->second->m_cacheType != DIR_CACHE_ALWAYS)
-    {
-      if (lastAccessed == m_cache.end() || i->second->GetLastAccess() < lastAccessed->second->GetLastAccess())
-        lastAccessed = i;
-      numCached++;
-    }
+    iCache i = m_cache.find(m_lruTail->m_path);
+    if (i == m_cache.end())
+      break; // can't happen
+    Delete(i);
+    m_evictions++;
   }
-  if (lastAccessed != m_cache.end() && numCached >= max_cached_dirs)
-    Delete(lastAccessed);
 }
 
 void CDirectoryCache::Delete(iCache it)
 {
   CDir* dir = it->second;
+  if (dir->m_cacheType != DIR_CACHE_ALWAYS)
+    Unlink(dir);
+  m_totalSize -= dir->m_size;
   delete dir;
   m_cache.erase(it);
 }
 
-#ifdef _DEBUG
-void CDirectoryCache::PrintStats() const
+void CDirectoryCache::Link(CDir* dir)
 {
-  CSingleLock lock (m_cs);
-  CLog::Log(LOGDEBUG, "%s - total of %u cache hits, and %u cache misses", __FUNCTION__, m_cacheHits, m_cacheMisses);
-  // run through and find the oldest and the number of items cached
-  unsigned int oldest = UINT_MAX;
-  unsigned int numItems = 0;
-  unsigned int numDirs = 0;
-  for (ciCache i = m_cache.begin(); i != m_cache.end(); i++)
+  dir->m_prev = NULL;
+  dir->m_next = m_lruHead;
+  if (m_lruHead)
+    m_lruHead->m_prev = dir;
+  m_lruHead = dir;
+  if (!m_lruTail)
+    m_lruTail = dir;
+  m_lruCount++;
+}
+
+void CDirectoryCache::Unlink(CDir* dir)
+{
+  if (dir->m_prev)
+    dir->m_prev->m_next = dir->m_next;
+  else
+    m_lruHead = dir->m_next;
+  if (dir->m_next)
+    dir->m_next->m_prev = dir->m_prev;
+  else
+    m_lruTail = dir->m_prev;
+  dir->m_prev = dir->m_next = NULL;
+  m_lruCount--;
+}
+
+void CDirectoryCache::Touch(CDir* dir)
+{
+  if (dir->m_cacheType == DIR_CACHE_ALWAYS || dir == m_lruHead)
+    return;
+  Unlink(dir);
+  Link(dir);
+}
+
+size_t CDirectoryCache::EstimateSize(const CFileItemList& items)
+{
+  // a rough estimate is enough here, count the item objects themselves
+  // plus the strings that dominate a plain file listing
+  size_t size = sizeof(CFileItemList);
+  for (int i = 0; i < items.Size(); i++)
   {
-    CDir *dir = i->second;
-    oldest = min(oldest, dir->GetLastAccess());
-    numItems += dir->m_Items->Size();
-    numDirs++;
+    const CFileItemPtr item = items[i];
+    size += sizeof(CFileItem) + sizeof(CFileItemPtr) + item->GetPath().size() + item->GetLabel().size();
   }
-  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total.  Oldest is %u, current is %u", __FUNCTION__, numDirs, numItems, oldest, m_accessCounter);
+  return size;
+}
+
+void CDirectoryCache::GetStats(Stats& stats) const
+{
+  CSingleLock lock (m_cs);
+  stats.directories = m_cache.size();
+  stats.items = 0;
+  for (ciCache i = m_cache.begin(); i != m_cache.end(); i++)
+    stats.items += i->second->m_Items->Size();
+  stats.bytes = m_totalSize;
+  stats.maxDirectories = g_advancedSettings.m_dirCacheMaxDirs;
+  stats.maxBytes = g_advancedSettings.m_dirCacheMemSize;
+  stats.hits = m_cacheHits;
+  stats.misses = m_cacheMisses;
+  stats.evictions = m_evictions;
+}
+
+#ifdef _DEBUG
+void CDirectoryCache::PrintStats() const
+{
+  Stats stats;
+  GetStats(stats);
+  CLog::Log(LOGDEBUG, "%s - total of %" PRIu64" cache hits, %" PRIu64" cache misses and %" PRIu64" evictions", __FUNCTION__, stats.hits, stats.misses, stats.evictions);
+  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total using about %zu bytes", __FUNCTION__, stats.directories, stats.items, stats.bytes);
 }
 #endif
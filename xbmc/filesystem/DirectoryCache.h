@@ -23,8 +23,9 @@
 #include "Directory.h"
 #include "threads/CriticalSection.h"
 
-#include <map>
+#include <memory>
 #include <set>
+#include <unordered_map>
 
 class CFileItem;
 
@@ -38,15 +39,31 @@ namespace XFILE
       CDir(DIR_CACHE_TYPE cacheType);
       virtual ~CDir();
 
-      void SetLastAccess(unsigned int &accessCounter);
-      unsigned int GetLastAccess() const { return m_lastAccess; };
-
-      CFileItemList* m_Items;
+      /*! \brief the cached listing. It is never modified once cached, so a
+       reader can keep a reference to it and make its copy outside of the cache
+       lock. Readers always get a copy, see CDirectoryCache::GetDirectory(). */
+      std::shared_ptr<CFileItemList> m_Items;
       DIR_CACHE_TYPE m_cacheType;
-    private:
-      unsigned int m_lastAccess;
+      size_t m_size;  ///< estimated memory use of m_Items in bytes
+
+      // least recently used list, only dirs that may be evicted are linked
+      CDir* m_prev;
+      CDir* m_next;
+      std::string m_path;
     };
   public:
+    struct Stats
+    {
+      unsigned int directories;
+      unsigned int items;
+      size_t bytes;
+      unsigned int maxDirectories;
+      size_t maxBytes;
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t evictions;
+    };
+
     CDirectoryCache(void);
     virtual ~CDirectoryCache(void);
     bool GetDirectory(const std::string& strPath, CFileItemList &items, bool retrieveAll = false);
@@ -57,27 +74,35 @@ namespace XFILE
     void Clear();
     void AddFile(const std::string& strFile);
     bool FileExists(const std::string& strPath, bool& bInCache);
+    void GetStats(Stats& stats) const;
 #ifdef _DEBUG
     void PrintStats() const;
 #endif
   protected:
     void InitCache(std::set<std::string>& dirs);
     void ClearCache(std::set<std::string>& dirs);
-    void CheckIfFull();
+    void CheckIfFull(size_t newSize);
 
-    std::map<std::string, CDir*> m_cache;
-    typedef std::map<std::string, CDir*>::iterator iCache;
-    typedef std::map<std::string, CDir*>::const_iterator ciCache;
+    std::unordered_map<std::string, CDir*> m_cache;
+    typedef std::unordered_map<std::string, CDir*>::iterator iCache;
+    typedef std::unordered_map<std::string, CDir*>::const_iterator ciCache;
     void Delete(iCache i);
 
+    void Link(CDir* dir);
+    void Unlink(CDir* dir);
+    void Touch(CDir* dir);
+    static size_t EstimateSize(const CFileItemList& items);
+
     CCriticalSection m_cs;
 
-    unsigned int m_accessCounter;
+    CDir* m_lruHead;   ///< most recently used
+    CDir* m_lruTail;   ///< least recently used, evicted first
+    unsigned int m_lruCount;
+    size_t m_totalSize;
 
-#ifdef _DEBUG
-    unsigned int m_cacheHits;
-    unsigned int m_cacheMisses;
-#endif
+    uint64_t m_cacheHits;
+    uint64_t m_cacheMisses;
+    uint64_t m_evictions;
   };
 }
 extern XFILE::CDirectoryCache g_directoryCache;
@@ -25,6 +25,7 @@
 #include "utils/log.h"
 
 #include <assert.h>
+#include <string.h>
 
 #ifdef HAVE_OPENSSL
 #include "threads/Thread.h"
@@ -67,6 +68,27 @@ static long g_curlReferences = 0;
 static unsigned int g_curlTimeout = 0;
 #endif
 
+/* idle sessions kept per host, the oldest one is closed when another is released */
+#define MAX_IDLE_SESSIONS_PER_HOST 8
+
+static CCriticalSection g_shareLocks[CURL_LOCK_DATA_LAST];
+
+extern "C" void share_lock_callback(CURL_HANDLE *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+  g_shareLocks[data].lock();
+}
+
+extern "C" void share_unlock_callback(CURL_HANDLE *handle, curl_lock_data data, void *userptr)
+{
+  g_shareLocks[data].unlock();
+}
+
+DllLibCurlGlobal::DllLibCurlGlobal()
+  : m_share(NULL)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
 bool DllLibCurlGlobal::Load()
 {
   CSingleLock lock(m_critSection);
@@ -91,6 +113,17 @@ bool DllLibCurlGlobal::Load()
   /* check idle will clean up the last one */
   g_curlReferences = 2;
 
+  /* share name lookups and ssl sessions between all handles, so reopening */
+  /* a connection to a host doesn't resolve and negotiate all over again */
+  m_share = share_init();
+  if (m_share)
+  {
+    share_setopt(m_share, CURLSHOPT_LOCKFUNC, share_lock_callback);
+    share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, share_unlock_callback);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+
 #if defined(HAS_CURL_STATIC)
   // Initialize ssl locking array
   m_sslLockArray = new CCriticalSection*[CRYPTO_num_locks()];
@@ -112,6 +145,10 @@ void DllLibCurlGlobal::Unload()
     if (!IsLoaded())
       return;
 
+    if (m_share)
+      share_cleanup(m_share);
+    m_share = NULL;
+
     // close libcurl
     global_cleanup();
 
@@ -150,17 +187,7 @@ void DllLibCurlGlobal::CheckIdle()
   {
     if( !it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > idletime )
     {
-      CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__, it->m_protocol.c_str(), it->m_hostname.c_str(), (void*)it->m_easy, (void*)it->m_multi);
-
-      // It's important to clean up multi *before* cleaning up easy, because the multi cleanup
-      // code accesses stuff in the easy's structure.
-      if(it->m_multi)
-        multi_cleanup(it->m_multi);
-      if(it->m_easy)
-        easy_cleanup(it->m_easy);
-
-      Unload();
-
+      CloseSession(*it);
       it = m_sessions.erase(it);
       continue;
     }
@@ -174,41 +201,72 @@ void DllLibCurlGlobal::CheckIdle()
 #endif
 }
 
+void DllLibCurlGlobal::CloseSession(SSession& session)
+{
+  CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p, reused %u times)\n", __FUNCTION__, session.m_protocol.c_str(), session.m_hostname.c_str(), (void*)session.m_easy, (void*)session.m_multi, session.m_reused);
+
+  // It's important to clean up multi *before* cleaning up easy, because the multi cleanup
+  // code accesses stuff in the easy's structure.
+  if(session.m_multi)
+    multi_cleanup(session.m_multi);
+  if(session.m_easy)
+    easy_cleanup(session.m_easy);
+
+  m_stats.closed++;
+  CLog::Log(LOGDEBUG, "%s - Sessions created %u, reused %u, closed %u", __FUNCTION__, m_stats.created, m_stats.reused, m_stats.closed);
+
+  Unload();
+}
+
+DllLibCurlGlobal::SPoolStats DllLibCurlGlobal::GetPoolStats()
+{
+  CSingleLock lock(m_critSection);
+  return m_stats;
+}
+
 void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle)
 {
   assert(easy_handle != NULL);
 
   CSingleLock lock(m_critSection);
 
+  /* allow reuse of requester is trying to connect to same host */
+  /* curl will take care of any differences in username/password */
+  /* prefer the session released last, its connections are the most */
+  /* likely to still be open and past tcp slow start */
   VEC_CURLSESSIONS::iterator it;
+  VEC_CURLSESSIONS::iterator best = m_sessions.end();
   for(it = m_sessions.begin(); it != m_sessions.end(); ++it)
   {
-    if( !it->m_busy )
+    if( !it->m_busy && it->m_protocol.compare(protocol) == 0 && it->m_hostname.compare(hostname) == 0)
     {
-      /* allow reuse of requester is trying to connect to same host */
-      /* curl will take care of any differences in username/password */
-      if( it->m_protocol.compare(protocol) == 0 && it->m_hostname.compare(hostname) == 0)
-      {
-        it->m_busy = true;
-        if(easy_handle)
-        {
-          if(!it->m_easy)
-            it->m_easy = easy_init();
-
-          *easy_handle = it->m_easy;
-        }
-
-        if(multi_handle)
-        {
-          if(!it->m_multi)
-            it->m_multi = multi_init();
-
-          *multi_handle = it->m_multi;
-        }
-
-        return;
-      }
+      if (best == m_sessions.end() || it->m_idletimestamp - best->m_idletimestamp < 0x80000000)
+        best = it;
+    }
+  }
+
+  if (best != m_sessions.end())
+  {
+    best->m_busy = true;
+    best->m_reused++;
+    m_stats.reused++;
+    if(easy_handle)
+    {
+      if(!best->m_easy)
+        best->m_easy = easy_init();
+
+      *easy_handle = best->m_easy;
     }
+
+    if(multi_handle)
+    {
+      if(!best->m_multi)
+        best->m_multi = multi_init();
+
+      *multi_handle = best->m_multi;
+    }
+
+    return;
   }
 
   SSession session = {};
@@ -232,7 +290,7 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
   }
 
   m_sessions.push_back(session);
-
+  m_stats.created++;
 
   CLog::Log(LOGINFO, "%s - Created session to %s://%s\n", __FUNCTION__, protocol, hostname);
 
@@ -269,9 +327,34 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
       easy_reset(easy);
       it->m_busy = false;
       it->m_idletimestamp = XbmcThreads::SystemClockMillis();
-      return;
+      break;
     }
   }
+
+  if (it == m_sessions.end())
+    return;
+
+  /* don't let a burst of parallel requests leave an unbounded number of idle */
+  /* sessions to one host behind, close the one that has been idle the longest */
+  const std::string protocol = it->m_protocol;
+  const std::string hostname = it->m_hostname;
+  unsigned int idle = 0;
+  VEC_CURLSESSIONS::iterator oldest = m_sessions.end();
+  for(it = m_sessions.begin(); it != m_sessions.end(); ++it)
+  {
+    if( !it->m_busy && it->m_protocol == protocol && it->m_hostname == hostname )
+    {
+      idle++;
+      if (oldest == m_sessions.end() || oldest->m_idletimestamp - it->m_idletimestamp < 0x80000000)
+        oldest = it;
+    }
+  }
+
+  if (idle > MAX_IDLE_SESSIONS_PER_HOST)
+  {
+    CloseSession(*oldest);
+    m_sessions.erase(oldest);
+  }
 }
 
 CURL_HANDLE* DllLibCurlGlobal::easy_duphandle(CURL_HANDLE* easy_handle)
@@ -55,6 +55,8 @@ namespace XCURL
     virtual void multi_cleanup(CURL_HANDLE * handle )=0;
     virtual struct curl_slist* slist_append(struct curl_slist *, const char *)=0;
     virtual void  slist_free_all(struct curl_slist *)=0;
+    virtual CURLSH * share_init(void)=0;
+    virtual CURLSHcode share_cleanup(CURLSH *share_handle)=0;
   };
 
   class DllLibCurl : public DllDynamic, DllLibCurlInterface
@@ -81,6 +83,9 @@ namespace XCURL
     DEFINE_METHOD2(struct curl_slist*, slist_append, (struct curl_slist * p1, const char * p2))
     DEFINE_METHOD1(void, slist_free_all, (struct curl_slist * p1))
     DEFINE_METHOD1(const char *, easy_strerror, (CURLcode p1))
+    DEFINE_METHOD0(CURLSH *, share_init)
+    DEFINE_METHOD_FP(CURLSHcode, share_setopt, (CURLSH *p1, CURLSHoption p2, ...))
+    DEFINE_METHOD1(CURLSHcode, share_cleanup, (CURLSH *p1))
 #if defined(HAS_CURL_STATIC)
     DEFINE_METHOD1(void, crypto_set_id_callback, (unsigned long (*p1)(void)))
     DEFINE_METHOD1(void, crypto_set_locking_callback, (void (*p1)(int, int, const char *, int)))
@@ -107,6 +112,9 @@ namespace XCURL
       RESOLVE_METHOD_RENAME(curl_multi_cleanup, multi_cleanup)
       RESOLVE_METHOD_RENAME(curl_slist_append, slist_append)
       RESOLVE_METHOD_RENAME(curl_slist_free_all, slist_free_all)
+      RESOLVE_METHOD_RENAME(curl_share_init, share_init)
+      RESOLVE_METHOD_RENAME_FP(curl_share_setopt, share_setopt)
+      RESOLVE_METHOD_RENAME(curl_share_cleanup, share_cleanup)
 #if defined(HAS_CURL_STATIC)
       RESOLVE_METHOD_RENAME(CRYPTO_set_id_callback, crypto_set_id_callback)
       RESOLVE_METHOD_RENAME(CRYPTO_set_locking_callback, crypto_set_locking_callback)
@@ -118,6 +126,8 @@ namespace XCURL
   class DllLibCurlGlobal : public DllLibCurl
   {
   public:
+    DllLibCurlGlobal();
+
     /* extend interface with buffered functions */
     void easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle);
     void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle);
@@ -125,6 +135,19 @@ namespace XCURL
     CURL_HANDLE* easy_duphandle(CURL_HANDLE* easy_handle);
     void CheckIdle();
 
+    /* dns cache and ssl sessions shared by all handles, may be NULL */
+    CURLSH* GetShare() const { return m_share; }
+
+    /* statistics of the session pool */
+    typedef struct SPoolStats
+    {
+      unsigned int created;   // sessions opened
+      unsigned int reused;    // requests served by an idle session
+      unsigned int closed;    // sessions closed after being idle
+    } SPoolStats;
+
+    SPoolStats GetPoolStats();
+
     /* overloaded load and unload with reference counter */
     virtual bool Load();
     virtual void Unload();
@@ -136,6 +159,7 @@ namespace XCURL
       std::string   m_protocol;
       std::string   m_hostname;
       bool          m_busy;
+      unsigned int  m_reused;         // times this session was handed out again
       CURL_HANDLE*  m_easy;
       CURLM*        m_multi;
     } SSession;
@@ -144,6 +168,12 @@ namespace XCURL
 
     VEC_CURLSESSIONS m_sessions;
     CCriticalSection m_critSection;
+
+  private:
+    void CloseSession(SSession& session);
+
+    CURLSH*     m_share;
+    SPoolStats  m_stats;
   };
 }
 
@@ -26,8 +26,10 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "BlockCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/LatencyHistogram.h"
 #include "settings/AdvancedSettings.h"
 
 #include <cassert>
@@ -38,6 +40,9 @@ using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
 
+// a read stalls the player when it waits on the source for too long
+static CLatencyHistogram &s_readLatency = CLatencyHistograms::Get().GetHistogram("filecache.read", 500000);
+
 class CWriteRate
 {
 public:
@@ -113,6 +118,14 @@ CFileCache::CFileCache(bool useDoubleCache)
    m_writePos = 0;
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
+   else if (g_advancedSettings.m_cacheUseBlockCache)
+   {
+     // the block cache keeps the data around a seek by itself, no need to double it
+     size_t front = g_advancedSettings.m_cacheMemBufferSize;
+     size_t back = std::max<size_t>( g_advancedSettings.m_cacheMemBufferSize / 4, 1024 * 1024);
+     m_pCache = new CBlockCache(front, back);
+     useDoubleCache = false;
+   }
    else
    {
      size_t front = g_advancedSettings.m_cacheMemBufferSize;
@@ -394,6 +407,7 @@ int CFileCache::Stat(const CURL& url, struct __stat64* buffer)
 
 ssize_t CFileCache::Read(void* lpBuf, size_t uiBufSize)
 {
+  CLatencyTimer readTimer(s_readLatency);
   CSingleLock lock(m_sync);
   if (!m_pCache)
   {
@@ -416,6 +430,20 @@ retry:
 
   if (iRc == CACHE_RC_WOULD_BLOCK)
   {
+    // we may have been reading a range cached earlier, that the source is not
+    // being read after. move the source on to where the cached data ends.
+    if (m_seekPossible != 0 && m_pCache->CachedDataEndPosIfSeekTo(m_readPos) != m_pCache->CachedDataEndPos())
+    {
+      m_seekPos = m_readPos;
+      m_seekEvent.Set();
+      if (!m_seekEnded.Wait())
+      {
+        CLog::Log(LOGWARNING,"%s - seek to %" PRId64" failed.", __FUNCTION__, m_seekPos);
+        return -1;
+      }
+      m_seekEvent.Reset();
+    }
+
     // just wait for some data to show up
     iRc = m_pCache->WaitForData(1, 10000);
     if (iRc > 0)
@@ -25,6 +25,7 @@
 #include "addons/AddonManager.h"
 #include "addons/AddonInstaller.h"
 #include "addons/IAddon.h"
+#include "addons/PluginSource.h"
 #include "interfaces/generic/ScriptInvocationManager.h"
 #include "threads/SingleLock.h"
 #include "guilib/GUIWindowManager.h"
@@ -129,7 +130,9 @@ bool CPluginDirectory::StartScript(const std::string& strPath, bool retrievingDi
   CLog::Log(LOGDEBUG, "%s - calling plugin %s('%s','%s','%s')", __FUNCTION__, m_addon->Name().c_str(), argv[0].c_str(), argv[1].c_str(), argv[2].c_str());
   bool success = false;
   std::string file = m_addon->LibPath();
-  int id = CScriptInvocationManager::Get().ExecuteAsync(file, m_addon, argv);
+  PluginPtr plugin = std::dynamic_pointer_cast<CPluginSource>(m_addon);
+  bool reuseLanguageInvoker = plugin && plugin->ReuseLanguageInvoker();
+  int id = CScriptInvocationManager::Get().ExecuteAsync(file, m_addon, argv, reuseLanguageInvoker);
   if (id >= 0)
   { // wait for our script to finish
     std::string scriptName = m_addon->Name();
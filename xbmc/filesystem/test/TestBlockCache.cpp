@@ -0,0 +1,112 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/BlockCache.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+namespace
+{
+const int64_t BLOCK = 128 * 1024;
+
+// fill the cache from its current write position up to end, with bytes derived from the position
+void Fill(CBlockCache &cache, int64_t end)
+{
+  std::vector<char> buf(BLOCK);
+  int64_t pos = cache.CachedDataEndPos();
+  while (pos < end)
+  {
+    size_t len = (size_t)std::min<int64_t>(end - pos, BLOCK);
+    for (size_t i = 0; i < len; i++)
+      buf[i] = (char)((pos + i) % 251);
+    int written = cache.WriteToCache(&buf[0], len);
+    ASSERT_GT(written, 0);
+    pos += written;
+  }
+}
+
+bool ReadsBack(CBlockCache &cache, int64_t pos, size_t len)
+{
+  std::vector<char> buf(len);
+  int read = cache.ReadFromCache(&buf[0], len);
+  if (read <= 0)
+    return false;
+  for (int i = 0; i < read; i++)
+  {
+    if (buf[i] != (char)((pos + i) % 251))
+      return false;
+  }
+  return true;
+}
+}
+
+TEST(TestBlockCache, KeepsRangeAfterSeekAway)
+{
+  CBlockCache cache(4 * BLOCK, 4 * BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // header at the start of the file
+  Fill(cache, 2 * BLOCK);
+  EXPECT_TRUE(ReadsBack(cache, 0, 1000));
+
+  // index at the end, not cached yet so the source has to be moved there
+  int64_t index = 100 * BLOCK + 10;
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(index));
+  EXPECT_EQ(100 * BLOCK, cache.CachedDataEndPosIfSeekTo(index));
+  EXPECT_TRUE(cache.Reset(index, false));
+  Fill(cache, 101 * BLOCK);
+  EXPECT_TRUE(ReadsBack(cache, index, 1000));
+
+  // back to the start, which must still be cached
+  EXPECT_TRUE(cache.IsCachedPosition(500));
+  EXPECT_EQ(500, cache.Seek(500));
+  EXPECT_TRUE(ReadsBack(cache, 500, 1000));
+  EXPECT_EQ(2 * BLOCK, cache.CachedDataEndPosIfSeekTo(500));
+
+  // the writer waits to be moved to the end of that range
+  EXPECT_EQ(0U, cache.GetMaxWriteSize(BLOCK));
+  EXPECT_FALSE(cache.Reset(1500, false));
+  EXPECT_EQ(2 * BLOCK, cache.CachedDataEndPos());
+  EXPECT_LT(0U, cache.GetMaxWriteSize(BLOCK));
+
+  cache.Close();
+}
+
+TEST(TestBlockCache, EvictsLeastRecentlyUsed)
+{
+  CBlockCache cache(2 * BLOCK, 2 * BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // read more than the cache holds, the start of the file has to go
+  for (int64_t block = 0; block < 8; block++)
+  {
+    Fill(cache, (block + 1) * BLOCK);
+    EXPECT_TRUE(ReadsBack(cache, block * BLOCK, BLOCK));
+  }
+
+  EXPECT_FALSE(cache.IsCachedPosition(0));
+  EXPECT_TRUE(cache.IsCachedPosition(7 * BLOCK));
+
+  cache.Close();
+}
@@ -0,0 +1,315 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#if defined(TARGET_POSIX)
+
+// before DllLibCurl.h, which includes curl.h and its socket headers in a namespace
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include "filesystem/CurlFile.h"
+#include "filesystem/DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "URL.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ctype.h>
+#include <inttypes.h>
+#include <map>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+/* Minimal HTTP/1.1 server with keep-alive and byte ranges, serving one file.
+   Requests for /norange ignore the Range header like some servers do. */
+class CTestHttpServer : public CThread
+{
+public:
+  CTestHttpServer(const std::string &content)
+    : CThread("TestHttpServer"), m_port(0), m_connections(0), m_requests(0),
+      m_ranges(0), m_content(content)
+  {
+    m_listen = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(m_listen, (struct sockaddr*)&addr, len) == 0 &&
+        listen(m_listen, 16) == 0 &&
+        getsockname(m_listen, (struct sockaddr*)&addr, &len) == 0)
+      m_port = ntohs(addr.sin_port);
+  }
+
+  ~CTestHttpServer()
+  {
+    StopThread(true);
+    for (std::map<int, std::string>::iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+      close(it->first);
+    close(m_listen);
+  }
+
+  std::string GetURL(const std::string &path) const
+  {
+    return StringUtils::Format("http://127.0.0.1:%d/%s", m_port, path.c_str());
+  }
+
+  int m_port;
+  std::atomic<int> m_connections;
+  std::atomic<int> m_requests;
+  std::atomic<int> m_ranges;
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(m_listen, &fds);
+      int maxfd = m_listen;
+      for (std::map<int, std::string>::iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+      {
+        FD_SET(it->first, &fds);
+        maxfd = std::max(maxfd, it->first);
+      }
+
+      struct timeval t = { 0, 50000 };
+      if (select(maxfd + 1, &fds, NULL, NULL, &t) <= 0)
+        continue;
+
+      if (FD_ISSET(m_listen, &fds))
+      {
+        int client = accept(m_listen, NULL, NULL);
+        if (client >= 0)
+        {
+          m_clients[client] = "";
+          m_connections++;
+        }
+      }
+
+      for (std::map<int, std::string>::iterator it = m_clients.begin(); it != m_clients.end();)
+      {
+        if (FD_ISSET(it->first, &fds) && !Receive(it->first, it->second))
+        {
+          close(it->first);
+          m_clients.erase(it++);
+        }
+        else
+          ++it;
+      }
+    }
+  }
+
+private:
+  bool Receive(int client, std::string &request)
+  {
+    char buffer[4096];
+    ssize_t len = recv(client, buffer, sizeof(buffer), 0);
+    if (len <= 0)
+      return false;
+    request.append(buffer, len);
+
+    size_t end;
+    while ((end = request.find("\r\n\r\n")) != std::string::npos)
+    {
+      std::string header = request.substr(0, end);
+      request.erase(0, end + 4);
+      if (!Respond(client, header))
+        return false;
+    }
+    return true;
+  }
+
+  bool Respond(int client, const std::string &header)
+  {
+    m_requests++;
+    int64_t size = m_content.size();
+    int64_t first = 0;
+    int64_t last = size - 1;
+    bool ranged = false;
+
+    size_t pos = header.find("Range: bytes=");
+    if (pos != std::string::npos && header.find("GET /norange") != 0)
+    {
+      ranged = true;
+      m_ranges++;
+      const char *range = header.c_str() + pos + 13;
+      char *next;
+      first = strtoll(range, &next, 10);
+      if (*next == '-' && isdigit(next[1]))
+        last = std::min(strtoll(next + 1, NULL, 10), (long long)size - 1);
+    }
+
+    std::string response;
+    if (ranged)
+      response = StringUtils::Format("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %" PRId64 "-%" PRId64 "/%" PRId64 "\r\n", first, last, size);
+    else
+      response = "HTTP/1.1 200 OK\r\n";
+    response += StringUtils::Format("Accept-Ranges: bytes\r\nContent-Type: application/octet-stream\r\nContent-Length: %" PRId64 "\r\n\r\n", last - first + 1);
+    response.append(m_content, first, last - first + 1);
+
+    // blocking, curl reads everything it asked for except on connections it drops
+    size_t sent = 0;
+    while (sent < response.size())
+    {
+      ssize_t len = send(client, response.c_str() + sent, response.size() - sent, MSG_NOSIGNAL);
+      if (len <= 0)
+        return false;
+      sent += len;
+    }
+    return true;
+  }
+
+  std::string m_content;
+  int m_listen;
+  std::map<int, std::string> m_clients;
+};
+
+class TestCurlFile : public testing::Test
+{
+protected:
+  TestCurlFile()
+  {
+    m_connections = g_advancedSettings.m_curlRangeConnections;
+    m_chunkSize = g_advancedSettings.m_curlRangeChunkSize;
+    g_advancedSettings.m_curlRangeConnections = 4;
+    g_advancedSettings.m_curlRangeChunkSize = 65536;
+
+    srand(42);
+    m_content.resize(20 * 65536 + 1234);
+    for (size_t i = 0; i < m_content.size(); i++)
+      m_content[i] = (char)rand();
+  }
+
+  ~TestCurlFile()
+  {
+    g_advancedSettings.m_curlRangeConnections = m_connections;
+    g_advancedSettings.m_curlRangeChunkSize = m_chunkSize;
+  }
+
+  std::string ReadAll(XFILE::CCurlFile &file, size_t readSize)
+  {
+    std::string data;
+    std::vector<char> buffer(readSize);
+    ssize_t read;
+    while ((read = file.Read(&buffer[0], buffer.size())) > 0)
+      data.append(&buffer[0], read);
+    return data;
+  }
+
+  std::string m_content;
+  unsigned int m_connections;
+  unsigned int m_chunkSize;
+};
+}
+
+TEST_F(TestCurlFile, RangeReads)
+{
+  CTestHttpServer server(m_content);
+  ASSERT_NE(0, server.m_port);
+  server.Create();
+
+  XFILE::CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetURL("file.bin"))));
+  EXPECT_EQ((int64_t)m_content.size(), file.GetLength());
+  EXPECT_TRUE(m_content == ReadAll(file, 10000));
+  EXPECT_EQ((int64_t)m_content.size(), file.GetPosition());
+  file.Close();
+
+  // one request per chunk plus the one opening the file, on kept alive connections
+  EXPECT_EQ(22, server.m_ranges);
+  EXPECT_GE(6, server.m_connections);
+}
+
+TEST_F(TestCurlFile, RangeSeeks)
+{
+  CTestHttpServer server(m_content);
+  ASSERT_NE(0, server.m_port);
+  server.Create();
+
+  XFILE::CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetURL("file.bin"))));
+
+  char buffer[3000];
+  const int64_t positions[] = { 100, 70000, 65536 * 7 - 10, 200000, 5, (int64_t)m_content.size() - 1000 };
+  for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+  {
+    ASSERT_EQ(positions[i], file.Seek(positions[i], SEEK_SET));
+    ssize_t read = 0;
+    while (read < 1000)
+    {
+      ssize_t len = file.Read(buffer + read, 1000 - read);
+      ASSERT_LT(0, len);
+      read += len;
+    }
+    EXPECT_EQ(0, memcmp(buffer, m_content.c_str() + positions[i], 1000));
+    EXPECT_EQ(positions[i] + 1000, file.GetPosition());
+  }
+  EXPECT_EQ(0, file.Read(buffer, sizeof(buffer)));
+  file.Close();
+}
+
+TEST_F(TestCurlFile, RangesIgnoredByServer)
+{
+  CTestHttpServer server(m_content);
+  ASSERT_NE(0, server.m_port);
+  server.Create();
+
+  // falls back to a single connection
+  XFILE::CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetURL("norange"))));
+  EXPECT_TRUE(m_content == ReadAll(file, 10000));
+  file.Close();
+}
+
+TEST_F(TestCurlFile, SessionsReused)
+{
+  g_advancedSettings.m_curlRangeConnections = 0;
+
+  CTestHttpServer server(m_content);
+  ASSERT_NE(0, server.m_port);
+  server.Create();
+
+  XCURL::DllLibCurlGlobal::SPoolStats before = g_curlInterface.GetPoolStats();
+  for (int i = 0; i < 3; i++)
+  {
+    XFILE::CCurlFile file;
+    ASSERT_TRUE(file.Open(CURL(server.GetURL("file.bin"))));
+    EXPECT_TRUE(m_content == ReadAll(file, 65536));
+    file.Close();
+  }
+  XCURL::DllLibCurlGlobal::SPoolStats after = g_curlInterface.GetPoolStats();
+
+  EXPECT_LE(2U, after.reused - before.reused);
+  EXPECT_EQ(1, server.m_connections);
+}
+
+#endif
@@ -61,6 +61,7 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
   m_autoScrollDelayTime = 0;
   m_autoScrollIsReversed = false;
   m_lastRenderTime = 0;
+  m_prerenderOffset = -1;
 }
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
@@ -143,11 +144,31 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   // to have same behaviour when scrolling down, we need to set page control to offset+1
   UpdatePageControl(offset + (m_scroller.IsScrollingDown() ? 1 : 0));
 
+  PrerenderItems(offset, cacheBefore, cacheAfter);
+
   m_lastRenderTime = currentTime;
 
   CGUIControl::Process(currentTime, dirtyregions);
 }
 
+void CGUIBaseContainer::PrerenderItems(int offset, int cacheBefore, int cacheAfter)
+{
+  if (offset == m_prerenderOffset)
+    return;
+
+  // have the fonts rasterize the labels of the page we are scrolling towards,
+  // so their glyphs are ready once the items come into view
+  int first = (offset > m_prerenderOffset) ? offset + m_itemsPerPage + cacheAfter
+                                           : offset - cacheBefore - m_itemsPerPage;
+  for (int current = first; current < first + m_itemsPerPage; current++)
+  {
+    int itemNo = CorrectOffset(current, 0);
+    if (itemNo >= 0 && itemNo < (int)m_items.size())
+      m_layout->Prerender(m_items[itemNo].get());
+  }
+  m_prerenderOffset = offset;
+}
+
 void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& item, bool focused, unsigned int currentTime, CDirtyRegionList &dirtyregions)
 {
   if (!m_focusedLayout || !m_layout) return;
@@ -207,9 +207,12 @@ protected:
   unsigned int m_lastRenderTime;
 
 private:
+  void PrerenderItems(int offset, int cacheBefore, int cacheAfter);
+
   int m_cursor;
   int m_offset;
   int m_cacheItems;
+  int m_prerenderOffset;  ///< offset the glyphs of the neighbouring page were prerendered for
   CStopWatch m_scrollTimer;
   CStopWatch m_lastScrollStartTimer;
   CStopWatch m_pageChangeTimer;
@@ -19,6 +19,7 @@
  */
 
 #include "GUIControlProfiler.h"
+#include "GUIInfoManager.h"
 #include "utils/XBMCTinyXML.h"
 #include "utils/TimeUtils.h"
 #include "utils/StringUtils.h"
@@ -260,6 +261,8 @@ void CGUIControlProfiler::Start(void)
   m_bIsRunning = true;
   m_pLastItem = NULL;
   m_ItemHead.Reset(this);
+  g_infoManager.ResetInfoBoolProfile();
+  INFO::InfoBool::SetProfiling(true);
 }
 
 void CGUIControlProfiler::BeginVisibility(CGUIControl *pControl)
@@ -328,6 +331,7 @@ void CGUIControlProfiler::EndFrame(void)
     }
 
     m_bIsRunning = false;
+    INFO::InfoBool::SetProfiling(false);
     if (SaveResults())
       m_ItemHead.Reset(this);
   }
@@ -349,5 +353,23 @@ bool CGUIControlProfiler::SaveResults(void)
   doc.LinkEndChild(root);
 
   m_ItemHead.SaveToXML(root);
+
+  // cost of the visibility conditions, most expensive first
+  TiXmlElement *xmlInfoBools = new TiXmlElement("infobools");
+  root->LinkEndChild(xmlInfoBools);
+  std::vector<INFO::InfoPtr> infoBools = g_infoManager.GetInfoBoolProfile();
+  for (std::vector<INFO::InfoPtr>::const_iterator it = infoBools.begin(); it != infoBools.end(); ++it)
+  {
+    TiXmlElement *xmlInfoBool = new TiXmlElement("infobool");
+    xmlInfoBool->SetAttribute("expression", (*it)->GetExpression().c_str());
+    str = StringUtils::Format("%u", (*it)->GetEvaluations());
+    xmlInfoBool->SetAttribute("evaluations", str.c_str());
+    str = StringUtils::Format("%.3f", (*it)->GetEvaluationTime() * 1000.0 / CurrentHostFrequency());
+    xmlInfoBool->SetAttribute("time", str.c_str());
+    str = StringUtils::Format("%.3f", (*it)->GetEvaluationTime() * 1000.0 / CurrentHostFrequency() / (*it)->GetEvaluations());
+    xmlInfoBool->SetAttribute("average", str.c_str());
+    xmlInfoBools->LinkEndChild(xmlInfoBool);
+  }
+
   return doc.SaveFile(m_strOutputFile);
 }
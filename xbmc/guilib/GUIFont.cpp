@@ -241,6 +241,13 @@ float CGUIFont::GetTextWidth( const vecText &text )
   return m_font->GetTextWidthInternal(text.begin(), text.end()) * g_graphicsContext.GetGUIScaleX();
 }
 
+void CGUIFont::Prerender(const vecText &text)
+{
+  if (!m_font) return;
+  CSingleLock lock(g_graphicsContext);
+  m_font->Prerender(text);
+}
+
 float CGUIFont::GetCharWidth( character_t ch )
 {
   if (!m_font) return 0;
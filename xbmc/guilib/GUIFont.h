@@ -128,6 +128,9 @@ public:
 
   float GetTextWidth( const vecText &text );
   float GetCharWidth( character_t ch );
+
+  /*! \brief Rasterize the glyphs of text that is likely to be drawn soon in the background */
+  void Prerender(const vecText &text);
   float GetTextHeight(int numLines) const;
   float GetTextBaseLine() const;
   float GetLineHeight() const;
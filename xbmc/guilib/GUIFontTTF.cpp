@@ -29,11 +29,14 @@
 #include "windowing/WindowingFactory.h"
 #include "URL.h"
 #include "filesystem/File.h"
+#include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 
+#include <deque>
 #include <math.h>
 #include <memory>
 #include <queue>
+#include <unordered_set>
 
 // stuff for freetype
 #include <ft2build.h>
@@ -52,7 +55,7 @@ using namespace std;
 
 
 #define CHARS_PER_TEXTURE_LINE 20 // number of characters to cache per texture line
-#define CHAR_CHUNK    64      // 64 chars allocated at a time (1024 bytes)
+#define MAX_PRERENDER_GLYPHS  1024 // glyphs waiting in the background rasterizer
 
 
 class CFreeTypeLibrary
@@ -80,8 +83,6 @@ public:
       return NULL;
     }
 
-    FT_Face face;
-
     // ok, now load the font face
     CURL realFile(CSpecialProtocol::TranslatePath(filename));
     if (realFile.GetFileName().empty())
@@ -98,11 +99,28 @@ public:
       XFILE::CFile f;
       if (f.LoadFile(realFile, memoryBuf) <= 0)
         return NULL;
-      if (FT_New_Memory_Face(m_library, (const FT_Byte*)memoryBuf.get(), memoryBuf.size(), 0, &face) != 0)
+    }
+
+    return OpenFace(m_library, realFile.GetFileName(), size, aspect, memoryBuf);
+  };
+
+  /*! \brief open a face of a font that is either in memoryBuf or a local file
+   Also used by the background rasterizers, which have a library of their own
+   as a library and its faces must only be used by one thread at a time.
+   */
+  static FT_Face OpenFace(FT_Library library, const std::string &localFile, float size, float aspect, const XUTILS::auto_buffer& memoryBuf)
+  {
+    FT_Face face;
+    if (memoryBuf.size() > 0)
+    {
+      if (FT_New_Memory_Face(library, (const FT_Byte*)memoryBuf.get(), memoryBuf.size(), 0, &face) != 0)
         return NULL;
     }
 #ifndef TARGET_WINDOWS
-    else if (FT_New_Face( m_library, realFile.GetFileName().c_str(), 0, &face ))
+    else if (FT_New_Face( library, localFile.c_str(), 0, &face ))
+      return NULL;
+#else
+    else
       return NULL;
 #endif // ! TARGET_WINDOWS
 
@@ -153,11 +171,207 @@ private:
 XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 #define g_freeTypeLibrary XBMC_GLOBAL_USE(CFreeTypeLibrary)
 
-CGUIFontTTFBase::CGUIFontTTFBase(const std::string& strFileName) : m_staticCache(*this), m_dynamicCache(*this)
+/*!
+ \brief Rasterizes glyphs of a font on a job worker ahead of drawing.
+
+ The worker has its own freetype library and face, the resulting bitmaps are
+ handed to the font on the render thread, which only has to copy them into
+ its texture. Shared with the jobs so a running job may outlive the font.
+ */
+class CGUIFontRasterizer
+{
+public:
+  CGUIFontRasterizer(const std::string &localFile, const std::shared_ptr<XUTILS::auto_buffer> &memoryBuf,
+                     float height, float aspect, FT_Pos borderStrength)
+    : m_localFile(localFile), m_memoryBuf(memoryBuf), m_height(height), m_aspect(aspect),
+      m_borderStrength(borderStrength), m_library(NULL), m_face(NULL), m_stroker(NULL),
+      m_failed(false), m_busy(false), m_readyBytes(0)
+  {
+  }
+
+  ~CGUIFontRasterizer()
+  {
+    if (m_stroker)
+      CFreeTypeLibrary::ReleaseStroker(m_stroker);
+    if (m_face)
+      CFreeTypeLibrary::ReleaseFont(m_face);
+    if (m_library)
+      FT_Done_FreeType(m_library);
+  }
+
+  /*! \brief queue glyphs for rasterizing
+   \return true if a job has to be started for them
+   */
+  bool Queue(const std::vector<character_t> &glyphs)
+  {
+    CSingleLock lock(m_critical);
+    if (m_failed)
+      return false;
+
+    bool queued = false;
+    for (std::vector<character_t>::const_iterator it = glyphs.begin(); it != glyphs.end(); ++it)
+    {
+      if (m_pending.size() + m_ready.size() >= MAX_PRERENDER_GLYPHS)
+        break;
+      if (m_ready.find(*it) != m_ready.end() || !m_pending.insert(*it).second)
+        continue;
+      m_queue.push_back(*it);
+      queued = true;
+    }
+
+    if (!queued || m_busy)
+      return false;
+    m_busy = true;
+    return true;
+  }
+
+  /*! \brief take a rasterized glyph, drops it from the queue if it isn't ready yet
+   as the font rasterizes it itself in that case
+   */
+  bool Take(character_t letterAndStyle, CGUIFontTTFBase::GlyphBitmap &glyph)
+  {
+    CSingleLock lock(m_critical);
+    std::unordered_map<character_t, CGUIFontTTFBase::GlyphBitmap>::iterator it = m_ready.find(letterAndStyle);
+    if (it == m_ready.end())
+    {
+      m_pending.erase(letterAndStyle);
+      return false;
+    }
+    glyph.left = it->second.left;
+    glyph.top = it->second.top;
+    glyph.width = it->second.width;
+    glyph.rows = it->second.rows;
+    glyph.advance = it->second.advance;
+    glyph.pixels.swap(it->second.pixels);
+    m_readyBytes -= glyph.pixels.size();
+    m_ready.erase(it);
+    return true;
+  }
+
+  void Abort()
+  {
+    CSingleLock lock(m_critical);
+    m_queue.clear();
+    m_pending.clear();
+  }
+
+  unsigned int GetReadyBytes() const
+  {
+    CSingleLock lock(m_critical);
+    return m_readyBytes;
+  }
+
+  /*! \brief rasterize queued glyphs until the queue is empty, runs on a job worker */
+  void Rasterize()
+  {
+    if (!Open())
+    {
+      CSingleLock lock(m_critical);
+      m_failed = true;
+      m_busy = false;
+      m_queue.clear();
+      m_pending.clear();
+      return;
+    }
+
+    for (;;)
+    {
+      character_t letterAndStyle;
+      {
+        CSingleLock lock(m_critical);
+        while (!m_queue.empty() && m_pending.find(m_queue.front()) == m_pending.end())
+          m_queue.pop_front(); // taken by the font in the meantime
+        if (m_queue.empty())
+        {
+          m_busy = false;
+          return;
+        }
+        letterAndStyle = m_queue.front();
+        m_queue.pop_front();
+      }
+
+      CGUIFontTTFBase::GlyphBitmap glyph;
+      bool rendered = CGUIFontTTFBase::RasterizeGlyph(m_face, m_stroker, (wchar_t)(letterAndStyle & 0xffff),
+                                                      letterAndStyle >> 16, glyph);
+
+      CSingleLock lock(m_critical);
+      if (m_pending.erase(letterAndStyle) && rendered)
+      {
+        m_readyBytes += glyph.pixels.size();
+        m_ready[letterAndStyle] = glyph;
+      }
+    }
+  }
+
+private:
+  bool Open()
+  {
+    if (m_face)
+      return true;
+
+    if (FT_Init_FreeType(&m_library))
+    {
+      m_library = NULL;
+      return false;
+    }
+    m_face = CFreeTypeLibrary::OpenFace(m_library, m_localFile, m_height, m_aspect, *m_memoryBuf);
+    if (!m_face)
+    {
+      CLog::Log(LOGERROR, "%s: unable to open font %s", __FUNCTION__, m_localFile.c_str());
+      return false;
+    }
+    if (m_borderStrength && FT_Stroker_New(m_library, &m_stroker) == 0)
+      FT_Stroker_Set(m_stroker, m_borderStrength, FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+    return true;
+  }
+
+  std::string m_localFile;
+  std::shared_ptr<XUTILS::auto_buffer> m_memoryBuf;
+  float m_height;
+  float m_aspect;
+  FT_Pos m_borderStrength;
+
+  // only used by the job
+  FT_Library m_library;
+  FT_Face m_face;
+  FT_Stroker m_stroker;
+
+  mutable CCriticalSection m_critical;
+  bool m_failed;
+  bool m_busy;                                  ///< a job is rasterizing the queue
+  std::deque<character_t> m_queue;
+  std::unordered_set<character_t> m_pending;    ///< queued and not taken by the font yet
+  std::unordered_map<character_t, CGUIFontTTFBase::GlyphBitmap> m_ready;
+  unsigned int m_readyBytes;
+};
+
+namespace
+{
+class CGUIFontRasterizeJob : public CJob
+{
+public:
+  CGUIFontRasterizeJob(const std::shared_ptr<CGUIFontRasterizer> &rasterizer)
+    : m_rasterizer(rasterizer)
+  {
+  }
+
+  virtual bool DoWork()
+  {
+    m_rasterizer->Rasterize();
+    return true;
+  }
+
+  virtual const char *GetType() const { return "fontrasterize"; }
+
+private:
+  std::shared_ptr<CGUIFontRasterizer> m_rasterizer;
+};
+}
+
+CGUIFontTTFBase::CGUIFontTTFBase(const std::string& strFileName)
+  : m_rasterQueue(false, 1, CJob::PRIORITY_LOW), m_staticCache(*this), m_dynamicCache(*this)
 {
   m_texture = NULL;
-  m_char = NULL;
-  m_maxChars = 0;
   m_nestedBeginCount = 0;
 
   m_vertex.reserve(4*1024);
@@ -169,7 +383,7 @@ CGUIFontTTFBase::CGUIFontTTFBase(const std::string& strFileName) : m_staticCache
   m_referenceCount = 0;
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
-  m_numChars = 0;
+  m_rendered = m_prerendered = 0;
   m_posX = m_posY = 0;
   m_textureHeight = m_textureWidth = 0;
   m_textureScaleX = m_textureScaleY = 0.0;
@@ -204,11 +418,8 @@ void CGUIFontTTFBase::ClearCharacterCache()
   DeleteHardwareTexture();
 
   m_texture = NULL;
-  delete[] m_char;
-  m_char = new Character[CHAR_CHUNK];
+  m_char.clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_numChars = 0;
-  m_maxChars = CHAR_CHUNK;
   // set the posX and posY so that our texture will be created on first character write.
   m_posX = m_textureWidth;
   m_posY = -(int)GetTextureLineHeight();
@@ -217,13 +428,23 @@ void CGUIFontTTFBase::ClearCharacterCache()
 
 void CGUIFontTTFBase::Clear()
 {
+  if (!m_char.empty())
+  {
+    FontStats stats = GetStats();
+    CLog::Log(LOGDEBUG, "%s: %s: %u glyphs in %u texture bytes, %u rasterized while drawing, %u in the background",
+              __FUNCTION__, m_strFilename.c_str(), stats.glyphs, stats.textureBytes, stats.rendered, stats.prerendered);
+  }
+
+  m_rasterQueue.CancelJobs();
+  if (m_rasterizer)
+    m_rasterizer->Abort();
+  m_rasterizer.reset();
+  m_rendered = m_prerendered = 0;
+
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
+  m_char.clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_char = NULL;
-  m_maxChars = 0;
-  m_numChars = 0;
   m_posX = 0;
   m_posY = 0;
   m_nestedBeginCount = 0;
@@ -239,14 +460,15 @@ void CGUIFontTTFBase::Clear()
   m_vertex.clear();
 
   m_strFileName.clear();
-  m_fontFileInMemory.clear();
+  m_fontFileInMemory.reset();
 }
 
 bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float aspect, float lineSpacing, bool border)
 {
   // we now know that this object is unique - only the GUIFont objects are non-unique, so no need
   // for reference tracking these fonts
-  m_face = g_freeTypeLibrary.GetFont(strFilename, height, aspect, m_fontFileInMemory);
+  m_fontFileInMemory = std::make_shared<XUTILS::auto_buffer>();
+  m_face = g_freeTypeLibrary.GetFont(strFilename, height, aspect, *m_fontFileInMemory);
 
   if (!m_face)
     return false;
@@ -272,13 +494,14 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
   int cellDescender = std::min<int>(m_face->bbox.yMin, m_face->descender);
   int cellAscender  = std::max<int>(m_face->bbox.yMax, m_face->ascender);
 
+  FT_Pos strength = 0;
   if (border)
   {
     /*
      add on the strength of any border - the non-bordered font needs
      aligning with the bordered font by utilising GetTextBaseLine()
      */
-    FT_Pos strength = FT_MulFix( m_face->units_per_EM, m_face->size->metrics.y_scale) / 12;
+    strength = FT_MulFix( m_face->units_per_EM, m_face->size->metrics.y_scale) / 12;
     if (strength < 128)
       strength = 128;
 
@@ -302,14 +525,13 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
 
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
-  m_char = NULL;
-
-  m_maxChars = 0;
-  m_numChars = 0;
+  m_char.clear();
 
   m_strFilename = strFilename;
 
+  m_rasterizer = std::make_shared<CGUIFontRasterizer>(CURL(CSpecialProtocol::TranslatePath(strFilename)).GetFileName(),
+                                                      m_fontFileInMemory, height, aspect, strength);
+
   m_textureHeight = 0;
   m_textureWidth = ((m_cellHeight * CHARS_PER_TEXTURE_LINE) & ~63) + 64;
 
@@ -621,49 +843,21 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   // letters are stored based on style and letter
   character_t ch = (style << 16) | letter;
 
-  int low = 0;
-  int high = m_numChars - 1;
-  while (low <= high)
-  {
-    int mid = (low + high) >> 1;
-    if (ch > m_char[mid].letterAndStyle)
-      low = mid + 1;
-    else if (ch < m_char[mid].letterAndStyle)
-      high = mid - 1;
-    else
-      return &m_char[mid];
-  }
-  // if we get to here, then low is where we should insert the new character
+  std::unordered_map<character_t, Character>::iterator it = m_char.find(ch);
+  if (it != m_char.end())
+    return &it->second;
 
-  // increase the size of the buffer if we need it
-  if (m_numChars >= m_maxChars)
-  { // need to increase the size of the buffer
-    Character *newTable = new Character[m_maxChars + CHAR_CHUNK];
-    if (m_char)
-    {
-      memcpy(newTable, m_char, low * sizeof(Character));
-      memcpy(newTable + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-      delete[] m_char;
-    }
-    m_char = newTable;
-    m_maxChars += CHAR_CHUNK;
-
-  }
-  else
-  { // just move the data along as necessary
-    memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-  }
   // render the character to our texture
   // must End() as we can't render text to our texture during a Begin(), End() block
+  Character character;
   unsigned int nestedBeginCount = m_nestedBeginCount;
   m_nestedBeginCount = 1;
   if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
+  if (!CacheCharacter(letter, style, &character))
   { // unable to cache character - try clearing them all out and starting over
-    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, m_numChars);
+    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, (int)m_char.size());
     ClearCharacterCache();
-    low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
+    if (!CacheCharacter(letter, style, &character))
     {
       CLog::Log(LOGERROR, "%s: Unable to cache character (out of memory?)", __FUNCTION__);
       if (nestedBeginCount) Begin();
@@ -674,44 +868,73 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   if (nestedBeginCount) Begin();
   m_nestedBeginCount = nestedBeginCount;
 
+  Character *cached = &m_char.insert(std::make_pair(ch, character)).first->second;
+
   // fixup quick access
-  memset(m_charquick, 0, sizeof(m_charquick));
-  for(int i=0;i<m_numChars;i++)
+  if (letter < 255)
+    m_charquick[(style << 8) | letter] = cached;
+
+  return cached;
+}
+
+void CGUIFontTTFBase::Prerender(const vecText &text)
+{
+  if (!m_rasterizer)
+    return;
+
+  std::vector<character_t> glyphs;
+  for (vecText::const_iterator it = text.begin(); it != text.end(); ++it)
   {
-    if ((m_char[i].letterAndStyle & 0xffff) < 255)
-    {
-      character_t ch = ((m_char[i].letterAndStyle & 0xffff0000) >> 8) | (m_char[i].letterAndStyle & 0xff);
-      m_charquick[ch] = m_char+i;
-    }
+    wchar_t letter = (wchar_t)(*it & 0xffff);
+    character_t style = (*it & 0x3000000) >> 24;
+    if (letter == L'\r' || letter == L'\n')
+      continue;
+    if (letter < 255 && m_charquick[(style << 8) | letter])
+      continue;
+    character_t ch = (style << 16) | letter;
+    if (m_char.find(ch) == m_char.end())
+      glyphs.push_back(ch);
   }
 
-  return m_char + low;
+  if (!glyphs.empty() && m_rasterizer->Queue(glyphs))
+    m_rasterQueue.AddJob(new CGUIFontRasterizeJob(m_rasterizer));
 }
 
-bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
+CGUIFontTTFBase::FontStats CGUIFontTTFBase::GetStats() const
 {
-  int glyph_index = FT_Get_Char_Index( m_face, letter );
+  FontStats stats;
+  stats.glyphs = m_char.size();
+  stats.textureBytes = m_textureWidth * m_textureHeight; // 8bit alpha
+  stats.pendingBytes = m_rasterizer ? m_rasterizer->GetReadyBytes() : 0;
+  stats.rendered = m_rendered;
+  stats.prerendered = m_prerendered;
+  return stats;
+}
+
+bool CGUIFontTTFBase::RasterizeGlyph(FT_Face face, FT_Stroker stroker, wchar_t letter, uint32_t style, GlyphBitmap &glyphBitmap)
+{
+  int glyph_index = FT_Get_Char_Index( face, letter );
 
   FT_Glyph glyph = NULL;
-  if (FT_Load_Glyph( m_face, glyph_index, FT_LOAD_TARGET_LIGHT ))
+  if (FT_Load_Glyph( face, glyph_index, FT_LOAD_TARGET_LIGHT ))
   {
     CLog::Log(LOGDEBUG, "%s Failed to load glyph %x", __FUNCTION__, letter);
     return false;
   }
   // make bold if applicable
   if (style & FONT_STYLE_BOLD)
-    EmboldenGlyph(m_face->glyph);
+    EmboldenGlyph(face, face->glyph);
   // and italics if applicable
   if (style & FONT_STYLE_ITALICS)
-    ObliqueGlyph(m_face->glyph);
+    ObliqueGlyph(face->glyph);
   // grab the glyph
-  if (FT_Get_Glyph(m_face->glyph, &glyph))
+  if (FT_Get_Glyph(face->glyph, &glyph))
   {
     CLog::Log(LOGDEBUG, "%s Failed to get glyph %x", __FUNCTION__, letter);
     return false;
   }
-  if (m_stroker)
-    FT_Glyph_StrokeBorder(&glyph, m_stroker, 0, 1);
+  if (stroker)
+    FT_Glyph_StrokeBorder(&glyph, stroker, 0, 1);
   // render the glyph
   if (FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, NULL, 1))
   {
@@ -719,21 +942,54 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
     return false;
   }
   FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)glyph;
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-  bool isEmptyGlyph = (bitmap.width == 0 || bitmap.rows == 0);
+  const FT_Bitmap &bitmap = bitGlyph->bitmap;
+
+  glyphBitmap.left = bitGlyph->left;
+  glyphBitmap.top = bitGlyph->top;
+  glyphBitmap.width = bitmap.width;
+  glyphBitmap.rows = bitmap.rows;
+  glyphBitmap.advance = face->glyph->advance.x;
+
+  // copy without row padding so the texture code can rely on pitch == width
+  glyphBitmap.pixels.resize(bitmap.width * bitmap.rows);
+  for (unsigned int y = 0; y < (unsigned int)bitmap.rows; y++)
+  {
+    const unsigned char *row = bitmap.pitch >= 0 ? bitmap.buffer + y * bitmap.pitch
+                                                 : bitmap.buffer + (bitmap.rows - 1 - y) * -bitmap.pitch;
+    memcpy(&glyphBitmap.pixels[y * bitmap.width], row, bitmap.width);
+  }
+
+  // free the glyph
+  FT_Done_Glyph(glyph);
+
+  return true;
+}
+
+bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
+{
+  // use the glyph from the background rasterizer if it got to it first
+  GlyphBitmap glyph;
+  if (m_rasterizer && m_rasterizer->Take((style << 16) | letter, glyph))
+    m_prerendered++;
+  else if (RasterizeGlyph(m_face, m_stroker, letter, style, glyph))
+    m_rendered++;
+  else
+    return false;
+
+  bool isEmptyGlyph = (glyph.width == 0 || glyph.rows == 0);
 
   if (!isEmptyGlyph)
   {
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
+    if (glyph.left < 0)
+      m_posX += -glyph.left;
 
     // check we have enough room for the character
-    if (m_posX + bitGlyph->left + bitmap.width > m_textureWidth)
+    if (m_posX + glyph.left + glyph.width > m_textureWidth)
     { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
       m_posX = 0;
       m_posY += GetTextureLineHeight();
-      if (bitGlyph->left < 0)
-        m_posX += -bitGlyph->left;
+      if (glyph.left < 0)
+        m_posX += -glyph.left;
 
       if(m_posY + GetTextureLineHeight() >= m_textureHeight)
       {
@@ -743,7 +999,6 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
         if (newHeight > g_Windowing.GetMaxTextureSize())
         {
           CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
-          FT_Done_Glyph(glyph);
           return false;
         }
 
@@ -751,7 +1006,6 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
         newTexture = ReallocTexture(newHeight);
         if(newTexture == NULL)
         {
-          FT_Done_Glyph(glyph);
           CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
           return false;
         }
@@ -761,37 +1015,44 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
 
     if(m_texture == NULL)
     {
-      FT_Done_Glyph(glyph);
       CLog::Log(LOGDEBUG, "%s: no texture to cache character to", __FUNCTION__);
       return false;
     }
   }
   // set the character in our table
   ch->letterAndStyle = (style << 16) | letter;
-  ch->offsetX = (short)bitGlyph->left;
-  ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
+  ch->offsetX = (short)glyph.left;
+  ch->offsetY = (short)m_cellBaseLine - glyph.top;
   ch->left = isEmptyGlyph ? 0 : ((float)m_posX + ch->offsetX);
   ch->top = isEmptyGlyph ? 0 : ((float)m_posY + ch->offsetY);
-  ch->right = ch->left + bitmap.width;
-  ch->bottom = ch->top + bitmap.rows;
-  ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->right = ch->left + glyph.width;
+  ch->bottom = ch->top + glyph.rows;
+  ch->advance = (float)MathUtils::round_int( (float)glyph.advance / 64 );
 
   // we need only render if we actually have some pixels
   if (!isEmptyGlyph)
   {
+    // the texture code takes a freetype bitmap
+    FT_BitmapGlyphRec bitGlyph;
+    memset(&bitGlyph, 0, sizeof(bitGlyph));
+    bitGlyph.left = glyph.left;
+    bitGlyph.top = glyph.top;
+    bitGlyph.bitmap.width = glyph.width;
+    bitGlyph.bitmap.rows = glyph.rows;
+    bitGlyph.bitmap.pitch = glyph.width;
+    bitGlyph.bitmap.buffer = &glyph.pixels[0];
+    bitGlyph.bitmap.num_grays = 256;
+    bitGlyph.bitmap.pixel_mode = FT_PIXEL_MODE_GRAY;
+
     // ensure our rect will stay inside the texture (it *should* but we need to be certain)
     unsigned int x1 = max(m_posX + ch->offsetX, 0);
     unsigned int y1 = max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
+    unsigned int x2 = min(x1 + glyph.width, m_textureWidth);
+    unsigned int y2 = min(y1 + glyph.rows, m_textureHeight);
+    CopyCharToTexture(&bitGlyph, x1, y1, x2, y2);
   
     m_posX += spacing_between_characters_in_texture + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
   }
-  m_numChars++;
-
-  // free the glyph
-  FT_Done_Glyph(glyph);
 
   return true;
 }
@@ -958,14 +1219,14 @@ void CGUIFontTTFBase::ObliqueGlyph(FT_GlyphSlot slot)
 
 
 // Embolden code - original taken from freetype2 (ftsynth.c)
-void CGUIFontTTFBase::EmboldenGlyph(FT_GlyphSlot slot)
+void CGUIFontTTFBase::EmboldenGlyph(FT_Face face, FT_GlyphSlot slot)
 {
   if ( slot->format != FT_GLYPH_FORMAT_OUTLINE )
     return;
 
   /* some reasonable strength */
-  FT_Pos strength = FT_MulFix( m_face->units_per_EM,
-                    m_face->size->metrics.y_scale ) / 24;
+  FT_Pos strength = FT_MulFix( face->units_per_EM,
+                    face->size->metrics.y_scale ) / 24;
 
   FT_BBox bbox_before, bbox_after;
   FT_Outline_Get_CBox( &slot->outline, &bbox_before );
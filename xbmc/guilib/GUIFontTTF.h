@@ -27,15 +27,19 @@
  *
  */
 
+#include <memory>
 #include <string>
 #include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 #include "utils/auto_buffer.h"
+#include "utils/JobManager.h"
 #include "Geometry.h"
 
 // forward definition
 class CBaseTexture;
+class CGUIFontRasterizer;
 
 struct FT_FaceRec_;
 struct FT_LibraryRec_;
@@ -77,8 +81,18 @@ struct SVertex
 class CGUIFontTTFBase
 {
   friend class CGUIFont;
+  friend class CGUIFontRasterizer;
 
 public:
+  /*! \brief memory and glyph cache statistics of a font */
+  struct FontStats
+  {
+    unsigned int glyphs;            ///< glyphs in the texture
+    unsigned int textureBytes;      ///< size of the glyph texture
+    unsigned int pendingBytes;      ///< background rasterized glyphs waiting for the texture
+    unsigned int rendered;          ///< glyphs rasterized while drawing
+    unsigned int prerendered;       ///< glyphs rasterized in the background
+  };
 
   CGUIFontTTFBase(const std::string& strFileName);
   virtual ~CGUIFontTTFBase(void);
@@ -95,6 +109,13 @@ public:
 
   const std::string& GetFileName() const { return m_strFileName; };
 
+  /*! \brief Rasterize the glyphs of text that is about to be shown in the background
+   The glyphs are only copied into the texture once they are drawn or measured.
+   */
+  void Prerender(const vecText &text);
+
+  FontStats GetStats() const;
+
 protected:
   struct Character
   {
@@ -103,6 +124,16 @@ protected:
     float advance;
     character_t letterAndStyle;
   };
+
+  /*! \brief a rasterized glyph that is not in the texture yet */
+  struct GlyphBitmap
+  {
+    int left, top;
+    unsigned int width, rows;
+    long advance;                       ///< 26.6 fixed point
+    std::vector<unsigned char> pixels;  ///< 8bit alpha, width bytes per row
+  };
+
   void AddReference();
   void RemoveReference();
 
@@ -122,6 +153,7 @@ protected:
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
+  static bool RasterizeGlyph(FT_Face face, FT_Stroker stroker, wchar_t letter, uint32_t style, GlyphBitmap &glyph);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX, std::vector<SVertex> &vertices);
   void ClearCharacterCache();
 
@@ -130,7 +162,7 @@ protected:
   virtual void DeleteHardwareTexture() = 0;
 
   // modifying glyphs
-  void EmboldenGlyph(FT_GlyphSlot slot);
+  static void EmboldenGlyph(FT_Face face, FT_GlyphSlot slot);
   static void ObliqueGlyph(FT_GlyphSlot slot);
 
   CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
@@ -148,10 +180,9 @@ protected:
 
   color_t m_color;
 
-  Character *m_char;                 // our characters
+  // our characters by letter and style, elements keep their address when the map grows
+  std::unordered_map<character_t, Character> m_char;
   Character *m_charquick[256*4];     // ascii chars (4 styles) here
-  int m_maxChars;                    // size of character array (can be incremented)
-  int m_numChars;                    // the current number of cached characters
 
   float m_ellipsesWidth;               // this is used every character (width of '.')
 
@@ -185,7 +216,12 @@ protected:
   float    m_textureScaleY;
 
   std::string m_strFileName;
-  XUTILS::auto_buffer m_fontFileInMemory; // used only in some cases, see CFreeTypeLibrary::GetFont()
+  std::shared_ptr<XUTILS::auto_buffer> m_fontFileInMemory; // used only in some cases, see CFreeTypeLibrary::GetFont()
+
+  std::shared_ptr<CGUIFontRasterizer> m_rasterizer;
+  CJobQueue m_rasterQueue;
+  unsigned int m_rendered;
+  unsigned int m_prerendered;
 
   CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue> m_staticCache;
   CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue> m_dynamicCache;
@@ -114,6 +114,17 @@ void CGUIListGroup::UpdateInfo(const CGUIListItem *item)
   }
 }
 
+void CGUIListGroup::Prerender(const CGUIListItem *item)
+{
+  for (iControls it = m_children.begin(); it != m_children.end(); it++)
+  {
+    if ((*it)->GetControlType() == CGUIControl::GUICONTROL_LISTLABEL)
+      ((CGUIListLabel *)(*it))->Prerender(item);
+    else if ((*it)->GetControlType() == CGUIControl::GUICONTROL_LISTGROUP)
+      ((CGUIListGroup *)(*it))->Prerender(item);
+  }
+}
+
 void CGUIListGroup::EnlargeWidth(float difference)
 {
   // Alters the width of the controls that have an ID of 1 to 14
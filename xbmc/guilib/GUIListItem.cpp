@@ -27,11 +27,6 @@
 
 using namespace std;
 
-bool CGUIListItem::icompare::operator()(const std::string &s1, const std::string &s2) const
-{
-  return StringUtils::CompareNoCase(s1, s2) < 0;
-}
-
 CGUIListItem::CGUIListItem(const CGUIListItem& item)
 {
   m_layout = NULL;
@@ -257,14 +252,14 @@ void CGUIListItem::Archive(CArchive &ar)
     ar << m_strLabel;
     ar << m_strLabel2;
     ar << m_sortLabel;
-    ar << m_strIcon;
+    ar << m_strIcon.str();
     ar << m_bSelected;
     ar << m_overlayIcon;
     ar << (int)m_mapProperties.size();
     for (PropertyMap::const_iterator it = m_mapProperties.begin(); it != m_mapProperties.end(); ++it)
     {
-      ar << it->first;
-      ar << it->second;
+      ar << it->key.str();
+      ar << it->value;
     }
     ar << (int)m_art.size();
     for (ArtMap::const_iterator i = m_art.begin(); i != m_art.end(); ++i)
@@ -285,7 +280,9 @@ void CGUIListItem::Archive(CArchive &ar)
     ar >> m_strLabel;
     ar >> m_strLabel2;
     ar >> m_sortLabel;
-    ar >> m_strIcon;
+    std::string strIcon;
+    ar >> strIcon;
+    m_strIcon = strIcon;
     ar >> m_bSelected;
 
     int overlayIcon;
@@ -327,12 +324,12 @@ void CGUIListItem::Serialize(CVariant &value)
   value["strLabel"] = m_strLabel;
   value["strLabel2"] = m_strLabel2;
   value["sortLabel"] = m_sortLabel;
-  value["strIcon"] = m_strIcon;
+  value["strIcon"] = m_strIcon.str();
   value["selected"] = m_bSelected;
 
   for (PropertyMap::const_iterator it = m_mapProperties.begin(); it != m_mapProperties.end(); ++it)
   {
-    value["properties"][it->first] = it->second;
+    value["properties"][it->key] = it->value;
   }
   for (ArtMap::const_iterator it = m_art.begin(); it != m_art.end(); ++it)
     value["art"][it->first] = it->second;
@@ -342,7 +339,7 @@ void CGUIListItem::FreeIcons()
 {
   FreeMemory();
   ClearArt();
-  m_strIcon = "";
+  m_strIcon.clear();
   SetInvalid();
 }
 
@@ -390,34 +387,60 @@ void CGUIListItem::SetInvalid()
   if (m_focusedLayout) m_focusedLayout->SetInvalid();
 }
 
+CGUIListItem::PropertyMap::iterator CGUIListItem::LowerBoundProperty(const std::string &strKey)
+{
+  PropertyMap::iterator first = m_mapProperties.begin();
+  size_t count = m_mapProperties.size();
+  while (count > 0)
+  {
+    size_t step = count / 2;
+    if (StringUtils::CompareNoCase(first[step].key, strKey) < 0)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+  return first;
+}
+
+CGUIListItem::PropertyMap::const_iterator CGUIListItem::LowerBoundProperty(const std::string &strKey) const
+{
+  return const_cast<CGUIListItem*>(this)->LowerBoundProperty(strKey);
+}
+
 void CGUIListItem::SetProperty(const std::string &strKey, const CVariant &value)
 {
-  PropertyMap::iterator iter = m_mapProperties.find(strKey);
-  if (iter == m_mapProperties.end())
+  PropertyMap::iterator iter = LowerBoundProperty(strKey);
+  if (iter == m_mapProperties.end() || !StringUtils::EqualsNoCase(iter->key, strKey))
   {
-    m_mapProperties.insert(make_pair(strKey, value));
+    Property property;
+    property.key = strKey;
+    property.value = value;
+    m_mapProperties.insert(iter, std::move(property));
     SetInvalid();
   }
-  else if (iter->second != value)
+  else if (iter->value != value)
   {
-    iter->second = value;
+    iter->value = value;
     SetInvalid();
   }
 }
 
 CVariant CGUIListItem::GetProperty(const std::string &strKey) const
 {
-  PropertyMap::const_iterator iter = m_mapProperties.find(strKey);
-  if (iter == m_mapProperties.end())
+  PropertyMap::const_iterator iter = LowerBoundProperty(strKey);
+  if (iter == m_mapProperties.end() || !StringUtils::EqualsNoCase(iter->key, strKey))
     return CVariant(CVariant::VariantTypeNull);
 
-  return iter->second;
+  return iter->value;
 }
 
 bool CGUIListItem::HasProperty(const std::string &strKey) const
 {
-  PropertyMap::const_iterator iter = m_mapProperties.find(strKey);
-  if (iter == m_mapProperties.end())
+  PropertyMap::const_iterator iter = LowerBoundProperty(strKey);
+  if (iter == m_mapProperties.end() || !StringUtils::EqualsNoCase(iter->key, strKey))
     return false;
 
   return true;
@@ -425,8 +448,8 @@ bool CGUIListItem::HasProperty(const std::string &strKey) const
 
 void CGUIListItem::ClearProperty(const std::string &strKey)
 {
-  PropertyMap::iterator iter = m_mapProperties.find(strKey);
-  if (iter != m_mapProperties.end())
+  PropertyMap::iterator iter = LowerBoundProperty(strKey);
+  if (iter != m_mapProperties.end() && StringUtils::EqualsNoCase(iter->key, strKey))
   {
     m_mapProperties.erase(iter);
     SetInvalid();
@@ -459,5 +482,5 @@ void CGUIListItem::IncrementProperty(const std::string &strKey, double dVal)
 void CGUIListItem::AppendProperties(const CGUIListItem &item)
 {
   for (PropertyMap::const_iterator i = item.m_mapProperties.begin(); i != item.m_mapProperties.end(); ++i)
-    SetProperty(i->first, i->second);
+    SetProperty(i->key, i->value);
 }
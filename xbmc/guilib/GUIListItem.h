@@ -30,11 +30,14 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include "utils/StringPool.h"
+#include "utils/Variant.h"
 
 //  Forward
 class CGUIListItemLayout;
 class CArchive;
-class CVariant;
 
 /*!
  \ingroup controls
@@ -172,21 +175,29 @@ public:
 
 protected:
   std::string m_strLabel2;     // text of column2
-  std::string m_strIcon;      // filename of icon
+  CPooledString m_strIcon;    // filename of icon, mostly one of a few default icons
   GUIIconOverlay m_overlayIcon; // type of overlay icon
 
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
   bool m_bSelected;     // item is selected or not
 
-  struct icompare
+  /*! \brief Properties as a vector sorted case insensitively by key.
+   Items only have a handful of properties, mostly with the same keys, so a
+   vector with pooled keys is a lot smaller than a map and as fast to search.
+   */
+  struct Property
   {
-    bool operator()(const std::string &s1, const std::string &s2) const;
+    CPooledString key;
+    CVariant value;
   };
+  typedef std::vector<Property> PropertyMap;
 
-  typedef std::map<std::string, CVariant, icompare> PropertyMap;
   PropertyMap m_mapProperties;
 private:
+  PropertyMap::iterator LowerBoundProperty(const std::string &strKey);
+  PropertyMap::const_iterator LowerBoundProperty(const std::string &strKey) const;
+
   std::wstring m_sortLabel;    // text for sorting. Need to be UTF16 for proper sorting
   std::string m_strLabel;      // text of column1
 
@@ -95,6 +95,11 @@ void CGUIListItemLayout::Render(CGUIListItem *item, int parentID)
   m_group.DoRender();
 }
 
+void CGUIListItemLayout::Prerender(const CGUIListItem *item)
+{
+  m_group.Prerender(item);
+}
+
 void CGUIListItemLayout::SetFocusedItem(unsigned int focus)
 {
   m_group.SetFocusedItem(focus);
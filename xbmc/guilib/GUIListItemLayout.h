@@ -37,6 +37,8 @@ public:
   void LoadLayout(TiXmlElement *layout, int context, bool focused);
   void Process(CGUIListItem *item, int parentID, unsigned int currentTime, CDirtyRegionList &dirtyregions);
   void Render(CGUIListItem *item, int parentID);
+  /*! \brief Rasterize the glyphs of the item's labels in the background, ahead of it being shown */
+  void Prerender(const CGUIListItem *item);
   float Size(ORIENTATION orientation) const;
   unsigned int GetFocusedItem() const;
   void SetFocusedItem(unsigned int focus);
@@ -19,6 +19,7 @@
  */
 
 #include "GUIListLabel.h"
+#include "GUITextLayout.h"
 #include <limits>
 #include "addons/Skin.h"
 
@@ -103,6 +104,12 @@ void CGUIListLabel::UpdateInfo(const CGUIListItem *item)
     SetLabel(m_info.GetLabel(m_parentID, true));
 }
 
+void CGUIListLabel::Prerender(const CGUIListItem *item)
+{
+  if (!m_info.IsConstant())
+    CGUITextLayout::Prerender(m_label.GetLabelInfo().font, m_info.GetItemLabel(item));
+}
+
 void CGUIListLabel::SetInvalid()
 {
   m_label.SetInvalid();
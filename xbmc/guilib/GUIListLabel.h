@@ -44,6 +44,7 @@ public:
   virtual void Render();
   virtual bool CanFocus() const { return false; };
   virtual void UpdateInfo(const CGUIListItem *item = NULL);
+  void Prerender(const CGUIListItem *item);
   virtual void SetFocus(bool focus);
   virtual void SetInvalid();
   virtual void SetWidth(float width);
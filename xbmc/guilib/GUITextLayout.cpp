@@ -339,6 +339,17 @@ void CGUITextLayout::Filter(std::string &text)
   g_charsetConverter.wToUTF8(utf16, text);
 }
 
+void CGUITextLayout::Prerender(CGUIFont *font, const std::string &text)
+{
+  if (!font || text.empty()) return;
+  std::wstring utf16;
+  g_charsetConverter.utf8ToW(text, utf16, false);
+  vecColors colors;
+  vecText parsedText;
+  ParseText(utf16, font->GetStyle(), 0, colors, parsedText);
+  font->Prerender(parsedText);
+}
+
 void CGUITextLayout::ParseText(const std::wstring &text, uint32_t defaultStyle, color_t defaultColor, vecColors &colors, vecText &parsedText)
 {
   // run through the string, searching for:
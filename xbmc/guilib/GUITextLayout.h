@@ -111,6 +111,12 @@ public:
   static void DrawText(CGUIFont *font, float x, float y, color_t color, color_t shadowColor, const std::string &text, uint32_t align);
   static void Filter(std::string &text);
 
+  /*! \brief Have the glyphs of text that is about to be shown rasterized in the background
+   \param font the font the text will be drawn with
+   \param text the text, which may contain style tags
+   */
+  static void Prerender(CGUIFont *font, const std::string &text);
+
 protected:
   void LineBreakText(const vecText &text, std::vector<CGUIString> &lines);
   void WrapText(const vecText &text, float maxWidth);
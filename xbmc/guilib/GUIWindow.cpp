@@ -38,10 +38,7 @@
 #include "ApplicationMessenger.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
-
-#ifdef HAS_PERFORMANCE_SAMPLE
-#include "utils/PerformanceSample.h"
-#endif
+#include "utils/Trace.h"
 
 using namespace std;
 
@@ -79,9 +76,7 @@ CGUIWindow::~CGUIWindow(void)
 
 bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
 {
-#ifdef HAS_PERFORMANCE_SAMPLE
-  CPerformanceSample aSample("WindowLoad-" + strFileName, true);
-#endif
+  TRACE_FUNCTION("gui");
 
   if (m_windowLoaded || g_SkinInfo == NULL)
     return true;      // no point loading if it's already there
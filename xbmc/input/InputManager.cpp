@@ -53,11 +53,7 @@
 #include "Util.h"
 #include "settings/Settings.h"
 
-#ifdef HAS_PERFORMANCE_SAMPLE
-#include "utils/PerformanceSample.h"
-#else
-#define MEASURE_FUNCTION
-#endif
+#include "utils/Trace.h"
 
 #include <algorithm>
 
@@ -113,7 +109,7 @@ bool CInputManager::ProcessPeripherals(float frameTime)
 
 bool CInputManager::ProcessMouse(int windowId)
 {
-  MEASURE_FUNCTION;
+  TRACE_FUNCTION("input");
 
   if (!m_Mouse.IsActive() || !g_application.IsAppFocused())
     return false;
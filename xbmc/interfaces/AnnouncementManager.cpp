@@ -20,24 +20,34 @@
 
 #include "AnnouncementManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include <stdio.h>
+#include <algorithm>
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
 #include "FileItem.h"
 #include "music/tags/MusicInfoTag.h"
 #include "music/MusicDatabase.h"
+#include "settings/AdvancedSettings.h"
 #include "video/VideoDatabase.h"
 #include "pvr/channels/PVRChannel.h"
 #include "PlayListPlayer.h"
 
 #define LOOKUP_PROPERTY "database-lookup"
 
+// announcements waiting for a single announcer before new ones are dropped
+#define MAX_QUEUED_ANNOUNCEMENTS 1024
+
 using namespace std;
 using namespace ANNOUNCEMENT;
 
 CAnnouncementManager::CAnnouncementManager()
-{ }
+  : CThread("Announcements"),
+    m_nextQueue(0)
+{
+  memset(&m_removedStats, 0, sizeof(m_removedStats));
+}
 
 CAnnouncementManager::~CAnnouncementManager()
 {
@@ -52,8 +62,17 @@ CAnnouncementManager& CAnnouncementManager::Get()
 
 void CAnnouncementManager::Deinitialize()
 {
+  StopThread();
+
   CSingleLock lock (m_critSection);
+  if (!m_announcers.empty())
+  {
+    AnnouncementStats stats = GetStats();
+    CLog::Log(LOGNOTICE, "CAnnouncementManager - %" PRIu64" announcements delivered, %" PRIu64" coalesced, %" PRIu64" dropped, %u still queued, at most %u queued",
+              stats.delivered, stats.coalesced, stats.dropped, stats.queued, stats.peakQueued);
+  }
   m_announcers.clear();
+  m_queues.clear();
 }
 
 void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
@@ -63,6 +82,10 @@ void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
 
   CSingleLock lock (m_critSection);
   m_announcers.push_back(listener);
+  m_queues[listener];
+
+  if (!IsRunning())
+    Create();
 }
 
 void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
@@ -76,9 +99,76 @@ void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
     if (m_announcers[i] == listener)
     {
       m_announcers.erase(m_announcers.begin() + i);
+      break;
+    }
+  }
+
+  map<IAnnouncer *, AnnouncerQueue>::iterator queue = m_queues.find(listener);
+  if (queue != m_queues.end())
+  {
+    m_removedStats.delivered += queue->second.delivered;
+    m_removedStats.coalesced += queue->second.coalesced;
+    m_removedStats.dropped += queue->second.dropped;
+    m_queues.erase(queue);
+  }
+
+  // the announcer may be destroyed once we return, so wait for calls to it in progress,
+  // except the one it may be removing itself from
+  while (IsCalled(listener))
+    m_called.wait(lock);
+}
+
+bool CAnnouncementManager::IsCalled(IAnnouncer *announcer) const
+{
+  for (vector<AnnouncerCall>::const_iterator it = m_calls.begin(); it != m_calls.end(); ++it)
+  {
+    if (it->first == announcer && !CThread::IsCurrentThread(it->second))
+      return true;
+  }
+  return false;
+}
+
+void CAnnouncementManager::Call(IAnnouncer *announcer, const Announcement &announcement)
+{
+  ThreadIdentifier thread = CThread::GetCurrentThreadId();
+  {
+    CSingleLock lock (m_critSection);
+    // it may have been removed since it was picked
+    if (m_queues.find(announcer) == m_queues.end())
       return;
+    m_queues[announcer].delivered++;
+    m_calls.push_back(AnnouncerCall(announcer, thread));
+  }
+
+  // nothing is locked while the announcer runs, it may take its time without
+  // holding up Announce() or the removal of other announcers
+  announcer->Announce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.data);
+
+  CSingleLock lock (m_critSection);
+  for (vector<AnnouncerCall>::iterator it = m_calls.begin(); it != m_calls.end(); ++it)
+  {
+    if (it->first == announcer && it->second == thread)
+    {
+      m_calls.erase(it);
+      break;
     }
   }
+  m_called.notifyAll();
+}
+
+AnnouncementStats CAnnouncementManager::GetStats() const
+{
+  CSingleLock lock (m_critSection);
+  AnnouncementStats stats = m_removedStats;
+  for (map<IAnnouncer *, AnnouncerQueue>::const_iterator it = m_queues.begin(); it != m_queues.end(); ++it)
+  {
+    stats.queued += it->second.queue.size();
+    stats.peakQueued = std::max(stats.peakQueued, it->second.peak);
+    stats.delivered += it->second.delivered;
+    stats.coalesced += it->second.coalesced;
+    stats.dropped += it->second.dropped;
+  }
+  return stats;
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message)
@@ -87,16 +177,148 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
   Announce(flag, sender, message, data);
 }
 
+// Library announcements about the same item may be merged, e.g. the many
+// OnUpdate of an item while it is being scanned.
+static std::string GetCoalesceKey(AnnouncementFlag flag, const CVariant &data)
+{
+  if (flag != VideoLibrary && flag != AudioLibrary)
+    return "";
+
+  const CVariant &item = data.isMember("item") ? data["item"] : data;
+  if (!item.isObject() || !item.isMember("type") || !item.isMember("id"))
+    return "";
+
+  return StringUtils::Format("%d/%s/%" PRId64, (int)flag, item["type"].asString().c_str(), item["id"].asInteger());
+}
+
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data)
 {
   CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
 
+  std::shared_ptr<Announcement> announcement(new Announcement);
+  announcement->flag = flag;
+  announcement->sender = sender;
+  announcement->message = message;
+  announcement->data = data;
+
+  if (flag == System)
+  {
+    // announcers may have to act on these before the system goes on (e.g. to sleep),
+    // so deliver them before returning, on this thread
+    std::vector<IAnnouncer *> announcers;
+    {
+      CSingleLock lock (m_critSection);
+      announcers = m_announcers;
+    }
+    for (vector<IAnnouncer *>::const_iterator it = announcers.begin(); it != announcers.end(); ++it)
+      Call(*it, *announcement);
+    return;
+  }
+
+  Queue(announcement, g_advancedSettings.m_announceCoalesceTime > 0 ? GetCoalesceKey(flag, data) : "");
+}
+
+void CAnnouncementManager::Queue(const AnnouncementPtr &announcement, const std::string &key)
+{
   CSingleLock lock (m_critSection);
+  if (m_announcers.empty())
+    return;
 
-  // Make a copy of announers. They may be removed or even remove themselves during execution of IAnnouncer::Announce()!
-  std::vector<IAnnouncer *> announcers(m_announcers); 
-  for (unsigned int i = 0; i < announcers.size(); i++)
-    announcers[i]->Announce(flag, sender, message, data);
+  unsigned int due = XbmcThreads::SystemClockMillis();
+  if (!key.empty())
+    due += g_advancedSettings.m_announceCoalesceTime;
+
+  for (vector<IAnnouncer *>::const_iterator it = m_announcers.begin(); it != m_announcers.end(); ++it)
+  {
+    AnnouncerQueue &queue = m_queues[*it];
+
+    if (!key.empty())
+    {
+      // replace the last announcement about the item if it is the same one
+      map<string, QueuedAnnouncement*>::iterator latest = queue.latest.find(key);
+      if (latest != queue.latest.end() &&
+          latest->second->announcement->message == announcement->message &&
+          latest->second->announcement->sender == announcement->sender)
+      {
+        latest->second->announcement = announcement;
+        queue.coalesced++;
+        continue;
+      }
+    }
+
+    if (queue.queue.size() >= MAX_QUEUED_ANNOUNCEMENTS)
+    {
+      if (queue.dropped++ == 0)
+        CLog::Log(LOGWARNING, "CAnnouncementManager - an announcer doesn't keep up, dropping announcements");
+      continue;
+    }
+
+    QueuedAnnouncement queued;
+    queued.announcement = announcement;
+    queued.due = due;
+    queued.key = key;
+    queue.queue.push_back(queued);
+    if (!key.empty())
+      queue.latest[key] = &queue.queue.back();
+    queue.peak = std::max(queue.peak, (unsigned int)queue.queue.size());
+  }
+
+  m_queued.Set();
+}
+
+bool CAnnouncementManager::DispatchNext(unsigned int &wait)
+{
+  IAnnouncer *announcer = NULL;
+  AnnouncementPtr announcement;
+  {
+    CSingleLock lock (m_critSection);
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    size_t count = m_announcers.size();
+    for (size_t i = 0; i < count; i++)
+    {
+      size_t index = (m_nextQueue + i) % count;
+      AnnouncerQueue &queue = m_queues[m_announcers[index]];
+      if (queue.queue.empty())
+        continue;
+
+      QueuedAnnouncement &head = queue.queue.front();
+      int remaining = (int)(head.due - now);
+      if (remaining > 0)
+      { // still waiting for repeats
+        wait = std::min(wait, (unsigned int)remaining);
+        continue;
+      }
+
+      if (!head.key.empty())
+      {
+        map<string, QueuedAnnouncement*>::iterator latest = queue.latest.find(head.key);
+        if (latest != queue.latest.end() && latest->second == &head)
+          queue.latest.erase(latest);
+      }
+
+      announcer = m_announcers[index];
+      announcement = head.announcement;
+      queue.queue.pop_front();
+      m_nextQueue = index + 1;
+      break;
+    }
+  }
+
+  if (!announcer)
+    return false;
+
+  Call(announcer, *announcement);
+  return true;
+}
+
+void CAnnouncementManager::Process()
+{
+  while (!m_bStop)
+  {
+    unsigned int wait = 1000;
+    if (!DispatchNext(wait))
+      AbortableWait(m_queued, wait);
+  }
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
@@ -18,16 +18,50 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "IAnnouncer.h"
 #include "FileItem.h"
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
 #include "utils/GlobalsHandling.h"
+#include "utils/Variant.h"
 
 namespace ANNOUNCEMENT
 {
-  class CAnnouncementManager
+  /*!
+   \brief Counters of the announcement queues, summed over all announcers
+   */
+  struct AnnouncementStats
+  {
+    unsigned int queued;     ///< announcements waiting to be delivered
+    unsigned int peakQueued; ///< most announcements waiting for a single announcer
+    uint64_t delivered;
+    uint64_t coalesced;      ///< merged into an announcement for the same item still waiting
+    uint64_t dropped;        ///< not delivered because an announcer's queue was full
+  };
+
+  /*!
+   \brief Delivers announcements to the registered announcers.
+
+   Announcements are queued for every announcer and delivered by a dispatcher
+   thread, so a slow announcer (e.g. a JSON-RPC client on a slow connection)
+   doesn't hold up the thread announcing. Each announcer gets the announcements
+   in the order they were made, except for system announcements (sleep, wake,
+   quit, ...) which are delivered before Announce() returns, on the thread
+   announcing.
+
+   Every announcer's queue is bounded, announcements that don't fit are dropped.
+   With advancedsettings' announcecoalescetime set, an announcement about a
+   library item waits that long for a repeat of itself, which then replaces it.
+   */
+  class CAnnouncementManager : private CThread
   {
   public:
     virtual ~CAnnouncementManager();
@@ -43,12 +77,59 @@ namespace ANNOUNCEMENT
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
+
+    AnnouncementStats GetStats() const;
+
+  protected:
+    virtual void Process();
+
   private:
     CAnnouncementManager();
     CAnnouncementManager(const CAnnouncementManager&);
     CAnnouncementManager const& operator=(CAnnouncementManager const&);
 
-    CCriticalSection m_critSection;
+    struct Announcement
+    {
+      AnnouncementFlag flag;
+      std::string sender;
+      std::string message;
+      CVariant data;
+    };
+    typedef std::shared_ptr<const Announcement> AnnouncementPtr;
+
+    struct QueuedAnnouncement
+    {
+      AnnouncementPtr announcement;
+      unsigned int due;        ///< not delivered before this time
+      std::string key;         ///< the item it is about, empty if it can't be coalesced
+    };
+
+    struct AnnouncerQueue
+    {
+      AnnouncerQueue() : peak(0), delivered(0), coalesced(0), dropped(0) {}
+
+      std::deque<QueuedAnnouncement> queue;
+      std::map<std::string, QueuedAnnouncement*> latest; ///< last queued announcement per item
+      unsigned int peak;
+      uint64_t delivered;
+      uint64_t coalesced;
+      uint64_t dropped;
+    };
+
+    void Queue(const AnnouncementPtr &announcement, const std::string &key);
+    bool DispatchNext(unsigned int &wait);
+    void Call(IAnnouncer *announcer, const Announcement &announcement);
+    bool IsCalled(IAnnouncer *announcer) const;
+
+    typedef std::pair<IAnnouncer *, ThreadIdentifier> AnnouncerCall;
+
+    mutable CCriticalSection m_critSection;
     std::vector<IAnnouncer *> m_announcers;
+    std::map<IAnnouncer *, AnnouncerQueue> m_queues;
+    size_t m_nextQueue;                   ///< round robin over the announcers
+    std::vector<AnnouncerCall> m_calls;   ///< announcers being called and the threads calling them
+    XbmcThreads::ConditionVariable m_called;
+    CEvent m_queued;
+    AnnouncementStats m_removedStats;     ///< counters of announcers that were removed
   };
 }
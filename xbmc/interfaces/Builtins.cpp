@@ -105,6 +105,7 @@
 #include "settings/DisplaySettings.h"
 #include "powermanagement/PowerManager.h"
 #include "filesystem/Directory.h"
+#include "utils/Trace.h"
 
 using namespace std;
 using namespace XFILE;
@@ -233,6 +234,7 @@ const BUILT_IN commands[] = {
 #endif
   { "VideoLibrary.Search",        false,  "Brings up a search dialog which will search the library" },
   { "ToggleDebug",                false,  "Enables/disables debug mode" },
+  { "ToggleTrace",                false,  "Starts/stops tracing, saving the trace to the temp folder when stopped" },
   { "StartPVRManager",            false,  "(Re)Starts the PVR manager" },
   { "StopPVRManager",             false,  "Stops the PVR manager" },
 #if defined(TARGET_ANDROID)
@@ -1878,6 +1880,16 @@ int CBuiltins::Execute(const std::string& execString)
     CSettings::Get().SetBool("debug.showloginfo", !debug);
     g_advancedSettings.SetDebugMode(!debug);
   }
+  else if (execute == "toggletrace")
+  {
+    if (CTracer::IsEnabled())
+    {
+      CTracer::Get().Stop();
+      CTracer::Get().Save(CTracer::GetTraceFile());
+    }
+    else
+      CTracer::Get().Start();
+  }
   else if (execute == "startpvrmanager")
   {
     g_application.StartPVRManager();
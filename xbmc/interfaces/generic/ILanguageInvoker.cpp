@@ -27,6 +27,7 @@
 ILanguageInvoker::ILanguageInvoker(ILanguageInvocationHandler *invocationHandler)
   : m_id(-1),
     m_state(InvokerStateUninitialized),
+    m_reusable(false),
     m_invocationHandler(invocationHandler)
 { }
 
@@ -46,6 +47,16 @@ bool ILanguageInvoker::Stop(bool abort /* = false */)
   return stop(abort);
 }
 
+bool ILanguageInvoker::Reset()
+{
+  if (!CanReuse() || !reset())
+    return false;
+
+  // the state only moves forward during an execution, start over
+  m_state = InvokerStateUninitialized;
+  return true;
+}
+
 bool ILanguageInvoker::IsActive() const
 {
   return GetState() > InvokerStateUninitialized && GetState() < InvokerStateDone;
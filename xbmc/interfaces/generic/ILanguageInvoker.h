@@ -55,11 +55,35 @@ public:
   bool IsActive() const;
   bool IsRunning() const;
 
+  /*!
+   * \brief Allows the invoker to keep its interpreter once a script is done
+   * so that it can run the next script of the same addon without starting up
+   * again. Only for addons that declared themselves reusable.
+   */
+  void SetReusable(bool reusable) { m_reusable = reusable; }
+  bool IsReusable() const { return m_reusable; }
+  /*!
+   * \brief Whether the invoker kept its interpreter after its script was done.
+   */
+  virtual bool CanReuse() const { return false; }
+  /*!
+   * \brief Prepares an invoker that kept its interpreter for executing another script.
+   * \return False if the invoker can't be reused
+   */
+  bool Reset();
+  /*!
+   * \brief Releases an interpreter kept for reuse. Has to be called by the
+   * thread that executed the scripts.
+   */
+  void Release() { release(); }
+
 protected:
   friend class CLanguageInvokerThread;
 
   virtual bool execute(const std::string &script, const std::vector<std::string> &arguments) = 0;
   virtual bool stop(bool abort) = 0;
+  virtual bool reset() { return false; }
+  virtual void release() { }
 
   virtual void pulseGlobalEvent();
   virtual bool onExecutionInitialized();
@@ -75,6 +99,7 @@ protected:
 private:
   int m_id;
   InvokerState m_state;
+  bool m_reusable;
   ILanguageInvocationHandler *m_invocationHandler;
 };
 
@@ -20,12 +20,15 @@
 
 #include "LanguageInvokerThread.h"
 #include "ScriptInvocationManager.h"
+#include "threads/SingleLock.h"
 
 CLanguageInvokerThread::CLanguageInvokerThread(LanguageInvokerPtr invoker, CScriptInvocationManager *invocationManager)
   : ILanguageInvoker(NULL),
     CThread("LanguageInvoker"),
     m_invoker(invoker),
-    m_invocationManager(invocationManager)
+    m_invocationManager(invocationManager),
+    m_idle(false),
+    m_executions(0)
 { }
 
 CLanguageInvokerThread::~CLanguageInvokerThread()
@@ -41,6 +44,26 @@ InvokerState CLanguageInvokerThread::GetState()
   return m_invoker->GetState();
 }
 
+bool CLanguageInvokerThread::IsIdle() const
+{
+  CSingleLock lock(m_critical);
+  return m_idle;
+}
+
+bool CLanguageInvokerThread::Reuse(int id, const std::string &script, const std::vector<std::string> &arguments)
+{
+  CSingleLock lock(m_critical);
+  if (!m_idle)
+    return false;
+
+  m_idle = false;
+  SetId(id);
+  m_script = script;
+  m_args = arguments;
+  m_restartEvent.Set();
+  return true;
+}
+
 bool CLanguageInvokerThread::execute(const std::string &script, const std::vector<std::string> &arguments)
 {
   if (m_invoker == NULL || script.empty())
@@ -69,6 +92,11 @@ bool CLanguageInvokerThread::stop(bool wait)
     // stop the thread
     CThread::StopThread(wait);
   }
+  else if (IsReusable())
+  {
+    // wake up an idle thread so it releases its interpreter
+    CThread::StopThread(wait);
+  }
 
   return result;
 }
@@ -81,6 +109,7 @@ void CLanguageInvokerThread::OnStartup()
   m_invoker->SetId(GetId());
   if (m_addon != NULL)
     m_invoker->SetAddon(m_addon);
+  m_invoker->SetReusable(IsReusable());
 }
 
 void CLanguageInvokerThread::Process()
@@ -89,6 +118,34 @@ void CLanguageInvokerThread::Process()
     return;
 
   m_invoker->Execute(m_script, m_args);
+  m_executions++;
+
+  // an invoker that kept its interpreter waits here until it's handed the next script
+  while (!m_bStop && m_invoker->CanReuse())
+  {
+    m_invoker->onExecutionDone();
+    {
+      CSingleLock lock(m_critical);
+      m_idle = true;
+    }
+    m_invocationManager->OnScriptEnded(GetId());
+
+    if (AbortableWait(m_restartEvent) != WAIT_SIGNALED)
+      break;
+
+    m_invoker->SetId(GetId());
+    if (!m_invoker->Reset())
+      break;
+
+    m_invoker->Execute(m_script, m_args);
+    m_executions++;
+  }
+
+  {
+    CSingleLock lock(m_critical);
+    m_idle = false;
+  }
+  m_invoker->Release();
 }
 
 void CLanguageInvokerThread::OnExit()
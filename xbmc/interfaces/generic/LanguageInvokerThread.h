@@ -20,6 +20,8 @@
  */
 
 #include "interfaces/generic/ILanguageInvoker.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/Thread.h"
 
 class CScriptInvocationManager;
@@ -32,6 +34,18 @@ public:
 
   virtual InvokerState GetState();
 
+  /*!
+   * \brief Whether the thread kept the interpreter of its last script and waits for the next one.
+   */
+  bool IsIdle() const;
+  /*!
+   * \brief Runs another script with the interpreter kept by an idle thread.
+   * \return False if the thread isn't idle (anymore)
+   */
+  bool Reuse(int id, const std::string &script, const std::vector<std::string> &arguments);
+  unsigned int GetExecutions() const { return m_executions; }
+  bool HasExited() const { return !CThread::IsRunning(); }
+
 protected:
   virtual bool execute(const std::string &script, const std::vector<std::string> &arguments);
   virtual bool stop(bool wait);
@@ -46,4 +60,8 @@ private:
   CScriptInvocationManager *m_invocationManager;
   std::string m_script;
   std::vector<std::string> m_args;
+  bool m_idle;
+  unsigned int m_executions;
+  CEvent m_restartEvent;
+  CCriticalSection m_critical;
 };
\ No newline at end of file
@@ -18,15 +18,21 @@
  *
  */
 
+#include <algorithm>
 #include <errno.h>
 #include <vector>
 
+#include "system.h"
 #include "ScriptInvocationManager.h"
+#include "addons/AddonVersion.h"
 #include "filesystem/File.h"
 #include "interfaces/generic/ILanguageInvocationHandler.h"
 #include "interfaces/generic/ILanguageInvoker.h"
 #include "interfaces/generic/LanguageInvokerThread.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/LatencyHistogram.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/log.h"
@@ -35,7 +41,8 @@ using namespace std;
 using namespace XFILE;
 
 CScriptInvocationManager::CScriptInvocationManager()
-  : m_nextId(0)
+  : m_lastEviction(0),
+    m_nextId(0)
 { }
 
 CScriptInvocationManager::~CScriptInvocationManager()
@@ -58,6 +65,9 @@ void CScriptInvocationManager::Process()
   {
     if (it->second.done)
     {
+      // threads that kept their interpreter wait for the next invocation
+      if (it->second.thread->IsIdle())
+        addIdleThread(it->second);
       tempList.push_back(it->second);
       m_scripts.erase(it++);
     }
@@ -69,12 +79,16 @@ void CScriptInvocationManager::Process()
   for (vector<LanguageInvokerThread>::const_iterator it = tempList.begin(); it != tempList.end(); ++it)
     m_scriptPaths.erase(it->script);
 
+  vector<CLanguageInvokerThreadPtr> exitedThreads;
+  evictIdleThreads(exitedThreads);
+
   // we can leave the lock now
   lock.Leave();
 
   // finally remove the finished threads but we do it outside of any locks in
   // case of any callbacks from the destruction of the CLanguageInvokerThread
   tempList.clear();
+  exitedThreads.clear();
 
   // let the invocation handlers do their processing
   for (LanguageInvocationHandlerMap::iterator it = m_invocationHandlers.begin(); it != m_invocationHandlers.end(); ++it)
@@ -96,6 +110,13 @@ void CScriptInvocationManager::Uninitialize()
   m_scripts.clear();
   m_scriptPaths.clear();
 
+  // idle interpreters have to be ended before their invocation handler goes
+  vector<CLanguageInvokerThreadPtr> idleThreads(m_releasedThreads);
+  for (IdleInvokerThreadMap::const_iterator it = m_idleThreads.begin(); it != m_idleThreads.end(); ++it)
+    idleThreads.push_back(it->second.thread);
+  m_idleThreads.clear();
+  m_releasedThreads.clear();
+
   // we can leave the lock now
   lock.Leave();
 
@@ -109,6 +130,10 @@ void CScriptInvocationManager::Uninitialize()
   }
   tempList.clear();
 
+  for (vector<CLanguageInvokerThreadPtr>::iterator it = idleThreads.begin(); it != idleThreads.end(); ++it)
+    (*it)->Stop(true);
+  idleThreads.clear();
+
   lock.Enter();
   // uninitialize all invocation handlers and then remove them
   for (LanguageInvocationHandlerMap::iterator it = m_invocationHandlers.begin(); it != m_invocationHandlers.end(); ++it)
@@ -199,7 +224,7 @@ LanguageInvokerPtr CScriptInvocationManager::GetLanguageInvoker(const std::strin
   return LanguageInvokerPtr();
 }
 
-int CScriptInvocationManager::ExecuteAsync(const std::string &script, const ADDON::AddonPtr &addon /* = ADDON::AddonPtr() */, const std::vector<std::string> &arguments /* = std::vector<std::string>() */)
+int CScriptInvocationManager::ExecuteAsync(const std::string &script, const ADDON::AddonPtr &addon /* = ADDON::AddonPtr() */, const std::vector<std::string> &arguments /* = std::vector<std::string>() */, bool reusable /* = false */)
 {
   if (script.empty())
     return -1;
@@ -211,10 +236,10 @@ int CScriptInvocationManager::ExecuteAsync(const std::string &script, const ADDO
   }
 
   LanguageInvokerPtr invoker = GetLanguageInvoker(script);
-  return ExecuteAsync(script, invoker, addon, arguments);
+  return ExecuteAsync(script, invoker, addon, arguments, reusable);
 }
 
-int CScriptInvocationManager::ExecuteAsync(const std::string &script, LanguageInvokerPtr languageInvoker, const ADDON::AddonPtr &addon /* = ADDON::AddonPtr() */, const std::vector<std::string> &arguments /* = std::vector<std::string>() */)
+int CScriptInvocationManager::ExecuteAsync(const std::string &script, LanguageInvokerPtr languageInvoker, const ADDON::AddonPtr &addon /* = ADDON::AddonPtr() */, const std::vector<std::string> &arguments /* = std::vector<std::string>() */, bool reusable /* = false */)
 {
   if (script.empty() || languageInvoker == NULL)
     return -1;
@@ -225,18 +250,28 @@ int CScriptInvocationManager::ExecuteAsync(const std::string &script, LanguageIn
     return -1;
   }
 
+  // reusable scripts need an addon to tell whether a kept interpreter is still up to date
+  reusable = reusable && addon != NULL && g_advancedSettings.m_iScriptPoolSize > 0;
+  if (reusable)
+  {
+    int scriptId = executeIdleThread(script, addon, arguments);
+    if (scriptId >= 0)
+      return scriptId;
+  }
+
   CLanguageInvokerThreadPtr invokerThread = CLanguageInvokerThreadPtr(new CLanguageInvokerThread(languageInvoker, this));
   if (invokerThread == NULL)
     return -1;
 
   if (addon != NULL)
     invokerThread->SetAddon(addon);
+  invokerThread->SetReusable(reusable);
 
   CSingleLock lock(m_critSection);
   invokerThread->SetId(m_nextId++);
   lock.Leave();
 
-  LanguageInvokerThread thread = { invokerThread, script, false };
+  LanguageInvokerThread thread = { invokerThread, script, false, false, CurrentHostCounter() };
   m_scripts.insert(make_pair(invokerThread->GetId(), thread));
   m_scriptPaths.insert(make_pair(script, invokerThread->GetId()));
   invokerThread->Execute(script, arguments);
@@ -340,8 +375,14 @@ void CScriptInvocationManager::OnScriptEnded(int scriptId)
 
   CSingleLock lock(m_critSection);
   LanguageInvokerThreadMap::iterator script = m_scripts.find(scriptId);
-  if (script != m_scripts.end())
-    script->second.done = true;
+  if (script == m_scripts.end() || script->second.done)
+    return;
+
+  script->second.done = true;
+
+  static CLatencyHistogram &cold = CLatencyHistograms::Get().GetHistogram("script.cold", 1000000);
+  static CLatencyHistogram &warm = CLatencyHistograms::Get().GetHistogram("script.warm", 1000000);
+  (script->second.warm ? warm : cold).RecordSince(script->second.start);
 }
 
 CScriptInvocationManager::LanguageInvokerThread CScriptInvocationManager::getInvokerThread(int scriptId) const
@@ -355,3 +396,130 @@ CScriptInvocationManager::LanguageInvokerThread CScriptInvocationManager::getInv
 
   return script->second;
 }
+
+int CScriptInvocationManager::executeIdleThread(const std::string &script, const ADDON::AddonPtr &addon, const std::vector<std::string> &arguments)
+{
+  CSingleLock lock(m_critSection);
+  IdleInvokerThreadMap::iterator idle = m_idleThreads.find(script);
+  if (idle == m_idleThreads.end())
+    return -1;
+
+  CLanguageInvokerThreadPtr invokerThread = idle->second.thread;
+  std::string version = idle->second.version;
+  m_idleThreads.erase(idle);
+
+  // an updated addon needs a fresh interpreter to import its new code
+  if (version != addon->Version().asString())
+  {
+    CLog::Log(LOGDEBUG, "%s - addon %s was updated, not reusing the interpreter of %s", __FUNCTION__, addon->ID().c_str(), script.c_str());
+    releaseThread(invokerThread);
+    return -1;
+  }
+
+  // register the script before the thread can end it
+  int scriptId = m_nextId++;
+  LanguageInvokerThread thread = { invokerThread, script, false, true, CurrentHostCounter() };
+  m_scripts.insert(make_pair(scriptId, thread));
+
+  if (!invokerThread->Reuse(scriptId, script, arguments))
+  {
+    m_scripts.erase(scriptId);
+    releaseThread(invokerThread);
+    return -1;
+  }
+
+  m_scriptPaths.insert(make_pair(script, scriptId));
+  CLog::Log(LOGDEBUG, "%s - executing %s (id=%d) in the interpreter kept from its previous invocation", __FUNCTION__, script.c_str(), scriptId);
+
+  return scriptId;
+}
+
+void CScriptInvocationManager::addIdleThread(const LanguageInvokerThread &invokerThread)
+{
+  const CLanguageInvokerThreadPtr &thread = invokerThread.thread;
+  const ADDON::AddonPtr &addon = thread->GetAddon();
+  if (addon == NULL || g_advancedSettings.m_iScriptPoolSize <= 0 ||
+      (g_advancedSettings.m_iScriptPoolMaxExecutions > 0 &&
+       thread->GetExecutions() >= (unsigned int)g_advancedSettings.m_iScriptPoolMaxExecutions))
+  {
+    releaseThread(thread);
+    return;
+  }
+
+  // keep the most recent interpreter of a script
+  IdleInvokerThreadMap::iterator idle = m_idleThreads.find(invokerThread.script);
+  if (idle != m_idleThreads.end())
+  {
+    releaseThread(idle->second.thread);
+    m_idleThreads.erase(idle);
+  }
+
+  IdleInvokerThread idleThread = { thread, addon->Version().asString(), XbmcThreads::SystemClockMillis() };
+  m_idleThreads.insert(make_pair(invokerThread.script, idleThread));
+}
+
+void CScriptInvocationManager::evictIdleThreads(std::vector<CLanguageInvokerThreadPtr> &exited)
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (now - m_lastEviction < 1000)
+    return;
+  m_lastEviction = now;
+
+  if (!m_idleThreads.empty())
+  {
+    // sub-interpreters share one allocator so their memory can't be told
+    // apart, all idle ones are released when the system runs low on memory
+    bool lowMemory = false;
+    if (g_advancedSettings.m_iScriptPoolMinFreeMemory > 0)
+    {
+      MEMORYSTATUSEX stat;
+      stat.dwLength = sizeof(MEMORYSTATUSEX);
+      GlobalMemoryStatusEx(&stat);
+      lowMemory = stat.ullAvailPhys / (1024 * 1024) < (uint64_t)g_advancedSettings.m_iScriptPoolMinFreeMemory;
+    }
+
+    unsigned int idleTimeout = (unsigned int)g_advancedSettings.m_iScriptPoolIdleTimeout * 1000;
+    for (IdleInvokerThreadMap::iterator it = m_idleThreads.begin(); it != m_idleThreads.end(); )
+    {
+      if (lowMemory || !it->second.thread->IsIdle() || now - it->second.lastUsed > idleTimeout)
+      {
+        CLog::Log(LOGDEBUG, "%s - releasing the idle interpreter of %s%s", __FUNCTION__, it->first.c_str(), lowMemory ? " (low memory)" : "");
+        releaseThread(it->second.thread);
+        m_idleThreads.erase(it++);
+      }
+      else
+        ++it;
+    }
+
+    // the least recently used interpreters go first when there are too many
+    while (m_idleThreads.size() > (size_t)std::max(g_advancedSettings.m_iScriptPoolSize, 0))
+    {
+      IdleInvokerThreadMap::iterator oldest = m_idleThreads.begin();
+      for (IdleInvokerThreadMap::iterator it = m_idleThreads.begin(); it != m_idleThreads.end(); ++it)
+      {
+        if (now - it->second.lastUsed > now - oldest->second.lastUsed)
+          oldest = it;
+      }
+      releaseThread(oldest->second.thread);
+      m_idleThreads.erase(oldest);
+    }
+  }
+
+  for (vector<CLanguageInvokerThreadPtr>::iterator it = m_releasedThreads.begin(); it != m_releasedThreads.end(); )
+  {
+    if ((*it)->HasExited())
+    {
+      exited.push_back(*it);
+      it = m_releasedThreads.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+void CScriptInvocationManager::releaseThread(const CLanguageInvokerThreadPtr &thread)
+{
+  // the thread ends its interpreter by itself, so the caller doesn't wait for it
+  thread->Stop(false);
+  m_releasedThreads.push_back(thread);
+}
@@ -22,6 +22,7 @@
 #include <map>
 #include <set>
 #include <memory>
+#include <vector>
 
 #include "addons/IAddon.h"
 #include "interfaces/generic/ILanguageInvoker.h"
@@ -50,9 +51,10 @@ public:
    * \param script Path to the script to be executed
    * \param addon (Optional) Addon to which the script belongs
    * \param arguments (Optional) List of arguments passed to the script
+   * \param reusable (Optional) Whether the interpreter may be kept to execute the next invocation of the script
    * \return -1 if an error occurred, otherwise the ID of the script
    */
-  int ExecuteAsync(const std::string &script, const ADDON::AddonPtr &addon = ADDON::AddonPtr(), const std::vector<std::string> &arguments = std::vector<std::string>());
+  int ExecuteAsync(const std::string &script, const ADDON::AddonPtr &addon = ADDON::AddonPtr(), const std::vector<std::string> &arguments = std::vector<std::string>(), bool reusable = false);
   /*!
   * \brief Executes the given script asynchronously in a separate thread.
   *
@@ -60,9 +62,15 @@ public:
   * \param languageInvoker Language invoker to be used to execute the script
   * \param addon (Optional) Addon to which the script belongs
   * \param arguments (Optional) List of arguments passed to the script
+  * \param reusable (Optional) Whether the interpreter may be kept to execute the next invocation of the script
   * \return -1 if an error occurred, otherwise the ID of the script
+  *
+  * \details A reusable script is executed by an idle interpreter kept from
+  * its previous invocation if there is one, in which case the given language
+  * invoker isn't used. Modules imported by earlier invocations stay loaded,
+  * so only addons that don't rely on a fresh interpreter should ask for it.
   */
-  int ExecuteAsync(const std::string &script, LanguageInvokerPtr languageInvoker, const ADDON::AddonPtr &addon = ADDON::AddonPtr(), const std::vector<std::string> &arguments = std::vector<std::string>());
+  int ExecuteAsync(const std::string &script, LanguageInvokerPtr languageInvoker, const ADDON::AddonPtr &addon = ADDON::AddonPtr(), const std::vector<std::string> &arguments = std::vector<std::string>(), bool reusable = false);
 
   /*!
   * \brief Executes the given script synchronously.
@@ -120,15 +128,32 @@ private:
     CLanguageInvokerThreadPtr thread;
     std::string script;
     bool done;
+    bool warm;     // executed by an interpreter kept from a previous invocation
+    int64_t start; // host counter when the script was started
   } LanguageInvokerThread;
   typedef std::map<int, LanguageInvokerThread> LanguageInvokerThreadMap;
   typedef std::map<std::string, ILanguageInvocationHandler*> LanguageInvocationHandlerMap;
 
+  typedef struct {
+    CLanguageInvokerThreadPtr thread;
+    std::string version;   // version of the addon the interpreter imported
+    unsigned int lastUsed; // when the interpreter became idle
+  } IdleInvokerThread;
+  typedef std::map<std::string, IdleInvokerThread> IdleInvokerThreadMap;
+
   LanguageInvokerThread getInvokerThread(int scriptId) const;
 
+  int executeIdleThread(const std::string &script, const ADDON::AddonPtr &addon, const std::vector<std::string> &arguments);
+  void addIdleThread(const LanguageInvokerThread &invokerThread);
+  void evictIdleThreads(std::vector<CLanguageInvokerThreadPtr> &exited);
+  void releaseThread(const CLanguageInvokerThreadPtr &thread);
+
   LanguageInvocationHandlerMap m_invocationHandlers;
   LanguageInvokerThreadMap m_scripts;
   std::map<std::string, int> m_scriptPaths;
+  IdleInvokerThreadMap m_idleThreads;                  // one idle interpreter per reusable script
+  std::vector<CLanguageInvokerThreadPtr> m_releasedThreads; // threads ending their interpreter
+  unsigned int m_lastEviction;
   int m_nextId;
   CCriticalSection m_critSection;
 };
\ No newline at end of file
@@ -20,16 +20,42 @@
 
 #include "InfoBool.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 
 namespace INFO
 {
+  bool InfoBool::m_profiling = false;
+
   InfoBool::InfoBool(const std::string &expression, int context)
     : m_value(false),
       m_context(context),
       m_listItemDependent(false),
+      m_sources(INFO_SOURCE_FRAME),
       m_expression(expression),
-      m_dirty(true)
+      m_dirty(true),
+      m_evaluations(0),
+      m_evaluationTime(0)
   {
     StringUtils::ToLower(m_expression);
   }
+
+  void InfoBool::Evaluate(const CGUIListItem *item)
+  {
+    if (!m_profiling)
+    {
+      Update(item);
+      return;
+    }
+
+    int64_t start = CurrentHostCounter();
+    Update(item);
+    m_evaluationTime += CurrentHostCounter() - start;
+    m_evaluations++;
+  }
+
+  void InfoBool::ResetProfile()
+  {
+    m_evaluations = 0;
+    m_evaluationTime = 0;
+  }
 }
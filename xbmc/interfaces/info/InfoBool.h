@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <string>
 #include <memory>
 
@@ -27,6 +28,21 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \ingroup info
+ \brief Where the value of an info bool comes from.
+ Info bools only depending on sources that publish their changes are not
+ re-evaluated every frame, see CGUIInfoManager::ResetChangedCache()
+ */
+enum InfoSource
+{
+  INFO_SOURCE_NONE    = 0,      ///< constant
+  INFO_SOURCE_FRAME   = 1 << 0, ///< may change at any time, re-evaluated every frame
+  INFO_SOURCE_PLAYER  = 1 << 1, ///< playback state (playing, paused, speed, stream types, muted)
+  INFO_SOURCE_LIBRARY = 1 << 2, ///< library content (has music, has movies, ...)
+  INFO_SOURCE_SKIN    = 1 << 3, ///< skin settings
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -51,10 +67,10 @@ public:
   inline bool Get(const CGUIListItem *item = NULL)
   {
     if (item && m_listItemDependent)
-      Update(item);
+      Evaluate(item);
     else if (m_dirty)
     {
-      Update(NULL);
+      Evaluate(NULL);
       m_dirty = false;
     }
     return m_value;
@@ -73,15 +89,34 @@ public:
 
   const std::string &GetExpression() const { return m_expression; }
   bool ListItemDependent() const { return m_listItemDependent; }
+  /*! \brief The InfoSource values this info bool depends on */
+  unsigned int GetSources() const { return m_sources; }
+
+  /*! \brief Enable or disable timing of the evaluations of all info bools
+   Used by the GUI control profiler
+   */
+  static void SetProfiling(bool profiling) { m_profiling = profiling; }
+  static bool IsProfiling() { return m_profiling; }
+  /*! \brief Number of evaluations and time spent in them (in host counter ticks) while profiling */
+  unsigned int GetEvaluations() const { return m_evaluations; }
+  int64_t GetEvaluationTime() const { return m_evaluationTime; }
+  void ResetProfile();
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_sources;      ///< InfoSource values the value depends on
 
 private:
+  void Evaluate(const CGUIListItem *item);
+
   std::string  m_expression;   ///< original expression
   bool         m_dirty;        ///< whether we need an update
+  unsigned int m_evaluations;
+  int64_t      m_evaluationTime;
+
+  static bool  m_profiling;
 };
 
 typedef std::shared_ptr<InfoBool> InfoPtr;
@@ -0,0 +1,80 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DiagnosticsOperations.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/Variant.h"
+
+#include <algorithm>
+
+using namespace JSONRPC;
+
+JSONRPC_STATUS CDiagnosticsOperations::GetHistograms(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  std::map<std::string, CLatencyHistogram::Summary> summaries;
+  CLatencyHistograms::Get().GetSummaries(summaries);
+
+  const CVariant &names = parameterObject["names"];
+  bool buckets = parameterObject["buckets"].asBoolean();
+
+  result["histograms"] = CVariant(CVariant::VariantTypeArray);
+  for (std::map<std::string, CLatencyHistogram::Summary>::const_iterator it = summaries.begin(); it != summaries.end(); ++it)
+  {
+    if (!names.empty() && std::find(names.begin_array(), names.end_array(), it->first) == names.end_array())
+      continue;
+
+    const CLatencyHistogram::Summary &summary = it->second;
+    CVariant histogram(CVariant::VariantTypeObject);
+    histogram["name"] = it->first;
+    histogram["count"] = summary.count;
+    histogram["stalls"] = summary.stalls;
+    histogram["stallthreshold"] = summary.threshold;
+    histogram["mean"] = summary.mean;
+    histogram["max"] = summary.max;
+    histogram["p50"] = summary.p50;
+    histogram["p90"] = summary.p90;
+    histogram["p99"] = summary.p99;
+    histogram["p999"] = summary.p999;
+
+    if (buckets)
+    {
+      histogram["buckets"] = CVariant(CVariant::VariantTypeArray);
+      for (std::vector<CLatencyHistogram::Bucket>::const_iterator bucket = summary.buckets.begin(); bucket != summary.buckets.end(); ++bucket)
+      {
+        CVariant item(CVariant::VariantTypeObject);
+        item["le"] = bucket->upperBound;
+        item["count"] = bucket->count;
+        histogram["buckets"].push_back(item);
+      }
+    }
+
+    result["histograms"].push_back(histogram);
+  }
+
+  return OK;
+}
+
+JSONRPC_STATUS CDiagnosticsOperations::ResetHistograms(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  if (!CLatencyHistograms::Get().Reset(parameterObject["name"].asString()))
+    return InvalidParams;
+
+  return ACK;
+}
@@ -99,7 +99,7 @@ static const std::string getListOfAddonClassesAsString(XBMCAddon::AddonClass::Re
 CPythonInvoker::CPythonInvoker(ILanguageInvocationHandler *invocationHandler)
   : ILanguageInvoker(invocationHandler),
     m_argc(0), m_argv(NULL),
-    m_threadState(NULL), m_stop(false)
+    m_threadState(NULL), m_interpreterState(NULL), m_stop(false)
 { }
 
 CPythonInvoker::~CPythonInvoker()
@@ -115,12 +115,10 @@ CPythonInvoker::~CPythonInvoker()
   Stop(true);
   pulseGlobalEvent();
 
-  if (m_argv != NULL)
-  {
-    for (unsigned int i = 0; i < m_argc; i++)
-      delete [] m_argv[i];
-    delete [] m_argv;
-  }
+  // normally released by the thread that executed the scripts
+  release();
+
+  freeArguments();
   onExecutionFinalized();
 }
 
@@ -135,7 +133,8 @@ bool CPythonInvoker::Execute(const std::string &script, const std::vector<std::s
     return false;
   }
 
-  if (!onExecutionInitialized())
+  // a kept interpreter has been initialized by its first execution
+  if (m_interpreterState == NULL && !onExecutionInitialized())
     return false;
 
   return ILanguageInvoker::Execute(script, arguments);
@@ -147,6 +146,7 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   m_sourceFile = script;
 
   // copy the arguments into a local buffer
+  freeArguments();
   m_argc = arguments.size();
   m_argv = new char*[m_argc];
   for (unsigned int i = 0; i < m_argc; i++)
@@ -159,7 +159,14 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
 
   // get the global lock
   PyEval_AcquireLock();
-  PyThreadState* state = Py_NewInterpreter();
+
+  // an interpreter kept from the previous execution already has its modules
+  // and paths set up, it's only kept again if this execution succeeds
+  PyThreadState* state = (PyThreadState*)m_interpreterState;
+  m_interpreterState = NULL;
+  bool reused = state != NULL;
+  if (!reused)
+    state = Py_NewInterpreter();
   if (state == NULL)
   {
     PyEval_ReleaseLock();
@@ -169,10 +176,16 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   // swap in my thread state
   PyThreadState_Swap(state);
 
-  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook(new XBMCAddon::Python::PythonLanguageHook(state->interp));
-  languageHook->RegisterMe();
+  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook;
+  if (reused)
+    languageHook = XBMCAddon::Python::PythonLanguageHook::GetIfExists(state->interp);
+  else
+  {
+    languageHook = new XBMCAddon::Python::PythonLanguageHook(state->interp);
+    languageHook->RegisterMe();
 
-  onInitialization();
+    onInitialization();
+  }
   setState(InvokerStateInitialized);
 
   std::string realFilename(CSpecialProtocol::TranslatePath(m_sourceFile));
@@ -185,65 +198,91 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   // this is used for python so it will search modules from script path first
   std::string scriptDir = URIUtils::GetDirectory(realFilename);
   URIUtils::RemoveSlashAtEnd(scriptDir);
-  addPath(scriptDir);
 
-  // add all addon module dependecies to path
-  if (m_addon)
+  if (reused)
   {
-    std::set<std::string> paths;
-    getAddonModuleDeps(m_addon, paths);
-    for (std::set<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
-      addPath(*it);
+    // only the arguments differ, leave sys.path as it is
+    if (m_argv != NULL)
+      PySys_SetArgvEx(m_argc, m_argv, 0);
   }
   else
-  { // for backwards compatibility.
-    // we don't have any addon so just add all addon modules installed
-    CLog::Log(LOGWARNING, "CPythonInvoker(%d): Script invoked without an addon. Adding all addon "
-        "modules installed to python path as fallback. This behaviour will be removed in future "
-        "version.", GetId());
-    ADDON::VECADDONS addons;
-    ADDON::CAddonMgr::Get().GetAddons(ADDON::ADDON_SCRIPT_MODULE, addons);
-    for (unsigned int i = 0; i < addons.size(); ++i)
-      addPath(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
-  }
+  {
+    addPath(scriptDir);
+
+    // add all addon module dependecies to path
+    if (m_addon)
+    {
+      std::set<std::string> paths;
+      getAddonModuleDeps(m_addon, paths);
+      for (std::set<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+        addPath(*it);
+    }
+    else
+    { // for backwards compatibility.
+      // we don't have any addon so just add all addon modules installed
+      CLog::Log(LOGWARNING, "CPythonInvoker(%d): Script invoked without an addon. Adding all addon "
+          "modules installed to python path as fallback. This behaviour will be removed in future "
+          "version.", GetId());
+      ADDON::VECADDONS addons;
+      ADDON::CAddonMgr::Get().GetAddons(ADDON::ADDON_SCRIPT_MODULE, addons);
+      for (unsigned int i = 0; i < addons.size(); ++i)
+        addPath(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
+    }
 
-  // we want to use sys.path so it includes site-packages
-  // if this fails, default to using Py_GetPath
-  PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
-  PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
-  PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
+    // we want to use sys.path so it includes site-packages
+    // if this fails, default to using Py_GetPath
+    PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
+    PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
+    PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
 
-  if (pathObj != NULL && PyList_Check(pathObj))
-  {
-    for (int i = 0; i < PyList_Size(pathObj); i++)
+    if (pathObj != NULL && PyList_Check(pathObj))
     {
-      PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
-      if (e != NULL && PyString_Check(e))
-        addNativePath(PyString_AsString(e)); // returns internal data, don't delete or modify
+      for (int i = 0; i < PyList_Size(pathObj); i++)
+      {
+        PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
+        if (e != NULL && PyString_Check(e))
+          addNativePath(PyString_AsString(e)); // returns internal data, don't delete or modify
+      }
     }
-  }
-  else
-    addNativePath(Py_GetPath());
+    else
+      addNativePath(Py_GetPath());
 
-  Py_DECREF(sysMod); // release ref to sysMod
+    Py_DECREF(sysMod); // release ref to sysMod
 
-  // set current directory and python's path.
-  if (m_argv != NULL)
-    PySys_SetArgv(m_argc, m_argv);
+    // set current directory and python's path.
+    if (m_argv != NULL)
+      PySys_SetArgv(m_argc, m_argv);
 
 #ifdef TARGET_WINDOWS
-  std::string pyPathUtf8;
-  g_charsetConverter.systemToUtf8(m_pythonPath, pyPathUtf8, false);
-  CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): setting the Python path to %s", GetId(), m_sourceFile.c_str(), pyPathUtf8.c_str());
+    std::string pyPathUtf8;
+    g_charsetConverter.systemToUtf8(m_pythonPath, pyPathUtf8, false);
+    CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): setting the Python path to %s", GetId(), m_sourceFile.c_str(), pyPathUtf8.c_str());
 #else // ! TARGET_WINDOWS
-  CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): setting the Python path to %s", GetId(), m_sourceFile.c_str(), m_pythonPath.c_str());
+    CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): setting the Python path to %s", GetId(), m_sourceFile.c_str(), m_pythonPath.c_str());
 #endif // ! TARGET_WINDOWS
-  PySys_SetPath((char *)m_pythonPath.c_str());
+    PySys_SetPath((char *)m_pythonPath.c_str());
+  }
 
   CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): entering source directory %s", GetId(), m_sourceFile.c_str(), scriptDir.c_str());
   PyObject* module = PyImport_AddModule((char*)"__main__");
   PyObject* moduleDict = PyModule_GetDict(module);
 
+  if (reused)
+  {
+    // the script starts from an empty __main__ while the modules imported by
+    // previous executions stay loaded
+    PyDict_Clear(moduleDict);
+    PyDict_SetItemString(moduleDict, "__builtins__", PyEval_GetBuiltins());
+    PyObject *name = PyString_FromString("__main__");
+    PyDict_SetItemString(moduleDict, "__name__", name);
+    Py_DECREF(name);
+
+    // the previous execution asked its threads to abort when it ended
+    PyObject *m = PyImport_AddModule((char*)"xbmc");
+    if (m == NULL || PyObject_SetAttrString(m, (char*)"abortRequested", Py_False))
+      CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): failed to reset abortRequested", GetId(), m_sourceFile.c_str());
+  }
+
   // when we are done initing we store thread state so we can be aborted
   PyThreadState_Swap(NULL);
   PyEval_ReleaseLock();
@@ -407,6 +446,17 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
       PyRun_SimpleString(GC_SCRIPT) == -1)
     CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): failed to run the gc to clean up after running prior to shutting down the Interpreter", GetId(), m_sourceFile.c_str());
 
+  // keep the interpreter of a successful execution for the next one
+  if (IsReusable() && !m_stop && stateToSet == InvokerStateDone)
+  {
+    m_interpreterState = state;
+    PyThreadState_Swap(NULL);
+    PyEval_ReleaseLock();
+
+    setState(stateToSet);
+    return true;
+  }
+
   Py_EndInterpreter(state);
 
   // If we still have objects left around, produce an error message detailing what's been left behind
@@ -519,6 +569,49 @@ bool CPythonInvoker::stop(bool abort)
   return true;
 }
 
+bool CPythonInvoker::CanReuse() const
+{
+  return m_interpreterState != NULL && GetState() == InvokerStateDone;
+}
+
+bool CPythonInvoker::reset()
+{
+  CSingleLock lock(m_critical);
+  if (m_stop)
+    return false;
+
+  m_stoppedEvent.Reset();
+  return true;
+}
+
+void CPythonInvoker::release()
+{
+  if (m_interpreterState == NULL)
+    return;
+
+  PyThreadState* state = (PyThreadState*)m_interpreterState;
+  m_interpreterState = NULL;
+
+  PyEval_AcquireLock();
+  PyThreadState_Swap(state);
+
+  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook = XBMCAddon::Python::PythonLanguageHook::GetIfExists(state->interp);
+  Py_EndInterpreter(state);
+
+  if (languageHook.isNotNull())
+  {
+    if (languageHook->HasRegisteredAddonClasses())
+      CLog::Log(LOGWARNING, "CPythonInvoker(%d, %s): the python script \"%s\" has left several "
+        "classes in memory that we couldn't clean up. The classes include: %s",
+        GetId(), m_sourceFile.c_str(), m_sourceFile.c_str(), getListOfAddonClassesAsString(languageHook).c_str());
+
+    languageHook->UnregisterMe();
+  }
+
+  PyEval_ReleaseLock();
+  CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): released the interpreter kept for reuse", GetId(), m_sourceFile.c_str());
+}
+
 void CPythonInvoker::onExecutionFailed()
 {
   PyThreadState_Swap(NULL);
@@ -642,6 +735,19 @@ void CPythonInvoker::getAddonModuleDeps(const ADDON::AddonPtr& addon, std::set<s
   }
 }
 
+void CPythonInvoker::freeArguments()
+{
+  if (m_argv == NULL)
+    return;
+
+  for (unsigned int i = 0; i < m_argc; i++)
+    delete [] m_argv[i];
+  delete [] m_argv;
+
+  m_argv = NULL;
+  m_argc = 0;
+}
+
 void CPythonInvoker::addPath(const std::string& path)
 {
 #if defined(TARGET_WINDOWS)
@@ -35,6 +35,7 @@ public:
   virtual bool Execute(const std::string &script, const std::vector<std::string> &arguments = std::vector<std::string>());
 
   virtual bool IsStopping() const { return m_stop || ILanguageInvoker::IsStopping(); }
+  virtual bool CanReuse() const;
 
   typedef void (*PythonModuleInitialization)();
   
@@ -43,6 +44,8 @@ protected:
   virtual bool execute(const std::string &script, const std::vector<std::string> &arguments);
   virtual void executeScript(void *fp, const std::string &script, void *module, void *moduleDict);
   virtual bool stop(bool abort);
+  virtual bool reset();
+  virtual void release();
   virtual void onExecutionFailed();
 
   // custom virtual methods
@@ -68,9 +71,11 @@ private:
   void addPath(const std::string& path); // add path in UTF-8 encoding
   void addNativePath(const std::string& path); // add path in system/Python encoding
   void getAddonModuleDeps(const ADDON::AddonPtr& addon, std::set<std::string>& paths);
+  void freeArguments();
 
   std::string m_pythonPath;
   void *m_threadState;
+  void *m_interpreterState; // the thread state of an interpreter kept for reuse
   bool m_stop;
   CEvent m_stoppedEvent;
 
@@ -3590,49 +3590,77 @@ bool CMusicDatabase::GetSongsByWhere(const std::string &baseDir, const Filter &f
     strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
     CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
 
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
+    if (sortDescription.sortBy == SortByNone)
     {
-      m_pDS->close();
-      return true;
-    }
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
-      return false;
+      // the rows are used in the order the database returns them, so step
+      // through them one at a time instead of loading the whole result set
+      if (!m_pDS->query_stream(strSQL))
+        return false;
 
-    // get data from returned rows
-    items.Reserve(results.size());
-    const dbiplus::query_data &data = m_pDS->get_result_set().records;
-    int count = 0;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); ++it)
-    {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-      
-      try
+      int count = 0;
+      while (!m_pDS->eof())
       {
         CFileItemPtr item(new CFileItem);
-        GetFileItemFromDataset(record, item.get(), musicUrl);
+        GetFileItemFromDataset(m_pDS->get_sql_record(), item.get(), musicUrl);
         // HACK for sorting by database returned order
         item->m_iprogramCount = ++count;
         items.Add(item);
+        m_pDS->next();
       }
-      catch (...)
+
+      // store the total value of items as a property
+      if (total < count)
+        total = count;
+      if (count > 0)
+        items.SetProperty("total", total);
+    }
+    else
+    {
+      // run query
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
+
+      int iRowsFound = m_pDS->num_rows();
+      if (iRowsFound == 0)
       {
         m_pDS->close();
-        CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
-        return (items.Size() > 0);
+        return true;
+      }
+
+      // store the total value of items as a property
+      if (total < iRowsFound)
+        total = iRowsFound;
+      items.SetProperty("total", total);
+
+      DatabaseResults results;
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
+        return false;
+
+      // get data from returned rows
+      items.Reserve(results.size());
+      const dbiplus::query_data &data = m_pDS->get_result_set().records;
+      int count = 0;
+      for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); ++it)
+      {
+        unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
+        const dbiplus::sql_record* const record = data.at(targetRow);
+
+        try
+        {
+          CFileItemPtr item(new CFileItem);
+          GetFileItemFromDataset(record, item.get(), musicUrl);
+          // HACK for sorting by database returned order
+          item->m_iprogramCount = ++count;
+          items.Add(item);
+        }
+        catch (...)
+        {
+          m_pDS->close();
+          CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
+          return (items.Size() > 0);
+        }
       }
     }
 
@@ -4651,7 +4679,9 @@ bool CMusicDatabase::CommitTransaction()
 {
   if (CDatabase::CommitTransaction())
   { // number of items in the db has likely changed, so reset the infomanager cache
-    g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSIC, GetSongsCount() > 0);
+    // (a batch only changes it once the batch is committed)
+    if (!InBatch())
+      g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSIC, GetSongsCount() > 0);
     return true;
   }
   return false;
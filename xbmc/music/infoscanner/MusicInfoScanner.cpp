@@ -50,6 +50,7 @@
 #include "GUIUserMessages.h"
 #include "addons/AddonManager.h"
 #include "addons/Scraper.h"
+#include "utils/CPUInfo.h"
 
 #include <algorithm>
 
@@ -60,7 +61,68 @@ using namespace MUSICDATABASEDIRECTORY;
 using namespace MUSIC_GRABBER;
 using namespace ADDON;
 
-CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCountReader(this, "MusicFileCounter")
+// directories whose tags may be read ahead of the database writes
+#define MAX_QUEUED_DIRECTORIES 32
+// songs and directories written per database transaction
+#define BATCH_SONGS            500
+#define BATCH_DIRECTORIES      50
+#define BATCH_INTERVAL         1000
+#define RATE_LOG_INTERVAL      10000
+
+// tags are mostly waiting on file reads, so use a few workers even on a single core
+static unsigned int GetTagReaderCount()
+{
+  return std::min(std::max(g_cpuInfo.getCPUCount(), 2), 8);
+}
+
+namespace MUSIC_INFO
+{
+/*! \brief A changed directory passing through the scan pipeline
+ The scanner thread fills in the files, a tag job reads their tags into
+ scannedItems, and the scanner thread then writes them to the database.
+ */
+class CMusicScanDirectory
+{
+public:
+  CMusicScanDirectory(const std::string &path, const std::string &hash)
+    : path(path), hash(hash), tagTime(0), cancelled(false), done(true)
+  {
+  }
+
+  std::string path;
+  std::string hash;
+  CFileItemList items;
+  CFileItemList scannedItems;
+  unsigned int tagTime;
+  std::atomic<bool> cancelled;
+  CEvent done;
+};
+
+class CMusicTagJob : public CJob
+{
+public:
+  CMusicTagJob(const std::shared_ptr<CMusicScanDirectory> &directory) : m_directory(directory) {}
+
+  virtual const char *GetType() const { return "musictags"; }
+
+  virtual bool DoWork()
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    CMusicInfoScanner::ScanTags(m_directory->items, m_directory->scannedItems, m_directory->cancelled);
+    m_directory->tagTime = XbmcThreads::SystemClockMillis() - start;
+    m_directory->done.Set();
+    return true;
+  }
+
+private:
+  std::shared_ptr<CMusicScanDirectory> m_directory;
+};
+}
+
+CMusicInfoScanner::CMusicInfoScanner()
+  : CThread("MusicInfoScanner"),
+    m_fileCountReader(this, "MusicFileCounter"),
+    m_tagReaders(false, GetTagReaderCount(), CJob::PRIORITY_LOW)
 {
   m_bRunning = false;
   m_showDialog = false;
@@ -126,6 +188,13 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      m_filesFound = m_enumerateTime = 0;
+      m_filesTagged = m_tagTime = 0;
+      m_songsWritten = m_writeTime = m_waitTime = 0;
+      m_lastRateLog = XbmcThreads::SystemClockMillis();
+      m_batchSongs = m_batchDirectories = m_batchStart = 0;
+      m_albumsToScrape.clear();
+
       bool commit = true;
       for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); ++it)
       {
@@ -148,8 +217,21 @@ void CMusicInfoScanner::Process()
         }
       }
 
+      // write the directories whose tags are still being read
+      if (commit && !WriteScanned(true))
+        commit = false;
+      if (!commit)
+        CancelScanned();
+
+      m_musicDatabase.CommitBatch();
+      LogScanRates(true);
+
       if (commit)
       {
+        if (m_flags & SCAN_ONLINE)
+          ScrapeAlbums();
+        m_albumsToScrape.clear();
+
         g_infoManager.ResetLibraryBools();
 
         if (m_needsCleanup)
@@ -439,6 +521,8 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
   if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
     return true;
 
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
   // load subfolder
   CFileItemList items;
   CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.GetMusicExtensions() + "|.jpg|.tbn|.lrc|.cdg");
@@ -452,7 +536,10 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
 
   // check whether we need to rescan or not
   std::string dbHash;
-  if ((m_flags & SCAN_RESCAN) || !m_musicDatabase.GetPathHash(strDirectory, dbHash) || dbHash != hash)
+  bool changed = (m_flags & SCAN_RESCAN) || !m_musicDatabase.GetPathHash(strDirectory, dbHash) || dbHash != hash;
+  m_enumerateTime += XbmcThreads::SystemClockMillis() - start;
+
+  if (changed)
   { // path has changed - rescan
     if (dbHash.empty())
       CLog::Log(LOGDEBUG, "%s Scanning dir '%s' as not in the database", __FUNCTION__, strDirectory.c_str());
@@ -463,20 +550,17 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
     items.FilterCueItems();
     items.Sort(SortByLabel, SortOrderAscending);
 
-    // and then scan in the new information
-    if (RetrieveMusicInfo(strDirectory, items) > 0)
-    {
-      if (m_handle)
-        OnDirectoryScanned(strDirectory);
-    }
-
-    // save information about this folder
-    m_musicDatabase.SetPathHash(strDirectory, hash);
+    // and then scan in the new information while we carry on with the subfolders
+    QueueDirectory(strDirectory, items, hash);
+    if (!WriteScanned(false))
+      return false;
   }
   else
   { // path is the same - no need to rescan
     CLog::Log(LOGDEBUG, "%s Skipping dir '%s' due to no change", __FUNCTION__, strDirectory.c_str());
-    m_currentItem += CountFiles(items, false);  // false for non-recursive
+    int count = CountFiles(items, false);  // false for non-recursive
+    m_currentItem += count;
+    m_filesFound += count;
 
     // updated the dialog with our progress
     if (m_handle)
@@ -508,13 +592,263 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
   return !m_bStop;
 }
 
-INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList& scannedItems)
+void CMusicInfoScanner::QueueDirectory(const std::string& strDirectory, const CFileItemList& items, const std::string& hash)
 {
-  vector<string> regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
+  std::shared_ptr<CMusicScanDirectory> directory(new CMusicScanDirectory(strDirectory, hash));
 
+  // the tag job only gets the files, so we can go on to the subfolders without sharing them
   for (int i = 0; i < items.Size(); ++i)
+  {
+    if (!items[i]->m_bIsFolder)
+      directory->items.Add(items[i]);
+  }
+  m_filesFound += CountFiles(directory->items, false);
+
+  m_scanQueue.push_back(directory);
+  if (directory->items.IsEmpty())
+    directory->done.Set();
+  else
+    m_tagReaders.AddJob(new CMusicTagJob(directory));
+}
+
+bool CMusicInfoScanner::WriteScanned(bool all)
+{
+  bool result = WriteReady(all);
+
+  // the batch isn't kept open while the scanner lists directories, which may
+  // take a long time on network shares and would hold up other writers
+  m_musicDatabase.CommitBatch();
+  return result;
+}
+
+bool CMusicInfoScanner::WriteReady(bool all)
+{
+  while (!m_scanQueue.empty())
+  {
+    if (m_bStop)
+      return false;
+
+    std::shared_ptr<CMusicScanDirectory> directory = m_scanQueue.front();
+    if (!directory->done.WaitMSec(0))
+    {
+      // keep finding directories while the tag readers have room
+      if (!all && m_scanQueue.size() < MAX_QUEUED_DIRECTORIES)
+        return true;
+
+      // don't keep other writers of the database waiting on the tag readers
+      m_musicDatabase.CommitBatch();
+
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      while (!directory->done.WaitMSec(100))
+      {
+        if (m_bStop)
+          return false;
+      }
+      m_waitTime += XbmcThreads::SystemClockMillis() - start;
+    }
+    m_scanQueue.pop_front();
+
+    // write the songs of several directories in one transaction rather than one per album
+    if (!m_musicDatabase.InBatch())
+    {
+      m_musicDatabase.BeginBatch();
+      m_batchStart = XbmcThreads::SystemClockMillis();
+      m_batchSongs = m_batchDirectories = 0;
+    }
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    int numAdded = WriteDirectory(*directory);
+    m_writeTime += XbmcThreads::SystemClockMillis() - start;
+
+    m_filesTagged += CountFiles(directory->items, false);
+    m_tagTime += directory->tagTime;
+    m_songsWritten += numAdded;
+    m_currentItem += CountFiles(directory->items, false);
+
+    if (m_handle)
+    {
+      if (m_itemCount > 0)
+        m_handle->SetPercentage(m_currentItem / (float)m_itemCount * 100);
+      if (numAdded > 0)
+        OnDirectoryScanned(directory->path);
+    }
+
+    m_batchSongs += numAdded;
+    if (m_batchSongs >= BATCH_SONGS || ++m_batchDirectories >= BATCH_DIRECTORIES ||
+        XbmcThreads::SystemClockMillis() - m_batchStart >= BATCH_INTERVAL)
+      m_musicDatabase.CommitBatch();
+
+    if (XbmcThreads::SystemClockMillis() - m_lastRateLog >= RATE_LOG_INTERVAL)
+      LogScanRates(false);
+  }
+  return !m_bStop;
+}
+
+int CMusicInfoScanner::WriteDirectory(CMusicScanDirectory& directory)
+{
+  MAPSONGS songsMap;
+
+  // get all information for all files in current directory from database, and remove them
+  if (m_musicDatabase.RemoveSongsFromPath(directory.path, songsMap))
+    m_needsCleanup = true;
+
+  int numAdded = 0;
+  if (directory.scannedItems.Size() > 0)
+  {
+    VECALBUMS albums;
+    FileItemsToAlbums(directory.scannedItems, albums, &songsMap);
+    FindArtForAlbums(albums, directory.path);
+
+    // Add each album
+    for (VECALBUMS::iterator album = albums.begin(); album != albums.end(); ++album)
+    {
+      // mark albums without a title as singles
+      if (album->strAlbum.empty())
+        album->releaseType = CAlbum::Single;
+
+      album->strPath = directory.path;
+      m_musicDatabase.AddAlbum(*album);
+
+      // Yuk - this is a kludgy way to do what we want to do, but it will work to sort
+      // out artist fanart until we can restructure the artist fanart to work more
+      // like the album fanart. This has to be done after we've added the album so
+      // we have the artist IDs to update, but before we call UpdateDatabaseArtistInfo.
+      if (albums.size() == 1 &&
+          album->artistCredits.size() > 0 &&
+          !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various artists") &&
+          !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various"))
+      {
+        CArtist artist;
+        if (m_musicDatabase.GetArtist(album->artistCredits[0].GetArtistId(), artist))
+        {
+          artist.strPath = URIUtils::GetParentPath(directory.path);
+          m_musicDatabase.SetArtForItem(artist.idArtist, MediaTypeArtist, GetArtistArtwork(artist));
+        }
+      }
+
+      // online info is fetched once all the files are in, so it doesn't hold up the scan
+      if (m_flags & SCAN_ONLINE)
+        m_albumsToScrape.push_back(std::make_pair(album->idAlbum, album->strPath));
+
+      numAdded += album->songs.size();
+    }
+  }
+
+  // save information about this folder
+  m_musicDatabase.SetPathHash(directory.path, directory.hash);
+  return numAdded;
+}
+
+void CMusicInfoScanner::CancelScanned()
+{
+  m_tagReaders.CancelJobs();
+  for (std::deque<std::shared_ptr<CMusicScanDirectory> >::iterator it = m_scanQueue.begin(); it != m_scanQueue.end(); ++it)
+    (*it)->cancelled = true;
+  m_scanQueue.clear();
+}
+
+void CMusicInfoScanner::ScrapeAlbums()
+{
+  ADDON::AddonPtr addon;
+  ADDON::ScraperPtr albumScraper;
+  ADDON::ScraperPtr artistScraper;
+  if(ADDON::CAddonMgr::Get().GetDefault(ADDON::ADDON_SCRAPER_ALBUMS, addon))
+    albumScraper = std::dynamic_pointer_cast<ADDON::CScraper>(addon);
+
+  if(ADDON::CAddonMgr::Get().GetDefault(ADDON::ADDON_SCRAPER_ARTISTS, addon))
+    artistScraper = std::dynamic_pointer_cast<ADDON::CScraper>(addon);
+
+  if (!albumScraper || !artistScraper)
+    return;
+
+  for (std::vector<std::pair<int, std::string> >::const_iterator it = m_albumsToScrape.begin(); it != m_albumsToScrape.end(); ++it)
   {
     if (m_bStop)
+      break;
+
+    // the albums are loaded one at a time rather than kept in memory for the whole scan
+    CAlbum album;
+    if (m_musicDatabase.HasAlbumBeenScraped(it->first) || !m_musicDatabase.GetAlbum(it->first, album, true))
+      continue;
+    album.strPath = it->second;
+
+    if (m_handle)
+    {
+      m_handle->SetText(StringUtils::Join(album.artist, g_advancedSettings.m_musicItemSeparator) + " - " + album.strAlbum);
+      m_handle->SetPercentage((it - m_albumsToScrape.begin()) / (float)m_albumsToScrape.size() * 100);
+    }
+
+    INFO_RET albumScrapeStatus = UpdateDatabaseAlbumInfo(album, albumScraper, false);
+
+    if (albumScrapeStatus == INFO_ADDED)
+    {
+      for (VECARTISTCREDITS::const_iterator artistCredit  = album.artistCredits.begin();
+                                            artistCredit != album.artistCredits.end();
+                                          ++artistCredit)
+      {
+        if (m_bStop)
+          break;
+
+        if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
+        {
+          CArtist artist;
+          m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
+          UpdateDatabaseArtistInfo(artist, artistScraper, false);
+        }
+      }
+
+      for (VECSONGS::iterator song  = album.songs.begin();
+                              song != album.songs.end();
+                              ++song)
+      {
+        if (m_bStop)
+          break;
+
+        for (VECARTISTCREDITS::const_iterator artistCredit  = song->artistCredits.begin();
+                                              artistCredit != song->artistCredits.end();
+                                            ++artistCredit)
+        {
+          if (m_bStop)
+            break;
+
+          if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
+          {
+            CArtist artist;
+            m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
+            UpdateDatabaseArtistInfo(artist, artistScraper, false);
+          }
+        }
+      }
+    }
+  }
+
+  if (m_handle)
+    m_handle->SetTitle(g_localizeStrings.Get(505));
+}
+
+static float FilesPerSecond(unsigned int files, unsigned int milliSeconds)
+{
+  return milliSeconds ? files * 1000.0f / milliSeconds : 0.0f;
+}
+
+void CMusicInfoScanner::LogScanRates(bool finished)
+{
+  CLog::Log(finished ? LOGNOTICE : LOGDEBUG,
+            "%s - listing: %u files in %u ms (%.1f files/s), tags: %u files in %u ms on %u workers (%.1f files/s per worker), "
+            "database: %u songs in %u ms (%.1f songs/s), %u ms waiting for tags",
+            __FUNCTION__, m_filesFound, m_enumerateTime, FilesPerSecond(m_filesFound, m_enumerateTime),
+            m_filesTagged, m_tagTime, GetTagReaderCount(), FilesPerSecond(m_filesTagged, m_tagTime),
+            m_songsWritten, m_writeTime, FilesPerSecond(m_songsWritten, m_writeTime), m_waitTime);
+  m_lastRateLog = XbmcThreads::SystemClockMillis();
+}
+
+INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList& scannedItems, const std::atomic<bool>& cancelled)
+{
+  vector<string> regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
+
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    if (cancelled)
       return INFO_CANCELLED;
 
     CFileItemPtr pItem = items[i];
@@ -525,8 +859,6 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
     if (pItem->m_bIsFolder || pItem->IsPlayList() || pItem->IsPicture() || pItem->IsLyrics())
       continue;
 
-    m_currentItem++;
-
     CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
     if (!tag.Loaded())
     {
@@ -535,9 +867,6 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
         pLoader->Load(pItem->GetPath(), tag);
     }
 
-    if (m_handle && m_itemCount>0)
-      m_handle->SetPercentage(m_currentItem / (float)m_itemCount * 100);
-
     if (!tag.Loaded() && !pItem->HasCueDocument())
     {
       CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, pItem->GetPath().c_str());
@@ -731,122 +1060,6 @@ void CMusicInfoScanner::FileItemsToAlbums(CFileItemList& items, VECALBUMS& album
   }
 }
 
-int CMusicInfoScanner::RetrieveMusicInfo(const std::string& strDirectory, CFileItemList& items)
-{
-  MAPSONGS songsMap;
-
-  // get all information for all files in current directory from database, and remove them
-  if (m_musicDatabase.RemoveSongsFromPath(strDirectory, songsMap))
-    m_needsCleanup = true;
-
-  CFileItemList scannedItems;
-  if (ScanTags(items, scannedItems) == INFO_CANCELLED || scannedItems.Size() == 0)
-    return 0;
-
-  VECALBUMS albums;
-  FileItemsToAlbums(scannedItems, albums, &songsMap);
-  FindArtForAlbums(albums, items.GetPath());
-
-  int numAdded = 0;
-  ADDON::AddonPtr addon;
-  ADDON::ScraperPtr albumScraper;
-  ADDON::ScraperPtr artistScraper;
-  if(ADDON::CAddonMgr::Get().GetDefault(ADDON::ADDON_SCRAPER_ALBUMS, addon))
-    albumScraper = std::dynamic_pointer_cast<ADDON::CScraper>(addon);
-
-  if(ADDON::CAddonMgr::Get().GetDefault(ADDON::ADDON_SCRAPER_ARTISTS, addon))
-    artistScraper = std::dynamic_pointer_cast<ADDON::CScraper>(addon);
-
-  // Add each album
-  for (VECALBUMS::iterator album = albums.begin(); album != albums.end(); ++album)
-  {
-    if (m_bStop)
-      break;
-
-    // mark albums without a title as singles
-    if (album->strAlbum.empty())
-      album->releaseType = CAlbum::Single;
-
-    album->strPath = strDirectory;
-    m_musicDatabase.AddAlbum(*album);
-
-    // Yuk - this is a kludgy way to do what we want to do, but it will work to sort
-    // out artist fanart until we can restructure the artist fanart to work more
-    // like the album fanart. This has to be done after we've added the album so
-    // we have the artist IDs to update, but before we call UpdateDatabaseArtistInfo.
-    if (albums.size() == 1 &&
-        album->artistCredits.size() > 0 &&
-        !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various artists") &&
-        !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various"))
-    {
-      CArtist artist;
-      if (m_musicDatabase.GetArtist(album->artistCredits[0].GetArtistId(), artist))
-      {
-        artist.strPath = URIUtils::GetParentPath(strDirectory);
-        m_musicDatabase.SetArtForItem(artist.idArtist, MediaTypeArtist, GetArtistArtwork(artist));
-      }
-    }
-
-    if ((m_flags & SCAN_ONLINE))
-    {
-      if (!albumScraper || !artistScraper)
-        continue;
-
-      INFO_RET albumScrapeStatus = INFO_NOT_FOUND;
-      if (!m_musicDatabase.HasAlbumBeenScraped(album->idAlbum))
-        albumScrapeStatus = UpdateDatabaseAlbumInfo(*album, albumScraper, false);
-
-      if (albumScrapeStatus == INFO_ADDED)
-      {
-        for (VECARTISTCREDITS::const_iterator artistCredit  = album->artistCredits.begin();
-                                              artistCredit != album->artistCredits.end();
-                                            ++artistCredit)
-        {
-          if (m_bStop)
-            break;
-
-          if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
-          {
-            CArtist artist;
-            m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
-            UpdateDatabaseArtistInfo(artist, artistScraper, false);
-          }
-        }
-
-        for (VECSONGS::iterator song  = album->songs.begin();
-                                song != album->songs.end();
-                                ++song)
-        {
-          if (m_bStop)
-            break;
-
-          for (VECARTISTCREDITS::const_iterator artistCredit  = song->artistCredits.begin();
-                                                artistCredit != song->artistCredits.end();
-                                              ++artistCredit)
-          {
-            if (m_bStop)
-              break;
-
-            CMusicArtistInfo musicArtistInfo;
-            if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
-            {
-              CArtist artist;
-              m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
-              UpdateDatabaseArtistInfo(artist, artistScraper, false);
-            }
-          }
-        }
-      }
-    }
-    numAdded += album->songs.size();
-  }
-
-  if (m_handle)
-    m_handle->SetTitle(g_localizeStrings.Get(505));
-
-  return numAdded;
-}
-
 void CMusicInfoScanner::FindArtForAlbums(VECALBUMS &albums, const std::string &path)
 {
   /*
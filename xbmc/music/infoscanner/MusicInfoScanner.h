@@ -18,8 +18,13 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <atomic>
+#include <deque>
+#include <memory>
+
 #include "threads/Thread.h"
 #include "music/MusicDatabase.h"
+#include "utils/JobManager.h"
 #include "MusicAlbumInfo.h"
 #include "MusicInfoScraper.h"
 
@@ -41,6 +46,9 @@ enum INFO_RET
   INFO_ADDED 
 };
 
+class CMusicScanDirectory;
+class CMusicTagJob;
+
 class CMusicInfoScanner : CThread, public IRunnable
 {
 public:
@@ -166,25 +174,52 @@ public:
    */
   std::map<std::string, std::string> GetArtistArtwork(const CArtist& artist);
 protected:
+  friend class CMusicTagJob;
+
   virtual void Process();
 
-  /*! \brief Scan in the ID3/Ogg/FLAC tags for a bunch of FileItems
-   Given a list of FileItems, scan in the tags for those FileItems
-   and populate a new FileItemList with the files that were successfully scanned.
-   Any files which couldn't be scanned (no/bad tags) are discarded in the process.
-   \param items [in] list of FileItems to scan
-   \param scannedItems [in] list to populate with the scannedItems
+  /*! \brief Queue the tags of a changed directory to be read on the job workers
+   The directory is written to the database by WriteScanned() once its tags
+   have been read, in the order the directories were queued.
+   \param strDirectory [in] path of the directory
+   \param items [in] the items of the directory
+   \param hash [in] the new hash of the directory, stored once it is written
+   */
+  void QueueDirectory(const std::string& strDirectory, const CFileItemList& items, const std::string& hash);
+
+  /*! \brief Write the queued directories whose tags have been read
+   \param all [in] wait for and write every queued directory, otherwise only
+   wait when too many directories are queued
+   \return false if the scan was stopped
    */
-  int RetrieveMusicInfo(const std::string& strDirectory, CFileItemList& items);
+  bool WriteScanned(bool all);
+
+  //! \brief Write the queued directories like WriteScanned(), leaving the last batch open
+  bool WriteReady(bool all);
+
+  /*! \brief Add the songs and albums of a directory to the database and store its hash
+   \return the number of songs added
+   */
+  int WriteDirectory(CMusicScanDirectory& directory);
+
+  //! \brief Cancel the directories still queued, they keep their old hash and are rescanned next time
+  void CancelScanned();
+
+  //! \brief Fetch the online info of the albums added by the scan, once all files are written
+  void ScrapeAlbums();
+
+  void LogScanRates(bool finished);
 
   /*! \brief Scan in the ID3/Ogg/FLAC tags for a bunch of FileItems
     Given a list of FileItems, scan in the tags for those FileItems
    and populate a new FileItemList with the files that were successfully scanned.
    Any files which couldn't be scanned (no/bad tags) are discarded in the process.
+   Runs on the job workers, so it mustn't touch the scanner's state.
    \param items [in] list of FileItems to scan
    \param scannedItems [in] list to populate with the scannedItems
+   \param cancelled [in] set when the scan is stopped
    */
-  INFO_RET ScanTags(const CFileItemList& items, CFileItemList& scannedItems);
+  static INFO_RET ScanTags(const CFileItemList& items, CFileItemList& scannedItems, const std::atomic<bool>& cancelled);
   int GetPathHash(const CFileItemList &items, std::string &hash);
   void GetAlbumArtwork(long id, const CAlbum &artist);
 
@@ -222,5 +257,22 @@ protected:
   std::set<std::string> m_seenPaths;
   int m_flags;
   CThread m_fileCountReader;
+
+  CJobQueue m_tagReaders;
+  std::deque<std::shared_ptr<CMusicScanDirectory> > m_scanQueue; ///< changed directories in the order they were found
+  std::vector<std::pair<int, std::string> > m_albumsToScrape; ///< ids and paths of the albums added by the scan
+
+  // pipeline statistics, in files and milliseconds spent per stage
+  unsigned int m_filesFound;
+  unsigned int m_enumerateTime;
+  unsigned int m_filesTagged;
+  unsigned int m_tagTime;
+  unsigned int m_songsWritten;
+  unsigned int m_writeTime;
+  unsigned int m_waitTime;
+  unsigned int m_lastRateLog;
+  unsigned int m_batchSongs;
+  unsigned int m_batchDirectories;
+  unsigned int m_batchStart;
 };
 }
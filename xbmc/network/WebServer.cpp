@@ -27,13 +27,22 @@
 #ifdef HAS_WEB_SERVER
 #include <memory>
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 
+#ifdef TARGET_POSIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "URL.h"
 #include "Util.h"
 #include "XBDateTime.h"
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
 #include "utils/Base64.h"
@@ -55,6 +64,11 @@
 
 #define MAX_POST_BUFFER_SIZE 2048
 
+// size of the buffer mhd hands to ContentReaderCallback, i.e. the largest single read from the file
+#define FILE_DOWNLOAD_BLOCK_SIZE     (128 * 1024)
+// files on other filesystems larger than this are read through the file cache, which reads ahead
+#define FILE_DOWNLOAD_READAHEAD_SIZE (4 * 1024 * 1024)
+
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
 
@@ -85,6 +99,7 @@ typedef struct {
 } HttpFileDownloadContext;
 
 vector<IHTTPRequestHandler *> CWebServer::m_requestHandlers;
+std::atomic<unsigned int> CWebServer::m_zeroCopyResponses(0);
 
 CWebServer::CWebServer()
   : m_daemon_ip6(NULL),
@@ -840,18 +855,35 @@ int CWebServer::CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct
     // set the initial write position
     context->ranges.GetFirstPosition(context->writePosition);
 
-    // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
+    // a single range of a local file can be sent straight from the file descriptor
+    response = NULL;
+    if (context->rangeCountTotal == 1)
+      response = CreateLocalFileResponse(filePath, context->writePosition, totalLength, fileLength);
+
     if (response == NULL)
     {
-      CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
-    }
+      // anything else is pushed through the VFS. Larger files on other filesystems are
+      // reopened through the file cache so they are read ahead while mhd is sending
+      if (context->rangeCountTotal == 1 && totalLength >= FILE_DOWNLOAD_READAHEAD_SIZE && !IsLocalFile(filePath))
+      {
+        std::shared_ptr<XFILE::CFile> cachedFile = std::make_shared<XFILE::CFile>();
+        if (cachedFile->Open(filePath, READ_CACHED))
+          context->file = cachedFile;
+      }
 
-    context.release(); // ownership was passed to mhd
+      // create the response object
+      response = MHD_create_response_from_callback(totalLength, FILE_DOWNLOAD_BLOCK_SIZE,
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == NULL)
+      {
+        CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
+
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -876,6 +908,64 @@ int CWebServer::CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct
   return MHD_YES;
 }
 
+bool CWebServer::IsLocalFile(const std::string &filePath)
+{
+  std::string localPath;
+  return GetLocalFilePath(filePath, localPath);
+}
+
+bool CWebServer::GetLocalFilePath(const std::string &filePath, std::string &localPath)
+{
+  localPath = CSpecialProtocol::TranslatePath(filePath);
+  return !localPath.empty() && CURL(localPath).GetProtocol().empty();
+}
+
+struct MHD_Response* CWebServer::CreateLocalFileResponse(const std::string &filePath, uint64_t offset, uint64_t length, uint64_t fileLength)
+{
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00090700)
+  if (!g_advancedSettings.m_webServerZeroCopy)
+    return NULL;
+
+  std::string localPath;
+  if (!GetLocalFilePath(filePath, localPath))
+    return NULL;
+
+  int fd = open(localPath.c_str(), O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  // make sure this is the file the VFS opened, the ranges were calculated from its length
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || static_cast<uint64_t>(fileStat.st_size) != fileLength)
+  {
+    close(fd);
+    return NULL;
+  }
+
+  // mhd takes over the file descriptor and sends from it with sendfile() where the platform supports it
+  struct MHD_Response *response = NULL;
+#if (MHD_VERSION >= 0x00094600)
+  response = MHD_create_response_from_fd_at_offset64(length, fd, offset);
+#else
+  if (length <= std::numeric_limits<size_t>::max() && offset <= static_cast<uint64_t>(std::numeric_limits<off_t>::max()))
+    response = MHD_create_response_from_fd_at_offset(static_cast<size_t>(length), fd, static_cast<off_t>(offset));
+#endif
+  if (response == NULL)
+    close(fd);
+  else
+    m_zeroCopyResponses++;
+
+#ifdef WEBSERVER_DEBUG
+  if (response != NULL)
+    CLog::Log(LOGDEBUG, "webserver [OUT] sending %" PRIu64 " bytes from %" PRIu64 " of %s directly", length, offset, localPath.c_str());
+#endif
+
+  return response;
+#else
+  return NULL;
+#endif
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response)
 {
   size_t payloadSize = 0;
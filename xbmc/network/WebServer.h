@@ -22,6 +22,7 @@
 #include "system.h"
 
 #ifdef HAS_WEB_SERVER
+#include <atomic>
 #include <vector>
 
 #include "interfaces/json-rpc/ITransportLayer.h"
@@ -59,6 +60,11 @@ public:
 
   static bool GetRequestedRanges(struct MHD_Connection *connection, uint64_t totalLength, CHttpRanges &ranges);
 
+  /*!
+   \brief Number of file downloads sent straight from the file descriptor so far
+   */
+  static unsigned int GetZeroCopyResponses() { return m_zeroCopyResponses; }
+
 private:
   struct MHD_Daemon* StartMHD(unsigned int flags, int port);
   static int AskForAuthentication (struct MHD_Connection *connection);
@@ -102,6 +108,12 @@ private:
 
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
   static int CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct MHD_Response *&response);
+  /*!
+   \brief Create a response sending length bytes from offset of a file on the local filesystem
+   straight from its file descriptor, without copying through the VFS.
+   \return the response or NULL if the file is not local or this isn't supported
+   */
+  static struct MHD_Response* CreateLocalFileResponse(const std::string &filePath, uint64_t offset, uint64_t length, uint64_t fileLength);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, const void *data, size_t size, bool free, bool copy, struct MHD_Response *&response);
 
@@ -112,6 +124,8 @@ private:
   static int FillArgumentMultiMap(void *cls, enum MHD_ValueKind kind, const char *key, const char *value);
 
   static std::string CreateMimeTypeFromExtension(const char *ext);
+  static bool IsLocalFile(const std::string &filePath);
+  static bool GetLocalFilePath(const std::string &filePath, std::string &localPath);
 
   static int AddHeader(struct MHD_Response *response, const std::string &name, const std::string &value);
   static bool GetLastModifiedDateTime(XFILE::CFile *file, CDateTime &lastModified);
@@ -123,5 +137,6 @@ private:
   std::string m_Credentials64Encoded;
   CCriticalSection m_critSection;
   static std::vector<IHTTPRequestHandler *> m_requestHandlers;
+  static std::atomic<unsigned int> m_zeroCopyResponses;
 };
 #endif
@@ -20,6 +20,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <iostream>
 
 #include <gtest/gtest.h>
 #include "system.h"
@@ -28,8 +29,10 @@
 #include "filesystem/File.h"
 #include "interfaces/json-rpc/JSONRPC.h"
 #include "network/WebServer.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/MediaSourceSettings.h"
 #include "test/TestUtils.h"
+#include "threads/SystemClock.h"
 #include "utils/JSONVariantParser.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -46,6 +49,8 @@ using namespace XFILE;
 #define TEST_FILES_HTML         TEST_FILES_DATA ".html"
 #define TEST_FILES_RANGES       TEST_FILES_DATA "-ranges.txt"
 
+#define LARGE_FILE_BLOCK_SIZE   (1024 * 1024)
+
 class TestWebServer : public testing::Test
 {
 protected:
@@ -69,21 +74,52 @@ protected:
     if (webserver.IsStarted())
       webserver.Stop();
 
+    if (!tempShare.strPath.empty())
+      CMediaSourceSettings::Get().DeleteSource("videos", tempShare.strName, tempShare.strPath, true);
     TearDownMediaSources();
   }
 
-  void SetupMediaSources()
+  static CMediaSource CreateShare(const std::string& name, const std::string& path)
   {
     CMediaSource source;
-    source.strName = "WebServer Share";
-    source.strPath = sourcePath;
-    source.vecPaths.push_back(sourcePath);
+    source.strName = name;
+    source.strPath = path;
+    source.vecPaths.push_back(path);
     source.m_allowSharing = true;
     source.m_iDriveType = CMediaSource::SOURCE_TYPE_LOCAL;
     source.m_iLockMode = LOCK_MODE_EVERYONE;
     source.m_ignore = true;
+    return source;
+  }
 
-    CMediaSourceSettings::Get().AddShare("videos", source);
+  void SetupMediaSources()
+  {
+    CMediaSourceSettings::Get().AddShare("videos", CreateShare("WebServer Share", sourcePath));
+  }
+
+  // fills a temporary file with blocks of a known pattern and makes its
+  // directory accessible through the webserver
+  CFile* CreateLargeTempFile(size_t blockCount, std::string& block)
+  {
+    block.assign(LARGE_FILE_BLOCK_SIZE, '\0');
+    for (size_t i = 0; i < block.size(); i++)
+      block[i] = static_cast<char>(i % 251);
+
+    CFile *tempFile = XBMC_CREATETEMPFILE(".bin");
+    if (tempFile == NULL)
+      return NULL;
+    for (size_t i = 0; i < blockCount; i++)
+      EXPECT_EQ(static_cast<ssize_t>(block.size()), tempFile->Write(block.c_str(), block.size()));
+    tempFile->Flush();
+
+    tempShare = CreateShare("WebServer Temp Share", URIUtils::GetDirectory(XBMC_TEMPFILEPATH(tempFile)));
+    CMediaSourceSettings::Get().AddShare("videos", tempShare);
+    return tempFile;
+  }
+
+  std::string GetUrlOfTempFile(CFile* tempFile)
+  {
+    return GetUrl(URIUtils::AddFileToFolder("vfs", CURL::Encode(XBMC_TEMPFILEPATH(tempFile))));
   }
 
   void TearDownMediaSources()
@@ -332,6 +368,7 @@ protected:
   CWebServer webserver;
   std::string baseUrl;
   std::string sourcePath;
+  CMediaSource tempShare;
 };
 
 TEST_F(TestWebServer, IsStarted)
@@ -772,4 +809,71 @@ TEST_F(TestWebServer, CanGetCachedRangedFileWithNewerIfRange)
   curl.SetRequestHeader(MHD_HTTP_HEADER_IF_RANGE, lastModifiedNewer.GetAsRFC1123DateTime());
   ASSERT_TRUE(curl.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
   CheckRangesTestFileResponse(curl, result, ranges);
-}
\ No newline at end of file
+}
+
+TEST_F(TestWebServer, CanGetLargeFileWithAndWithoutZeroCopy)
+{
+  const size_t blockCount = 32;
+  std::string block;
+  CFile *tempFile = CreateLargeTempFile(blockCount, block);
+  ASSERT_TRUE(tempFile != NULL);
+  const std::string url = GetUrlOfTempFile(tempFile);
+
+  // download the file sent straight from its file descriptor and through the VFS callback
+  const bool zeroCopy = g_advancedSettings.m_webServerZeroCopy;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    g_advancedSettings.m_webServerZeroCopy = pass == 0;
+    unsigned int zeroCopyResponses = CWebServer::GetZeroCopyResponses();
+
+    std::string result;
+    CCurlFile curl;
+    EXPECT_TRUE(curl.Get(url, result));
+
+    EXPECT_EQ(block.size() * blockCount, result.size());
+    if (result.size() == block.size() * blockCount)
+    {
+      EXPECT_EQ(0, result.compare(block.size() * (blockCount - 1), block.size(), block));
+    }
+
+    // the download took the path being tested
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00090700)
+    EXPECT_EQ(zeroCopyResponses + (pass == 0 ? 1 : 0), CWebServer::GetZeroCopyResponses());
+#else
+    EXPECT_EQ(zeroCopyResponses, CWebServer::GetZeroCopyResponses());
+#endif
+  }
+  g_advancedSettings.m_webServerZeroCopy = zeroCopy;
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(tempFile));
+}
+
+// Throughput of a large download sent straight from its file descriptor and
+// through the VFS callback. Run it with --gtest_also_run_disabled_tests
+TEST_F(TestWebServer, DISABLED_LargeFileThroughput)
+{
+  const size_t blockCount = 256;
+  std::string block;
+  CFile *tempFile = CreateLargeTempFile(blockCount, block);
+  ASSERT_TRUE(tempFile != NULL);
+  const std::string url = GetUrlOfTempFile(tempFile);
+
+  const bool zeroCopy = g_advancedSettings.m_webServerZeroCopy;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    g_advancedSettings.m_webServerZeroCopy = pass == 0;
+
+    std::string result;
+    CCurlFile curl;
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    EXPECT_TRUE(curl.Get(url, result));
+    unsigned int elapsed = std::max(XbmcThreads::SystemClockMillis() - start, 1U);
+    EXPECT_EQ(block.size() * blockCount, result.size());
+
+    std::cout << (pass == 0 ? "Zero copy" : "Callback") << " throughput (MiB/s): " <<
+      testing::PrintToString(result.size() * 1000.0 / elapsed / LARGE_FILE_BLOCK_SIZE) << std::endl;
+  }
+  g_advancedSettings.m_webServerZeroCopy = zeroCopy;
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(tempFile));
+}
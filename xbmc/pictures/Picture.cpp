@@ -35,6 +35,8 @@
 #include "guilib/Texture.h"
 #include "guilib/imagefactory.h"
 #include "cores/FFmpeg.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #if defined(HAS_OMXPLAYER)
 #include "cores/omxplayer/OMXImage.h"
 #endif
@@ -45,6 +47,76 @@ extern "C" {
 
 using namespace XFILE;
 
+#define MAX_IDLE_SCALERS 4
+
+namespace
+{
+/* Artwork mostly comes in a few sizes that are scaled to the same cache sizes,
+   so scaler contexts are kept for reuse instead of setting up their filters
+   for every image. Jobs caching images in parallel each take one of their own. */
+class CScalerPool
+{
+public:
+  ~CScalerPool()
+  {
+    for (std::vector<Scaler>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+      sws_freeContext(it->context);
+  }
+
+  struct SwsContext *Acquire(unsigned int in_width, unsigned int in_height, unsigned int out_width, unsigned int out_height)
+  {
+    struct SwsContext *context = NULL;
+    {
+      CSingleLock lock(m_section);
+      std::vector<Scaler>::iterator it;
+      for (it = m_idle.begin(); it != m_idle.end(); ++it)
+      {
+        if (it->in_width == in_width && it->in_height == in_height &&
+            it->out_width == out_width && it->out_height == out_height)
+          break;
+      }
+      // no match, reconfigure the most recently used one
+      if (it == m_idle.end() && !m_idle.empty())
+        it = m_idle.end() - 1;
+      if (it != m_idle.end())
+      {
+        context = it->context;
+        m_idle.erase(it);
+      }
+    }
+
+    return sws_getCachedContext(context, in_width, in_height, PIX_FMT_BGRA,
+                                out_width, out_height, PIX_FMT_BGRA,
+                                SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  }
+
+  void Release(struct SwsContext *context, unsigned int in_width, unsigned int in_height, unsigned int out_width, unsigned int out_height)
+  {
+    Scaler scaler = { context, in_width, in_height, out_width, out_height };
+    CSingleLock lock(m_section);
+    if (m_idle.size() >= MAX_IDLE_SCALERS)
+    {
+      sws_freeContext(m_idle.front().context);
+      m_idle.erase(m_idle.begin());
+    }
+    m_idle.push_back(scaler);
+  }
+
+private:
+  struct Scaler
+  {
+    struct SwsContext *context;
+    unsigned int in_width, in_height;
+    unsigned int out_width, out_height;
+  };
+
+  CCriticalSection m_section;
+  std::vector<Scaler> m_idle;
+};
+
+CScalerPool g_scalerPool;
+}
+
 bool CPicture::GetThumbnailFromSurface(const unsigned char* buffer, int width, int height, int stride, const std::string &thumbFile, uint8_t* &result, size_t& result_size)
 {
   unsigned char *thumb = NULL;
@@ -198,6 +270,13 @@ bool CPicture::ResizeTexture(const std::string &image, uint8_t *pixels, uint32_t
   return success;
 }
 
+void CPicture::GetMaxCacheSize(unsigned int &width, unsigned int &height)
+{
+  // see CacheTexture(), fanart may be cached at a larger size than other images
+  height = std::max(g_advancedSettings.m_imageRes, g_advancedSettings.m_fanartRes);
+  width = height * 16/9;
+}
+
 bool CPicture::CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest)
 {
   return CacheTexture(texture->GetPixels(), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(),
@@ -330,9 +409,7 @@ void CPicture::GetScale(unsigned int width, unsigned int height, unsigned int &o
 bool CPicture::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
                           uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
 {
-  struct SwsContext *context = sws_getContext(in_width, in_height, PIX_FMT_BGRA,
-                                                         out_width, out_height, PIX_FMT_BGRA,
-                                                         SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  struct SwsContext *context = g_scalerPool.Acquire(in_width, in_height, out_width, out_height);
 
   uint8_t *src[] = { in_pixels, 0, 0, 0 };
   int     srcStride[] = { (int)in_pitch, 0, 0, 0 };
@@ -342,7 +419,7 @@ bool CPicture::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned in
   if (context)
   {
     sws_scale(context, src, srcStride, 0, in_height, dst, dstStride);
-    sws_freeContext(context);
+    g_scalerPool.Release(context, in_width, in_height, out_width, out_height);
     return true;
   }
   return false;
@@ -49,6 +49,13 @@ public:
   static bool CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
   static bool CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
 
+  /*! \brief The size no cached image is larger than, images about to be cached
+   need not be decoded at a larger size.
+   \param width [out] maximum width of a cached image
+   \param height [out] maximum height of a cached image
+   */
+  static void GetMaxCacheSize(unsigned int &width, unsigned int &height);
+
 private:
   static void GetScale(unsigned int width, unsigned int height, unsigned int &out_width, unsigned int &out_height);
   static bool ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
@@ -0,0 +1,188 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "guilib/JpegIO.h"
+#include "guilib/Texture.h"
+#include "pictures/Picture.h"
+#include "settings/AdvancedSettings.h"
+#include "test/TestUtils.h"
+#include "utils/TimeUtils.h"
+
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+/* sample artwork, sizes as they come from the scrapers, limited to the
+   2048 pixels textures have without a GL context */
+struct SampleArt
+{
+  const char  *name;
+  unsigned int width;
+  unsigned int height;
+};
+
+const SampleArt corpus[] = { { "fanart", 1920, 1080 },
+                             { "large fanart", 2048, 1152 },
+                             { "poster", 1000, 1500 },
+                             { "square", 1600, 1600 },
+                             { "clearart", 1000, 562 } };
+
+const int ITERATIONS = 5;
+
+std::vector<unsigned char> EncodeSample(const SampleArt &art)
+{
+  // smooth gradients with some noise, compressing roughly like a photo
+  std::vector<unsigned char> pixels(art.width * art.height * 4);
+  unsigned char *p = &pixels[0];
+  for (unsigned int y = 0; y < art.height; y++)
+  {
+    for (unsigned int x = 0; x < art.width; x++, p += 4)
+    {
+      p[0] = (unsigned char)(255 * x / art.width);
+      p[1] = (unsigned char)(255 * y / art.height);
+      p[2] = (unsigned char)(127 + 120 * sin(x * 0.01) * cos(y * 0.013) + rand() % 8);
+      p[3] = 0xff;
+    }
+  }
+
+  CJpegIO jpeg;
+  unsigned char *data = NULL;
+  unsigned int size = 0;
+  std::vector<unsigned char> encoded;
+  if (jpeg.CreateThumbnailFromSurface(&pixels[0], art.width, art.height, XB_FMT_A8R8G8B8, art.width * 4, "", data, size))
+    encoded.assign(data, data + size);
+  jpeg.ReleaseThumbnailBuffer();
+  return encoded;
+}
+
+class TestPicture : public testing::Test
+{
+protected:
+  TestPicture()
+  {
+    // as set on low powered devices, leaves room to scale while decoding
+    m_imageRes = g_advancedSettings.m_imageRes;
+    m_fanartRes = g_advancedSettings.m_fanartRes;
+    g_advancedSettings.m_imageRes = 720;
+    g_advancedSettings.m_fanartRes = 720;
+
+    srand(42);
+    for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+      m_samples.push_back(EncodeSample(corpus[i]));
+
+    m_file = XBMC_CREATETEMPFILE(".jpg");
+    if (m_file)
+      m_file->Close();
+  }
+
+  ~TestPicture()
+  {
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+    g_advancedSettings.m_imageRes = m_imageRes;
+    g_advancedSettings.m_fanartRes = m_fanartRes;
+  }
+
+  CBaseTexture *Decode(size_t sample, bool cacheSized)
+  {
+    unsigned int width = 0, height = 0;
+    if (cacheSized)
+      CPicture::GetMaxCacheSize(width, height);
+    return CBaseTexture::LoadFromFileInMemory(&m_samples[sample][0], m_samples[sample].size(), "image/jpeg", width, height);
+  }
+
+  std::vector<std::vector<unsigned char> > m_samples;
+  XFILE::CFile *m_file;
+  unsigned int m_imageRes;
+  unsigned int m_fanartRes;
+};
+
+double ElapsedMs(int64_t start)
+{
+  return (double)(CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency();
+}
+}
+
+TEST_F(TestPicture, CacheSizedDecode)
+{
+  ASSERT_TRUE(m_file != NULL);
+  for (size_t i = 0; i < m_samples.size(); i++)
+  {
+    ASSERT_FALSE(m_samples[i].empty()) << corpus[i].name;
+
+    CBaseTexture *full = Decode(i, false);
+    CBaseTexture *scaled = Decode(i, true);
+    ASSERT_TRUE(full != NULL) << corpus[i].name;
+    ASSERT_TRUE(scaled != NULL) << corpus[i].name;
+    EXPECT_EQ(corpus[i].width, full->GetWidth()) << corpus[i].name;
+    EXPECT_LE(scaled->GetWidth(), full->GetWidth()) << corpus[i].name;
+
+    // the cached image is the same size either way, and never upscaled
+    uint32_t fullWidth = 0, fullHeight = 0;
+    uint32_t scaledWidth = 0, scaledHeight = 0;
+    EXPECT_TRUE(CPicture::CacheTexture(full, fullWidth, fullHeight, XBMC_TEMPFILEPATH(m_file)));
+    EXPECT_TRUE(CPicture::CacheTexture(scaled, scaledWidth, scaledHeight, XBMC_TEMPFILEPATH(m_file)));
+    EXPECT_EQ(fullWidth, scaledWidth) << corpus[i].name;
+    EXPECT_EQ(fullHeight, scaledHeight) << corpus[i].name;
+    EXPECT_GE(scaled->GetWidth(), scaledWidth) << corpus[i].name;
+    EXPECT_GE(scaled->GetHeight(), scaledHeight) << corpus[i].name;
+
+    delete full;
+    delete scaled;
+  }
+}
+
+// Decode, scale and save timings, run it with --gtest_also_run_disabled_tests
+TEST_F(TestPicture, DISABLED_Benchmark)
+{
+  ASSERT_TRUE(m_file != NULL);
+  std::cout << "ms per image, decode at full size / at cache size, scale and save" << std::endl;
+  for (size_t i = 0; i < m_samples.size(); i++)
+  {
+    double full = 0, scaled = 0, cache = 0;
+    for (int n = 0; n < ITERATIONS; n++)
+    {
+      int64_t start = CurrentHostCounter();
+      CBaseTexture *texture = Decode(i, false);
+      full += ElapsedMs(start);
+      delete texture;
+
+      start = CurrentHostCounter();
+      texture = Decode(i, true);
+      scaled += ElapsedMs(start);
+      ASSERT_TRUE(texture != NULL);
+
+      uint32_t width = 0, height = 0;
+      start = CurrentHostCounter();
+      EXPECT_TRUE(CPicture::CacheTexture(texture, width, height, XBMC_TEMPFILEPATH(m_file)));
+      cache += ElapsedMs(start);
+      delete texture;
+    }
+
+    std::cout << corpus[i].name << " " << corpus[i].width << "x" << corpus[i].height << ": decode "
+              << full / ITERATIONS << " / " << scaled / ITERATIONS << ", cache " << cache / ITERATIONS << std::endl;
+  }
+}
@@ -292,6 +292,8 @@ void CAdvancedSettings::Initialize()
   m_iEpgActiveTagCheckInterval = 60; /* check for updated active tags every minute */
   m_iEpgRetryInterruptedUpdateInterval = 30; /* retry an interrupted epg update after 30 seconds */
   m_iEpgUpdateEmptyTagsInterval = 60; /* override user selectable EPG update interval for empty EPG tags */
+  m_iEpgPersistBatchSize = 5000; /* write up to 5000 changed tags per second */
+  m_iEpgPersistBatchSizePlaying = 500; /* and up to 500 during playback */
   m_bEpgDisplayUpdatePopup = true; /* display a progress popup while updating EPG data from clients */
   m_bEpgDisplayIncrementalUpdatePopup = false; /* also display a progress popup while doing incremental EPG updates */
 
@@ -308,6 +310,8 @@ void CAdvancedSettings::Initialize()
   m_curlretries = 2;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
+  m_curlRangeConnections = 0;     //Concurrent range requests for large http files, off by default
+  m_curlRangeChunkSize = 1024 * 1024;
 
   m_startFullScreen = false;
   m_showExitButton = true;
@@ -350,16 +354,26 @@ void CAdvancedSettings::Initialize()
   m_bPVRAutoScanIconsUserSet       = false;
   m_iPVRNumericChannelSwitchTimeout = 1000;
 
+  m_iScriptPoolSize = 2;
+  m_iScriptPoolIdleTimeout = 60;
+  m_iScriptPoolMaxExecutions = 100;
+  m_iScriptPoolMinFreeMemory = 64;
+
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_cacheUseBlockCache = true;
   m_networkBufferMode = 0; // Default (buffer all internet streams/filesystems)
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_readBufferFactor = 4.0f;
+  m_dirCacheMaxDirs = 50;
+  m_dirCacheMemSize = 1024 * 1024 * 16;
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webServerZeroCopy = true;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
@@ -391,6 +405,8 @@ void CAdvancedSettings::Initialize()
   m_logLevelHint = m_logLevel = LOG_LEVEL_DEBUG;
   m_extraLogEnabled = false;
   m_extraLogLevels = 0;
+  m_asyncLogging = false;
+  m_announceCoalesceTime = 0;
 
   #if defined(TARGET_DARWIN)
     std::string logDir = getenv("HOME");
@@ -420,6 +436,9 @@ bool CAdvancedSettings::Load()
     ParseSettingsFile(m_settingsFiles[i]);
   ParseSettingsFile(CProfilesManager::Get().GetUserDataItem("advancedsettings.xml"));
 
+  // write the log from its own thread, so debug logging doesn't stall playback
+  CLog::SetAsync(m_asyncLogging);
+
   // Add the list of disc stub extensions (if any) to the list of video extensions
   if (!m_discStubExtensions.empty())
     m_videoExtensions += "|" + m_discStubExtensions;
@@ -782,11 +801,21 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
+    XMLUtils::GetUInt(pElement, "curlrangeconnections", m_curlRangeConnections, 0, 8);
+    XMLUtils::GetUInt(pElement, "curlrangechunksize", m_curlRangeChunkSize, 65536, 32 * 1024 * 1024);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    XMLUtils::GetBoolean(pElement, "blockcache", m_cacheUseBlockCache);
     XMLUtils::GetUInt(pElement, "buffermode", m_networkBufferMode, 0, 3);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
   }
 
+  pElement = pRootElement->FirstChildElement("directorycache");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "maxdirectories", m_dirCacheMaxDirs, 1, 10000);
+    XMLUtils::GetUInt(pElement, "memorysize", m_dirCacheMemSize);
+  }
+
   pElement = pRootElement->FirstChildElement("jsonrpc");
   if (pElement)
   {
@@ -794,6 +823,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+    XMLUtils::GetBoolean(pElement, "zerocopy", m_webServerZeroCopy);
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
@@ -828,6 +861,9 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     CLog::SetLogLevel(g_advancedSettings.m_logLevel);
   }
 
+  XMLUtils::GetBoolean(pRootElement, "asynclogging", m_asyncLogging);
+  XMLUtils::GetUInt(pRootElement, "announcecoalescetime", m_announceCoalesceTime, 0, 10000);
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
 
   //airtunes + airplay
@@ -869,6 +905,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "activetagcheckinterval", m_iEpgActiveTagCheckInterval);
     XMLUtils::GetInt(pElement, "retryinterruptedupdateinterval", m_iEpgRetryInterruptedUpdateInterval);
     XMLUtils::GetInt(pElement, "updateemptytagsinterval", m_iEpgUpdateEmptyTagsInterval);
+    XMLUtils::GetInt(pElement, "persistbatchsize", m_iEpgPersistBatchSize, 0, INT_MAX);
+    XMLUtils::GetInt(pElement, "persistbatchsizeplaying", m_iEpgPersistBatchSizePlaying, 0, INT_MAX);
     XMLUtils::GetBoolean(pElement, "displayupdatepopup", m_bEpgDisplayUpdatePopup);
     XMLUtils::GetBoolean(pElement, "displayincrementalupdatepopup", m_bEpgDisplayIncrementalUpdatePopup);
   }
@@ -1057,6 +1095,15 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pPVR, "numericchannelswitchtimeout", m_iPVRNumericChannelSwitchTimeout, 50, 60000);
   }
 
+  TiXmlElement *pScriptPool = pRootElement->FirstChildElement("scriptpool");
+  if (pScriptPool)
+  {
+    XMLUtils::GetInt(pScriptPool, "size", m_iScriptPoolSize, 0, 32);
+    XMLUtils::GetInt(pScriptPool, "idletimeout", m_iScriptPoolIdleTimeout, 0, 86400);
+    XMLUtils::GetInt(pScriptPool, "maxexecutions", m_iScriptPoolMaxExecutions, 0, INT_MAX);
+    XMLUtils::GetInt(pScriptPool, "minfreememory", m_iScriptPoolMinFreeMemory, 0, INT_MAX);
+  }
+
   TiXmlElement* pDatabase = pRootElement->FirstChildElement("videodatabase");
   if (pDatabase)
   {
@@ -214,6 +214,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_logLevelHint;
     bool m_extraLogEnabled;
     int m_extraLogLevels;
+    bool m_asyncLogging;
+    unsigned int m_announceCoalesceTime; ///< ms repeated library notifications of an item are held back to be merged, 0 to disable
     std::string m_cddbAddress;
 
     //airtunes + airplay
@@ -295,6 +297,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iEpgActiveTagCheckInterval; // seconds
     int m_iEpgRetryInterruptedUpdateInterval; // seconds
     int m_iEpgUpdateEmptyTagsInterval; // seconds
+    int m_iEpgPersistBatchSize;     // tags written per transaction, 0 for all
+    int m_iEpgPersistBatchSizePlaying; // tags written per transaction during playback, 0 for all
     bool m_bEpgDisplayUpdatePopup;
     bool m_bEpgDisplayIncrementalUpdatePopup;
 
@@ -311,6 +315,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curllowspeedtime;
     int m_curlretries;
     bool m_curlDisableIPV6;
+    unsigned int m_curlRangeConnections;
+    unsigned int m_curlRangeChunkSize;
 
     bool m_fullScreen;
     bool m_startFullScreen;
@@ -353,6 +359,10 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bPVRChannelIconsAutoScan; /*!< @brief automatically scan user defined folder for channel icons when loading internal channel groups */
     bool m_bPVRAutoScanIconsUserSet; /*!< @brief mark channel icons populated by auto scan as "user set" */
     int m_iPVRNumericChannelSwitchTimeout; /*!< @brief time in ms before the numeric dialog auto closes when confirmchannelswitch is disabled */
+    int m_iScriptPoolSize;           /*!< @brief idle interpreters kept for addons that allow reusing them, 0 to disable */
+    int m_iScriptPoolIdleTimeout;    /*!< @brief time in seconds before an idle interpreter is released */
+    int m_iScriptPoolMaxExecutions;  /*!< @brief executions before an interpreter is released, 0 for no limit */
+    int m_iScriptPoolMinFreeMemory;  /*!< @brief free memory in MB below which idle interpreters are released, 0 to ignore */
 
     DatabaseSettings m_databaseMusic; // advanced music database setup
     DatabaseSettings m_databaseVideo; // advanced video database setup
@@ -365,12 +375,18 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    bool m_cacheUseBlockCache; ///< keep multiple cached ranges of a file in the memory cache
     unsigned int m_networkBufferMode;
     float m_readBufferFactor;
 
+    unsigned int m_dirCacheMaxDirs; ///< maximum number of directory listings kept in the directory cache
+    unsigned int m_dirCacheMemSize; ///< approximate memory budget of the directory cache in bytes, 0 for no limit
+
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    bool m_webServerZeroCopy; ///< serve local files to the webserver through their file descriptor (sendfile)
+
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
     void ParseSettingsFile(const std::string &file);
@@ -21,6 +21,17 @@
 #include "FileItem.h"
 #include "URL.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+#include "video/VideoInfoTag.h"
+
+#include <iostream>
+#if defined(TARGET_LINUX)
+#include <malloc.h>
+#endif
 
 #include "gtest/gtest.h"
 
@@ -136,3 +147,181 @@ const TestFileData BaseMovies[] = {{ "c:\\dir\\filename.avi", false, "c:\\dir\\f
                                    { "/home/user/movies/movie_name/BDMV/index.bdmv", true, "/home/user/movies/movie_name/" }};
 
 INSTANTIATE_TEST_CASE_P(BaseNameMovies, TestFileItemBasePath, ValuesIn(BaseMovies));
+
+TEST(TestFileItem, CopyOnWriteTags)
+{
+  CFileItem item;
+  item.SetPath("/movies/movie.mkv");
+  item.GetVideoInfoTag()->m_strTitle = "Movie";
+
+  // copies share the tag until one of them modifies it
+  CFileItem copy(item);
+  const CFileItem &constItem = item;
+  const CFileItem &constCopy = copy;
+  EXPECT_EQ(constItem.GetVideoInfoTag(), constCopy.GetVideoInfoTag());
+  EXPECT_FALSE(copy.HasMusicInfoTag());
+
+  copy.GetVideoInfoTag()->m_strTitle = "Copy";
+  EXPECT_NE(constItem.GetVideoInfoTag(), constCopy.GetVideoInfoTag());
+  EXPECT_EQ("Movie", constItem.GetVideoInfoTag()->m_strTitle);
+  EXPECT_EQ("Copy", constCopy.GetVideoInfoTag()->m_strTitle);
+
+  // a tag that is no longer shared isn't copied again
+  const CVideoInfoTag *tag = constItem.GetVideoInfoTag();
+  EXPECT_EQ(tag, item.GetVideoInfoTag());
+
+  CFileItem assigned;
+  assigned = copy;
+  copy.Reset();
+  EXPECT_FALSE(copy.HasVideoInfoTag());
+  ASSERT_TRUE(assigned.HasVideoInfoTag());
+  EXPECT_EQ("Copy", assigned.GetVideoInfoTag()->m_strTitle);
+}
+
+namespace
+{
+class TagReader : public IRunnable
+{
+public:
+  TagReader(CFileItem &item, CEvent &start) : m_item(item), m_start(start), m_tag(NULL) {}
+
+  void Run()
+  {
+    m_start.Wait();
+    // the non-const getter is used for reading too, and copies a shared tag
+    m_tag = m_item.GetVideoInfoTag();
+    m_title = m_tag->m_strTitle;
+  }
+
+  CFileItem &m_item;
+  CEvent &m_start;
+  const CVideoInfoTag *m_tag;
+  std::string m_title;
+};
+}
+
+TEST(TestFileItem, ConcurrentTagReads)
+{
+  CFileItem item;
+  item.GetVideoInfoTag()->m_strTitle = "Movie";
+  const CFileItem &constItem = item;
+
+  for (int i = 0; i < 100; i++)
+  {
+    CFileItem copy(item);
+    const CFileItem &constCopy = copy;
+    CEvent start(true);
+    TagReader first(item, start);
+    TagReader second(item, start);
+    CThread firstThread(&first, "TestTagReader");
+    CThread secondThread(&second, "TestTagReader");
+    firstThread.Create();
+    secondThread.Create();
+    start.Set();
+    firstThread.StopThread(true);
+    secondThread.StopThread(true);
+
+    // only one of the threads copies the tag, both get that copy
+    EXPECT_EQ(first.m_tag, second.m_tag);
+    EXPECT_EQ(constItem.GetVideoInfoTag(), first.m_tag);
+    EXPECT_NE(constCopy.GetVideoInfoTag(), first.m_tag);
+    EXPECT_EQ("Movie", first.m_title);
+    EXPECT_EQ("Movie", second.m_title);
+    EXPECT_EQ("Movie", constCopy.GetVideoInfoTag()->m_strTitle);
+  }
+}
+
+TEST(TestFileItem, Properties)
+{
+  CFileItem item;
+  EXPECT_FALSE(item.HasProperties());
+  item.SetProperty("IsPlayable", "true");
+  item.SetProperty("artist", "A");
+  item.SetProperty("Album", 1);
+
+  // keys are case insensitive
+  EXPECT_TRUE(item.HasProperty("isplayable"));
+  EXPECT_EQ("true", item.GetProperty("ISPLAYABLE").asString());
+  item.SetProperty("ARTIST", "B");
+  EXPECT_EQ("B", item.GetProperty("artist").asString());
+  item.IncrementProperty("album", 2);
+  EXPECT_EQ(3, item.GetProperty("Album").asInteger());
+  EXPECT_TRUE(item.GetProperty("missing").isNull());
+
+  item.ClearProperty("Artist");
+  EXPECT_FALSE(item.HasProperty("artist"));
+  EXPECT_TRUE(item.HasProperty("album"));
+
+  CFileItem other;
+  other.SetProperty("ALBUM", 5);
+  other.SetProperty("zeta", true);
+  item.AppendProperties(other);
+  EXPECT_EQ(5, item.GetProperty("album").asInteger());
+  EXPECT_TRUE(item.GetProperty("Zeta").asBoolean());
+  EXPECT_TRUE(item.HasProperty("IsPlayable"));
+
+  CFileItem copy(item);
+  EXPECT_EQ(5, copy.GetProperty("album").asInteger());
+  item.ClearProperties();
+  EXPECT_FALSE(item.HasProperties());
+  EXPECT_TRUE(copy.HasProperty("zeta"));
+}
+
+#if defined(TARGET_LINUX)
+static size_t AllocatedBytes()
+{
+  // mallinfo() is deprecated and its counters overflow at 2 GiB
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  return mallinfo2().uordblks;
+#else
+  return mallinfo().uordblks;
+#endif
+}
+#endif
+
+// The memory used by a list of 60,000 movies and by a copy of it, like the one the directory cache
+// keeps. Run it with --gtest_also_run_disabled_tests
+TEST(TestFileItemBenchmark, DISABLED_MemoryPerItem)
+{
+#if defined(TARGET_LINUX)
+  const int count = 60000;
+  size_t before = AllocatedBytes();
+  int64_t start = CurrentHostCounter();
+  CFileItemList *items = new CFileItemList;
+  for (int i = 0; i < count; i++)
+  {
+    std::string path = StringUtils::Format("/media/movies/Movie %d (%d)/Movie %d.mkv", i, 1950 + i % 60, i);
+    CFileItemPtr item(new CFileItem(path, false));
+    item->SetLabel(StringUtils::Format("Movie %d", i));
+    item->SetIconImage("DefaultVideo.png");
+    item->SetMimeType("video/x-matroska");
+    item->SetProperty("IsPlayable", "true");
+    item->SetProperty("watchedepisodes", i % 10);
+
+    CVideoInfoTag *tag = item->GetVideoInfoTag();
+    tag->m_strTitle = item->GetLabel();
+    tag->m_strFileNameAndPath = path;
+    tag->m_iDbId = i;
+    tag->m_iYear = 1950 + i % 60;
+    tag->m_type = MediaTypeMovie;
+    items->Add(item);
+  }
+  double build = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+  size_t list = AllocatedBytes() - before;
+
+  start = CurrentHostCounter();
+  CFileItemList *copy = new CFileItemList;
+  copy->Copy(*items);
+  double copied = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+  size_t copyBytes = AllocatedBytes() - before - list;
+
+  EXPECT_EQ(count, copy->Size());
+  std::cout << count << " items built in " << build << " ms, " << list / count << " bytes per item. Copied in "
+            << copied << " ms, " << copyBytes / count << " bytes per copied item" << std::endl;
+
+  delete copy;
+  delete items;
+#else
+  std::cout << "memory use is only measured on Linux" << std::endl;
+#endif
+}
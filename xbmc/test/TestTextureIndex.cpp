@@ -0,0 +1,150 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextureCacheJob.h"
+#include "TextureIndex.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+CTextureIndex::Entry MakeEntry(int id, const std::string &file, const CDateTime &lastHashCheck)
+{
+  CTextureIndex::Entry entry;
+  entry.id = id;
+  entry.file = file;
+  entry.imageHash = "hash";
+  entry.lastHashCheck = lastHashCheck;
+  entry.width = 320;
+  entry.height = 180;
+  return entry;
+}
+
+CTextureDetails MakeDetails(int id, const std::string &file)
+{
+  CTextureDetails details;
+  details.id = id;
+  details.file = file;
+  details.width = 640;
+  details.height = 360;
+  return details;
+}
+}
+
+TEST(TestTextureIndex, HashCheckedDaily)
+{
+  CDateTime now = CDateTime::GetCurrentDateTime();
+  CTextureIndex::Entries entries;
+  entries["never"] = MakeEntry(1, "a/never.jpg", CDateTime());
+  entries["today"] = MakeEntry(2, "b/today.jpg", now);
+  entries["old"] = MakeEntry(3, "c/old.jpg", now - CDateTimeSpan(2, 0, 0, 0));
+
+  CTextureIndex index;
+  EXPECT_FALSE(index.IsLoaded());
+  index.Load(entries);
+  EXPECT_TRUE(index.IsLoaded());
+  EXPECT_EQ(3U, index.Size());
+
+  CTextureDetails details;
+  ASSERT_TRUE(index.Get("never", details));
+  EXPECT_EQ(1, details.id);
+  EXPECT_EQ("a/never.jpg", details.file);
+  EXPECT_EQ(320U, details.width);
+  EXPECT_TRUE(details.hash.empty());
+
+  details = CTextureDetails();
+  ASSERT_TRUE(index.Get("today", details));
+  EXPECT_TRUE(details.hash.empty());
+
+  details = CTextureDetails();
+  ASSERT_TRUE(index.Get("old", details));
+  EXPECT_EQ("hash", details.hash);
+
+  // invalidated images are checked again
+  index.SetHashCheck("today", now - CDateTimeSpan(2, 0, 0, 0));
+  details = CTextureDetails();
+  ASSERT_TRUE(index.Get("today", details));
+  EXPECT_EQ("hash", details.hash);
+
+  EXPECT_FALSE(index.Get("missing", details));
+}
+
+TEST(TestTextureIndex, AddRemove)
+{
+  CTextureIndex index;
+  index.Add("one", MakeDetails(1, "a/one.jpg"));
+  index.Add("two", MakeDetails(2, "b/two.jpg"));
+  index.Add("one", MakeDetails(3, "c/one.jpg"));
+  EXPECT_EQ(2U, index.Size());
+
+  CTextureDetails details;
+  ASSERT_TRUE(index.Get("one", details));
+  EXPECT_EQ(3, details.id);
+  EXPECT_EQ("c/one.jpg", details.file);
+  EXPECT_EQ(640U, details.width);
+
+  index.Remove(2);
+  EXPECT_FALSE(index.Get("two", details));
+  index.Remove("one");
+  EXPECT_FALSE(index.Get("one", details));
+  EXPECT_EQ(0U, index.Size());
+}
+
+TEST(TestTextureIndex, ChangesWhileLoading)
+{
+  CDateTime now = CDateTime::GetCurrentDateTime();
+  CTextureIndex index;
+
+  // made while the database is being read
+  index.Add("added", MakeDetails(10, "a/added.jpg"));
+  index.Add("replaced", MakeDetails(11, "b/replaced.jpg"));
+  index.Remove("removed");
+  index.Remove(3);
+  index.SetHashCheck("checked", now - CDateTimeSpan(2, 0, 0, 0));
+
+  // the rows as read, from before the changes
+  CTextureIndex::Entries entries;
+  entries["replaced"] = MakeEntry(1, "c/replaced.jpg", CDateTime());
+  entries["removed"] = MakeEntry(2, "d/removed.jpg", CDateTime());
+  entries["removedbyid"] = MakeEntry(3, "e/removedbyid.jpg", CDateTime());
+  entries["checked"] = MakeEntry(4, "f/checked.jpg", now);
+  entries["unchanged"] = MakeEntry(5, "g/unchanged.jpg", CDateTime());
+  index.Load(entries);
+
+  EXPECT_EQ(4U, index.Size());
+  CTextureDetails details;
+  ASSERT_TRUE(index.Get("added", details));
+  EXPECT_EQ(10, details.id);
+  ASSERT_TRUE(index.Get("replaced", details));
+  EXPECT_EQ(11, details.id);
+  EXPECT_EQ("b/replaced.jpg", details.file);
+  EXPECT_FALSE(index.Get("removed", details));
+  EXPECT_FALSE(index.Get("removedbyid", details));
+
+  details = CTextureDetails();
+  ASSERT_TRUE(index.Get("checked", details));
+  EXPECT_EQ(4, details.id);
+  EXPECT_EQ("hash", details.hash);
+  ASSERT_TRUE(index.Get("unchanged", details));
+
+  index.Clear();
+  EXPECT_FALSE(index.IsLoaded());
+  EXPECT_EQ(0U, index.Size());
+}
@@ -34,6 +34,12 @@ namespace XbmcThreads
   public:
     inline ThreadLocal() : key(0) { pthread_key_create(&key,NULL); }
 
+    /**
+     * The destructor is called with the value of a thread when it exits,
+     * unless the value is NULL.
+     */
+    inline explicit ThreadLocal(void (*destructor)(void*)) : key(0) { pthread_key_create(&key,destructor); }
+
     inline ~ThreadLocal() { pthread_key_delete(key); }
 
     inline void set(T* val) { pthread_setspecific(key,(void*)val); }
@@ -31,27 +31,78 @@ namespace XbmcThreads
    */
   template <typename T> class ThreadLocal
   {
+    // with a destructor the value is kept in fiber local storage, which calls
+    // back when a thread exits, along with the destructor to call
+    struct Slot
+    {
+      T* value;
+      void (*destructor)(void*);
+    };
+
     DWORD key;
+    void (*destructor)(void*);
+
+    static VOID WINAPI ReleaseSlot(PVOID data)
+    {
+      Slot* slot = (Slot*)data;
+      if (slot && slot->value)
+        slot->destructor(slot->value);
+      delete slot;
+    }
+
   public:
-    inline ThreadLocal()
+    inline ThreadLocal() : destructor(NULL)
     {
        if ((key = TlsAlloc()) == TLS_OUT_OF_INDEXES)
           throw XbmcCommons::UncheckedException("Ran out of Windows TLS Indexes. Windows Error Code %d",(int)GetLastError());
     }
 
+    /**
+     * The destructor is called with the value of a thread when it exits,
+     * unless the value is NULL.
+     */
+    inline explicit ThreadLocal(void (*destructor_)(void*)) : destructor(destructor_)
+    {
+       if ((key = FlsAlloc(ReleaseSlot)) == FLS_OUT_OF_INDEXES)
+          throw XbmcCommons::UncheckedException("Ran out of Windows FLS Indexes. Windows Error Code %d",(int)GetLastError());
+    }
+
     inline ~ThreadLocal() 
     {
-       if (!TlsFree(key))
+       if (!(destructor ? FlsFree(key) : TlsFree(key)))
           throw XbmcCommons::UncheckedException("Failed to free Tls %d, Windows Error Code %d",(int)key, (int)GetLastError());
     }
 
     inline void set(T* val)
     {
-       if (!TlsSetValue(key,(LPVOID)val))
-          throw XbmcCommons::UncheckedException("Failed to set Tls %d, Windows Error Code %d",(int)key, (int)GetLastError());
+       if (!destructor)
+       {
+          if (!TlsSetValue(key,(LPVOID)val))
+             throw XbmcCommons::UncheckedException("Failed to set Tls %d, Windows Error Code %d",(int)key, (int)GetLastError());
+          return;
+       }
+
+       Slot* slot = (Slot*)FlsGetValue(key);
+       if (!slot)
+       {
+          slot = new Slot;
+          slot->destructor = destructor;
+          if (!FlsSetValue(key,(PVOID)slot))
+          {
+             delete slot;
+             throw XbmcCommons::UncheckedException("Failed to set Fls %d, Windows Error Code %d",(int)key, (int)GetLastError());
+          }
+       }
+       slot->value = val;
     }
 
-    inline T* get() { return (T*)TlsGetValue(key); }
+    inline T* get()
+    {
+       if (!destructor)
+          return (T*)TlsGetValue(key);
+       Slot* slot = (Slot*)FlsGetValue(key);
+       return slot ? slot->value : NULL;
+    }
   };
 }
 
@@ -67,6 +67,19 @@ public:
   }
 };
 
+void deleteThinggy(void* thinggy)
+{
+  delete (Thinggy*)thinggy;
+}
+
+ThreadLocal<Thinggy> destroyingThreadLocal(deleteThinggy);
+
+class DestroyingRunnable : public IRunnable
+{
+public:
+  inline void Run() { destroyingThreadLocal.set(new Thinggy); }
+};
+
 class GlobalThreadLocal : public Runnable
 {
 public:
@@ -143,6 +156,21 @@ TEST(TestThreadLocal, Heap)
   cleanup();
 }
 
+TEST(TestThreadLocal, DestructorOnExit)
+{
+  DestroyingRunnable runnable;
+  {
+    thread t(runnable);
+    t.join();
+  }
+
+  // the destructor runs after the thread signalled its exit
+  for (int i = 0; i < 1000 && !destructorCalled; i++)
+    SleepMillis(1);
+  EXPECT_TRUE(destructorCalled);
+  destructorCalled = false;
+}
+
 TEST(TestThreadLocal, HeapDestroyed)
 {
   {
@@ -23,7 +23,10 @@
 #include <functional>
 #include <stdexcept>
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/CPUInfo.h"
 #include "utils/log.h"
+#include "utils/Trace.h"
 
 #include "system.h"
 
@@ -36,9 +39,15 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+// time (ms) a low priority job waits before it is moved to normal priority
+#define JOB_PROMOTION_TIME  5000
+// time (ms) an idle worker waits for new jobs before it exits
+#define WORKER_IDLE_TIMEOUT 30000
+
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int slot) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_slot = slot;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -65,13 +74,15 @@ void CJobWorker::Process()
     bool success = false;
     try
     {
+      // job types are string literals, so can be kept with the event
+      TRACE_SCOPE_ARG("jobs", "Job", job->GetType());
       success = job->DoWork();
     }
     catch (...)
     {
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
     }
-    m_jobManager->OnJobComplete(success, job);
+    m_jobManager->OnJobComplete(this, success, job);
   }
 }
 
@@ -146,7 +157,7 @@ void CJobQueue::QueueNextJob()
   if (m_jobQueue.size() && m_processing.size() < m_jobsAtOnce)
   {
     CJobPointer &job = m_jobQueue.back();
-    job.m_id = CJobManager::GetInstance().AddJob(job.m_job, this, m_priority);
+    job.m_id = CJobManager::GetInstance().AddJob(job.m_job, this, m_priority, this);
     m_processing.push_back(job);
     m_jobQueue.pop_back();
   }
@@ -181,13 +192,23 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
+  m_nextSlot = 0;
+  m_queuedJobs = 0;
+  m_maxQueued = 0;
+  m_activeJobs = 0;
+  m_idleWorkers = 0;
+  m_lastPromotion = XbmcThreads::SystemClockMillis();
   m_running = true;
   m_pauseJobs = false;
+
+  // one slot per worker thread we may run at once
+  m_numSlots = GetMaxWorkers(CJob::PRIORITY_HIGH);
+  m_slots = new CWorkerSlot[m_numSlots];
 }
 
 void CJobManager::Restart()
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_workerSection);
 
   if (m_running)
     throw std::logic_error("CJobManager already running");
@@ -196,140 +217,282 @@ void CJobManager::Restart()
 
 void CJobManager::CancelJobs()
 {
-  CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  for (unsigned int i = 0; i < m_numSlots; ++i)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
-  }
+    CWorkerSlot &slot = m_slots[i];
+    CSingleLock lock(slot.m_section);
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+    // clear any pending jobs
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      for (JobQueue::iterator it = slot.m_jobQueue[priority].begin(); it != slot.m_jobQueue[priority].end(); ++it)
+      {
+        JobTypeStats &stats = slot.m_stats[it->m_job->GetType()];
+        stats.queued--;
+        stats.cancelled++;
+        it->FreeJob();
+      }
+      m_queuedJobs -= slot.m_jobQueue[priority].size();
+      slot.m_jobQueue[priority].clear();
+      slot.m_queued[priority] = 0;
+    }
+
+    // cancel any callbacks on jobs still processing
+    for_each(slot.m_processing.begin(), slot.m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+  }
 
   // tell our workers to finish
-  while (m_workers.size())
+  while (HasWorkers())
   {
-    lock.Leave();
     m_jobEvent.Set();
     Sleep(0); // yield after setting the event to give the workers some time to die
-    lock.Enter();
   }
+
+  LogJobStats();
 }
 
 CJobManager::~CJobManager()
 {
+  delete[] m_slots;
 }
 
-unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
+unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority, const void *affinity)
 {
-  CSingleLock lock(m_section);
-
-  if (!m_running)
-    return 0;
-
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = ++m_jobCounter;
+  if (id == 0)
+    id = ++m_jobCounter;
+
+  // jobs sharing an affinity key always go to the same slot, so they keep their order.
+  // everything else is spread over the slots round robin
+  unsigned int slotIndex;
+  if (affinity)
+    slotIndex = GetAffinitySlot(affinity);
+  else
+    slotIndex = m_nextSlot++ % m_numSlots;
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem work(job, id, priority, callback);
+  work.m_queuedAt = work.m_enqueuedAt = XbmcThreads::SystemClockMillis();
+
+  {
+    CWorkerSlot &slot = m_slots[slotIndex];
+    CSingleLock lock(slot.m_section);
+
+    // checked under the slot lock, so CancelJobs() either sees this job or we see it cancelling
+    if (!m_running)
+      return 0;
 
-  StartWorkers(priority);
-  return work.m_id;
+    slot.m_jobQueue[priority].push_back(work);
+    slot.m_queued[priority]++;
+
+    JobTypeStats &stats = slot.m_stats[job->GetType()];
+    stats.added++;
+    stats.queued++;
+  }
+
+  unsigned int queued = ++m_queuedJobs;
+  unsigned int maxQueued = m_maxQueued;
+  while (queued > maxQueued && !m_maxQueued.compare_exchange_weak(maxQueued, queued))
+    ;
+
+  StartWorkers(slotIndex, priority);
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
-
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  for (unsigned int i = 0; i < m_numSlots; ++i)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
+    CWorkerSlot &slot = m_slots[i];
+    CSingleLock lock(slot.m_section);
+
+    // check whether we have this job in the queue
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      JobQueue::iterator it = find(slot.m_jobQueue[priority].begin(), slot.m_jobQueue[priority].end(), jobID);
+      if (it != slot.m_jobQueue[priority].end())
+      {
+        JobTypeStats &stats = slot.m_stats[it->m_job->GetType()];
+        stats.queued--;
+        stats.cancelled++;
+
+        delete it->m_job;
+        slot.m_jobQueue[priority].erase(it);
+        slot.m_queued[priority]--;
+        m_queuedJobs--;
+        return;
+      }
+    }
+    // or if we're processing it
+    Processing::iterator it = find(slot.m_processing.begin(), slot.m_processing.end(), jobID);
+    if (it != slot.m_processing.end())
     {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
+      it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
       return;
     }
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
 }
 
-void CJobManager::StartWorkers(CJob::PRIORITY priority)
+void CJobManager::StartWorkers(unsigned int slot, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if (m_activeJobs >= GetMaxWorkers(priority))
     return;
 
   // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  if (m_idleWorkers > 0)
   {
     m_jobEvent.Set();
     return;
   }
 
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  // everyone is busy - we need more workers.  Prefer the slot the job was queued on.
+  CSingleLock lock(m_workerSection);
+  if (!m_running)
+    return;
+  for (unsigned int i = 0; i < m_numSlots; ++i)
+  {
+    CWorkerSlot &free = m_slots[(slot + i) % m_numSlots];
+    if (!free.m_worker)
+    {
+      free.m_worker = new CJobWorker(this, (slot + i) % m_numSlots);
+      return;
+    }
+  }
 }
 
-CJob *CJobManager::PopJob()
+bool CJobManager::ReserveWorker(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
+  unsigned int active = m_activeJobs;
+  do
+  {
+    if (active >= GetMaxWorkers(priority))
+      return false;
+  } while (!m_activeJobs.compare_exchange_weak(active, active + 1));
+  return true;
+}
+
+void CJobManager::PromoteJobs()
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  unsigned int last = m_lastPromotion;
+  if (now - last < JOB_PROMOTION_TIME / 2 || !m_lastPromotion.compare_exchange_strong(last, now))
+    return;
+
+  for (unsigned int i = 0; i < m_numSlots; ++i)
+  {
+    CWorkerSlot &slot = m_slots[i];
+    CSingleLock lock(slot.m_section);
+
+    // oldest jobs are at the front, and are appended to the normal queue in that order, so
+    // jobs of an affinity group keep their order. Pausable jobs are left alone, and jobs
+    // never age into the headroom kept for high priority ones.
+    JobQueue &queue = slot.m_jobQueue[CJob::PRIORITY_LOW];
+    while (!queue.empty() && now - queue.front().m_enqueuedAt >= JOB_PROMOTION_TIME)
+    {
+      CWorkItem job = queue.front();
+      queue.pop_front();
+      slot.m_queued[CJob::PRIORITY_LOW]--;
+
+      job.m_enqueuedAt = now;
+      slot.m_jobQueue[CJob::PRIORITY_NORMAL].push_back(job);
+      slot.m_queued[CJob::PRIORITY_NORMAL]++;
+    }
+  }
+}
+
+CJob *CJobManager::PopJob(unsigned int slotIndex)
+{
+  PromoteJobs();
+
+  CWorkerSlot &own = m_slots[slotIndex];
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    bool queued = false;
+    for (unsigned int i = 0; i < m_numSlots && !queued; ++i)
+      queued = m_slots[i].m_queued[priority] > 0;
+    if (!queued)
+      continue;
+
+    // lower priorities have lower limits, so if this one is full we're done
+    if (!ReserveWorker(CJob::PRIORITY(priority)))
+      return NULL;
+
+    // our own slot first, then steal from the others
+    for (unsigned int i = 0; i < m_numSlots; ++i)
     {
+      unsigned int fromIndex = (slotIndex + i) % m_numSlots;
+      CWorkerSlot &from = m_slots[fromIndex];
+      if (from.m_queued[priority] == 0)
+        continue;
+
+      // both queues are locked so the job is always visible to CancelJob().
+      // lock in index order to avoid deadlocking against another thief
+      CSingleLock lock1(m_slots[std::min(slotIndex, fromIndex)].m_section);
+      CSingleLock lock2(m_slots[std::max(slotIndex, fromIndex)].m_section);
+      if (from.m_jobQueue[priority].empty())
+        continue;
+
       // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
+      CWorkItem job = from.m_jobQueue[priority].front();
+      from.m_jobQueue[priority].pop_front();
+      from.m_queued[priority]--;
+      m_queuedJobs--;
+
+      job.m_startedAt = XbmcThreads::SystemClockMillis();
+      unsigned int waited = job.m_startedAt - job.m_queuedAt;
+      from.m_stats[job.m_job->GetType()].queued--;
+      JobTypeStats &stats = own.m_stats[job.m_job->GetType()];
+      stats.totalWaitMs += waited;
+      stats.maxWaitMs = std::max(stats.maxWaitMs, (uint64_t)waited);
 
       // add to the processing vector
-      m_processing.push_back(job);
+      own.m_processing.push_back(job);
       job.m_job->m_callback = this;
       return job.m_job;
     }
+
+    // someone else got there first
+    m_activeJobs--;
   }
   return NULL;
 }
 
 void CJobManager::PauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = true;
 }
 
 void CJobManager::UnPauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = false;
+
+  // workers may have retired while the pausable jobs were held back
+  if (m_queuedJobs > 0)
+    StartWorkers(0, CJob::PRIORITY_LOW_PAUSABLE);
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int i = 0; i < m_numSlots; ++i)
   {
-    if (priority == it->m_priority)
-      return true;
+    const CWorkerSlot &slot = m_slots[i];
+    CSingleLock lock(slot.m_section);
+    for(Processing::const_iterator it = slot.m_processing.begin(); it < slot.m_processing.end(); ++it)
+    {
+      if (priority == it->m_priority)
+        return true;
+    }
   }
   return false;
 }
@@ -337,40 +500,58 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int i = 0; i < m_numSlots; ++i)
   {
-    if (type == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    const CWorkerSlot &slot = m_slots[i];
+    CSingleLock lock(slot.m_section);
+    for(Processing::const_iterator it = slot.m_processing.begin(); it < slot.m_processing.end(); ++it)
+    {
+      if (type == std::string(it->m_job->GetType()))
+        jobsMatched++;
+    }
   }
   return jobsMatched;
 }
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
+  unsigned int slot = worker->GetSlot();
   while (m_running)
   {
     // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    CJob *job = PopJob(slot);
     if (job)
       return job;
+
+    // announce we're idle before checking again, so that AddJob() either sees us
+    // waiting and wakes us, or queued the job before our second look
+    m_idleWorkers++;
+    job = PopJob(slot);
+    if (job)
+    {
+      m_idleWorkers--;
+      return job;
+    }
+
     // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
+    bool newJob = m_jobEvent.WaitMSec(WORKER_IDLE_TIMEOUT);
+    m_idleWorkers--;
     if (!newJob)
       break;
   }
   // ensure no jobs have come in during the period after
   // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
+  CSingleLock lock(m_workerSection);
+  if (m_running)
+  {
+    CJob *job = PopJob(slot);
+    if (job)
+      return job;
+  }
   // have no jobs
   RemoveWorker(worker);
   return NULL;
@@ -378,28 +559,34 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  for (unsigned int i = 0; i < m_numSlots; ++i)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    const CWorkerSlot &slot = m_slots[i];
+    CSingleLock lock(slot.m_section);
+    // find the job in the processing queue, and check whether it's cancelled (no callback)
+    Processing::const_iterator it = find(slot.m_processing.begin(), slot.m_processing.end(), job);
+    if (it != slot.m_processing.end())
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      CWorkItem item(*it);
+      lock.Leave(); // leave section prior to call
+      if (item.m_callback)
+      {
+        item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+        return false;
+      }
+      return true;
     }
   }
   return true; // couldn't find the job, or it's been cancelled
 }
 
-void CJobManager::OnJobComplete(bool success, CJob *job)
+void CJobManager::OnJobComplete(const CJobWorker *worker, bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
+  CWorkerSlot &slot = m_slots[worker->GetSlot()];
+  CSingleLock lock(slot.m_section);
   // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  Processing::iterator i = find(slot.m_processing.begin(), slot.m_processing.end(), job);
+  if (i != slot.m_processing.end())
   {
     // tell any listeners we're done with the job, then delete it
     CWorkItem item(*i);
@@ -414,25 +601,89 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
     }
     lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
+    Processing::iterator j = find(slot.m_processing.begin(), slot.m_processing.end(), job);
+    if (j != slot.m_processing.end())
+      slot.m_processing.erase(j);
+
+    unsigned int ran = XbmcThreads::SystemClockMillis() - item.m_startedAt;
+    JobTypeStats &stats = slot.m_stats[item.m_job->GetType()];
+    stats.completed++;
+    stats.totalRunMs += ran;
+    stats.maxRunMs = std::max(stats.maxRunMs, (uint64_t)ran);
     lock.Leave();
     item.FreeJob();
   }
+
+  // free the worker, and hand any jobs that were held back by the limits to a sleeping one
+  m_activeJobs--;
+  if (m_queuedJobs > 0 && m_idleWorkers > 0)
+    m_jobEvent.Set();
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_workerSection);
   // remove our worker
-  Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
-  if (i != m_workers.end())
-    m_workers.erase(i); // workers auto-delete
+  CWorkerSlot &slot = m_slots[worker->GetSlot()];
+  if (slot.m_worker == worker)
+    slot.m_worker = NULL; // workers auto-delete
+}
+
+bool CJobManager::HasWorkers() const
+{
+  CSingleLock lock(m_workerSection);
+  for (unsigned int i = 0; i < m_numSlots; ++i)
+  {
+    if (m_slots[i].m_worker)
+      return true;
+  }
+  return false;
 }
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
 {
-  static const unsigned int max_workers = 5;
+  // jobs are a mix of cpu bound (image decoding) and io bound (scanning, network) work,
+  // so allow a few more workers than there are cores, but never fewer than one per priority
+  static const unsigned int max_workers = std::min(std::max(g_cpuInfo.getCPUCount(), 1) + 3, 16);
   return max_workers - (CJob::PRIORITY_HIGH - priority);
 }
+
+unsigned int CJobManager::GetJobStats(JobStats &stats) const
+{
+  stats.clear();
+  for (unsigned int i = 0; i < m_numSlots; ++i)
+  {
+    const CWorkerSlot &slot = m_slots[i];
+    CSingleLock lock(slot.m_section);
+    for (JobStats::const_iterator it = slot.m_stats.begin(); it != slot.m_stats.end(); ++it)
+    {
+      JobTypeStats &total = stats[it->first];
+      total.queued      += it->second.queued;
+      total.added       += it->second.added;
+      total.completed   += it->second.completed;
+      total.cancelled   += it->second.cancelled;
+      total.totalWaitMs += it->second.totalWaitMs;
+      total.maxWaitMs    = std::max(total.maxWaitMs, it->second.maxWaitMs);
+      total.totalRunMs  += it->second.totalRunMs;
+      total.maxRunMs     = std::max(total.maxRunMs, it->second.maxRunMs);
+    }
+  }
+  return m_maxQueued;
+}
+
+void CJobManager::LogJobStats() const
+{
+  JobStats stats;
+  unsigned int maxQueued = GetJobStats(stats);
+  CLog::Log(LOGDEBUG, "CJobManager - %u worker slots, at most %u jobs queued", m_numSlots, maxQueued);
+  for (JobStats::const_iterator it = stats.begin(); it != stats.end(); ++it)
+  {
+    const JobTypeStats &s = it->second;
+    uint64_t started = s.added - s.cancelled - s.queued;
+    CLog::Log(LOGDEBUG, "CJobManager - %s: added %" PRIu64 ", completed %" PRIu64 ", cancelled %" PRIu64 ", queued %" PRId64 ", "
+                        "wait avg %.1f max %" PRIu64 " ms, run avg %.1f max %" PRIu64 " ms",
+              it->first.empty() ? "(untyped)" : it->first.c_str(), s.added, s.completed, s.cancelled, s.queued,
+              started ? (double)s.totalWaitMs / started : 0.0, s.maxWaitMs,
+              s.completed ? (double)s.totalRunMs / s.completed : 0.0, s.maxRunMs);
+  }
+}
@@ -19,9 +19,12 @@
  *
  */
 
+#include <atomic>
+#include <map>
 #include <queue>
 #include <vector>
 #include <string>
+#include <stdint.h>
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
@@ -31,12 +34,14 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, unsigned int slot);
   virtual ~CJobWorker();
 
   void Process();
+  unsigned int GetSlot() const { return m_slot; };
 private:
   CJobManager  *m_jobManager;
+  unsigned int  m_slot;
 };
 
 /*!
@@ -170,6 +175,22 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Jobs are queued on a fixed set of worker slots, each with its own lock and its own
+ per-priority queues, so adding and picking up jobs does not serialise on a single
+ lock.  Each slot is served by at most one CJobWorker thread, which takes work from
+ its own slot first and steals from the other slots when that is empty.  Threads are
+ started on demand and retire when idle; the queues stay with the slot, so jobs are
+ never lost when a thread retires.  The number of slots scales with the CPU core count.
+
+ Jobs sharing an affinity key are always queued on the same slot and every slot is
+ drained in order, so they are started in the order they were added.  CJobQueue uses
+ this to keep its ordering when it runs several jobs at once.
+
+ Queued PRIORITY_LOW jobs that have waited for a while are promoted to PRIORITY_NORMAL so
+ a steady stream of higher priority work can not starve them.  They are not promoted any
+ further, so the workers kept for PRIORITY_HIGH jobs stay free for them, and
+ PRIORITY_LOW_PAUSABLE jobs are never promoted, as that would defeat PauseJobs().
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -183,6 +204,9 @@ class CJobManager
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_queuedAt = 0;
+      m_enqueuedAt = 0;
+      m_startedAt = 0;
     }
     bool operator==(unsigned int jobID) const
     {
@@ -204,10 +228,32 @@ class CJobManager
     CJob         *m_job;
     unsigned int  m_id;
     IJobCallback *m_callback;
-    CJob::PRIORITY m_priority;
+    CJob::PRIORITY m_priority;  //!< priority as requested by the caller
+    unsigned int  m_queuedAt;   //!< time (ms) the job was added
+    unsigned int  m_enqueuedAt; //!< time (ms) the job entered its current queue
+    unsigned int  m_startedAt;  //!< time (ms) processing started
   };
 
 public:
+  /*!
+   \brief Latency and queue depth figures for one type of job (as given by CJob::GetType()).
+   \sa GetJobStats()
+   */
+  struct JobTypeStats
+  {
+    JobTypeStats() : queued(0), added(0), completed(0), cancelled(0),
+                     totalWaitMs(0), maxWaitMs(0), totalRunMs(0), maxRunMs(0) {}
+    int64_t  queued;      //!< jobs currently waiting in a queue
+    uint64_t added;       //!< jobs added
+    uint64_t completed;   //!< jobs that finished processing
+    uint64_t cancelled;   //!< jobs removed from a queue before they started
+    uint64_t totalWaitMs; //!< time spent queued by jobs that have started
+    uint64_t maxWaitMs;
+    uint64_t totalRunMs;  //!< time spent in DoWork() and OnJobComplete()
+    uint64_t maxRunMs;
+  };
+  typedef std::map<std::string, JobTypeStats> JobStats;
+
   /*!
    \brief The only way through which the global instance of the CJobManager should be accessed.
    \return the global instance.
@@ -219,10 +265,17 @@ public:
    \param job a pointer to the job to add. The job should be subclassed from CJob
    \param callback a pointer to an IJobCallback instance to receive job progress and completion notices.
    \param priority the priority that this job should run at.
+   \param affinity optional key grouping jobs that must be started in the order they are added.
    \return a unique identifier for this job, to be used with other interaction
    \sa CJob, IJobCallback, CancelJob()
    */
-  unsigned int AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority = CJob::PRIORITY_LOW);
+  unsigned int AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority = CJob::PRIORITY_LOW, const void *affinity = NULL);
+
+  /*!
+   \brief Get the worker slot that jobs added with the given affinity key are queued on.
+   \sa AddJob(), CJobWorker::GetSlot()
+   */
+  unsigned int GetAffinitySlot(const void *affinity) const { return (unsigned int)(((uintptr_t)affinity >> 4) % m_numSlots); }
 
   /*!
    \brief Cancel a job with the given id.
@@ -274,6 +327,18 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Retrieve per job type latency and queue depth figures collected since startup.
+   \param stats map of job type to its figures, filled on return.
+   \return the largest number of jobs that have been queued at once.
+   */
+  unsigned int GetJobStats(JobStats &stats) const;
+
+  /*!
+   \brief Write the figures from GetJobStats() to the debug log.
+   */
+  void LogJobStats() const;
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -288,11 +353,12 @@ protected:
   /*!
    \brief Callback from CJobWorker after a job has completed.
    Calls IJobCallback::OnJobComplete(), and then destroys job.
-   \param job a pointer to the calling subclassed CJob instance.
+   \param worker a pointer to the CJobWorker instance that processed the job.
    \param success the result from the DoWork call
+   \param job a pointer to the calling subclassed CJob instance.
    \sa IJobCallback, CJob
    */
-  void  OnJobComplete(bool success, CJob *job);
+  void  OnJobComplete(const CJobWorker *worker, bool success, CJob *job);
 
   /*!
    \brief Callback from CJob to report progress and check for cancellation.
@@ -312,27 +378,58 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  typedef std::deque<CWorkItem>    JobQueue;
+  typedef std::vector<CWorkItem>   Processing;
+
+  /*!
+   \brief Queues and bookkeeping of a single worker thread.
+   Everything but m_worker is guarded by m_section, m_worker is guarded by
+   CJobManager::m_workerSection.
+   */
+  class CWorkerSlot
+  {
+  public:
+    CWorkerSlot() : m_worker(NULL)
+    {
+      for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+        m_queued[priority] = 0;
+    }
+    mutable CCriticalSection m_section;
+    JobQueue            m_jobQueue[CJob::PRIORITY_HIGH+1];
+    std::atomic<int>    m_queued[CJob::PRIORITY_HIGH+1]; //!< sizes of m_jobQueue, readable without the lock
+    Processing          m_processing;
+    JobStats            m_stats;
+    CJobWorker         *m_worker;
+  };
+
+  /*! \brief Pop a job off the job queues and add it to the processing queue of the worker's slot
+   Checks the worker's own slot first, then steals from the other slots.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(unsigned int slot);
 
-  void StartWorkers(CJob::PRIORITY priority);
+  /*! \brief Move low priority jobs that have waited for too long to the normal priority queue */
+  void PromoteJobs();
+
+  void StartWorkers(unsigned int slot, CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
+  bool HasWorkers() const;
+  bool ReserveWorker(CJob::PRIORITY priority);
   static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
 
-  unsigned int m_jobCounter;
+  std::atomic<unsigned int> m_jobCounter;
+  std::atomic<unsigned int> m_nextSlot;    //!< round robin slot for jobs without affinity
+  std::atomic<unsigned int> m_queuedJobs;  //!< jobs waiting in any queue
+  std::atomic<unsigned int> m_maxQueued;
+  std::atomic<unsigned int> m_activeJobs;  //!< jobs currently processing
+  std::atomic<unsigned int> m_idleWorkers; //!< workers waiting on m_jobEvent
+  std::atomic<unsigned int> m_lastPromotion;
+  std::atomic<bool>         m_pauseJobs;
+  std::atomic<bool>         m_running;
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
-  typedef std::vector<CJobWorker*> Workers;
-
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  bool       m_pauseJobs;
-  Processing m_processing;
-  Workers    m_workers;
+  unsigned int     m_numSlots;
+  CWorkerSlot     *m_slots;
 
-  CCriticalSection m_section;
+  mutable CCriticalSection m_workerSection;
   CEvent           m_jobEvent;
-  bool             m_running;
 };
@@ -0,0 +1,169 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LatencyHistogram.h"
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+
+#define SUB_BUCKET_BITS 3 // log2(SUB_BUCKETS)
+
+const unsigned int CLatencyHistogram::SUB_BUCKETS;
+const unsigned int CLatencyHistogram::BUCKETS;
+
+CLatencyHistogram::CLatencyHistogram(uint64_t stallThreshold)
+  : m_stallThreshold(stallThreshold)
+{
+  Reset();
+}
+
+unsigned int CLatencyHistogram::GetBucket(uint64_t microseconds)
+{
+  if (microseconds < SUB_BUCKETS)
+    return (unsigned int)microseconds;
+
+  unsigned int msb = 0;
+  for (uint64_t v = microseconds; v > 1; v >>= 1)
+    msb++;
+
+  // the bits below the most significant one select the sub-bucket
+  unsigned int sub = (unsigned int)(microseconds >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+  return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t CLatencyHistogram::GetUpperBound(unsigned int bucket)
+{
+  if (bucket < SUB_BUCKETS)
+    return bucket;
+
+  unsigned int shift = bucket / SUB_BUCKETS - 1;
+  uint64_t lower = (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+  return lower + (((uint64_t)1 << shift) - 1);
+}
+
+void CLatencyHistogram::Record(uint64_t microseconds)
+{
+  m_buckets[GetBucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(microseconds, std::memory_order_relaxed);
+  if (m_stallThreshold && microseconds >= m_stallThreshold)
+    m_stalls.fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t max = m_max.load(std::memory_order_relaxed);
+  while (microseconds > max && !m_max.compare_exchange_weak(max, microseconds, std::memory_order_relaxed))
+    ;
+}
+
+void CLatencyHistogram::RecordSince(int64_t start)
+{
+  int64_t elapsed = CurrentHostCounter() - start;
+  if (elapsed < 0)
+    elapsed = 0;
+  Record((uint64_t)(elapsed * 1000000.0 / CurrentHostFrequency()));
+}
+
+void CLatencyHistogram::GetSummary(Summary &summary) const
+{
+  // counters are read one by one while others may record, the summary is close enough for monitoring
+  uint64_t counts[BUCKETS];
+  uint64_t count = 0;
+  for (unsigned int i = 0; i < BUCKETS; i++)
+  {
+    counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+    count += counts[i];
+  }
+
+  summary.count = count;
+  summary.stalls = m_stalls.load(std::memory_order_relaxed);
+  summary.threshold = m_stallThreshold;
+  summary.max = m_max.load(std::memory_order_relaxed);
+  summary.mean = count ? m_sum.load(std::memory_order_relaxed) / count : 0;
+  summary.buckets.clear();
+
+  const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+  uint64_t *percentiles[] = { &summary.p50, &summary.p90, &summary.p99, &summary.p999 };
+  const unsigned int n = sizeof(quantiles) / sizeof(quantiles[0]);
+  for (unsigned int q = 0; q < n; q++)
+    *percentiles[q] = 0;
+
+  uint64_t seen = 0;
+  unsigned int q = 0;
+  for (unsigned int i = 0; i < BUCKETS; i++)
+  {
+    if (!counts[i])
+      continue;
+
+    Bucket bucket = { GetUpperBound(i), counts[i] };
+    summary.buckets.push_back(bucket);
+
+    seen += counts[i];
+    for (; q < n && seen >= quantiles[q] * count; q++)
+      *percentiles[q] = std::min(bucket.upperBound, summary.max);
+  }
+}
+
+void CLatencyHistogram::Reset()
+{
+  for (unsigned int i = 0; i < BUCKETS; i++)
+    m_buckets[i].store(0, std::memory_order_relaxed);
+  m_sum.store(0, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+  m_stalls.store(0, std::memory_order_relaxed);
+}
+
+CLatencyHistograms &CLatencyHistograms::Get()
+{
+  // never destroyed, and neither are the histograms, threads may still record
+  // into them or exit while statics are destroyed
+  static CLatencyHistograms *histograms = new CLatencyHistograms;
+  return *histograms;
+}
+
+CLatencyHistogram &CLatencyHistograms::GetHistogram(const std::string &name, uint64_t stallThreshold)
+{
+  CSingleLock lock(m_section);
+  std::map<std::string, CLatencyHistogram*>::iterator i = m_histograms.find(name);
+  if (i == m_histograms.end())
+    i = m_histograms.insert(std::make_pair(name, new CLatencyHistogram(stallThreshold))).first;
+  return *i->second;
+}
+
+void CLatencyHistograms::GetSummaries(std::map<std::string, CLatencyHistogram::Summary> &summaries) const
+{
+  CSingleLock lock(m_section);
+  for (std::map<std::string, CLatencyHistogram*>::const_iterator i = m_histograms.begin(); i != m_histograms.end(); ++i)
+    i->second->GetSummary(summaries[i->first]);
+}
+
+bool CLatencyHistograms::Reset(const std::string &name /* = "" */)
+{
+  CSingleLock lock(m_section);
+  if (name.empty())
+  {
+    for (std::map<std::string, CLatencyHistogram*>::iterator i = m_histograms.begin(); i != m_histograms.end(); ++i)
+      i->second->Reset();
+    return true;
+  }
+
+  std::map<std::string, CLatencyHistogram*>::iterator i = m_histograms.find(name);
+  if (i == m_histograms.end())
+    return false;
+  i->second->Reset();
+  return true;
+}
@@ -0,0 +1,143 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "utils/TimeUtils.h"
+
+/*!
+ \brief Histogram of latencies in microseconds, e.g. frame times or waits
+
+ Buckets are logarithmic with 8 linear sub-buckets each, so any value is
+ recorded within 12.5% using a fixed, small amount of memory. Recording
+ only increments atomic counters, so any thread may record without locking
+ and the histogram is always on.
+ */
+class CLatencyHistogram
+{
+public:
+  struct Bucket
+  {
+    uint64_t upperBound; ///< largest value in the bucket, in microseconds
+    uint64_t count;
+  };
+
+  struct Summary
+  {
+    uint64_t count;
+    uint64_t stalls;    ///< values of at least the stall threshold
+    uint64_t threshold; ///< stall threshold, in microseconds
+    uint64_t mean;
+    uint64_t max;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    std::vector<Bucket> buckets; ///< non empty buckets, in order
+  };
+
+  /*!
+   \param stallThreshold latency in microseconds from which a value counts as a stall
+   */
+  explicit CLatencyHistogram(uint64_t stallThreshold);
+
+  void Record(uint64_t microseconds);
+
+  /*!
+   \brief Record the time since the given CurrentHostCounter() value
+   */
+  void RecordSince(int64_t start);
+
+  void GetSummary(Summary &summary) const;
+  void Reset();
+
+  static unsigned int GetBucket(uint64_t microseconds);
+  static uint64_t GetUpperBound(unsigned int bucket);
+
+  static const unsigned int SUB_BUCKETS = 8;
+  static const unsigned int BUCKETS = 62 * SUB_BUCKETS;
+
+private:
+  CLatencyHistogram(const CLatencyHistogram&);
+  CLatencyHistogram &operator=(const CLatencyHistogram&);
+
+  std::atomic<uint32_t> m_buckets[BUCKETS];
+  std::atomic<uint64_t> m_sum;
+  std::atomic<uint64_t> m_max;
+  std::atomic<uint64_t> m_stalls;
+  uint64_t m_stallThreshold;
+};
+
+/*!
+ \brief Records the lifetime of the object into a latency histogram
+ */
+class CLatencyTimer
+{
+public:
+  explicit CLatencyTimer(CLatencyHistogram &histogram) : m_histogram(histogram), m_start(CurrentHostCounter()) {}
+  ~CLatencyTimer() { m_histogram.RecordSince(m_start); }
+
+private:
+  CLatencyTimer(const CLatencyTimer&);
+  CLatencyTimer &operator=(const CLatencyTimer&);
+
+  CLatencyHistogram &m_histogram;
+  int64_t m_start;
+};
+
+/*!
+ \brief The named latency histograms of the application, for monitoring
+ \sa CLatencyHistogram
+ */
+class CLatencyHistograms
+{
+public:
+  static CLatencyHistograms &Get();
+
+  /*!
+   \brief Get the histogram with the given name, added if it doesn't exist
+   Histograms live until exit, so the reference may be kept.
+   \param name name of the histogram, e.g. "gui.frame"
+   \param stallThreshold latency in microseconds from which a value counts as a stall
+   */
+  CLatencyHistogram &GetHistogram(const std::string &name, uint64_t stallThreshold);
+
+  void GetSummaries(std::map<std::string, CLatencyHistogram::Summary> &summaries) const;
+
+  /*!
+   \brief Reset the histogram with the given name, or all histograms if empty
+   \return false if there is no histogram with the name
+   */
+  bool Reset(const std::string &name = "");
+
+private:
+  CLatencyHistograms() {}
+  CLatencyHistograms(const CLatencyHistograms&);
+  CLatencyHistograms &operator=(const CLatencyHistograms&);
+
+  mutable CCriticalSection m_section;
+  std::map<std::string, CLatencyHistogram*> m_histograms;
+};
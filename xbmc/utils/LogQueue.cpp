@@ -0,0 +1,129 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LogQueue.h"
+
+/*
+ * A bounded multi producer queue on a ring of slots with sequence numbers.
+ * A producer claims a position with a compare and swap and publishes the
+ * record by advancing the sequence of its slot, so producers never wait for
+ * each other or for the writer.
+ */
+
+CLogQueue::CLogQueue(unsigned int capacity)
+  : m_popPos(0),
+    m_dropped(0),
+    m_writerWaiting(false),
+    m_queued(false)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+
+  m_mask = size - 1;
+  m_slots = new Slot[size];
+  for (size_t i = 0; i < size; i++)
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  m_pushPos.store(0, std::memory_order_relaxed);
+}
+
+CLogQueue::~CLogQueue()
+{
+  delete[] m_slots;
+}
+
+bool CLogQueue::Push(LogRecord &record)
+{
+  Slot *slot;
+  size_t pos = m_pushPos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    slot = &m_slots[pos & m_mask];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if (diff == 0)
+    {
+      if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // the writer hasn't taken the record pushed a full ring ago yet
+      m_dropped++;
+      return false;
+    }
+    else
+      pos = m_pushPos.load(std::memory_order_relaxed);
+  }
+
+  slot->record.level = record.level;
+  slot->record.threadId = record.threadId;
+  slot->record.hour = record.hour;
+  slot->record.minute = record.minute;
+  slot->record.second = record.second;
+  slot->record.line.swap(record.line);
+  slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+
+  // only pay for the event if the writer is asleep
+  if (m_writerWaiting.load(std::memory_order_seq_cst) && m_writerWaiting.exchange(false))
+    m_queued.Set();
+
+  return true;
+}
+
+bool CLogQueue::Pop(LogRecord &record)
+{
+  Slot &slot = m_slots[m_popPos & m_mask];
+  if (slot.sequence.load(std::memory_order_acquire) != m_popPos + 1)
+    return false;
+
+  record.level = slot.record.level;
+  record.threadId = slot.record.threadId;
+  record.hour = slot.record.hour;
+  record.minute = slot.record.minute;
+  record.second = slot.record.second;
+  record.line.swap(slot.record.line);
+  // don't keep the memory of long lines around in the ring
+  std::string().swap(slot.record.line);
+
+  slot.sequence.store(m_popPos + m_mask + 1, std::memory_order_release);
+  m_popPos++;
+  return true;
+}
+
+void CLogQueue::Wait(unsigned int milliSeconds)
+{
+  m_writerWaiting.store(true, std::memory_order_seq_cst);
+
+  // a record may have been pushed before the flag was visible
+  if (m_slots[m_popPos & m_mask].sequence.load(std::memory_order_seq_cst) == m_popPos + 1)
+  {
+    m_writerWaiting.store(false);
+    return;
+  }
+
+  m_queued.WaitMSec(milliSeconds);
+  m_writerWaiting.store(false);
+}
+
+void CLogQueue::Wake()
+{
+  m_queued.Set();
+}
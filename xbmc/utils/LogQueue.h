@@ -0,0 +1,107 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+#include "threads/Event.h"
+
+/*!
+ \brief A log line waiting to be written
+ */
+struct LogRecord
+{
+  int         level;
+  uint64_t    threadId;
+  int         hour;
+  int         minute;
+  int         second;
+  std::string line;
+};
+
+/*!
+ \brief Bounded queue of log records, written by any number of threads and
+ read by a single writer thread.
+
+ Push() never blocks or takes a lock, so logging doesn't stall the calling
+ thread on file I/O. When the queue is full the record is dropped and
+ counted instead, which also bounds the memory used by a flood of log lines.
+ */
+class CLogQueue
+{
+public:
+  /*!
+   \param capacity maximum number of queued records, rounded up to a power of two
+   */
+  explicit CLogQueue(unsigned int capacity);
+  ~CLogQueue();
+
+  /*!
+   \brief Queue a record, may be called by any thread
+   \param record the record to queue, its line is taken over on success
+   \return false if the queue is full and the record was dropped
+   */
+  bool Push(LogRecord &record);
+
+  /*!
+   \brief Take the oldest record, must only be called by the writer thread
+   \return false if the queue is empty
+   */
+  bool Pop(LogRecord &record);
+
+  /*!
+   \brief Wait until records are queued or the timeout expires, for the writer thread
+   */
+  void Wait(unsigned int milliSeconds);
+
+  /*!
+   \brief Wake up a waiting writer thread, e.g. to have it stop
+   */
+  void Wake();
+
+  /*!
+   \brief Number of records dropped since the queue was created
+   */
+  uint64_t GetDropped() const { return m_dropped; }
+
+  unsigned int GetCapacity() const { return m_mask + 1; }
+
+private:
+  CLogQueue(const CLogQueue&);
+  CLogQueue &operator=(const CLogQueue&);
+
+  struct Slot
+  {
+    // the slot is free for the push at position sequence, or holds the
+    // record pushed at position sequence - 1
+    std::atomic<size_t> sequence;
+    LogRecord record;
+  };
+
+  Slot *m_slots;
+  size_t m_mask;
+  std::atomic<size_t> m_pushPos;
+  size_t m_popPos;                        ///< only used by the writer thread
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<bool> m_writerWaiting;
+  CEvent m_queued;
+};
@@ -24,11 +24,14 @@
 #include "Util.h"
 #include "XBDateTime.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/Thread.h"
 #include "utils/CharsetConverter.h"
+#include "utils/CPUInfo.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
 #include <algorithm>
+#include <locale>
 
 using namespace std;
 
@@ -380,130 +383,235 @@ string ByDateTaken(SortAttribute attributes, const SortItem &values)
   return values.at(FieldDateTaken).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+namespace
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
-  {
-    result = false;
-    return true;
-  }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
+// below this many items sorting on a single thread is faster than starting threads
+const size_t PARALLEL_SORT_MIN_ITEMS = 4096;
+const unsigned int PARALLEL_SORT_MAX_THREADS = 4;
+
+/* The characters of a sort label are stored as their collation rank, so comparing
+   them doesn't need the locale anymore. Digits additionally keep their value for
+   the numeric comparison of StringUtils::AlphaNumericCompare(). */
+const uint32_t KEY_DIGIT_VALUE = 0x0f;
+const uint32_t KEY_DIGIT = 0x10;
+const unsigned int KEY_RANK_SHIFT = 5;
+
+typedef struct SortKey
+{
+  size_t index;       // of the item in the unsorted list
+  size_t label;       // start of the label in the key buffer
+  SortSpecial special;
+  int folder;         // -1 if unknown
+} SortKey;
+
+class CSortKeyCompare
+{
+public:
+  CSortKeyCompare(const std::vector<uint32_t> &keys, bool descending, bool handleFolder)
+    : m_keys(&keys[0]), m_descending(descending), m_handleFolder(handleFolder)
+  { }
+
+  bool operator()(const SortKey &left, const SortKey &right) const
   {
-    result = true;
-    return true;
+    // one has a special sort: left is sorted above right if
+    // it should be sorted on top or right should be sorted on bottom
+    if (left.special != right.special)
+      return left.special == SortSpecialOnTop || right.special == SortSpecialOnBottom;
+    // both have either sort on top or sort on bottom -> leave as-is
+    if (left.special != SortSpecialNone)
+      return false;
+
+    if (m_handleFolder && left.folder >= 0 && right.folder >= 0 && left.folder != right.folder)
+      return left.folder != 0;
+
+    int64_t result = Compare(m_keys + left.label, m_keys + right.label);
+    return m_descending ? result > 0 : result < 0;
   }
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-  
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
+private:
+  // same as StringUtils::AlphaNumericCompare(), on collation ranks
+  static int64_t Compare(const uint32_t *l, const uint32_t *r)
   {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
+    while (*l != 0 && *r != 0)
     {
-      result = true;
-      return true;
+      // check if we have a numerical value
+      if ((*l & KEY_DIGIT) && (*r & KEY_DIGIT))
+      {
+        const uint32_t *ld = l;
+        int64_t lnum = 0;
+        while ((*ld & KEY_DIGIT) && ld < l + 15)
+          lnum = lnum * 10 + (*ld++ & KEY_DIGIT_VALUE);
+        const uint32_t *rd = r;
+        int64_t rnum = 0;
+        while ((*rd & KEY_DIGIT) && rd < r + 15)
+          rnum = rnum * 10 + (*rd++ & KEY_DIGIT_VALUE);
+        if (lnum != rnum)
+          return lnum - rnum;
+        l = ld;
+        r = rd;
+        continue;
+      }
+
+      uint32_t lrank = *l >> KEY_RANK_SHIFT;
+      uint32_t rrank = *r >> KEY_RANK_SHIFT;
+      if (lrank != rrank)
+        return lrank < rrank ? -1 : 1;
+      l++; r++;
     }
-    
-    // otherwise right is sorted above left
-    result = false;
-    return true;
-  }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
-  {
-    result = false;
-    return true;
+    if (*r)
+      return -1;
+    else if (*l)
+      return 1;
+    return 0;
   }
 
-  if (handleFolder)
+  const uint32_t *m_keys;
+  bool m_descending;
+  bool m_handleFolder;
+};
+
+class CSortTask : public IRunnable
+{
+public:
+  explicit CSortTask(const std::function<void()> &task) : m_task(task) { }
+  virtual void Run() { m_task(); }
+private:
+  std::function<void()> m_task;
+};
+
+// runs the tasks concurrently, the first one on the calling thread
+void RunParallel(const std::vector<std::function<void()> > &tasks)
+{
+  std::vector<CSortTask*> runnables;
+  std::vector<CThread*> threads;
+  for (size_t i = 1; i < tasks.size(); i++)
   {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
-    {
-      result = itLeft->second.asBoolean();
-      return true;
-    }
+    runnables.push_back(new CSortTask(tasks[i]));
+    threads.push_back(new CThread(runnables.back(), "SortWorker"));
+    threads.back()->Create();
   }
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
+  if (!tasks.empty())
+    tasks[0]();
 
-  return false;
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i]->StopThread(true);
+    delete threads[i];
+    delete runnables[i];
+  }
 }
 
-bool SorterAscending(const SortItem &left, const SortItem &right)
+unsigned int GetSortThreads(size_t count)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
-
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
+  if (count < PARALLEL_SORT_MIN_ITEMS)
+    return 1;
+  return std::max(1, std::min(g_cpuInfo.getCPUCount(), (int)PARALLEL_SORT_MAX_THREADS));
 }
 
-bool SorterDescending(const SortItem &left, const SortItem &right)
+// splits [0, count) into one range per thread and runs func(begin, end) for all of them
+void ForEachRange(size_t count, unsigned int threads, const std::function<void(size_t, size_t)> &func)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
-
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
+  std::vector<std::function<void()> > tasks;
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    size_t begin = count * i / threads;
+    size_t end = count * (i + 1) / threads;
+    tasks.push_back([&func, begin, end]() { func(begin, end); });
+  }
+  RunParallel(tasks);
 }
 
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
+// stable sort of the ranges in parallel, followed by (parallel) rounds of stable merges
+void ParallelStableSort(std::vector<SortKey> &keys, const CSortKeyCompare &compare)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  unsigned int threads = GetSortThreads(keys.size());
+  if (threads < 2)
+  {
+    std::stable_sort(keys.begin(), keys.end(), compare);
+    return;
+  }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  std::vector<size_t> bounds;
+  for (unsigned int i = 0; i <= threads; i++)
+    bounds.push_back(keys.size() * i / threads);
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  ForEachRange(keys.size(), threads, [&keys, &compare](size_t begin, size_t end)
+  {
+    std::stable_sort(keys.begin() + begin, keys.begin() + end, compare);
+  });
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+  while (bounds.size() > 2)
+  {
+    std::vector<size_t> merged;
+    std::vector<std::function<void()> > merges;
+    for (size_t i = 0; i + 2 < bounds.size(); i += 2)
+    {
+      size_t begin = bounds[i], middle = bounds[i + 1], end = bounds[i + 2];
+      merges.push_back([&keys, &compare, begin, middle, end]()
+      {
+        std::inplace_merge(keys.begin() + begin, keys.begin() + middle, keys.begin() + end, compare);
+      });
+      merged.push_back(begin);
+    }
+    // an odd range is carried over to the next round as-is
+    if (bounds.size() % 2 == 0)
+      merged.push_back(bounds[bounds.size() - 2]);
+    merged.push_back(bounds.back());
 
-bool SorterIndirectAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterAscending(*left, *right);
+    RunParallel(merges);
+    bounds.swap(merged);
+  }
 }
 
-bool SorterIndirectDescending(const SortItemPtr &left, const SortItemPtr &right)
+inline wchar_t FoldCase(wchar_t c)
 {
-  return SorterDescending(*left, *right);
+  // the comparison ignores the case of A-Z only
+  if (c >= L'A' && c <= L'Z')
+    return c + (L'a' - L'A');
+  return c;
 }
 
-bool SorterIndirectIgnoreFoldersAscending(const SortItemPtr &left, const SortItemPtr &right)
+// collation rank of every character used in the labels, indexed by FoldCase(character)
+void GetCollationRanks(const std::vector<std::wstring> &labels, std::vector<uint32_t> &ranks)
 {
-  return SorterIgnoreFoldersAscending(*left, *right);
-}
+  size_t size = 0;
+  for (std::vector<std::wstring>::const_iterator label = labels.begin(); label != labels.end(); ++label)
+  {
+    for (std::wstring::const_iterator c = label->begin(); c != label->end(); ++c)
+      size = std::max(size, (size_t)FoldCase(*c) + 1);
+  }
 
-bool SorterIndirectIgnoreFoldersDescending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterIgnoreFoldersDescending(*left, *right);
+  std::vector<bool> used(size, false);
+  for (std::vector<std::wstring>::const_iterator label = labels.begin(); label != labels.end(); ++label)
+  {
+    for (std::wstring::const_iterator c = label->begin(); c != label->end(); ++c)
+      used[FoldCase(*c)] = true;
+  }
+
+  std::vector<wchar_t> chars;
+  for (size_t c = 0; c < size; c++)
+  {
+    if (used[c])
+      chars.push_back((wchar_t)c);
+  }
+
+  const std::collate<wchar_t>& coll = std::use_facet< std::collate<wchar_t> >(g_langInfo.GetSystemLocale());
+  std::sort(chars.begin(), chars.end(), [&coll](wchar_t left, wchar_t right)
+  {
+    return coll.compare(&left, &left + 1, &right, &right + 1) < 0;
+  });
+
+  // characters the locale considers equal share their rank, 0 is the end of a label
+  ranks.assign(size, 0);
+  uint32_t rank = 0;
+  for (size_t i = 0; i < chars.size(); i++)
+  {
+    if (i == 0 || coll.compare(&chars[i - 1], &chars[i - 1] + 1, &chars[i], &chars[i] + 1) != 0)
+      rank++;
+    ranks[chars[i]] = rank;
+  }
+}
 }
 
 map<SortBy, SortUtils::SortPreparator> fillPreparators()
@@ -638,34 +746,100 @@ map<SortBy, Fields> fillSortingFields()
 map<SortBy, SortUtils::SortPreparator> SortUtils::m_preparators = fillPreparators();
 map<SortBy, Fields> SortUtils::m_sortingFields = fillSortingFields();
 
-void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+void SortUtils::SortIndices(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, size_t count,
+                            const SortItemPreparer &prepare, std::vector<size_t> &order, std::vector<std::wstring> &labels)
 {
-  if (sortBy != SortByNone)
+  order.clear();
+  labels.assign(count, std::wstring());
+  if (count == 0)
+    return;
+
+  SortPreparator preparator = getPreparator(sortBy);
+  const Fields &sortingFields = GetFieldsForSorting(sortBy);
+
+  // Prepare the string used for sorting and everything else the order depends on.
+  // Random keys come from CUtil::GetRandomNumber() and its single seed, they are
+  // generated on the calling thread
+  unsigned int threads = sortBy == SortByRandom ? 1 : GetSortThreads(count);
+  std::vector<SortKey> keys(count);
+  ForEachRange(count, threads, [&](size_t begin, size_t end)
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
+    SortItem scratch;
+    for (size_t index = begin; index < end; index++)
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
+      scratch.clear();
+      SortItem &item = prepare(index, scratch);
 
-      // Prepare the string used for sorting and store it under FieldSort
-      for (DatabaseResults::iterator item = items.begin(); item != items.end(); ++item)
+      // add all fields to the item that are required for sorting if they are currently missing
+      for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
       {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if (item->find(*field) == item->end())
-            item->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        std::wstring sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-        item->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
+        if (item.find(*field) == item.end())
+          item.insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
       }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
+      g_charsetConverter.utf8ToW(preparator(attributes, item), labels[index], false);
+
+      SortKey &key = keys[index];
+      key.index = index;
+      key.special = SortSpecialNone;
+      SortItem::const_iterator it = item.find(FieldSortSpecial);
+      if (it != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+        key.special = (SortSpecial)it->second.asInteger();
+      it = item.find(FieldFolder);
+      key.folder = it != item.end() ? (it->second.asBoolean() ? 1 : 0) : -1;
+    }
+  });
+
+  // turn the labels into collation ranks, all in one buffer
+  std::vector<uint32_t> ranks;
+  GetCollationRanks(labels, ranks);
+
+  size_t size = 0;
+  for (std::vector<std::wstring>::const_iterator label = labels.begin(); label != labels.end(); ++label)
+    size += label->size() + 1;
+
+  std::vector<uint32_t> buffer(size);
+  size_t offset = 0;
+  for (size_t index = 0; index < count; index++)
+  {
+    keys[index].label = offset;
+    for (std::wstring::const_iterator c = labels[index].begin(); c != labels[index].end(); ++c)
+    {
+      uint32_t code = ranks[FoldCase(*c)] << KEY_RANK_SHIFT;
+      if (*c >= L'0' && *c <= L'9')
+        code |= KEY_DIGIT | (uint32_t)(*c - L'0');
+      buffer[offset++] = code;
+    }
+    buffer[offset++] = 0;
+  }
+
+  // Do the sorting
+  ParallelStableSort(keys, CSortKeyCompare(buffer, sortOrder == SortOrderDescending, (attributes & SortAttributeIgnoreFolders) == 0));
+
+  order.reserve(count);
+  for (std::vector<SortKey>::const_iterator key = keys.begin(); key != keys.end(); ++key)
+    order.push_back(key->index);
+}
+
+void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+{
+  if (sortBy != SortByNone && getPreparator(sortBy) != NULL)
+  {
+    std::vector<size_t> order;
+    std::vector<std::wstring> labels;
+    SortIndices(sortBy, sortOrder, attributes, items.size(), [&items](size_t index, SortItem&) -> SortItem&
+    {
+      return items[index];
+    }, order, labels);
+
+    // store the string used for sorting under FieldSort and apply the new order
+    DatabaseResults sortedItems(items.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      items[order[i]].insert(pair<Field, CVariant>(FieldSort, CVariant(labels[order[i]])));
+      sortedItems[i].swap(items[order[i]]);
     }
+    items.swap(sortedItems);
   }
 
   if (limitStart > 0 && (size_t)limitStart < items.size())
@@ -679,32 +853,24 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
 
 void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
 {
-  if (sortBy != SortByNone)
+  if (sortBy != SortByNone && getPreparator(sortBy) != NULL)
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
+    std::vector<size_t> order;
+    std::vector<std::wstring> labels;
+    SortIndices(sortBy, sortOrder, attributes, items.size(), [&items](size_t index, SortItem&) -> SortItem&
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
+      return *items[index];
+    }, order, labels);
 
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if ((*item)->find(*field) == (*item)->end())
-            (*item)->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        std::wstring sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, **item), sortLabel, false);
-        (*item)->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
+    // store the string used for sorting under FieldSort and apply the new order
+    SortItems sortedItems;
+    sortedItems.reserve(items.size());
+    for (std::vector<size_t>::const_iterator index = order.begin(); index != order.end(); ++index)
+    {
+      items[*index]->insert(pair<Field, CVariant>(FieldSort, CVariant(labels[*index])));
+      sortedItems.push_back(items[*index]);
     }
+    items.swap(sortedItems);
   }
 
   if (limitStart > 0 && (size_t)limitStart < items.size())
@@ -726,6 +892,42 @@ void SortUtils::Sort(const SortDescription &sortDescription, SortItems& items)
   Sort(sortDescription.sortBy, sortDescription.sortOrder, sortDescription.sortAttributes, items, sortDescription.limitEnd, sortDescription.limitStart);
 }
 
+void SortUtils::Sort(const SortDescription &sortDescription, size_t count, const SortItemGetter &getItem,
+                     std::vector<size_t> &order, std::vector<std::wstring> *labels /* = NULL */)
+{
+  std::vector<std::wstring> sortLabels;
+  if (sortDescription.sortBy != SortByNone && getPreparator(sortDescription.sortBy) != NULL)
+  {
+    const Fields &fields = GetFieldsForSorting(sortDescription.sortBy);
+    SortIndices(sortDescription.sortBy, sortDescription.sortOrder, sortDescription.sortAttributes, count,
+                [&getItem, &fields](size_t index, SortItem &scratch) -> SortItem&
+    {
+      getItem(index, fields, scratch);
+      return scratch;
+    }, order, sortLabels);
+  }
+  else
+  {
+    order.clear();
+    for (size_t index = 0; index < count; index++)
+      order.push_back(index);
+    sortLabels.assign(count, std::wstring());
+  }
+
+  if (labels)
+    labels->swap(sortLabels);
+
+  int limitStart = sortDescription.limitStart;
+  int limitEnd = sortDescription.limitEnd;
+  if (limitStart > 0 && (size_t)limitStart < order.size())
+  {
+    order.erase(order.begin(), order.begin() + limitStart);
+    limitEnd -= limitStart;
+  }
+  if (limitEnd > 0 && (size_t)limitEnd < order.size())
+    order.erase(order.begin() + limitEnd, order.end());
+}
+
 bool SortUtils::SortFromDataset(const SortDescription &sortDescription, const MediaType &mediaType, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results)
 {
   FieldList fields;
@@ -756,22 +958,6 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
-SortUtils::SorterIndirect SortUtils::getSorterIndirect(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIndirectIgnoreFoldersDescending : SorterIndirectIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterIndirectDescending : SorterIndirectAscending;
-}
-
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
 {
   map<SortBy, Fields>::const_iterator it = m_sortingFields.find(sortBy);
@@ -19,9 +19,11 @@
  *
  */
 
+#include <functional>
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "DatabaseUtils.h"
 #include "SortFileItem.h"
@@ -135,19 +137,38 @@ public:
   static void Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd = -1, int limitStart = 0);
   static void Sort(const SortDescription &sortDescription, DatabaseResults& items);
   static void Sort(const SortDescription &sortDescription, SortItems& items);
+
+  /*! \brief Fills in the fields of the item with the given index needed for sorting.
+   Called from several threads at once for large lists, each index is requested once.
+   */
+  typedef std::function<void(size_t index, const Fields &fields, SortItem &item)> SortItemGetter;
+
+  /*! \brief Sort a list of items without keeping a SortItem per item around.
+   The sort label of every item is reduced to a compact, collation-aware key and only
+   the keys are sorted, in parallel on multi-core machines for large lists.
+   \param sortDescription how to sort, including the limits to apply.
+   \param count number of items in the list.
+   \param getItem provides the sort fields of an item, see SortItemGetter.
+   \param order [out] indices of the items in sorted order.
+   \param labels [out] if not NULL, the sort label of every item, by index.
+   */
+  static void Sort(const SortDescription &sortDescription, size_t count, const SortItemGetter &getItem,
+                   std::vector<size_t> &order, std::vector<std::wstring> *labels = NULL);
+
   static bool SortFromDataset(const SortDescription &sortDescription, const MediaType &mediaType, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
   
   static const Fields& GetFieldsForSorting(SortBy sortBy);
   static std::string RemoveArticles(const std::string &label);
   
   typedef std::string (*SortPreparator) (SortAttribute, const SortItem&);
-  typedef bool (*Sorter) (const DatabaseResult &, const DatabaseResult &);
-  typedef bool (*SorterIndirect) (const SortItemPtr &, const SortItemPtr &);
   
 private:
+  // returns the item with the given index, either directly or filled into scratch
+  typedef std::function<SortItem&(size_t index, SortItem &scratch)> SortItemPreparer;
+
   static const SortPreparator& getPreparator(SortBy sortBy);
-  static Sorter getSorter(SortOrder sortOrder, SortAttribute attributes);
-  static SorterIndirect getSorterIndirect(SortOrder sortOrder, SortAttribute attributes);
+  static void SortIndices(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, size_t count,
+                          const SortItemPreparer &prepare, std::vector<size_t> &order, std::vector<std::wstring> &labels);
 
   static std::map<SortBy, SortPreparator> m_preparators;
   static std::map<SortBy, Fields> m_sortingFields;
@@ -0,0 +1,143 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "StringPool.h"
+
+const size_t CStringPool::MAX_LENGTH;
+const size_t CStringPool::MAX_STRINGS;
+
+CStringPool &CStringPool::Get()
+{
+  // never destroyed, static items may still be using its strings on exit
+  static CStringPool *pool = new CStringPool;
+  return *pool;
+}
+
+const std::string &CStringPool::Empty()
+{
+  static const std::string *empty = new std::string;
+  return *empty;
+}
+
+const std::string *CStringPool::Intern(const std::string &str, bool &owned)
+{
+  if (str.empty())
+  {
+    owned = false;
+    return &Empty();
+  }
+
+  if (str.size() <= MAX_LENGTH)
+  {
+    // the strings are mostly in the pool already, so look for them with a shared lock
+    {
+      CSharedLock lock(m_critSection);
+      std::unordered_set<std::string>::const_iterator it = m_strings.find(str);
+      if (it != m_strings.end())
+      {
+        owned = false;
+        return &*it;
+      }
+    }
+
+    CExclusiveLock lock(m_critSection);
+    if (m_strings.size() < MAX_STRINGS || m_strings.find(str) != m_strings.end())
+    {
+      owned = false;
+      return &*m_strings.insert(str).first;
+    }
+  }
+
+  owned = true;
+  return new std::string(str);
+}
+
+size_t CStringPool::Size() const
+{
+  CSharedLock lock(m_critSection);
+  return m_strings.size();
+}
+
+CPooledString::CPooledString(const CPooledString &rhs)
+  : m_str(rhs.m_owned ? new std::string(*rhs.m_str) : rhs.m_str),
+    m_owned(rhs.m_owned)
+{
+}
+
+CPooledString::CPooledString(CPooledString &&rhs) throw()
+  : m_str(rhs.m_str),
+    m_owned(rhs.m_owned)
+{
+  rhs.m_str = &CStringPool::Empty();
+  rhs.m_owned = false;
+}
+
+CPooledString &CPooledString::operator=(const CPooledString &rhs)
+{
+  if (this == &rhs)
+    return *this;
+
+  if (rhs.m_owned)
+  {
+    Assign(*rhs.m_str);
+  }
+  else
+  {
+    Release();
+    m_str = rhs.m_str;
+  }
+  return *this;
+}
+
+CPooledString &CPooledString::operator=(CPooledString &&rhs) throw()
+{
+  if (this == &rhs)
+    return *this;
+
+  Release();
+  m_str = rhs.m_str;
+  m_owned = rhs.m_owned;
+  rhs.m_str = &CStringPool::Empty();
+  rhs.m_owned = false;
+  return *this;
+}
+
+void CPooledString::clear()
+{
+  Release();
+}
+
+void CPooledString::Assign(const std::string &str)
+{
+  // str may be our own string
+  bool owned;
+  const std::string *pooled = CStringPool::Get().Intern(str, owned);
+  Release();
+  m_str = pooled;
+  m_owned = owned;
+}
+
+void CPooledString::Release()
+{
+  if (m_owned)
+    delete m_str;
+  m_str = &CStringPool::Empty();
+  m_owned = false;
+}
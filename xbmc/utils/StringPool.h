@@ -0,0 +1,118 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <unordered_set>
+
+#include "threads/SharedSection.h"
+
+/*!
+ \brief Pool of short strings that are used over and over again, like mime
+ types, icon names or property keys.
+
+ Pooled strings are never freed, so a pool is capped and strings that don't
+ fit are handed back as a copy owned by the caller. Each user of a pool with
+ values that aren't bounded gets a pool of its own, so it can't fill up the
+ pool of another.
+ */
+class CStringPool
+{
+public:
+  static const size_t MAX_LENGTH = 64;
+  static const size_t MAX_STRINGS = 16384;
+
+  CStringPool() { }
+
+  /*!
+   \brief The pool of the strings of list items, see CPooledString.
+   */
+  static CStringPool &Get();
+
+  /*!
+   \brief Get the pooled instance of a string.
+   \param str the string.
+   \param owned set to true if the string couldn't be pooled and the caller has to delete the returned copy.
+   \return the pooled string or a copy of it.
+   */
+  const std::string *Intern(const std::string &str, bool &owned);
+
+  /*!
+   \brief The empty string, which never has to be looked up.
+   */
+  static const std::string &Empty();
+
+  size_t Size() const;
+
+private:
+  CStringPool(const CStringPool&);
+  CStringPool &operator=(const CStringPool&);
+
+  CSharedSection m_critSection;
+  std::unordered_set<std::string> m_strings;
+};
+
+/*!
+ \brief A string of a list item, kept in CStringPool::Get() when possible.
+
+ Copies share the pooled instance, so a string repeated over thousands of items
+ is only stored once. It's read only, assign a new value to change it.
+ */
+class CPooledString
+{
+public:
+  CPooledString() : m_str(&CStringPool::Empty()), m_owned(false) { }
+  CPooledString(const std::string &str) : m_str(&CStringPool::Empty()), m_owned(false) { Assign(str); }
+  CPooledString(const char *str) : m_str(&CStringPool::Empty()), m_owned(false) { Assign(str); }
+  CPooledString(const CPooledString &rhs);
+  CPooledString(CPooledString &&rhs) throw();
+  ~CPooledString() { Release(); }
+
+  CPooledString &operator=(const CPooledString &rhs);
+  CPooledString &operator=(CPooledString &&rhs) throw();
+  CPooledString &operator=(const std::string &str) { Assign(str); return *this; }
+  CPooledString &operator=(const char *str) { Assign(str); return *this; }
+
+  operator const std::string&() const { return *m_str; }
+  const std::string &str() const { return *m_str; }
+  const char *c_str() const { return m_str->c_str(); }
+  size_t size() const { return m_str->size(); }
+  bool empty() const { return m_str->empty(); }
+  void clear();
+
+  bool operator==(const CPooledString &rhs) const { return m_str == rhs.m_str || *m_str == *rhs.m_str; }
+  bool operator==(const std::string &rhs) const { return *m_str == rhs; }
+  bool operator==(const char *rhs) const { return *m_str == rhs; }
+  bool operator!=(const CPooledString &rhs) const { return !(*this == rhs); }
+  bool operator!=(const std::string &rhs) const { return *m_str != rhs; }
+  bool operator!=(const char *rhs) const { return *m_str != rhs; }
+
+private:
+  void Assign(const std::string &str);
+  void Release();
+
+  const std::string *m_str;
+  bool m_owned;
+};
+
+inline bool operator==(const std::string &lhs, const CPooledString &rhs) { return rhs == lhs; }
+inline bool operator==(const char *lhs, const CPooledString &rhs) { return rhs == lhs; }
+inline bool operator!=(const std::string &lhs, const CPooledString &rhs) { return rhs != lhs; }
+inline bool operator!=(const char *lhs, const CPooledString &rhs) { return rhs != lhs; }
@@ -0,0 +1,248 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Trace.h"
+#include "XBDateTime.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <inttypes.h>
+
+#define TRACE_BUFFER_EVENTS 4096 // per thread, 128kB
+#define TRACE_MAX_THREADS   128
+
+std::atomic<bool> CTracer::s_enabled(false);
+
+CTraceBuffer::CTraceBuffer(unsigned int capacity, const std::string &threadName, uint64_t threadId)
+  : m_sessionStart(0), m_events(capacity), m_mask(capacity ? capacity - 1 : 0),
+    m_writing(0), m_recorded(0), m_threadName(threadName), m_threadId(threadId)
+{
+}
+
+void CTraceBuffer::Reset(const std::string &threadName, uint64_t threadId)
+{
+  m_sessionStart = 0;
+  m_writing = 0;
+  m_recorded = 0;
+  m_threadName = threadName;
+  m_threadId = threadId;
+}
+
+void CTraceBuffer::Record(const TracePoint *point, const char *arg, int64_t start, int64_t duration)
+{
+  if (m_events.empty())
+    return;
+
+  // only this thread writes, so the counters are just published for readers
+  uint64_t index = m_recorded.load(std::memory_order_relaxed);
+  m_writing.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  TraceEvent &event = m_events[index & m_mask];
+  event.point = point;
+  event.arg = arg;
+  event.start = start;
+  event.duration = duration;
+
+  m_recorded.store(index + 1, std::memory_order_release);
+}
+
+uint64_t CTraceBuffer::GetEvents(uint64_t first, std::vector<TraceEvent> &events) const
+{
+  uint64_t capacity = m_events.size();
+  uint64_t end = m_recorded.load(std::memory_order_acquire);
+  uint64_t begin = std::max(first, end > capacity ? end - capacity : 0);
+
+  size_t copied = events.size();
+  for (uint64_t i = begin; i < end; i++)
+    events.push_back(m_events[i & m_mask]);
+
+  // drop the events the writer overwrote while we were copying them
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint64_t writing = m_writing.load(std::memory_order_relaxed);
+  if (writing > capacity && writing - capacity > begin)
+  {
+    uint64_t overwritten = std::min(writing - capacity, end) - begin;
+    events.erase(events.begin() + copied, events.begin() + copied + overwritten);
+  }
+  return end;
+}
+
+CTracer &CTracer::Get()
+{
+  // never destroyed, threads may still record or exit while statics are destroyed
+  static CTracer *tracer = new CTracer;
+  return *tracer;
+}
+
+CTracer::CTracer() : m_buffer(OnThreadExit), m_overflow(0, "", 0), m_start(0), m_dropped(0)
+{
+}
+
+void CTracer::Start()
+{
+  CSingleLock lock(m_section);
+  for (std::vector<CTraceBuffer*>::iterator i = m_buffers.begin(); i != m_buffers.end(); ++i)
+    (*i)->m_sessionStart = (*i)->GetRecorded();
+  m_start = CurrentHostCounter();
+  m_dropped = 0;
+  s_enabled = true;
+  CLog::Log(LOGNOTICE, "%s - tracing started", __FUNCTION__);
+}
+
+void CTracer::Stop()
+{
+  s_enabled = false;
+  CLog::Log(LOGNOTICE, "%s - tracing stopped", __FUNCTION__);
+}
+
+void CTracer::Record(const TracePoint *point, const char *arg, int64_t start, int64_t duration)
+{
+  if (!IsEnabled())
+    return;
+
+  CTraceBuffer *buffer = GetBuffer();
+  if (buffer == &m_overflow)
+    m_dropped++;
+  else
+    buffer->Record(point, arg, start, duration);
+}
+
+CTraceBuffer *CTracer::GetBuffer()
+{
+  CTraceBuffer *buffer = m_buffer.get();
+  if (buffer)
+    return buffer;
+
+  // first event of this thread, buffers are only allocated for threads that are traced
+  CThread *thread = CThread::GetCurrentThread();
+  uint64_t threadId = (uint64_t)CThread::GetCurrentThreadId();
+  std::string name = thread ? thread->GetName() : StringUtils::Format("Thread %" PRIu64, threadId);
+
+  CSingleLock lock(m_section);
+
+  // rather take the buffer of an exited thread that has nothing in this trace
+  std::vector<CTraceBuffer*>::iterator released = m_released.begin();
+  while (released != m_released.end() && (*released)->GetRecorded() != (*released)->m_sessionStart)
+    ++released;
+
+  if (released == m_released.end() && m_buffers.size() < TRACE_MAX_THREADS)
+  {
+    buffer = new CTraceBuffer(TRACE_BUFFER_EVENTS, name, threadId);
+    m_buffers.push_back(buffer);
+  }
+  else if (!m_released.empty())
+  {
+    // out of buffers, the oldest exited thread loses its events to this one
+    if (released == m_released.end())
+      released = m_released.begin();
+    buffer = *released;
+    m_released.erase(released);
+    m_dropped += (unsigned int)(buffer->GetRecorded() - buffer->m_sessionStart);
+    buffer->Reset(name, threadId);
+  }
+  else
+  {
+    CLog::Log(LOGWARNING, "%s - more than %u threads traced, not tracing this one", __FUNCTION__, TRACE_MAX_THREADS);
+    buffer = &m_overflow;
+  }
+  m_buffer.set(buffer);
+  return buffer;
+}
+
+void CTracer::OnThreadExit(void *buffer)
+{
+  CTracer &tracer = Get();
+  if (buffer == &tracer.m_overflow)
+    return;
+
+  CSingleLock lock(tracer.m_section);
+  tracer.m_released.push_back((CTraceBuffer*)buffer);
+}
+
+static std::string EscapeJSON(const char *text)
+{
+  std::string escaped;
+  for (const char *c = text; *c; c++)
+  {
+    if (*c == '"' || *c == '\\')
+      escaped += '\\';
+    if ((unsigned char)*c >= 0x20)
+      escaped += *c;
+  }
+  return escaped;
+}
+
+std::string CTracer::GetTrace()
+{
+  CSingleLock lock(m_section);
+  double usPerTick = 1000000.0 / CurrentHostFrequency();
+
+  std::string trace = "{\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Kodi\"}}";
+
+  std::vector<TraceEvent> events;
+  for (size_t i = 0; i < m_buffers.size(); i++)
+  {
+    const CTraceBuffer *buffer = m_buffers[i];
+    int tid = (int)i + 1;
+    trace += StringUtils::Format(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                                 tid, EscapeJSON(buffer->GetThreadName().c_str()).c_str());
+
+    events.clear();
+    buffer->GetEvents(buffer->m_sessionStart, events);
+    for (std::vector<TraceEvent>::const_iterator event = events.begin(); event != events.end(); ++event)
+    {
+      if (event->start < m_start)
+        continue; // started before the trace
+      trace += StringUtils::Format(",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                                   EscapeJSON(event->point->name).c_str(), EscapeJSON(event->point->category).c_str(), tid,
+                                   (event->start - m_start) * usPerTick, event->duration * usPerTick);
+      if (event->arg)
+        trace += StringUtils::Format(",\"args\":{\"arg\":\"%s\"}", EscapeJSON(event->arg).c_str());
+      trace += "}";
+    }
+  }
+
+  trace += StringUtils::Format("],\n\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%u}}\n", m_dropped.load());
+  return trace;
+}
+
+std::string CTracer::GetTraceFile()
+{
+  return StringUtils::Format("special://temp/trace-%s.json", CDateTime::GetCurrentDateTime().GetAsSaveString().c_str());
+}
+
+bool CTracer::Save(const std::string &path)
+{
+  std::string trace = GetTrace();
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true) || file.Write(trace.c_str(), trace.size()) != (ssize_t)trace.size())
+  {
+    CLog::Log(LOGERROR, "%s - failed to save trace to %s", __FUNCTION__, path.c_str());
+    return false;
+  }
+  CLog::Log(LOGNOTICE, "%s - trace saved to %s", __FUNCTION__, path.c_str());
+  return true;
+}
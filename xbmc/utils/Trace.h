@@ -0,0 +1,208 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/ThreadLocal.h"
+#include "utils/TimeUtils.h"
+
+/*!
+ \brief Trace a scope, e.g. TRACE_SCOPE("gui", "Render");
+ The category and name must be string literals, they identify the tracepoint.
+ */
+#define TRACE_SCOPE(category, name) \
+  TRACE_SCOPE_ARG(category, name, NULL)
+
+/*!
+ \brief Trace a scope with an argument shown with the event, e.g. the type of a job
+ The argument must stay valid for the lifetime of the application, e.g. a string literal.
+ */
+#define TRACE_SCOPE_ARG(category, name, arg) \
+  static const TracePoint TRACE_CONCAT(tracePoint_, __LINE__) = { category, name }; \
+  CTraceScope TRACE_CONCAT(traceScope_, __LINE__)(&TRACE_CONCAT(tracePoint_, __LINE__), arg)
+
+/*!
+ \brief Trace the enclosing function
+ */
+#define TRACE_FUNCTION(category) \
+  TRACE_SCOPE(category, __FUNCTION__)
+
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_CONCAT2(a, b) a##b
+
+/*!
+ \brief A place in the code that is traced, defined statically by the TRACE_ macros
+ Its address identifies it, so recording an event never looks up or copies a name.
+ */
+struct TracePoint
+{
+  const char *category;
+  const char *name;
+};
+
+struct TraceEvent
+{
+  const TracePoint *point;
+  const char       *arg;
+  int64_t           start;
+  int64_t           duration;
+};
+
+/*!
+ \brief Events recorded by one thread
+
+ A ring buffer written only by its thread, so recording takes no lock. When
+ full the oldest events are overwritten, a trace shows the time leading up to
+ it being saved. Readers copy the events without stopping the writer and
+ discard those overwritten while copying.
+ */
+class CTraceBuffer
+{
+public:
+  CTraceBuffer(unsigned int capacity, const std::string &threadName, uint64_t threadId);
+
+  /*!
+   \brief Hand the buffer to another thread once its thread has exited, discarding its events
+   */
+  void Reset(const std::string &threadName, uint64_t threadId);
+
+  void Record(const TracePoint *point, const char *arg, int64_t start, int64_t duration);
+
+  /*!
+   \brief Copy the events recorded since the given count, may be called by any thread
+   \param first number of events recorded before those wanted
+   \param events [out] the events still in the buffer
+   \return the number of events recorded so far
+   */
+  uint64_t GetEvents(uint64_t first, std::vector<TraceEvent> &events) const;
+
+  uint64_t GetRecorded() const { return m_recorded.load(std::memory_order_acquire); }
+
+  const std::string &GetThreadName() const { return m_threadName; }
+  uint64_t GetThreadId() const { return m_threadId; }
+
+  uint64_t m_sessionStart; ///< events recorded before tracing was last started, accessed with the tracer locked
+
+private:
+  std::vector<TraceEvent> m_events;
+  unsigned int            m_mask;
+  std::atomic<uint64_t>   m_writing;  ///< events written or being written, read back to detect overwritten events
+  std::atomic<uint64_t>   m_recorded; ///< events completely written
+  std::string             m_threadName;
+  uint64_t                m_threadId;
+};
+
+/*!
+ \brief Records timings of traced scopes for profiling, e.g. to find frame drops
+
+ Tracing is off by default, then a traced scope costs a single check of a
+ flag. Once started every thread records its events into a buffer of its own,
+ which is saved in the Chrome trace event format, viewed with chrome://tracing
+ or Perfetto.
+ */
+class CTracer
+{
+public:
+  static CTracer &Get();
+
+  static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  /*! \brief Start tracing, discarding events from previous traces */
+  void Start();
+
+  /*! \brief Stop tracing, the events recorded so far are kept until tracing is started again */
+  void Stop();
+
+  /*!
+   \brief Save the events of the current or last trace
+   \param path the file to write
+   \return true if the trace was saved, false otherwise.
+   */
+  bool Save(const std::string &path);
+
+  /*!
+   \brief Get the events of the current or last trace as Chrome trace event JSON
+   */
+  std::string GetTrace();
+
+  /*!
+   \brief Get a file in the temp folder to save a trace to, named after the current time
+   */
+  static std::string GetTraceFile();
+
+  void Record(const TracePoint *point, const char *arg, int64_t start, int64_t duration);
+
+private:
+  CTracer();
+  CTracer(const CTracer&);
+  CTracer &operator=(const CTracer&);
+  ~CTracer();
+
+  CTraceBuffer *GetBuffer();
+  static void OnThreadExit(void *buffer);
+
+  static std::atomic<bool> s_enabled;
+
+  CCriticalSection m_section;
+  XbmcThreads::ThreadLocal<CTraceBuffer> m_buffer;
+  std::vector<CTraceBuffer*> m_buffers; ///< kept until exit, reused once their thread has exited
+  std::vector<CTraceBuffer*> m_released; ///< buffers of threads that have exited, oldest first
+  CTraceBuffer m_overflow;              ///< empty buffer for threads beyond the limit
+  int64_t m_start;
+  std::atomic<unsigned int> m_dropped;  ///< events of threads beyond the limit or of reused buffers
+};
+
+/*!
+ \brief Records an event for the lifetime of the object, use the TRACE_ macros
+ */
+class CTraceScope
+{
+public:
+  CTraceScope(const TracePoint *point, const char *arg)
+  {
+    if (CTracer::IsEnabled())
+    {
+      m_point = point;
+      m_arg = arg;
+      m_start = CurrentHostCounter();
+    }
+    else
+      m_point = NULL;
+  }
+
+  ~CTraceScope()
+  {
+    if (m_point)
+      CTracer::Get().Record(m_point, m_arg, m_start, CurrentHostCounter() - m_start);
+  }
+
+private:
+  CTraceScope(const CTraceScope&);
+  CTraceScope &operator=(const CTraceScope&);
+
+  const TracePoint *m_point;
+  const char       *m_arg;
+  int64_t           m_start;
+};
@@ -18,11 +18,13 @@
  *
  */
 
+#include <algorithm>
 #include <stdlib.h>
 #include <string.h>
 #include <sstream>
 
 #include "Variant.h"
+#include "StringPool.h"
 
 #ifndef strtoll
 #ifdef TARGET_WINDOWS
@@ -128,11 +130,192 @@ double str2double(const wstring &str, double fallback /* = 0.0 */)
   return fallback;
 }
 
+namespace
+{
+// strings shorter than this are stored inside the variant
+const size_t SHORT_STRING_SIZE = 16;
+const uint8_t SHORT_STRING_NONE = 0xFF;
+
+// member values are allocated in chunks growing up to this size
+const size_t MIN_CHUNK_SIZE = 4;
+const size_t MAX_CHUNK_SIZE = 64;
+
+// object keys have a pool of their own, so other strings can't fill it up.
+// Never destroyed, static variants may still be using its keys on exit
+static CStringPool &GetKeyPool()
+{
+  static CStringPool *pool = new CStringPool;
+  return *pool;
+}
+}
+
+/*
+ * The members of an object, as a vector sorted by key. Lookups are a binary
+ * search and iterating doesn't chase any pointers but the values themselves.
+ *
+ * Values are allocated in chunks owned by the object rather than one by one,
+ * and a value keeps its address for as long as it is a member, just like in
+ * a std::map, so references to members stay valid while others are added.
+ */
+class CVariant::VariantMap
+{
+public:
+  VariantMap() : m_chunkUsed(0) { }
+
+  VariantMap(const VariantMap &rhs) : m_chunkUsed(0)
+  {
+    m_members.reserve(rhs.m_members.size());
+    if (!rhs.m_members.empty())
+    {
+      // copies are never grown much, so they get a single chunk of the exact size
+      m_chunks.push_back(Chunk(new CVariant[rhs.m_members.size()], rhs.m_members.size()));
+      for (VariantMembers::const_iterator it = rhs.m_members.begin(); it != rhs.m_members.end(); ++it)
+      {
+        VariantMember member = { it->ownsKey ? new std::string(*it->key) : it->key, AllocateValue(), it->ownsKey };
+        *member.value = *it->value;
+        m_members.push_back(member);
+      }
+    }
+  }
+
+  ~VariantMap()
+  {
+    clear();
+    for (std::vector<Chunk>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+      delete[] it->first;
+  }
+
+  VariantMembers::iterator begin() { return m_members.begin(); }
+  VariantMembers::const_iterator begin() const { return m_members.begin(); }
+  VariantMembers::iterator end() { return m_members.end(); }
+  VariantMembers::const_iterator end() const { return m_members.end(); }
+  size_t size() const { return m_members.size(); }
+  bool empty() const { return m_members.empty(); }
+
+  const CVariant *find(const std::string &key) const
+  {
+    VariantMembers::const_iterator it = LowerBound(key);
+    if (it != m_members.end() && *it->key == key)
+      return it->value;
+    return NULL;
+  }
+
+  CVariant &operator[](const std::string &key)
+  {
+    // members are often added in order, check the end first
+    VariantMembers::iterator it = m_members.end();
+    if (!m_members.empty() && *m_members.back().key >= key)
+    {
+      it = LowerBound(key);
+      if (*it->key == key)
+        return *it->value;
+    }
+
+    VariantMember member;
+    // keys are mostly the same few hundred field names, so they are shared by all objects
+    member.key = GetKeyPool().Intern(key, member.ownsKey);
+    member.value = AllocateValue();
+    m_members.insert(it, member);
+    return *member.value;
+  }
+
+  void erase(const std::string &key)
+  {
+    VariantMembers::iterator it = LowerBound(key);
+    if (it != m_members.end() && *it->key == key)
+    {
+      Release(*it);
+      m_members.erase(it);
+    }
+  }
+
+  void clear()
+  {
+    for (VariantMembers::iterator it = m_members.begin(); it != m_members.end(); ++it)
+      Release(*it);
+    m_members.clear();
+  }
+
+  bool operator==(const VariantMap &rhs) const
+  {
+    if (m_members.size() != rhs.m_members.size())
+      return false;
+
+    for (size_t i = 0; i < m_members.size(); i++)
+    {
+      if ((m_members[i].key != rhs.m_members[i].key && *m_members[i].key != *rhs.m_members[i].key) ||
+          *m_members[i].value != *rhs.m_members[i].value)
+        return false;
+    }
+    return true;
+  }
+
+private:
+  VariantMap &operator=(const VariantMap &rhs);
+
+  typedef std::pair<CVariant*, size_t> Chunk;
+
+  VariantMembers::iterator LowerBound(const std::string &key)
+  {
+    VariantMembers::iterator first = m_members.begin();
+    size_t count = m_members.size();
+    while (count > 0)
+    {
+      size_t step = count / 2;
+      if (*first[step].key < key)
+      {
+        first += step + 1;
+        count -= step + 1;
+      }
+      else
+        count = step;
+    }
+    return first;
+  }
+
+  VariantMembers::const_iterator LowerBound(const std::string &key) const
+  {
+    return const_cast<VariantMap*>(this)->LowerBound(key);
+  }
+
+  CVariant *AllocateValue()
+  {
+    if (!m_free.empty())
+    {
+      CVariant *value = m_free.back();
+      m_free.pop_back();
+      return value;
+    }
+
+    if (m_chunks.empty() || m_chunkUsed == m_chunks.back().second)
+    {
+      size_t size = m_chunks.empty() ? MIN_CHUNK_SIZE : std::min(m_chunks.back().second * 2, MAX_CHUNK_SIZE);
+      m_chunks.push_back(Chunk(new CVariant[size], size));
+      m_chunkUsed = 0;
+    }
+    return &m_chunks.back().first[m_chunkUsed++];
+  }
+
+  void Release(const VariantMember &member)
+  {
+    if (member.ownsKey)
+      delete member.key;
+    member.value->cleanup();
+    m_free.push_back(member.value);
+  }
+
+  VariantMembers m_members;
+  std::vector<Chunk> m_chunks;
+  size_t m_chunkUsed;             ///< values handed out from the last chunk
+  std::vector<CVariant*> m_free;  ///< values of erased members, to be reused
+};
+
 CVariant CVariant::ConstNullVariant = CVariant::VariantTypeConstNull;
 
 CVariant::CVariant(VariantType type)
 {
   m_type = type;
+  m_shortString = SHORT_STRING_NONE;
 
   switch (type)
   {
@@ -149,7 +332,7 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new string();
+      setString("", 0);
       break;
     case VariantTypeWideString:
       m_data.wstring = new wstring();
@@ -211,19 +394,19 @@ CVariant::CVariant(bool boolean)
 CVariant::CVariant(const char *str)
 {
   m_type = VariantTypeString;
-  m_data.string = new string(str);
+  setString(str, strlen(str));
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
   m_type = VariantTypeString;
-  m_data.string = new string(str, length);
+  setString(str, length);
 }
 
 CVariant::CVariant(const string &str)
 {
   m_type = VariantTypeString;
-  m_data.string = new string(str);
+  setString(str.c_str(), str.size());
 }
 
 CVariant::CVariant(const wchar_t *str)
@@ -258,13 +441,15 @@ CVariant::CVariant(const std::map<std::string, std::string> &strMap)
   m_type = VariantTypeObject;
   m_data.map = new VariantMap;
   for (std::map<std::string, std::string>::const_iterator it = strMap.begin(); it != strMap.end(); ++it)
-    m_data.map->insert(make_pair(it->first, CVariant(it->second)));
+    (*m_data.map)[it->first] = it->second;
 }
 
 CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 {
   m_type = VariantTypeObject;
-  m_data.map = new VariantMap(variantMap.begin(), variantMap.end());
+  m_data.map = new VariantMap;
+  for (std::map<std::string, CVariant>::const_iterator it = variantMap.begin(); it != variantMap.end(); ++it)
+    (*m_data.map)[it->first] = it->second;
 }
 
 CVariant::CVariant(const CVariant &variant)
@@ -273,6 +458,12 @@ CVariant::CVariant(const CVariant &variant)
   *this = variant;
 }
 
+CVariant::CVariant(CVariant &&variant) throw()
+{
+  m_type = VariantTypeNull;
+  *this = std::move(variant);
+}
+
 CVariant::~CVariant()
 {
   cleanup();
@@ -280,7 +471,7 @@ CVariant::~CVariant()
 
 void CVariant::cleanup()
 {
-  if (m_type == VariantTypeString)
+  if (m_type == VariantTypeString && m_shortString == SHORT_STRING_NONE)
     delete m_data.string;
   else if (m_type == VariantTypeWideString)
     delete m_data.wstring;
@@ -291,6 +482,35 @@ void CVariant::cleanup()
   m_type = VariantTypeNull;
 }
 
+void CVariant::setString(const char *str, size_t length)
+{
+  if (length < SHORT_STRING_SIZE)
+  {
+    memcpy(m_data.shortString, str, length);
+    m_data.shortString[length] = '\0';
+    m_shortString = (uint8_t)length;
+  }
+  else
+  {
+    m_data.string = new string(str, length);
+    m_shortString = SHORT_STRING_NONE;
+  }
+}
+
+const char *CVariant::stringData() const
+{
+  if (m_shortString != SHORT_STRING_NONE)
+    return m_data.shortString;
+  return m_data.string->c_str();
+}
+
+size_t CVariant::stringSize() const
+{
+  if (m_shortString != SHORT_STRING_NONE)
+    return m_shortString;
+  return m_data.string->size();
+}
+
 bool CVariant::isInteger() const
 {
   return m_type == VariantTypeInteger;
@@ -352,7 +572,7 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+      return str2int64(string(stringData(), stringSize()), fallback);
     case VariantTypeWideString:
       return str2int64(*m_data.wstring, fallback);
     default:
@@ -373,7 +593,7 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+      return str2uint64(string(stringData(), stringSize()), fallback);
     case VariantTypeWideString:
       return str2uint64(*m_data.wstring, fallback);
     default:
@@ -394,7 +614,7 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+      return str2double(string(stringData(), stringSize()), fallback);
     case VariantTypeWideString:
       return str2double(*m_data.wstring, fallback);
     default:
@@ -415,7 +635,7 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+      return (float)str2double(string(stringData(), stringSize()), fallback);
     case VariantTypeWideString:
       return (float)str2double(*m_data.wstring, fallback);
     default:
@@ -438,9 +658,12 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+    {
+      size_t size = stringSize();
+      if (size == 0 || (size == 1 && stringData()[0] == '0') || (size == 5 && memcmp(stringData(), "false", 5) == 0))
         return false;
       return true;
+    }
     case VariantTypeWideString:
       if (m_data.wstring->empty() || m_data.wstring->compare(L"0") == 0 || m_data.wstring->compare(L"false") == 0)
         return false;
@@ -457,7 +680,7 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
-      return *m_data.string;
+      return string(stringData(), stringSize());
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
     case VariantTypeInteger:
@@ -524,9 +747,9 @@ CVariant &CVariant::operator[](const std::string &key)
 
 const CVariant &CVariant::operator[](const std::string &key) const
 {
-  VariantMap::const_iterator it;
-  if (m_type == VariantTypeObject && (it = m_data.map->find(key)) != m_data.map->end())
-    return it->second;
+  const CVariant *value;
+  if (m_type == VariantTypeObject && (value = m_data.map->find(key)) != NULL)
+    return *value;
   else
     return ConstNullVariant;
 }
@@ -571,7 +794,7 @@ CVariant &CVariant::operator=(const CVariant &rhs)
     m_data.dvalue = rhs.m_data.dvalue;
     break;
   case VariantTypeString:
-    m_data.string = new string(*rhs.m_data.string);
+    setString(rhs.stringData(), rhs.stringSize());
     break;
   case VariantTypeWideString:
     m_data.wstring = new wstring(*rhs.m_data.wstring);
@@ -580,7 +803,7 @@ CVariant &CVariant::operator=(const CVariant &rhs)
     m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
     break;
   case VariantTypeObject:
-    m_data.map = new VariantMap(rhs.m_data.map->begin(), rhs.m_data.map->end());
+    m_data.map = new VariantMap(*rhs.m_data.map);
     break;
   default:
     break;
@@ -589,6 +812,30 @@ CVariant &CVariant::operator=(const CVariant &rhs)
   return *this;
 }
 
+CVariant &CVariant::operator=(CVariant &&rhs) throw()
+{
+  if (m_type == VariantTypeConstNull || this == &rhs)
+    return *this;
+
+  // the shared null must never be taken apart
+  if (rhs.m_type == VariantTypeConstNull)
+    return *this = static_cast<const CVariant&>(rhs);
+
+  // take the value before cleaning up, rhs may be a part of this
+  VariantType type = rhs.m_type;
+  uint8_t shortString = rhs.m_shortString;
+  VariantUnion data = rhs.m_data;
+  rhs.m_type = VariantTypeNull;
+
+  cleanup();
+
+  m_type = type;
+  m_shortString = shortString;
+  m_data = data;
+
+  return *this;
+}
+
 bool CVariant::operator==(const CVariant &rhs) const
 {
   if (m_type == rhs.m_type)
@@ -604,7 +851,7 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return stringSize() == rhs.stringSize() && memcmp(stringData(), rhs.stringData(), stringSize()) == 0;
     case VariantTypeWideString:
       return *m_data.wstring == *rhs.m_data.wstring;
     case VariantTypeArray:
@@ -631,15 +878,32 @@ void CVariant::push_back(const CVariant &variant)
     m_data.array->push_back(variant);
 }
 
+void CVariant::push_back(CVariant &&variant)
+{
+  if (m_type == VariantTypeNull)
+  {
+    m_type = VariantTypeArray;
+    m_data.array = new VariantArray;
+  }
+
+  if (m_type == VariantTypeArray)
+    m_data.array->push_back(std::move(variant));
+}
+
 void CVariant::append(const CVariant &variant)
 {
   push_back(variant);
 }
 
+void CVariant::append(CVariant &&variant)
+{
+  push_back(std::move(variant));
+}
+
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return stringData();
   else
     return NULL;
 }
@@ -647,12 +911,15 @@ const char *CVariant::c_str() const
 void CVariant::swap(CVariant &rhs)
 {
   VariantType  temp_type = m_type;
+  uint8_t      temp_shortString = m_shortString;
   VariantUnion temp_data = m_data;
 
   m_type = rhs.m_type;
+  m_shortString = rhs.m_shortString;
   m_data = rhs.m_data;
 
   rhs.m_type = temp_type;
+  rhs.m_shortString = temp_shortString;
   rhs.m_data = temp_data;
 }
 
@@ -691,7 +958,7 @@ CVariant::const_iterator_array CVariant::end_array() const
 CVariant::iterator_map CVariant::begin_map()
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->begin();
+    return iterator_map(m_data.map->begin());
   else
     return iterator_map();
 }
@@ -699,7 +966,7 @@ CVariant::iterator_map CVariant::begin_map()
 CVariant::const_iterator_map CVariant::begin_map() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->begin();
+    return const_iterator_map(static_cast<const VariantMap*>(m_data.map)->begin());
   else
     return const_iterator_map();
 }
@@ -707,7 +974,7 @@ CVariant::const_iterator_map CVariant::begin_map() const
 CVariant::iterator_map CVariant::end_map()
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->end();
+    return iterator_map(m_data.map->end());
   else
     return iterator_map();
 }
@@ -715,7 +982,7 @@ CVariant::iterator_map CVariant::end_map()
 CVariant::const_iterator_map CVariant::end_map() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->end();
+    return const_iterator_map(static_cast<const VariantMap*>(m_data.map)->end());
   else
     return const_iterator_map();
 }
@@ -727,7 +994,7 @@ unsigned int CVariant::size() const
   else if (m_type == VariantTypeArray)
     return m_data.array->size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return stringSize();
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->size();
   else
@@ -741,7 +1008,7 @@ bool CVariant::empty() const
   else if (m_type == VariantTypeArray)
     return m_data.array->empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return stringSize() == 0;
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->empty();
   else if (m_type == VariantTypeNull)
@@ -757,7 +1024,12 @@ void CVariant::clear()
   else if (m_type == VariantTypeArray)
     m_data.array->clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+  {
+    if (m_shortString != SHORT_STRING_NONE)
+      setString("", 0);
+    else
+      m_data.string->clear();
+  }
   else if (m_type == VariantTypeWideString)
     m_data.wstring->clear();
 }
@@ -788,7 +1060,7 @@ void CVariant::erase(unsigned int position)
 bool CVariant::isMember(const std::string &key) const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->find(key) != m_data.map->end();
+    return m_data.map->find(key) != NULL;
 
   return false;
 }
@@ -18,6 +18,7 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <iterator>
 #include <map>
 #include <vector>
 #include <string>
@@ -66,6 +67,7 @@ public:
   CVariant(const std::map<std::string, std::string> &strMap);
   CVariant(const std::map<std::string, CVariant> &variantMap);
   CVariant(const CVariant &variant);
+  CVariant(CVariant &&variant) throw();
   ~CVariant();
 
   bool isInteger() const;
@@ -94,11 +96,14 @@ public:
   const CVariant &operator[](unsigned int position) const;
 
   CVariant &operator=(const CVariant &rhs);
+  CVariant &operator=(CVariant &&rhs) throw();
   bool operator==(const CVariant &rhs) const;
   bool operator!=(const CVariant &rhs) const { return !(*this == rhs); }
 
   void push_back(const CVariant &variant);
+  void push_back(CVariant &&variant);
   void append(const CVariant &variant);
+  void append(CVariant &&variant);
 
   const char *c_str() const;
 
@@ -106,14 +111,72 @@ public:
 
 private:
   typedef std::vector<CVariant> VariantArray;
-  typedef std::map<std::string, CVariant> VariantMap;
+  class VariantMap;
+
+  /* A member of an object. Values never move while they are members, and keys
+     are usually shared by all objects using them, see Variant.cpp */
+  struct VariantMember
+  {
+    const std::string *key;
+    CVariant *value;
+    bool ownsKey;
+  };
+  typedef std::vector<VariantMember> VariantMembers;
 
 public:
+  /*! \brief A member of an object as seen through its iterators, like the value_type of a std::map */
+  template<class Value>
+  struct map_member
+  {
+    map_member(const std::string &key, Value &value) : first(key), second(value) { }
+    const std::string &first;
+    Value &second;
+  };
+
+  /*! \brief Iterates the members of an object, ordered by key like a std::map */
+  template<class Value, class MemberIterator>
+  class map_iterator
+  {
+  public:
+    struct arrow_proxy
+    {
+      map_member<Value> member;
+      const map_member<Value> *operator->() const { return &member; }
+    };
+
+    typedef std::forward_iterator_tag iterator_category;
+    typedef map_member<Value> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef arrow_proxy pointer;
+    typedef map_member<Value> reference;
+
+    map_iterator() : m_member() { }
+    explicit map_iterator(MemberIterator member) : m_member(member) { }
+    // an iterator converts to a const_iterator
+    template<class OtherValue, class OtherIterator>
+    map_iterator(const map_iterator<OtherValue, OtherIterator> &other) : m_member(other.m_member) { }
+
+    reference operator*() const { return reference(*m_member->key, *m_member->value); }
+    pointer operator->() const { pointer proxy = { **this }; return proxy; }
+
+    map_iterator &operator++() { ++m_member; return *this; }
+    map_iterator operator++(int) { map_iterator it(*this); ++m_member; return it; }
+
+    template<class OtherValue, class OtherIterator>
+    bool operator==(const map_iterator<OtherValue, OtherIterator> &rhs) const { return m_member == rhs.m_member; }
+    template<class OtherValue, class OtherIterator>
+    bool operator!=(const map_iterator<OtherValue, OtherIterator> &rhs) const { return m_member != rhs.m_member; }
+
+  private:
+    template<class OtherValue, class OtherIterator> friend class map_iterator;
+    MemberIterator m_member;
+  };
+
   typedef VariantArray::iterator        iterator_array;
   typedef VariantArray::const_iterator  const_iterator_array;
 
-  typedef VariantMap::iterator          iterator_map;
-  typedef VariantMap::const_iterator    const_iterator_map;
+  typedef map_iterator<CVariant, VariantMembers::iterator>             iterator_map;
+  typedef map_iterator<const CVariant, VariantMembers::const_iterator> const_iterator_map;
 
   iterator_array begin_array();
   const_iterator_array begin_array() const;
@@ -137,6 +200,10 @@ public:
 
 private:
   void cleanup();
+  void setString(const char *str, size_t length);
+  const char *stringData() const;
+  size_t stringSize() const;
+
   union VariantUnion
   {
     int64_t integer;
@@ -144,11 +211,13 @@ private:
     bool boolean;
     double dvalue;
     std::string *string;
+    char shortString[16];         ///< strings shorter than this are stored in place
     std::wstring *wstring;
     VariantArray *array;
     VariantMap *map;
   };
 
   VariantType m_type;
+  uint8_t m_shortString;          ///< length of a string in m_data.shortString, or SHORT_STRING_NONE
   VariantUnion m_data;
 };
@@ -22,6 +22,7 @@
 #include "system.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
+#include "utils/LogQueue.h"
 #include "utils/StringUtils.h"
 #include "CompileInfo.h"
 
@@ -32,17 +33,54 @@ static const char* const levelNames[] =
 static const char* const logLevelNames[] =
 { "LOG_LEVEL_NONE" /*-1*/, "LOG_LEVEL_NORMAL" /*0*/, "LOG_LEVEL_DEBUG" /*1*/, "LOG_LEVEL_DEBUG_FREEMEM" /*2*/ };
 
+// lines queued for the writer thread at most, a few seconds of heavy debug logging
+#define LOG_QUEUE_SIZE 8192
+// time the writer thread sleeps when there is nothing to write
+#define LOG_WRITER_IDLE_MS 100
+
 // s_globals is used as static global with CLog global variables
 #define s_globals XBMC_GLOBAL_USE(CLog).m_globalInstance
 
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter() : CThread("LogWriter") {}
+
+  void Stop()
+  {
+    StopThread(false);
+    s_globals.m_queue->Wake();
+    StopThread(true);
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      CLog::WriteQueued();
+      s_globals.m_queue->Wait(LOG_WRITER_IDLE_MS);
+    }
+  }
+};
+
 CLog::CLog()
 {}
 
 CLog::~CLog()
 {}
 
+CLog::CLogGlobals::~CLogGlobals()
+{
+  // a writer thread still running may use the queue until the process is gone
+  if (!m_writer)
+    delete m_queue;
+}
+
 void CLog::Close()
 {
+  SetAsync(false);
+
   CSingleLock waitLock(s_globals.critSec);
   s_globals.m_platform.CloseLogFile();
   s_globals.m_repeatLine.clear();
@@ -73,14 +111,55 @@ void CLog::LogFunction(int loglevel, const char* functionName, const char* forma
   }
 }
 
-void CLog::LogString(int logLevel, const std::string& logString)
+void CLog::LogString(int logLevel, std::string logString)
+{
+  LogRecord record;
+  record.level = logLevel;
+  record.threadId = (uint64_t)CThread::GetCurrentThreadId();
+  s_globals.m_platform.GetCurrentLocalTime(record.hour, record.minute, record.second);
+  record.line.swap(logString);
+
+  if (s_globals.m_async)
+  {
+    // a full queue drops the line, it is counted and noted by the writer
+    s_globals.m_queue->Push(record);
+    return;
+  }
+
+  CSingleLock waitLock(s_globals.critSec);
+  // lines queued while switching back to writing synchronously go first
+  WriteQueued();
+  WriteRecord(record);
+}
+
+void CLog::WriteQueued()
 {
   CSingleLock waitLock(s_globals.critSec);
-  std::string strData(logString);
+  if (!s_globals.m_queue)
+    return;
+
+  LogRecord record;
+  while (s_globals.m_queue->Pop(record))
+    WriteRecord(record);
+
+  uint64_t dropped = s_globals.m_queue->GetDropped();
+  if (dropped != s_globals.m_dropped)
+  {
+    std::string strData = StringUtils::Format("%" PRIu64" log lines dropped, they were logged faster than they could be written.",
+                                              dropped - s_globals.m_dropped);
+    s_globals.m_dropped = dropped;
+    s_globals.m_platform.GetCurrentLocalTime(record.hour, record.minute, record.second);
+    WriteLogString(LOGWARNING, strData, (uint64_t)CThread::GetCurrentThreadId(), record.hour, record.minute, record.second);
+  }
+}
+
+void CLog::WriteRecord(const LogRecord& record)
+{
+  std::string strData(record.line);
   StringUtils::TrimRight(strData);
   if (!strData.empty())
   {
-    if (s_globals.m_repeatLogLevel == logLevel && s_globals.m_repeatLine == strData)
+    if (s_globals.m_repeatLogLevel == record.level && s_globals.m_repeatLine == strData)
     {
       s_globals.m_repeatCount++;
       return;
@@ -90,19 +169,59 @@ void CLog::LogString(int logLevel, const std::string& logString)
       std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
                                                 s_globals.m_repeatCount);
       PrintDebugString(strData2);
-      WriteLogString(s_globals.m_repeatLogLevel, strData2);
+      WriteLogString(s_globals.m_repeatLogLevel, strData2, record.threadId, record.hour, record.minute, record.second);
       s_globals.m_repeatCount = 0;
     }
     
     s_globals.m_repeatLine = strData;
-    s_globals.m_repeatLogLevel = logLevel;
+    s_globals.m_repeatLogLevel = record.level;
 
     PrintDebugString(strData);
 
-    WriteLogString(logLevel, strData);
+    WriteLogString(record.level, strData, record.threadId, record.hour, record.minute, record.second);
   }
 }
 
+void CLog::SetAsync(bool async)
+{
+  CThread *writer = NULL;
+  {
+    CSingleLock waitLock(s_globals.critSec);
+    if (async == (s_globals.m_writer != NULL))
+      return;
+
+    if (async)
+    {
+      if (!s_globals.m_queue)
+        s_globals.m_queue = new CLogQueue(LOG_QUEUE_SIZE);
+      s_globals.m_writer = new CLogWriter();
+      s_globals.m_async = true;
+      s_globals.m_writer->Create();
+      return;
+    }
+
+    s_globals.m_async = false;
+    writer = s_globals.m_writer;
+    s_globals.m_writer = NULL;
+  }
+
+  // without holding the lock, the writer thread logs while stopping
+  static_cast<CLogWriter*>(writer)->Stop();
+  delete writer;
+  WriteQueued();
+}
+
+bool CLog::IsAsync()
+{
+  return s_globals.m_async;
+}
+
+uint64_t CLog::GetDroppedCount()
+{
+  CSingleLock waitLock(s_globals.critSec);
+  return s_globals.m_queue ? s_globals.m_queue->GetDropped() : 0;
+}
+
 bool CLog::Init(const std::string& path)
 {
   CSingleLock waitLock(s_globals.critSec);
@@ -196,7 +315,7 @@ void CLog::PrintDebugString(const std::string& line)
 #endif // defined(_DEBUG) || defined(PROFILE)
 }
 
-bool CLog::WriteLogString(int logLevel, const std::string& logString)
+bool CLog::WriteLogString(int logLevel, const std::string& logString, uint64_t threadId, int hour, int minute, int second)
 {
   static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%" PRIu64" %7s: ";
 
@@ -204,14 +323,11 @@ bool CLog::WriteLogString(int logLevel, const std::string& logString)
   /* fixup newline alignment, number of spaces should equal prefix length */
   StringUtils::Replace(strData, "\n", "\n                                            ");
 
-  int hour, minute, second;
-  s_globals.m_platform.GetCurrentLocalTime(hour, minute, second);
-  
   strData = StringUtils::Format(prefixFormat,
                                   hour,
                                   minute,
                                   second,
-                                  (uint64_t)CThread::GetCurrentThreadId(),
+                                  threadId,
                                   levelNames[logLevel]) + strData;
 
   return s_globals.m_platform.WriteStringToLog(strData);
@@ -20,6 +20,8 @@
  *
  */
 
+#include <atomic>
+#include <stdint.h>
 #include <string>
 
 #if defined(TARGET_POSIX)
@@ -36,6 +38,10 @@ typedef class CWin32InterfaceForCLog PlatformInterfaceForCLog;
 
 #include "utils/params_check_macros.h"
 
+class CLogQueue;
+class CThread;
+struct LogRecord;
+
 class CLog
 {
 public:
@@ -52,24 +58,46 @@ public:
   static int  GetLogLevel();
   static void SetExtraLogLevels(int level);
   static bool IsLogLevelLogged(int loglevel);
+  /*!
+   \brief Write the log from a separate thread.
+
+   Log lines are queued and the calling thread never waits for the log file.
+   If lines are logged faster than they can be written, the queue is bounded
+   and lines are dropped, which is noted in the log.
+   */
+  static void SetAsync(bool async);
+  static bool IsAsync();
+  /*!
+   \brief Number of log lines dropped because the queue was full
+   */
+  static uint64_t GetDroppedCount();
 
 protected:
+  friend class CLogWriter;
+
   class CLogGlobals
   {
   public:
-    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0) {}
-    ~CLogGlobals() {}
+    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0),
+                        m_queue(NULL), m_writer(NULL), m_dropped(0), m_async(false) {}
+    ~CLogGlobals();
     PlatformInterfaceForCLog m_platform;
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
     int         m_extraLogLevels;
+    CLogQueue  *m_queue;
+    CThread    *m_writer;
+    uint64_t    m_dropped;    ///< dropped lines already noted in the log
+    std::atomic<bool> m_async;
     CCriticalSection critSec;
   };
   class CLogGlobals m_globalInstance; // used as static global variable
-  static void LogString(int logLevel, const std::string& logString);
-  static bool WriteLogString(int logLevel, const std::string& logString);
+  static void LogString(int logLevel, std::string logString);
+  static void WriteRecord(const LogRecord& record);
+  static void WriteQueued();
+  static bool WriteLogString(int logLevel, const std::string& logString, uint64_t threadId, int hour, int minute, int second);
 };
 
 
@@ -18,6 +18,8 @@
  *
  */
 
+#include <atomic>
+
 #include "utils/JobManager.h"
 #include "settings/Settings.h"
 #include "utils/SystemInfo.h"
@@ -71,10 +73,17 @@ TEST_F(TestJobManager, CancelJob)
 
 namespace
 {
+int GetWorkerSlot()
+{
+  const CJobWorker *worker = dynamic_cast<const CJobWorker *>(CThread::GetCurrentThread());
+  return worker ? (int)worker->GetSlot() : -1;
+}
+
 struct JobControlPackage
 {
   JobControlPackage() :
-    ready (false)
+    ready (false),
+    slot (-1)
   {
     // We're not ready to wait yet
     jobCreatedMutex.lock();
@@ -86,6 +95,7 @@ struct JobControlPackage
   }
 
   bool ready;
+  int slot; // of the worker that runs the job
   XbmcThreads::ConditionVariable jobCreatedCond;
   CCriticalSection jobCreatedMutex;
 };
@@ -119,6 +129,7 @@ public:
     {
       CSingleLock lock(m_package.jobCreatedMutex);
     
+      m_package.slot = GetWorkerSlot();
       m_package.ready = true;
       m_package.jobCreatedCond.notifyAll();
     }
@@ -141,10 +152,10 @@ private:
 };
 
 BroadcastingJob *
-WaitForJobToStartProcessing(CJob::PRIORITY priority, JobControlPackage &package)
+WaitForJobToStartProcessing(CJob::PRIORITY priority, JobControlPackage &package, const void *affinity = NULL)
 {
   BroadcastingJob* job = new BroadcastingJob(package);
-  CJobManager::GetInstance().AddJob(job, NULL, priority);
+  CJobManager::GetInstance().AddJob(job, NULL, priority, affinity);
 
   // We're now ready to wait, wait and then unblock once ready
   while (!package.ready)
@@ -177,3 +188,111 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+namespace
+{
+class CountingJob : public CJob
+{
+public:
+  const char * GetType() const
+  {
+    return "CountingJob";
+  }
+
+  bool DoWork()
+  {
+    return true;
+  }
+};
+}
+
+TEST_F(TestJobManager, JobStats)
+{
+  CJobManager::JobStats stats;
+  CJobManager::GetInstance().GetJobStats(stats);
+  uint64_t added = stats["CountingJob"].added;
+  uint64_t completed = stats["CountingJob"].completed;
+
+  for (int i = 0; i < 10; i++)
+    CJobManager::GetInstance().AddJob(new CountingJob(), NULL, CJob::PRIORITY_NORMAL);
+
+  // give the workers up to 5 seconds to get through the jobs
+  for (int i = 0; i < 500; i++)
+  {
+    CJobManager::GetInstance().GetJobStats(stats);
+    if (stats["CountingJob"].completed == completed + 10)
+      break;
+    XbmcThreads::ThreadSleep(10);
+  }
+
+  EXPECT_EQ(added + 10, stats["CountingJob"].added);
+  EXPECT_EQ(completed + 10, stats["CountingJob"].completed);
+  EXPECT_EQ(0, stats["CountingJob"].queued);
+}
+
+namespace
+{
+class SlotRecordingJob : public CJob
+{
+public:
+  SlotRecordingJob(std::atomic<int> &slot) : m_slot(slot) {}
+
+  const char * GetType() const
+  {
+    return "SlotRecordingJob";
+  }
+
+  bool DoWork()
+  {
+    m_slot = GetWorkerSlot();
+    return true;
+  }
+
+private:
+  std::atomic<int> &m_slot;
+};
+}
+
+TEST_F(TestJobManager, AffinityKeepsSlot)
+{
+  int keys[2];
+  CJobManager &manager = CJobManager::GetInstance();
+  EXPECT_EQ(manager.GetAffinitySlot(&keys[0]), manager.GetAffinitySlot(&keys[0]));
+
+  // a job is run by the worker of its slot when that one is free
+  JobControlPackage package;
+  BroadcastingJob *job (WaitForJobToStartProcessing(CJob::PRIORITY_NORMAL, package, &keys[1]));
+  EXPECT_LE(0, package.slot);
+  job->FinishAndStopBlocking();
+}
+
+TEST_F(TestJobManager, BusyWorkerJobIsStolen)
+{
+  CJobManager &manager = CJobManager::GetInstance();
+
+  // keep a worker busy
+  JobControlPackage package;
+  BroadcastingJob *job (WaitForJobToStartProcessing(CJob::PRIORITY_NORMAL, package));
+  ASSERT_LE(0, package.slot);
+
+  // pin a job to the slot of the busy worker
+  static char keys[64 * 16];
+  const void *affinity = NULL;
+  for (size_t i = 0; i < sizeof(keys) && !affinity; i++)
+  {
+    if (manager.GetAffinitySlot(&keys[i]) == (unsigned int)package.slot)
+      affinity = &keys[i];
+  }
+  ASSERT_TRUE(affinity != NULL);
+
+  std::atomic<int> slot(-1);
+  manager.AddJob(new SlotRecordingJob(slot), NULL, CJob::PRIORITY_NORMAL, affinity);
+
+  // another worker has to take it from the busy worker's queue
+  for (int i = 0; i < 500 && slot < 0; i++)
+    XbmcThreads::ThreadSleep(10);
+  EXPECT_LE(0, slot);
+  EXPECT_NE(package.slot, slot);
+
+  job->FinishAndStopBlocking();
+}
@@ -0,0 +1,106 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/LatencyHistogram.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestLatencyHistogram, Buckets)
+{
+  // small values are exact
+  for (uint64_t i = 0; i < 16; i++)
+  {
+    EXPECT_EQ(i, CLatencyHistogram::GetBucket(i));
+    EXPECT_EQ(i, CLatencyHistogram::GetUpperBound(CLatencyHistogram::GetBucket(i)));
+  }
+
+  // larger values are within 1/8th
+  uint64_t values[] = { 16, 17, 1000, 16667, 40000, 1000000, 123456789, UINT64_MAX };
+  for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+  {
+    unsigned int bucket = CLatencyHistogram::GetBucket(values[i]);
+    ASSERT_GT(CLatencyHistogram::BUCKETS, bucket);
+    uint64_t upper = CLatencyHistogram::GetUpperBound(bucket);
+    EXPECT_LE(values[i], upper);
+    EXPECT_GE(values[i] / 8, upper - values[i]);
+    EXPECT_LT(CLatencyHistogram::GetUpperBound(bucket - 1), values[i]);
+  }
+  EXPECT_EQ(CLatencyHistogram::BUCKETS - 1, CLatencyHistogram::GetBucket(UINT64_MAX));
+}
+
+TEST(TestLatencyHistogram, Summary)
+{
+  CLatencyHistogram histogram(50000);
+  for (uint64_t i = 1; i <= 1000; i++)
+    histogram.Record(i * 100);
+
+  CLatencyHistogram::Summary summary;
+  histogram.GetSummary(summary);
+  EXPECT_EQ(1000U, summary.count);
+  EXPECT_EQ(501U, summary.stalls);
+  EXPECT_EQ(50000U, summary.threshold);
+  EXPECT_EQ(50050U, summary.mean);
+  EXPECT_EQ(100000U, summary.max);
+
+  // percentiles are the upper bound of their bucket
+  EXPECT_LE(50000U, summary.p50);
+  EXPECT_GE(50000U * 9 / 8, summary.p50);
+  EXPECT_LE(90000U, summary.p90);
+  EXPECT_GE(90000U * 9 / 8, summary.p90);
+  EXPECT_LE(99000U, summary.p99);
+  EXPECT_GE(100000U, summary.p999);
+
+  uint64_t count = 0;
+  for (size_t i = 0; i < summary.buckets.size(); i++)
+  {
+    if (i > 0)
+    {
+      EXPECT_LT(summary.buckets[i - 1].upperBound, summary.buckets[i].upperBound);
+    }
+    count += summary.buckets[i].count;
+  }
+  EXPECT_EQ(1000U, count);
+
+  histogram.Reset();
+  histogram.GetSummary(summary);
+  EXPECT_EQ(0U, summary.count);
+  EXPECT_EQ(0U, summary.stalls);
+  EXPECT_EQ(0U, summary.p50);
+  EXPECT_TRUE(summary.buckets.empty());
+}
+
+TEST(TestLatencyHistogram, Registry)
+{
+  CLatencyHistogram &histogram = CLatencyHistograms::Get().GetHistogram("test.registry", 10);
+  EXPECT_EQ(&histogram, &CLatencyHistograms::Get().GetHistogram("test.registry", 20));
+  histogram.Record(15);
+
+  std::map<std::string, CLatencyHistogram::Summary> summaries;
+  CLatencyHistograms::Get().GetSummaries(summaries);
+  ASSERT_TRUE(summaries.find("test.registry") != summaries.end());
+  EXPECT_EQ(1U, summaries["test.registry"].count);
+  EXPECT_EQ(1U, summaries["test.registry"].stalls);
+
+  EXPECT_FALSE(CLatencyHistograms::Get().Reset("test.unknown"));
+  EXPECT_TRUE(CLatencyHistograms::Get().Reset("test.registry"));
+  summaries.clear();
+  CLatencyHistograms::Get().GetSummaries(summaries);
+  EXPECT_EQ(0U, summaries["test.registry"].count);
+}
@@ -0,0 +1,147 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/Thread.h"
+#include "utils/LogQueue.h"
+#include "utils/StringUtils.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+LogRecord MakeRecord(int level, const std::string &line)
+{
+  LogRecord record;
+  record.level = level;
+  record.threadId = 0;
+  record.hour = record.minute = record.second = 0;
+  record.line = line;
+  return record;
+}
+
+class CLogProducer : public IRunnable
+{
+public:
+  CLogProducer(CLogQueue &queue, int id, int count) : m_queue(queue), m_id(id), m_count(count) {}
+  virtual void Run()
+  {
+    for (int i = 0; i < m_count; i++)
+    {
+      LogRecord record = MakeRecord(m_id, StringUtils::Format("%d", i));
+      while (!m_queue.Push(record))
+        XbmcThreads::ThreadSleep(0);
+    }
+  }
+private:
+  CLogQueue &m_queue;
+  int m_id;
+  int m_count;
+};
+}
+
+TEST(TestLogQueue, FirstInFirstOut)
+{
+  CLogQueue queue(4);
+  EXPECT_EQ(4U, queue.GetCapacity());
+
+  LogRecord record;
+  EXPECT_FALSE(queue.Pop(record));
+
+  for (int i = 0; i < 10; i++)
+  {
+    LogRecord in = MakeRecord(i, StringUtils::Format("line %d", i));
+    EXPECT_TRUE(queue.Push(in));
+    EXPECT_TRUE(in.line.empty());
+    ASSERT_TRUE(queue.Pop(record));
+    EXPECT_EQ(i, record.level);
+    EXPECT_EQ(StringUtils::Format("line %d", i), record.line);
+  }
+  EXPECT_FALSE(queue.Pop(record));
+}
+
+TEST(TestLogQueue, DropsWhenFull)
+{
+  CLogQueue queue(3);
+  ASSERT_EQ(4U, queue.GetCapacity());
+
+  for (int i = 0; i < 6; i++)
+  {
+    LogRecord in = MakeRecord(i, "line");
+    EXPECT_EQ(i < 4, queue.Push(in));
+  }
+  EXPECT_EQ(2U, queue.GetDropped());
+
+  // the oldest lines are kept
+  LogRecord record;
+  for (int i = 0; i < 4; i++)
+  {
+    ASSERT_TRUE(queue.Pop(record));
+    EXPECT_EQ(i, record.level);
+  }
+  EXPECT_FALSE(queue.Pop(record));
+
+  LogRecord in = MakeRecord(10, "line");
+  EXPECT_TRUE(queue.Push(in));
+  EXPECT_EQ(2U, queue.GetDropped());
+}
+
+TEST(TestLogQueue, MultipleProducers)
+{
+  const int producers = 4;
+  const int count = 20000;
+  CLogQueue queue(64);
+
+  std::vector<CLogProducer*> runnables;
+  std::vector<CThread*> threads;
+  for (int i = 0; i < producers; i++)
+  {
+    runnables.push_back(new CLogProducer(queue, i, count));
+    threads.push_back(new CThread(runnables.back(), "TestLogProducer"));
+    threads.back()->Create();
+  }
+
+  // every producer's lines arrive complete and in order
+  std::vector<int> next(producers, 0);
+  int received = 0;
+  LogRecord record;
+  while (received < producers * count)
+  {
+    if (!queue.Pop(record))
+    {
+      queue.Wait(10);
+      continue;
+    }
+    ASSERT_LE(0, record.level);
+    ASSERT_GT(producers, record.level);
+    ASSERT_EQ(StringUtils::Format("%d", next[record.level]), record.line);
+    next[record.level]++;
+    received++;
+  }
+  EXPECT_FALSE(queue.Pop(record));
+
+  for (int i = 0; i < producers; i++)
+  {
+    threads[i]->StopThread(true);
+    delete threads[i];
+    delete runnables[i];
+  }
+}
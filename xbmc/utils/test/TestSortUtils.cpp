@@ -19,10 +19,81 @@
  */
 
 #include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+
 #include "gtest/gtest.h"
 
+namespace
+{
+// the order of the sort label of items before SortUtils used precomputed keys
+class ReferenceCompare
+{
+public:
+  ReferenceCompare(const std::vector<SortItem> &items, const std::vector<std::wstring> &labels,
+                   bool descending, bool handleFolder)
+    : m_items(items), m_labels(labels), m_descending(descending), m_handleFolder(handleFolder)
+  { }
+
+  bool operator()(size_t left, size_t right) const
+  {
+    SortSpecial leftSpecial = (SortSpecial)m_items[left].at(FieldSortSpecial).asInteger();
+    SortSpecial rightSpecial = (SortSpecial)m_items[right].at(FieldSortSpecial).asInteger();
+    if (leftSpecial != rightSpecial)
+      return leftSpecial == SortSpecialOnTop || rightSpecial == SortSpecialOnBottom;
+    if (leftSpecial != SortSpecialNone)
+      return false;
+
+    bool leftFolder = m_items[left].at(FieldFolder).asBoolean();
+    bool rightFolder = m_items[right].at(FieldFolder).asBoolean();
+    if (m_handleFolder && leftFolder != rightFolder)
+      return leftFolder;
+
+    int64_t result = StringUtils::AlphaNumericCompare(m_labels[left].c_str(), m_labels[right].c_str());
+    return m_descending ? result > 0 : result < 0;
+  }
+
+private:
+  const std::vector<SortItem> &m_items;
+  const std::vector<std::wstring> &m_labels;
+  bool m_descending;
+  bool m_handleFolder;
+};
+
+// a music library with many items by the same artist, on the same album, ...
+std::vector<SortItem> CreateLibrary(size_t count)
+{
+  const char *words[] = { "the", "Love", "night", "Blue", "a", "Song", "of", "DREAM", "09", "2", "10", "(live)", "mix" };
+  const size_t wordCount = sizeof(words) / sizeof(words[0]);
+
+  srand(42);
+  std::vector<SortItem> items(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    std::string label;
+    for (int word = rand() % 4; word >= 0; word--)
+      label += std::string(words[rand() % wordCount]) + " ";
+    label += StringUtils::Format("%d", rand() % 100);
+
+    SortItem &item = items[i];
+    item[FieldLabel] = label;
+    item[FieldTitle] = label;
+    item[FieldArtist] = StringUtils::Format("Artist %d", rand() % 500);
+    item[FieldAlbum] = StringUtils::Format("Album %d", rand() % 4000);
+    item[FieldYear] = 1950 + rand() % 65;
+    item[FieldTrackNumber] = 1 + rand() % 15;
+    item[FieldFolder] = rand() % 10 == 0;
+    item[FieldSortSpecial] = rand() % 1000 == 0 ? SortSpecialOnTop : (rand() % 1000 == 0 ? SortSpecialOnBottom : SortSpecialNone);
+  }
+  return items;
+}
+}
+
 TEST(TestSortUtils, Sort_SortBy)
 {
   SortItems items;
@@ -131,3 +202,112 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+TEST(TestSortUtils, Sort_Indices)
+{
+  // enough items to sort in parallel
+  const size_t count = 20000;
+  std::vector<SortItem> items = CreateLibrary(count);
+
+  for (int i = 0; i < 4; i++)
+  {
+    SortDescription desc;
+    desc.sortBy = SortByLabel;
+    desc.sortOrder = (i & 1) ? SortOrderDescending : SortOrderAscending;
+    desc.sortAttributes = (i & 2) ? SortAttributeIgnoreFolders : SortAttributeNone;
+
+    std::vector<size_t> order;
+    std::vector<std::wstring> labels;
+    SortUtils::Sort(desc, count, [&items](size_t index, const Fields &fields, SortItem &item)
+    {
+      item = items[index];
+    }, order, &labels);
+    ASSERT_EQ(count, order.size());
+    ASSERT_EQ(count, labels.size());
+
+    std::vector<size_t> expected;
+    for (size_t index = 0; index < count; index++)
+      expected.push_back(index);
+    std::stable_sort(expected.begin(), expected.end(),
+                     ReferenceCompare(items, labels, desc.sortOrder == SortOrderDescending, (i & 2) == 0));
+    EXPECT_EQ(expected, order);
+  }
+}
+
+TEST(TestSortUtils, Sort_IndicesLimits)
+{
+  std::vector<SortItem> items = CreateLibrary(100);
+
+  SortDescription desc;
+  desc.sortBy = SortByTitle;
+  std::vector<size_t> all;
+  SortUtils::Sort(desc, items.size(), [&items](size_t index, const Fields &fields, SortItem &item)
+  {
+    item = items[index];
+  }, all);
+
+  desc.limitStart = 10;
+  desc.limitEnd = 30;
+  std::vector<size_t> limited;
+  SortUtils::Sort(desc, items.size(), [&items](size_t index, const Fields &fields, SortItem &item)
+  {
+    item = items[index];
+  }, limited);
+
+  ASSERT_EQ(20U, limited.size());
+  EXPECT_TRUE(std::equal(limited.begin(), limited.end(), all.begin() + 10));
+}
+
+// Sorting 50,000 items by their precomputed keys against the way CFileItemList was sorted
+// before. Run it with --gtest_also_run_disabled_tests
+TEST(TestSortUtils, DISABLED_Benchmark)
+{
+  const size_t count = 50000;
+  std::vector<SortItem> items = CreateLibrary(count);
+
+  SortDescription desc;
+  desc.sortBy = SortByArtist;
+
+  int64_t start = CurrentHostCounter();
+  std::vector<size_t> order;
+  std::vector<std::wstring> labels;
+  SortUtils::Sort(desc, count, [&items](size_t index, const Fields &fields, SortItem &item)
+  {
+    item = items[index];
+  }, order, &labels);
+  double keys = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  // the way CFileItemList was sorted before: a SortItem per item, compared through the
+  // maps. The sort labels are taken from above, so preparing them isn't included here
+  start = CurrentHostCounter();
+  SortItems sortItems(count);
+  for (size_t index = 0; index < count; index++)
+  {
+    sortItems[index] = SortItemPtr(new SortItem(items[index]));
+    (*sortItems[index])[FieldSort] = labels[index];
+    (*sortItems[index])[FieldId] = (int64_t)index;
+  }
+  std::stable_sort(sortItems.begin(), sortItems.end(), [](const SortItemPtr &left, const SortItemPtr &right)
+  {
+    SortSpecial leftSpecial = (SortSpecial)left->find(FieldSortSpecial)->second.asInteger();
+    SortSpecial rightSpecial = (SortSpecial)right->find(FieldSortSpecial)->second.asInteger();
+    if (leftSpecial != rightSpecial)
+      return leftSpecial == SortSpecialOnTop || rightSpecial == SortSpecialOnBottom;
+    if (leftSpecial != SortSpecialNone)
+      return false;
+    bool leftFolder = left->find(FieldFolder)->second.asBoolean();
+    bool rightFolder = right->find(FieldFolder)->second.asBoolean();
+    if (leftFolder != rightFolder)
+      return leftFolder;
+    std::wstring labelLeft = left->find(FieldSort)->second.asWideString();
+    std::wstring labelRight = right->find(FieldSort)->second.asWideString();
+    return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
+  });
+  double legacy = (double)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+
+  for (size_t index = 0; index < count; index++)
+    ASSERT_EQ(order[index], (size_t)sortItems[index]->at(FieldId).asInteger());
+
+  std::cout << count << " items by artist: sort keys " << keys << " ms (including labels), "
+            << "SortItem comparison " << legacy << " ms (excluding labels)" << std::endl;
+}
@@ -0,0 +1,117 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StringPool.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestStringPool, Intern)
+{
+  bool owned;
+  const std::string *first = CStringPool::Get().Intern("video/x-matroska", owned);
+  EXPECT_FALSE(owned);
+  const std::string *second = CStringPool::Get().Intern(std::string("video/") + "x-matroska", owned);
+  EXPECT_FALSE(owned);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ("video/x-matroska", *first);
+
+  EXPECT_EQ(&CStringPool::Empty(), CStringPool::Get().Intern("", owned));
+  EXPECT_FALSE(owned);
+
+  // long strings are not worth pooling
+  std::string path(CStringPool::MAX_LENGTH + 1, 'x');
+  const std::string *copy = CStringPool::Get().Intern(path, owned);
+  EXPECT_TRUE(owned);
+  EXPECT_EQ(path, *copy);
+  delete copy;
+}
+
+TEST(TestStringPool, PooledString)
+{
+  CPooledString empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ("", empty);
+
+  CPooledString icon("DefaultFolder.png");
+  CPooledString other(std::string("DefaultFolder.png"));
+  EXPECT_EQ(&icon.str(), &other.str());
+  EXPECT_TRUE(icon == other);
+  EXPECT_TRUE(icon == "DefaultFolder.png");
+  EXPECT_TRUE(icon != "DefaultFile.png");
+  EXPECT_EQ(17U, icon.size());
+  EXPECT_STREQ("DefaultFolder.png", icon.c_str());
+
+  const std::string &ref = icon;
+  EXPECT_EQ("DefaultFolder.png", ref);
+
+  other = "DefaultFile.png";
+  EXPECT_EQ("DefaultFile.png", other.str());
+  EXPECT_EQ("DefaultFolder.png", icon.str());
+
+  icon.clear();
+  EXPECT_TRUE(icon.empty());
+}
+
+TEST(TestStringPool, OwnedString)
+{
+  std::string path(CStringPool::MAX_LENGTH * 2, 'y');
+  CPooledString owned(path);
+  EXPECT_EQ(path, owned.str());
+
+  CPooledString copy(owned);
+  EXPECT_NE(&owned.str(), &copy.str());
+  EXPECT_TRUE(owned == copy);
+
+  CPooledString moved(std::move(copy));
+  EXPECT_EQ(path, moved.str());
+  EXPECT_TRUE(copy.empty());
+
+  // assigning a string to itself keeps it
+  moved = moved.str();
+  EXPECT_EQ(path, moved.str());
+
+  owned = "short";
+  EXPECT_EQ("short", owned.str());
+}
+
+TEST(TestStringPool, FullPool)
+{
+  CStringPool pool;
+  bool owned;
+  const std::string *icon = pool.Intern("DefaultVideo.png", owned);
+  EXPECT_FALSE(owned);
+  // pools don't share their strings
+  EXPECT_NE(icon, CStringPool::Get().Intern("DefaultVideo.png", owned));
+
+  for (size_t i = pool.Size(); i < CStringPool::MAX_STRINGS; i++)
+  {
+    pool.Intern(std::to_string(i) + ".png", owned);
+    EXPECT_FALSE(owned);
+  }
+
+  // a full pool still has the strings it's got, and copies new ones
+  EXPECT_EQ(icon, pool.Intern("DefaultVideo.png", owned));
+  EXPECT_FALSE(owned);
+  const std::string *copy = pool.Intern("DefaultAudio.png", owned);
+  EXPECT_TRUE(owned);
+  EXPECT_EQ("DefaultAudio.png", *copy);
+  delete copy;
+  EXPECT_EQ(CStringPool::MAX_STRINGS, pool.Size());
+}
@@ -0,0 +1,179 @@
+/*
+ *      Copyright (C) 2015 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/Thread.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/Trace.h"
+#include "utils/Variant.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+void TracedWork()
+{
+  TRACE_SCOPE("test", "Outer");
+  {
+    TRACE_SCOPE_ARG("test", "Inner", "argument");
+    XbmcThreads::ThreadSleep(1);
+  }
+}
+
+class CTracedThread : public CThread
+{
+public:
+  CTracedThread(const char *name = "TestTraceThread") : CThread(name) {}
+protected:
+  virtual void Process() { TracedWork(); }
+};
+
+CVariant ParseTrace()
+{
+  std::string trace = CTracer::Get().GetTrace();
+  return CJSONVariantParser::Parse((const unsigned char *)trace.c_str(), trace.size());
+}
+
+std::vector<CVariant> GetEvents(const CVariant &trace, const std::string &name)
+{
+  std::vector<CVariant> events;
+  const CVariant &all = trace["traceEvents"];
+  for (CVariant::const_iterator_array it = all.begin_array(); it != all.end_array(); ++it)
+  {
+    if ((*it)["ph"].asString() == "X" && (*it)["name"].asString() == name)
+      events.push_back(*it);
+  }
+  return events;
+}
+}
+
+TEST(TestTrace, Disabled)
+{
+  CTracer::Get().Start();
+  CTracer::Get().Stop();
+  TracedWork();
+
+  CVariant trace = ParseTrace();
+  ASSERT_TRUE(trace.isObject());
+  EXPECT_TRUE(GetEvents(trace, "Outer").empty());
+}
+
+TEST(TestTrace, ScopesRecorded)
+{
+  CTracer::Get().Start();
+  TracedWork();
+  CTracer::Get().Stop();
+  TracedWork(); // after stopping, not recorded
+
+  CVariant trace = ParseTrace();
+  std::vector<CVariant> outer = GetEvents(trace, "Outer");
+  std::vector<CVariant> inner = GetEvents(trace, "Inner");
+  ASSERT_EQ(1U, outer.size());
+  ASSERT_EQ(1U, inner.size());
+
+  EXPECT_EQ("test", outer[0]["cat"].asString());
+  EXPECT_EQ("argument", inner[0]["args"]["arg"].asString());
+  EXPECT_EQ(outer[0]["tid"].asInteger(), inner[0]["tid"].asInteger());
+  EXPECT_LE(outer[0]["ts"].asDouble(), inner[0]["ts"].asDouble());
+  EXPECT_GE(outer[0]["dur"].asDouble(), inner[0]["dur"].asDouble());
+  EXPECT_LE(1000.0, inner[0]["dur"].asDouble());
+}
+
+TEST(TestTrace, Threads)
+{
+  CTracer::Get().Start();
+  TracedWork();
+  CTracedThread thread;
+  thread.Create();
+  thread.StopThread(true);
+  CTracer::Get().Stop();
+
+  CVariant trace = ParseTrace();
+  std::vector<CVariant> outer = GetEvents(trace, "Outer");
+  ASSERT_EQ(2U, outer.size());
+  EXPECT_NE(outer[0]["tid"].asInteger(), outer[1]["tid"].asInteger());
+
+  // threads are named in the trace
+  int64_t tid = -1;
+  const CVariant &all = trace["traceEvents"];
+  for (CVariant::const_iterator_array it = all.begin_array(); it != all.end_array(); ++it)
+  {
+    if ((*it)["ph"].asString() == "M" && (*it)["name"].asString() == "thread_name" &&
+        (*it)["args"]["name"].asString() == "TestTraceThread")
+      tid = (*it)["tid"].asInteger();
+  }
+  EXPECT_TRUE(tid == outer[0]["tid"].asInteger() || tid == outer[1]["tid"].asInteger());
+}
+
+TEST(TestTrace, ExitedThreadsReused)
+{
+  CTracer::Get().Start();
+  // more threads than there are buffers, one after the other
+  for (int i = 0; i < 200; i++)
+  {
+    CTracedThread thread;
+    thread.Create();
+    thread.StopThread(true);
+  }
+  CTracedThread last("TestTraceLastThread");
+  last.Create();
+  last.StopThread(true);
+  CTracer::Get().Stop();
+
+  CVariant trace = ParseTrace();
+  int64_t tid = -1;
+  const CVariant &all = trace["traceEvents"];
+  for (CVariant::const_iterator_array it = all.begin_array(); it != all.end_array(); ++it)
+  {
+    if ((*it)["ph"].asString() == "M" && (*it)["name"].asString() == "thread_name" &&
+        (*it)["args"]["name"].asString() == "TestTraceLastThread")
+      tid = (*it)["tid"].asInteger();
+  }
+  ASSERT_NE(-1, tid);
+
+  std::vector<CVariant> outer = GetEvents(trace, "Outer");
+  bool traced = false;
+  for (std::vector<CVariant>::const_iterator it = outer.begin(); it != outer.end(); ++it)
+    traced |= (*it)["tid"].asInteger() == tid;
+  EXPECT_TRUE(traced);
+}
+
+TEST(TestTrace, BufferWraps)
+{
+  static const TracePoint point = { "test", "Wrap" };
+  CTraceBuffer buffer(4, "test", 0);
+  for (int i = 0; i < 10; i++)
+    buffer.Record(&point, NULL, i, 1);
+
+  std::vector<TraceEvent> events;
+  EXPECT_EQ(10U, buffer.GetEvents(0, events));
+  ASSERT_EQ(4U, events.size());
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    EXPECT_EQ(&point, events[i].point);
+    EXPECT_EQ((int64_t)(6 + i), events[i].start);
+  }
+
+  events.clear();
+  EXPECT_EQ(10U, buffer.GetEvents(8, events));
+  ASSERT_EQ(2U, events.size());
+  EXPECT_EQ(8, events[0].start);
+}
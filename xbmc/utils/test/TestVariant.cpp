@@ -348,3 +348,114 @@ TEST(TestVariant, isMember)
   EXPECT_TRUE(a.isMember("key1"));
   EXPECT_FALSE(a.isMember("key2"));
 }
+
+TEST(TestVariant, MapOrder)
+{
+  CVariant a;
+  a["movieid"] = 1;
+  a["title"] = "title";
+  a["art"] = CVariant(CVariant::VariantTypeObject);
+  a["year"] = 2015;
+  a["genre"] = CVariant(CVariant::VariantTypeArray);
+  a["title"] = "other title";
+
+  const char *keys[] = { "art", "genre", "movieid", "title", "year" };
+  unsigned int count = 0;
+  for (CVariant::const_iterator_map it = a.begin_map(); it != a.end_map(); ++it, ++count)
+  {
+    ASSERT_LT(count, sizeof(keys) / sizeof(keys[0]));
+    EXPECT_EQ(keys[count], it->first);
+  }
+  EXPECT_EQ(5U, count);
+  EXPECT_STREQ("other title", a["title"].c_str());
+}
+
+TEST(TestVariant, MapMembersStayInPlace)
+{
+  CVariant a;
+  CVariant &first = a["m"];
+  first = "first";
+
+  // members before and after, enough to need more storage
+  for (int i = 0; i < 200; i++)
+  {
+    a["a" + CVariant(i).asString()] = i;
+    a["z" + CVariant(i).asString()] = i;
+  }
+  a.erase("a10");
+  a["b"] = "reuses the erased value";
+
+  EXPECT_EQ(&first, &a["m"]);
+  EXPECT_STREQ("first", first.c_str());
+  EXPECT_EQ(401U, a.size());
+  EXPECT_EQ(199, a["z199"].asInteger());
+
+  CVariant b(a);
+  EXPECT_TRUE(a == b);
+  b["a11"] = 12;
+  EXPECT_FALSE(a == b);
+}
+
+TEST(TestVariant, ShortAndLongStrings)
+{
+  std::string lengths[] = { "", "a", "fifteen chars..", "sixteen chars...", std::string(100, 'x') };
+  for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+  {
+    CVariant a(lengths[i]);
+    CVariant b(a);
+    EXPECT_EQ(lengths[i], a.asString());
+    EXPECT_EQ(lengths[i], b.asString());
+    EXPECT_EQ(lengths[i].size(), b.size());
+    EXPECT_STREQ(lengths[i].c_str(), b.c_str());
+    EXPECT_TRUE(a == b);
+
+    b.clear();
+    EXPECT_TRUE(b.empty());
+    EXPECT_STREQ("", b.c_str());
+  }
+
+  std::string nul("a\0b", 3);
+  CVariant a(nul.c_str(), nul.size());
+  EXPECT_EQ(3U, a.size());
+  EXPECT_EQ(nul, a.asString());
+  EXPECT_FALSE(a == CVariant("a"));
+
+  EXPECT_EQ(42, CVariant("42").asInteger());
+  EXPECT_FALSE(CVariant("false").asBoolean(true));
+  EXPECT_FALSE(CVariant("0").asBoolean(true));
+  EXPECT_TRUE(CVariant("00").asBoolean(false));
+}
+
+TEST(TestVariant, Move)
+{
+  CVariant a;
+  a["key"] = std::string(100, 'x');
+  CVariant b(std::move(a));
+  EXPECT_TRUE(a.isNull());
+  EXPECT_EQ(std::string(100, 'x'), b["key"].asString());
+
+  CVariant c("short");
+  c = std::move(b["key"]);
+  EXPECT_TRUE(b["key"].isNull());
+  EXPECT_EQ(100U, c.size());
+
+  // moving a member into its parent
+  CVariant d;
+  d["inner"]["value"] = 1;
+  d = std::move(d["inner"]);
+  EXPECT_EQ(1, d["value"].asInteger());
+
+  CVariant e;
+  e.push_back(std::move(d));
+  e.append(CVariant("appended"));
+  EXPECT_EQ(2U, e.size());
+  EXPECT_EQ(1, e[0]["value"].asInteger());
+  EXPECT_STREQ("appended", e[1].c_str());
+
+  // the shared null is never taken apart
+  CVariant f(std::move(c["missing"]));
+  EXPECT_TRUE(CVariant::ConstNullVariant.isNull());
+  CVariant g;
+  g = std::move(CVariant::ConstNullVariant);
+  EXPECT_EQ(CVariant::VariantTypeConstNull, CVariant::ConstNullVariant.type());
+}
@@ -18,12 +18,15 @@
  *
  */
 
+#include <algorithm>
+#include <iostream>
 #include <stdlib.h>
 #include "utils/log.h"
 #include "utils/RegExp.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include "CompileInfo.h"
 
 #include "test/TestUtils.h"
@@ -151,3 +154,76 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, Async)
+{
+  std::string logfile, logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+  CRegExp regex;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+  EXPECT_TRUE(XFILE::CFile::Exists(logfile));
+
+  CLog::SetAsync(true);
+  EXPECT_TRUE(CLog::IsAsync());
+  CLog::Log(LOGNOTICE, "first async message");
+  CLog::Log(LOGNOTICE, "repeated async message");
+  CLog::Log(LOGNOTICE, "repeated async message");
+  CLog::Log(LOGNOTICE, "last async message");
+  // everything queued is written when closing
+  CLog::Close();
+  EXPECT_FALSE(CLog::IsAsync());
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  EXPECT_TRUE(regex.RegComp("NOTICE: first async message.*NOTICE: repeated async message.*Previous line repeats 1 times.*NOTICE: last async message"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+// The cost of a line to the caller, with and without the writer thread. Run it with
+// --gtest_also_run_disabled_tests
+TEST_F(Testlog, DISABLED_Benchmark)
+{
+  const int count = 20000;
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  std::string logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  // time spent in the calling thread per line, the writer thread's cost isn't included
+  for (int async = 0; async < 2; async++)
+  {
+    CLog::SetAsync(async != 0);
+    int64_t worst = 0;
+    int64_t start = CurrentHostCounter();
+    for (int i = 0; i < count; i++)
+    {
+      int64_t call = CurrentHostCounter();
+      CLog::Log(LOGDEBUG, "benchmark line %d of %d, %s", i, count, "some more text to make it a typical debug line");
+      worst = std::max(worst, CurrentHostCounter() - call);
+    }
+    int64_t total = CurrentHostCounter() - start;
+    CLog::SetAsync(false);
+
+    std::cout << (async ? "async" : "sync") << ": "
+              << (double)total * 1000000000.0 / CurrentHostFrequency() / count << " ns per line, worst "
+              << (double)worst * 1000000.0 / CurrentHostFrequency() << " us, "
+              << CLog::GetDroppedCount() << " lines dropped" << std::endl;
+  }
+
+  CLog::Close();
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
@@ -49,15 +49,65 @@
 #include "TextureCache.h"
 #include "GUIUserMessages.h"
 #include "URL.h"
+#include "utils/CPUInfo.h"
+
+#include <algorithm>
 
 using namespace std;
 using namespace XFILE;
 using namespace ADDON;
 
+// concurrent directory stat()s, mostly waiting on the file system
+#define HASH_READERS   4
+// how long a batch of database writes may stay open
+#define BATCH_INTERVAL 1000
+
 namespace VIDEO
 {
+  /*! \brief A fast hash computed ahead of the scan
+   */
+  class CVideoHashPrefetch
+  {
+  public:
+    CVideoHashPrefetch(const std::string &directory, const std::vector<std::string> &excludes, bool recursive)
+      : directory(directory), excludes(excludes), recursive(recursive), cancelled(false), done(true)
+    {
+    }
+
+    std::string directory;
+    std::vector<std::string> excludes;
+    bool recursive;
+    std::string hash;
+    std::atomic<bool> cancelled;
+    CEvent done;
+  };
+
+  class CVideoHashJob : public CJob
+  {
+  public:
+    CVideoHashJob(const std::shared_ptr<CVideoHashPrefetch> &prefetch) : m_prefetch(prefetch) {}
+
+    virtual const char *GetType() const { return "videohash"; }
+
+    virtual bool DoWork()
+    {
+      if (!m_prefetch->cancelled)
+      {
+        if (m_prefetch->recursive)
+          m_prefetch->hash = CVideoInfoScanner::GetRecursiveFastHash(m_prefetch->directory, m_prefetch->excludes);
+        else
+          m_prefetch->hash = CVideoInfoScanner::GetFastHash(m_prefetch->directory, m_prefetch->excludes);
+      }
+      m_prefetch->done.Set();
+      return true;
+    }
+
+  private:
+    std::shared_ptr<CVideoHashPrefetch> m_prefetch;
+  };
 
   CVideoInfoScanner::CVideoInfoScanner()
+    : m_hashReaders(false, std::max(1, std::min(g_cpuInfo.getCPUCount(), HASH_READERS)), CJob::PRIORITY_LOW)
   {
     m_bStop = false;
     m_bRunning = false;
@@ -68,6 +118,8 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_pathHashesLoaded = false;
+    m_batchStart = 0;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
@@ -107,6 +159,12 @@ namespace VIDEO
 
       m_database.Open();
 
+      // look hashes up in memory rather than a query per directory, and
+      // write in transactions that span many items
+      m_pathHashesLoaded = m_database.GetPathHashes(m_pathHashes);
+      m_database.BeginBatch();
+      m_batchStart = XbmcThreads::SystemClockMillis();
+
       m_bCanInterrupt = true;
 
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Starting scan ..");
@@ -121,6 +179,8 @@ namespace VIDEO
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      PrefetchScanPaths();
+
       bool bCancelled = false;
       while (!bCancelled && !m_pathsToScan.empty())
       {
@@ -131,6 +191,7 @@ namespace VIDEO
          * occurs.
          */
         std::string directory = *m_pathsToScan.begin();
+        CommitBatch();
         if (!CDirectory::Exists(directory))
         {
           /*
@@ -143,8 +204,15 @@ namespace VIDEO
         }
         else if (!DoScan(directory))
           bCancelled = true;
+
+        CommitBatchIfDue();
       }
 
+      CancelPrefetch();
+      m_database.CommitBatch();
+      m_pathHashes.clear();
+      m_pathHashesLoaded = false;
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -166,6 +234,10 @@ namespace VIDEO
     catch (...)
     {
       CLog::Log(LOGERROR, "VideoInfoScanner: Exception while scanning.");
+      CancelPrefetch();
+      m_database.CommitBatch();
+      m_pathHashes.clear();
+      m_pathHashesLoaded = false;
     }
     
     m_bRunning = false;
@@ -287,14 +359,15 @@ namespace VIDEO
 
       std::string fastHash;
       if (g_advancedSettings.m_bVideoLibraryUseFastHash)
-        fastHash = GetFastHash(strDirectory, regexps);
+        fastHash = GetPrefetchedHash(strDirectory, regexps, false);
 
-      if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
+      if (GetDatabaseHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         hash = fastHash;
       }
       else
       { // need to fetch the folder
+        CommitBatch();
         CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
         items.Stack();
 
@@ -333,11 +406,12 @@ namespace VIDEO
 
       if (foundDirectly && !settings.parent_name_root)
       {
+        CommitBatch();
         CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
         items.SetPath(strDirectory);
         GetPathHash(items, hash);
         bSkip = true;
-        if (!m_database.GetPathHash(strDirectory, dbHash) || dbHash != hash)
+        if (!GetDatabaseHash(strDirectory, dbHash) || dbHash != hash)
           bSkip = false;
         else
           items.Clear();
@@ -358,7 +432,7 @@ namespace VIDEO
       {
         if (!m_bStop && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
         {
-          m_database.SetPathHash(strDirectory, hash);
+          SetDatabaseHash(strDirectory, hash);
           if (m_bClean)
             m_pathsToClean.insert(m_database.GetPathId(strDirectory));
           CLog::Log(LOGDEBUG, "VideoInfoScanner: Finished adding information from dir %s", CURL::GetRedacted(strDirectory).c_str());
@@ -373,12 +447,24 @@ namespace VIDEO
     }
     else if (hash != dbHash && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
     { // update the hash either way - we may have changed the hash to a fast version
-      m_database.SetPathHash(strDirectory, hash);
+      SetDatabaseHash(strDirectory, hash);
     }
 
     if (m_handle)
       OnDirectoryScanned(strDirectory);
 
+    // have the subfolders' hashes ready by the time we get to them
+    if (g_advancedSettings.m_bVideoLibraryUseFastHash && settings.recurse > 0 &&
+        (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
+    {
+      for (int i = 0; i < items.Size(); ++i)
+      {
+        const CFileItemPtr &pItem = items[i];
+        if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList() && !CUtil::ExcludeFileOrFolder(pItem->GetPath(), regexps))
+          PrefetchHash(pItem->GetPath(), regexps, false);
+      }
+    }
+
     for (int i = 0; i < items.Size(); ++i)
     {
       CFileItemPtr pItem = items[i];
@@ -416,10 +502,22 @@ namespace VIDEO
 
     m_database.Open();
 
+    // the shows' recursive hashes are the slow part of a rescan, so have them read in parallel
+    if (content == CONTENT_TVSHOWS && g_advancedSettings.m_bVideoLibraryUseFastHash)
+    {
+      for (int i = 0; i < items.Size(); ++i)
+      {
+        if (items[i]->m_bIsFolder && !CUtil::ExcludeFileOrFolder(items[i]->GetPath(), g_advancedSettings.m_tvshowExcludeFromScanRegExps))
+          PrefetchHash(items[i]->GetPath(), g_advancedSettings.m_tvshowExcludeFromScanRegExps, true);
+      }
+    }
+
     bool FoundSomeInfo = false;
     vector<int> seenPaths;
     for (int i = 0; i < (int)items.Size(); ++i)
     {
+      CommitBatchIfDue();
+
       m_nfoReader.Close();
       CFileItemPtr pItem = items[i];
 
@@ -505,7 +603,7 @@ namespace VIDEO
     {
       INFO_RET ret = RetrieveInfoForEpisodes(pItem, idTvShow, info2, useLocal, pDlgProgress);
       if (ret == INFO_ADDED)
-        m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+        SetDatabaseHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
       return ret;
     }
 
@@ -532,7 +630,7 @@ namespace VIDEO
       {
         INFO_RET ret = RetrieveInfoForEpisodes(pItem, lResult, info2, useLocal, pDlgProgress);
         if (ret == INFO_ADDED)
-          m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+          SetDatabaseHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
         return ret;
       }
       return INFO_ADDED;
@@ -557,7 +655,7 @@ namespace VIDEO
     {
       INFO_RET ret = RetrieveInfoForEpisodes(pItem, lResult, info2, useLocal, pDlgProgress);
       if (ret == INFO_ADDED)
-        m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+        SetDatabaseHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
     }
     return INFO_ADDED;
   }
@@ -693,6 +791,7 @@ namespace VIDEO
 
       if (updateSeasonArt)
       {
+        CommitBatch();
         CVideoInfoDownloader loader(scraper);
         loader.GetArtwork(showInfo);
         GetSeasonThumbs(showInfo, seasonArt, CVideoThumbLoader::GetArtTypes(MediaTypeSeason), useLocal);
@@ -726,9 +825,9 @@ namespace VIDEO
 
       std::string hash, dbHash;
       if (g_advancedSettings.m_bVideoLibraryUseFastHash)
-        hash = GetRecursiveFastHash(item->GetPath(), regexps);
+        hash = GetPrefetchedHash(item->GetPath(), regexps, true);
 
-      if (m_database.GetPathHash(item->GetPath(), dbHash) && !hash.empty() && dbHash == hash)
+      if (GetDatabaseHash(item->GetPath(), dbHash) && !hash.empty() && dbHash == hash)
       {
         // fast hashes match - no need to process anything
         bSkip = true;
@@ -741,6 +840,7 @@ namespace VIDEO
         if (!hash.empty())
           flags |= DIR_FLAG_NO_FILE_INFO;
 
+        CommitBatch();
         CUtil::GetRecursiveListing(item->GetPath(), items, g_advancedSettings.m_videoExtensions, flags);
 
         // fast hash failed - compute slow one
@@ -1212,7 +1312,10 @@ namespace VIDEO
         map<int, map<string, string> > seasonArt;
 
         if (!libraryImport)
+        {
+          CommitBatch();
           GetSeasonThumbs(movieDetails, seasonArt, CVideoThumbLoader::GetArtTypes(MediaTypeSeason), useLocal);
+        }
 
         lResult = m_database.SetDetailsForTvShow(paths, movieDetails, art, seasonArt);
         movieDetails.m_iDbId = lResult;
@@ -1439,6 +1542,8 @@ namespace VIDEO
       if ((pDlgProgress && pDlgProgress->IsCanceled()) || m_bStop)
         return INFO_CANCELLED;
 
+      CommitBatchIfDue();
+
       if (m_database.GetEpisodeId(file->strPath, file->iEpisode, file->iSeason) > -1)
       {
         if (m_handle)
@@ -1484,6 +1589,7 @@ namespace VIDEO
             pDlgProgress->Progress();
           }
 
+          CommitBatch();
           CVideoInfoDownloader imdb(scraper);
           if (!imdb.GetEpisodeList(url, episodes))
             return INFO_NOT_FOUND;
@@ -1582,6 +1688,7 @@ namespace VIDEO
 
       if (bFound)
       {
+        CommitBatch();
         CVideoInfoDownloader imdb(scraper);
         CFileItem item;
         item.SetPath(file->strPath);
@@ -1724,6 +1831,8 @@ namespace VIDEO
     if (m_handle && !url.strTitle.empty())
       m_handle->SetText(url.strTitle);
 
+    // don't hold other writers up while the scraper is online
+    CommitBatch();
     CVideoInfoDownloader imdb(scraper);
     bool ret = imdb.GetDetails(url, movieDetails, pDialog);
 
@@ -1778,7 +1887,7 @@ namespace VIDEO
     return count;
   }
 
-  bool CVideoInfoScanner::CanFastHash(const CFileItemList &items, const vector<string> &excludes) const
+  bool CVideoInfoScanner::CanFastHash(const CFileItemList &items, const vector<string> &excludes)
   {
     if (!g_advancedSettings.m_bVideoLibraryUseFastHash)
       return false;
@@ -1791,7 +1900,7 @@ namespace VIDEO
     return true;
   }
 
-  std::string CVideoInfoScanner::GetFastHash(const std::string &directory, const vector<string> &excludes) const
+  std::string CVideoInfoScanner::GetFastHash(const std::string &directory, const vector<string> &excludes)
   {
     XBMC::XBMC_MD5 md5state;
 
@@ -1813,7 +1922,7 @@ namespace VIDEO
     return "";
   }
 
-  std::string CVideoInfoScanner::GetRecursiveFastHash(const std::string &directory, const vector<string> &excludes) const
+  std::string CVideoInfoScanner::GetRecursiveFastHash(const std::string &directory, const vector<string> &excludes)
   {
     CFileItemList items;
     items.Add(CFileItemPtr(new CFileItem(directory, true)));
@@ -1849,6 +1958,108 @@ namespace VIDEO
     return "";
   }
 
+  void CVideoInfoScanner::PrefetchHash(const std::string &directory, const vector<string> &excludes, bool recursive)
+  {
+    if (m_prefetchedHashes.find(directory) != m_prefetchedHashes.end())
+      return;
+
+    std::shared_ptr<CVideoHashPrefetch> prefetch(new CVideoHashPrefetch(directory, excludes, recursive));
+    m_prefetchedHashes.insert(make_pair(directory, prefetch));
+    m_hashReaders.AddJob(new CVideoHashJob(prefetch));
+  }
+
+  std::string CVideoInfoScanner::GetPrefetchedHash(const std::string &directory, const vector<string> &excludes, bool recursive)
+  {
+    // waiting for the hash or working it out lists the directory, which may be slow
+    CommitBatch();
+
+    map<string, std::shared_ptr<CVideoHashPrefetch> >::iterator it = m_prefetchedHashes.find(directory);
+    if (it != m_prefetchedHashes.end())
+    {
+      std::shared_ptr<CVideoHashPrefetch> prefetch = it->second;
+      m_prefetchedHashes.erase(it);
+
+      if (prefetch->recursive == recursive && prefetch->excludes == excludes)
+      {
+        while (!prefetch->done.WaitMSec(100))
+        {
+          if (m_bStop)
+            return "";
+        }
+        return prefetch->hash;
+      }
+      prefetch->cancelled = true;
+    }
+
+    return recursive ? GetRecursiveFastHash(directory, excludes) : GetFastHash(directory, excludes);
+  }
+
+  void CVideoInfoScanner::PrefetchScanPaths()
+  {
+    if (!g_advancedSettings.m_bVideoLibraryUseFastHash)
+      return;
+
+    for (set<string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); ++it)
+    {
+      SScanSettings settings;
+      bool foundDirectly = false;
+      ScraperPtr info = m_database.GetScraperForPath(*it, settings, foundDirectly);
+      if (!info || (!m_scanAll && settings.noupdate))
+        continue;
+
+      // follows DoScan(): movie folders are fast hashed, and tv shows below
+      // their source recursively by EnumerateSeriesFolder()
+      if (info->Content() == CONTENT_MOVIES || info->Content() == CONTENT_MUSICVIDEOS)
+        PrefetchHash(*it, g_advancedSettings.m_moviesExcludeFromScanRegExps, false);
+      else if (info->Content() == CONTENT_TVSHOWS && (!foundDirectly || settings.parent_name_root))
+        PrefetchHash(*it, g_advancedSettings.m_tvshowExcludeFromScanRegExps, true);
+    }
+  }
+
+  void CVideoInfoScanner::CancelPrefetch()
+  {
+    m_hashReaders.CancelJobs();
+    for (map<string, std::shared_ptr<CVideoHashPrefetch> >::iterator it = m_prefetchedHashes.begin(); it != m_prefetchedHashes.end(); ++it)
+      it->second->cancelled = true;
+    m_prefetchedHashes.clear();
+  }
+
+  bool CVideoInfoScanner::GetDatabaseHash(const std::string &path, std::string &hash)
+  {
+    if (!m_pathHashesLoaded)
+      return m_database.GetPathHash(path, hash);
+
+    map<string, string>::const_iterator it = m_pathHashes.find(path);
+    if (it == m_pathHashes.end())
+      return false;
+
+    hash = it->second;
+    return true;
+  }
+
+  void CVideoInfoScanner::SetDatabaseHash(const std::string &path, const std::string &hash)
+  {
+    if (m_database.SetPathHash(path, hash) && m_pathHashesLoaded)
+      m_pathHashes[path] = hash;
+  }
+
+  void CVideoInfoScanner::CommitBatch()
+  {
+    if (!m_database.InBatch())
+      return;
+
+    // the new batch holds no locks until something is written to it
+    m_database.CommitBatch();
+    m_database.BeginBatch();
+    m_batchStart = XbmcThreads::SystemClockMillis();
+  }
+
+  void CVideoInfoScanner::CommitBatchIfDue()
+  {
+    if (XbmcThreads::SystemClockMillis() - m_batchStart >= BATCH_INTERVAL)
+      CommitBatch();
+  }
+
   void CVideoInfoScanner::GetSeasonThumbs(const CVideoInfoTag &show, map<int, map<string, string> > &seasonArt, const vector<string> &artTypes, bool useLocal)
   {
     bool lookForThumb = find(artTypes.begin(), artTypes.end(), "thumb") == artTypes.end();
@@ -1940,6 +2151,7 @@ namespace VIDEO
   {
     CFileItemList items;
     std::string actorsDir = URIUtils::AddFileToFolder(strPath, ".actors");
+    CommitBatch();
     if (CDirectory::Exists(actorsDir))
       CDirectory::GetDirectory(actorsDir, items, ".png|.jpg|.tbn", DIR_FLAG_NO_FILE_DIRS |
                                DIR_FLAG_NO_FILE_INFO);
@@ -1969,6 +2181,10 @@ namespace VIDEO
 
   CNfoFile::NFOResult CVideoInfoScanner::CheckForNFOFile(CFileItem* pItem, bool bGrabAny, ScraperPtr& info, CScraperUrl& scrUrl)
   {
+    // looking for the nfo lists directories, and the nfo may point to a url
+    // the scraper resolves online
+    CommitBatch();
+
     std::string strNfoFile;
     if (info->Content() == CONTENT_MOVIES || info->Content() == CONTENT_MUSICVIDEOS
         || (info->Content() == CONTENT_TVSHOWS && !pItem->m_bIsFolder))
@@ -2056,6 +2272,7 @@ namespace VIDEO
   int CVideoInfoScanner::FindVideo(const std::string &videoName, const ScraperPtr &scraper, CScraperUrl &url, CGUIDialogProgress *progress)
   {
     MOVIELIST movielist;
+    CommitBatch();
     CVideoInfoDownloader imdb(scraper);
     int returncode = imdb.FindMovie(videoName, movielist, progress);
     if (returncode < 0 || (returncode == 0 && (m_bStop || !DownloadFailed(progress))))
@@ -18,9 +18,13 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <map>
+#include <memory>
+
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
+#include "utils/JobManager.h"
 
 class CRegExp;
 class CFileItem;
@@ -47,6 +51,9 @@ namespace VIDEO
                   INFO_NOT_FOUND,
                   INFO_ADDED };
 
+  class CVideoHashPrefetch;
+  class CVideoHashJob;
+
   class CVideoInfoScanner
   {
   public:
@@ -192,7 +199,7 @@ namespace VIDEO
      \param excludes string array of exclude expressions
      \return the md5 hash of the folder"
      */
-    std::string GetFastHash(const std::string &directory, const std::vector<std::string> &excludes) const;
+    static std::string GetFastHash(const std::string &directory, const std::vector<std::string> &excludes);
 
     /*! \brief Retrieve a "fast" hash of the given directory recursively (if available)
      Performs a stat() on the directory, and uses modified time to create a "fast"
@@ -204,7 +211,7 @@ namespace VIDEO
      \param excludes string array of exclude expressions
      \return the md5 hash of the folder
      */
-    std::string GetRecursiveFastHash(const std::string &directory, const std::vector<std::string> &excludes) const;
+    static std::string GetRecursiveFastHash(const std::string &directory, const std::vector<std::string> &excludes);
 
     /*! \brief Decide whether a folder listing could use the "fast" hash
      Fast hashing can be done whenever the folder contains no scannable subfolders, as the
@@ -214,7 +221,35 @@ namespace VIDEO
      \param excludes string array of exclude expressions
      \return true if this directory listing can be fast hashed, false otherwise
      */
-    bool CanFastHash(const CFileItemList &items, const std::vector<std::string> &excludes) const;
+    static bool CanFastHash(const CFileItemList &items, const std::vector<std::string> &excludes);
+
+    /*! \brief Start computing the "fast" hash of a directory on the job workers
+     The hash is picked up by GetPrefetchedHash() when the scan gets to the directory,
+     so the stat() calls of many directories overlap rather than run one after another.
+     \param directory folder to hash
+     \param excludes string array of exclude expressions
+     \param recursive whether to hash the folder recursively, as for a tv show
+     */
+    void PrefetchHash(const std::string &directory, const std::vector<std::string> &excludes, bool recursive);
+
+    /*! \brief Get the "fast" hash of a directory, waiting for a prefetched one if there is one
+     \sa PrefetchHash, GetFastHash, GetRecursiveFastHash
+     */
+    std::string GetPrefetchedHash(const std::string &directory, const std::vector<std::string> &excludes, bool recursive);
+
+    //! \brief Prefetch the hashes of the paths queued for scanning
+    void PrefetchScanPaths();
+    void CancelPrefetch();
+
+    /*! \brief Get the hash stored for a path, from the hashes loaded at the start of the scan if possible
+     \return false if the path isn't in the database
+     */
+    bool GetDatabaseHash(const std::string &path, std::string &hash);
+    void SetDatabaseHash(const std::string &path, const std::string &hash);
+
+    //! \brief Commit the running batch of database writes, before a scraper or a directory listing, or once it has been open for a while
+    void CommitBatch();
+    void CommitBatchIfDue();
 
     /*! \brief Process a series folder, filling in episode details and adding them to the database.
      TODO: Ideally we would return INFO_HAVE_ALREADY if we don't have to update any episodes
@@ -249,6 +284,14 @@ namespace VIDEO
     std::set<std::string> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+
+    CJobQueue m_hashReaders;
+    std::map<std::string, std::shared_ptr<CVideoHashPrefetch> > m_prefetchedHashes;
+    std::map<std::string, std::string> m_pathHashes; ///< hashes of all paths, loaded at the start of a scan
+    bool m_pathHashesLoaded;
+    unsigned int m_batchStart;
+
+    friend class CVideoHashJob;
   };
 }
 
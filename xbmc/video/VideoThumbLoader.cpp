@@ -261,15 +261,17 @@ bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
 
 bool CVideoThumbLoader::LoadItemCached(CFileItem* pItem)
 {
+  // read the tag through a const item, so a tag shared with copies of the item isn't copied
+  const CFileItem &constItem = *pItem;
   if (pItem->m_bIsShareOrDrive
   ||  pItem->IsParentFolder())
     return false;
 
   m_videoDatabase->Open();
 
-  if (!pItem->HasVideoInfoTag() || !pItem->GetVideoInfoTag()->HasStreamDetails()) // no stream details
+  if (!pItem->HasVideoInfoTag() || !constItem.GetVideoInfoTag()->HasStreamDetails()) // no stream details
   {
-    if ((pItem->HasVideoInfoTag() && pItem->GetVideoInfoTag()->m_iFileId >= 0) // file (or maybe folder) is in the database
+    if ((pItem->HasVideoInfoTag() && constItem.GetVideoInfoTag()->m_iFileId >= 0) // file (or maybe folder) is in the database
     || (!pItem->m_bIsFolder && pItem->IsVideo())) // Some other video file for which we haven't yet got any database details
     {
       if (m_videoDatabase->GetStreamDetails(*pItem))
@@ -282,11 +284,11 @@ bool CVideoThumbLoader::LoadItemCached(CFileItem* pItem)
   {
     FillLibraryArt(*pItem);
 
-    if (!pItem->GetVideoInfoTag()->m_type.empty()                &&
-         pItem->GetVideoInfoTag()->m_type != MediaTypeMovie      &&
-         pItem->GetVideoInfoTag()->m_type != MediaTypeTvShow     &&
-         pItem->GetVideoInfoTag()->m_type != MediaTypeEpisode    &&
-         pItem->GetVideoInfoTag()->m_type != MediaTypeMusicVideo)
+    if (!constItem.GetVideoInfoTag()->m_type.empty()                &&
+         constItem.GetVideoInfoTag()->m_type != MediaTypeMovie      &&
+         constItem.GetVideoInfoTag()->m_type != MediaTypeTvShow     &&
+         constItem.GetVideoInfoTag()->m_type != MediaTypeEpisode    &&
+         constItem.GetVideoInfoTag()->m_type != MediaTypeMusicVideo)
     {
       m_videoDatabase->Close();
       return true; // nothing else to be done
@@ -297,7 +299,7 @@ bool CVideoThumbLoader::LoadItemCached(CFileItem* pItem)
   map<string, string> artwork = pItem->GetArt();
   if (artwork.empty())
   {
-    vector<string> artTypes = GetArtTypes(pItem->HasVideoInfoTag() ? pItem->GetVideoInfoTag()->m_type : "");
+    vector<string> artTypes = GetArtTypes(pItem->HasVideoInfoTag() ? constItem.GetVideoInfoTag()->m_type : "");
     if (find(artTypes.begin(), artTypes.end(), "thumb") == artTypes.end())
       artTypes.push_back("thumb"); // always look for "thumb" art for files
     for (vector<string>::const_iterator i = artTypes.begin(); i != artTypes.end(); ++i)
@@ -317,15 +319,16 @@ bool CVideoThumbLoader::LoadItemCached(CFileItem* pItem)
 
 bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
 {
+  const CFileItem &constItem = *pItem;
   if (pItem->m_bIsShareOrDrive || pItem->IsParentFolder() || pItem->GetPath() == "add")
     return false;
 
   if (pItem->HasVideoInfoTag()                                &&
-     !pItem->GetVideoInfoTag()->m_type.empty()                &&
-      pItem->GetVideoInfoTag()->m_type != MediaTypeMovie      &&
-      pItem->GetVideoInfoTag()->m_type != MediaTypeTvShow     &&
-      pItem->GetVideoInfoTag()->m_type != MediaTypeEpisode    &&
-      pItem->GetVideoInfoTag()->m_type != MediaTypeMusicVideo)
+     !constItem.GetVideoInfoTag()->m_type.empty()                &&
+      constItem.GetVideoInfoTag()->m_type != MediaTypeMovie      &&
+      constItem.GetVideoInfoTag()->m_type != MediaTypeTvShow     &&
+      constItem.GetVideoInfoTag()->m_type != MediaTypeEpisode    &&
+      constItem.GetVideoInfoTag()->m_type != MediaTypeMusicVideo)
     return false; // Nothing to do here
 
   DetectAndAddMissingItemData(*pItem);
@@ -333,7 +336,7 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
   m_videoDatabase->Open();
 
   map<string, string> artwork = pItem->GetArt();
-  vector<string> artTypes = GetArtTypes(pItem->HasVideoInfoTag() ? pItem->GetVideoInfoTag()->m_type : "");
+  vector<string> artTypes = GetArtTypes(pItem->HasVideoInfoTag() ? constItem.GetVideoInfoTag()->m_type : "");
   if (find(artTypes.begin(), artTypes.end(), "thumb") == artTypes.end())
     artTypes.push_back("thumb"); // always look for "thumb" art for files
   for (vector<string>::const_iterator i = artTypes.begin(); i != artTypes.end(); ++i)
@@ -398,7 +401,7 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
     // flag extraction
     if (CSettings::Get().GetBool("myvideos.extractflags") &&
        (!pItem->HasVideoInfoTag()                     ||
-        !pItem->GetVideoInfoTag()->HasStreamDetails() ) )
+        !constItem.GetVideoInfoTag()->HasStreamDetails() ) )
     {
       CFileItem item(*pItem);
       std::string path(item.GetPath());
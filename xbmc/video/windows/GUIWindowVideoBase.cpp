@@ -62,6 +62,7 @@
 #include "Autorun.h"
 #include "URL.h"
 #include "utils/GroupUtils.h"
+#include "TextureCache.h"
 #include "TextureDatabase.h"
 
 using namespace std;
@@ -539,7 +540,7 @@ bool CGUIWindowVideoBase::ShowIMDB(CFileItem *item, const ScraperPtr &info2, boo
       if (db.Open())
       {
         for (CGUIListItem::ArtMap::const_iterator i = item->GetArt().begin(); i != item->GetArt().end(); ++i)
-          db.InvalidateCachedTexture(i->second);
+          CTextureCache::Get().InvalidateCachedTexture(i->second, &db);
         db.Close();
       }
       item->ClearArt();